@@ -6,6 +6,7 @@
 #include <consensus/validation.h>
 #include <crypto/sha256.h>
 #include <node/miner.h>
+#include <qtum/qtumtransaction.h>
 #include <random.h>
 #include <test/util/mining.h>
 #include <test/util/script.h>
@@ -61,5 +62,40 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
     });
 }
 
+
+// Assemble a block from a mempool of payments and contract deployments, with
+// more gas limits than fit under the block gas limit, so the contract stage
+// ranks the packages by GasPackageScore and executes the ones it picks.
+static void BlockAssemblerContractPackageTxns(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    // Mature the coinbases spent below
+    constexpr int NUM_TXS{300};
+    testing_setup->mineBlocks(NUM_TXS);
+
+    const CScript script_pub_key{GetScriptForRawPubKey(testing_setup->coinbaseKey.GetPubKey())};
+    for (int i = 0; i < NUM_TXS; ++i) {
+        const CTransactionRef& coinbase{testing_setup->m_coinbase_txns[i]};
+        std::vector<CTxOut> outputs;
+        CAmount fee{(CAmount)(1 + det_rand.randrange(100)) * CENT};
+        if (i % 3 != 0) {
+            const int64_t gas_limit(100000 + det_rand.randrange(400000));
+            const int64_t gas_price(40 + det_rand.randrange(60));
+            outputs.emplace_back(0, CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(gas_limit) << CScriptNum(gas_price) << std::vector<unsigned char>{0x00} << OP_CREATE);
+            fee += gas_limit * gas_price;
+        }
+        outputs.emplace_back(coinbase->vout[0].nValue - fee, script_pub_key);
+        testing_setup->CreateValidMempoolTransaction({coinbase}, {COutPoint(coinbase->GetHash(), 0)}, /*input_height=*/0, {testing_setup->coinbaseKey}, outputs);
+    }
+    node::BlockAssembler::Options assembler_options;
+    assembler_options.test_block_validity = false;
+
+    bench.run([&] {
+        PrepareBlock(testing_setup->m_node, script_pub_key, assembler_options);
+    });
+}
+
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
+BENCHMARK(BlockAssemblerContractPackageTxns, benchmark::PriorityLevel::HIGH);
@@ -2,8 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <bench/bench.h>
+#include <coins.h>
 #include <kernel/mempool_entry.h>
+#include <key.h>
 #include <policy/policy.h>
 #include <random.h>
 #include <test/util/setup_common.h>
@@ -11,6 +14,7 @@
 #include <util/chaintype.h>
 #include <validation.h>
 
+#include <list>
 #include <vector>
 
 static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
@@ -118,5 +122,57 @@ static void MempoolCheck(benchmark::Bench& bench)
     });
 }
 
+static void MempoolAddressIndex(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+
+    // Transactions between a few hundred P2PKH addresses, spending coins from the view
+    std::vector<CScript> scripts;
+    std::vector<std::pair<uint256, int>> addresses;
+    for (int i = 0; i < 200; ++i) {
+        const PKHash dest{GenerateRandomKey().GetPubKey()};
+        scripts.push_back(GetScriptForDestination(dest));
+        std::vector<unsigned char> address_bytes(32);
+        std::copy(dest.begin(), dest.end(), address_bytes.begin());
+        addresses.emplace_back(uint256(address_bytes), GetAddressIndexType(dest));
+    }
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+    std::list<CTxMemPoolEntry> entries;
+    LockPoints lp;
+    for (int i = 0; i < 2000; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(2);
+        for (auto& in : tx.vin) {
+            in.prevout = COutPoint(Txid::FromUint256(det_rand.rand256()), 0);
+            view.AddCoin(in.prevout, Coin(CTxOut(10 * COIN, scripts[det_rand.randrange(scripts.size())]), 1, false, false), false);
+        }
+        tx.vout.resize(2);
+        for (auto& out : tx.vout) {
+            out.scriptPubKey = scripts[det_rand.randrange(scripts.size())];
+            out.nValue = 10 * COIN;
+        }
+        entries.emplace_back(MakeTransactionRef(tx), 1000, /*time=*/0, /*entry_height=*/1, /*entry_sequence=*/0, /*spends_coinbase=*/false, /*sigops_cost=*/4, lp);
+    }
+
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& entry : entries) {
+            pool.addAddressIndex(entry, view);
+            pool.addSpentIndex(entry, view);
+        }
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> results;
+        pool.getAddressIndex(addresses, results);
+        assert(results.size() == 8000);
+        for (const auto& entry : entries) {
+            pool.removeAddressIndex(entry.GetTx().GetHash());
+            pool.removeSpentIndex(entry.GetTx().GetHash());
+        }
+    });
+}
+
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAddressIndex, benchmark::PriorityLevel::HIGH);
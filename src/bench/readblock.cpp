@@ -9,16 +9,20 @@
 #include <node/blockstorage.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <tinyformat.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
-static FlatFilePos WriteBlockToDisk(ChainstateManager& chainman)
+/** Deflate level used by the compressed block benchmarks */
+static constexpr int BENCH_COMPRESSION_LEVEL{6};
+
+static FlatFilePos WriteBlockToDisk(node::BlockManager& blockman)
 {
     DataStream stream{benchmark::data::blockbench};
     CBlock block;
     stream >> TX_WITH_WITNESS(block);
 
-    return chainman.m_blockman.SaveBlockToDisk(block, 0, nullptr);
+    return blockman.SaveBlockToDisk(block, 0, nullptr);
 }
 
 static void ReadBlockFromDiskTest(benchmark::Bench& bench)
@@ -27,7 +31,7 @@ static void ReadBlockFromDiskTest(benchmark::Bench& bench)
     ChainstateManager& chainman{*testing_setup->m_node.chainman};
 
     CBlock block;
-    const auto pos{WriteBlockToDisk(chainman)};
+    const auto pos{WriteBlockToDisk(chainman.m_blockman)};
 
     bench.run([&] {
         const auto success{chainman.m_blockman.ReadBlockFromDisk(block, pos)};
@@ -41,7 +45,7 @@ static void ReadRawBlockFromDiskTest(benchmark::Bench& bench)
     ChainstateManager& chainman{*testing_setup->m_node.chainman};
 
     std::vector<uint8_t> block_data;
-    const auto pos{WriteBlockToDisk(chainman)};
+    const auto pos{WriteBlockToDisk(chainman.m_blockman)};
 
     bench.run([&] {
         const auto success{chainman.m_blockman.ReadRawBlockFromDisk(block_data, pos)};
@@ -49,5 +53,59 @@ static void ReadRawBlockFromDiskTest(benchmark::Bench& bench)
     });
 }
 
+static void ReadCompressedBlockFromDiskTest(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN)};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+
+    // Use a separate blocks directory so the compressed block does not clobber the chainstate's block files
+    const fs::path blocks_dir{testing_setup->m_path_root / "compressed_blocks"};
+    fs::create_directories(blocks_dir);
+    const node::BlockManager::Options blockman_opts{
+        .chainparams = chainman.GetParams(),
+        .blocks_dir = blocks_dir,
+        .notifications = chainman.GetNotifications(),
+        .block_compression_level = BENCH_COMPRESSION_LEVEL,
+    };
+    node::BlockManager blockman{*Assert(testing_setup->m_node.shutdown), blockman_opts};
+
+    CBlock block;
+    const auto pos{WriteBlockToDisk(blockman)};
+    const uint64_t stored_size{blockman.CalculateCurrentUsage() - BLOCK_SERIALIZATION_HEADER_SIZE};
+    const uint64_t block_size{benchmark::data::blockbench.size()};
+    bench.name(strprintf("%s (%u of %u bytes saved on disk)", __func__, block_size - stored_size, block_size));
+
+    bench.run([&] {
+        const auto success{blockman.ReadBlockFromDisk(block, pos)};
+        assert(success);
+    });
+}
+
+static void CompressBlockData(benchmark::Bench& bench)
+{
+    const Span<const uint8_t> block_data{benchmark::data::blockbench};
+    const size_t compressed_size{node::CompressBlockData(block_data, BENCH_COMPRESSION_LEVEL).size()};
+    bench.name(strprintf("%s (%u of %u bytes saved)", __func__, block_data.size() - compressed_size, block_data.size()));
+
+    bench.batch(block_data.size()).unit("byte").run([&] {
+        const auto compressed{node::CompressBlockData(block_data, BENCH_COMPRESSION_LEVEL)};
+        ankerl::nanobench::doNotOptimizeAway(compressed);
+    });
+}
+
+static void DecompressBlockData(benchmark::Bench& bench)
+{
+    const auto compressed{node::CompressBlockData(benchmark::data::blockbench, BENCH_COMPRESSION_LEVEL)};
+    std::vector<uint8_t> block_data;
+
+    bench.batch(benchmark::data::blockbench.size()).unit("byte").run([&] {
+        const auto success{node::DecompressBlockData(compressed, block_data)};
+        assert(success);
+    });
+}
+
 BENCHMARK(ReadBlockFromDiskTest, benchmark::PriorityLevel::HIGH);
 BENCHMARK(ReadRawBlockFromDiskTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ReadCompressedBlockFromDiskTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CompressBlockData, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DecompressBlockData, benchmark::PriorityLevel::HIGH);
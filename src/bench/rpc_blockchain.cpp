@@ -13,6 +13,8 @@
 
 #include <univalue.h>
 
+#include <string_view>
+
 namespace {
 
 struct TestBlockAndIndex {
@@ -59,3 +61,18 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite, benchmark::PriorityLevel::HIGH);
+
+static void BlockToJsonVerboseStream(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    bench.run([&] {
+        // Bytes only pass through, so the whole reply is never held in memory
+        size_t size{0};
+        UniValueStreamWriter writer([&](std::string_view chunk) { size += chunk.size(); });
+        blockToJSON(data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, writer);
+        writer.flush();
+        ankerl::nanobench::doNotOptimizeAway(size);
+    });
+}
+
+BENCHMARK(BlockToJsonVerboseStream, benchmark::PriorityLevel::HIGH);
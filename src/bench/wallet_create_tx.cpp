@@ -35,7 +35,8 @@ TipBlock getTip(const CChainParams& params, const node::NodeContext& context)
 void generateFakeBlock(const CChainParams& params,
                        const node::NodeContext& context,
                        CWallet& wallet,
-                       const CScript& coinbase_out_script)
+                       const CScript& coinbase_out_script,
+                       const std::vector<CTransactionRef>& txs = {})
 {
     TipBlock tip{getTip(params, context)};
 
@@ -51,6 +52,7 @@ void generateFakeBlock(const CChainParams& params,
     coinbase_tx.vout[1].scriptPubKey = coinbase_out_script; // extra output
     coinbase_tx.vout[1].nValue = 1 * COIN;
     block.vtx = {MakeTransactionRef(std::move(coinbase_tx))};
+    block.vtx.insert(block.vtx.end(), txs.begin(), txs.end());
 
     block.nVersion = VERSIONBITS_LAST_OLD_BLOCK_VERSION;
     block.hashPrevBlock = tip.prev_block_hash;
@@ -175,6 +177,55 @@ static void AvailableCoins(benchmark::Bench& bench, const std::vector<OutputType
     });
 }
 
+// Wallet of a staker, with the many small outputs left by staking rewards and MPoS payouts,
+// and as many outputs spent since by consolidations
+static void WalletAvailableCoinsManySmallUtxos(benchmark::Bench& bench)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    // Set clock to genesis block, so the descriptors/keys creation time don't interfere with the blocks scanning process.
+    SetMockTime(test_setup->m_node.chainman->GetParams().GenesisBlock().nTime);
+    CWallet wallet{test_setup->m_node.chain.get(), "", CreateMockableWalletDatabase()};
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        wallet.SetupDescriptorScriptPubKeyMans();
+    }
+
+    const CScript dest_wallet{GetScriptForDestination(getNewDestination(wallet, OutputType::LEGACY))};
+    const CScript dest_other{CScript() << OP_TRUE};
+
+    // Each block pays the wallet in a transaction with many outputs. The payouts
+    // of the first half of the blocks are consolidated in the same block.
+    const auto& params = Params();
+    constexpr unsigned int num_blocks = 200;
+    constexpr unsigned int outputs_per_block = 1000;
+    for (unsigned int i = 0; i < num_blocks; ++i) {
+        CMutableTransaction payout;
+        payout.vin.emplace_back(COutPoint(Txid::FromUint256(GetRandHash()), 0));
+        payout.vout.assign(outputs_per_block, CTxOut(COIN / 10, dest_wallet));
+        std::vector<CTransactionRef> txs{MakeTransactionRef(std::move(payout))};
+        if (i < num_blocks / 2) {
+            CMutableTransaction consolidation;
+            for (unsigned int n = 0; n < outputs_per_block; ++n) {
+                consolidation.vin.emplace_back(COutPoint(txs[0]->GetHash(), n));
+            }
+            consolidation.vout.emplace_back(outputs_per_block * (COIN / 10), dest_other);
+            txs.push_back(MakeTransactionRef(std::move(consolidation)));
+        }
+        generateFakeBlock(params, test_setup->m_node, wallet, dest_other, txs);
+    }
+
+    constexpr size_t num_coins = num_blocks / 2 * outputs_per_block;
+    auto bal = WITH_LOCK(wallet.cs_wallet, return wallet::AvailableCoins(wallet).GetTotalAmount()); // Cache
+    assert(bal == (int64_t) (num_coins * (COIN / 10)));
+
+    bench.epochIterations(2).run([&] {
+        LOCK(wallet.cs_wallet);
+        const auto& res = wallet::AvailableCoins(wallet);
+        assert(res.All().size() == num_coins);
+    });
+}
+
 static void WalletCreateTxUseOnlyPresetInputs(benchmark::Bench& bench) { WalletCreateTx(bench, OutputType::BECH32, /*allow_other_inputs=*/false,
                                                                                         {{/*num_of_internal_inputs=*/4}}); }
 
@@ -186,3 +237,4 @@ static void WalletAvailableCoins(benchmark::Bench& bench) { AvailableCoins(bench
 BENCHMARK(WalletCreateTxUseOnlyPresetInputs, benchmark::PriorityLevel::LOW)
 BENCHMARK(WalletCreateTxUsePresetInputsAndCoinSelection, benchmark::PriorityLevel::LOW)
 BENCHMARK(WalletAvailableCoins, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletAvailableCoinsManySmallUtxos, benchmark::PriorityLevel::LOW);
@@ -0,0 +1,49 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
+#include <bench/bench.h>
+#include <test/util/setup_common.h>
+#include <util/translation.h>
+#ifdef USE_SQLITE
+#include <wallet/sqlite.h>
+#endif
+
+#include <cassert>
+
+namespace wallet {
+#ifdef USE_SQLITE
+static void WalletSQLiteWrites(benchmark::Bench& bench, int64_t group_commit_ms)
+{
+    const auto test_setup = MakeNoLogFileContext<BasicTestingSetup>();
+
+    DatabaseOptions options;
+    options.group_commit_ms = group_commit_ms;
+    DatabaseStatus status;
+    bilingual_str error;
+    std::unique_ptr<SQLiteDatabase> database = MakeSQLiteDatabase(test_setup->m_path_root / "sqlite", options, status, error);
+    assert(database);
+
+    // Writes made like the ones of block processing, which are not flushed on close
+    const std::string value(200, 'v');
+    uint32_t n{0};
+    bench.batch(100).unit("write").run([&] {
+        std::unique_ptr<DatabaseBatch> batch = database->MakeBatch(/*flush_on_close=*/false);
+        for (int i = 0; i < 100; ++i) {
+            assert(batch->Write(std::make_pair(std::string("key"), n++), value));
+        }
+    });
+    database->Flush();
+}
+
+static void WalletSQLiteWritesCommitEach(benchmark::Bench& bench) { WalletSQLiteWrites(bench, /*group_commit_ms=*/0); }
+static void WalletSQLiteWritesGroupCommit(benchmark::Bench& bench) { WalletSQLiteWrites(bench, /*group_commit_ms=*/1000); }
+
+BENCHMARK(WalletSQLiteWritesCommitEach, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletSQLiteWritesGroupCommit, benchmark::PriorityLevel::HIGH);
+#endif
+} // namespace wallet
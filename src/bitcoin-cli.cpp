@@ -32,6 +32,7 @@
 #include <cmath>
 #include <cstdio>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -57,6 +58,7 @@ static const char DEFAULT_RPCCONNECT[] = "127.0.0.1";
 static const int DEFAULT_HTTP_CLIENT_TIMEOUT=900;
 static constexpr int DEFAULT_WAIT_CLIENT_TIMEOUT = 0;
 static const bool DEFAULT_NAMED=false;
+static constexpr int DEFAULT_STDIN_BATCH_SIZE{100};
 static const int CONTINUE_EXECUTION=-1;
 static constexpr int8_t UNKNOWN_NETWORK{-1};
 // See GetNetworkName() in netbase.cpp
@@ -104,6 +106,8 @@ static void SetupCliArgs(ArgsManager& argsman)
     argsman.AddArg("-rpcwait", "Wait for RPC server to start", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-rpcwaittimeout=<n>", strprintf("Timeout in seconds to wait for the RPC server to start, or 0 for no timeout. (default: %d)", DEFAULT_WAIT_CLIENT_TIMEOUT), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
     argsman.AddArg("-rpcwallet=<walletname>", "Send RPC for non-default wallet on RPC server (needs to exactly match corresponding -wallet option passed to qtumd). This changes the RPC endpoint used, e.g. http://127.0.0.1:8332/wallet/<walletname>", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-stdinbatch", "Read commands from standard input, one per line as the method followed by its arguments, and send them as JSON-RPC batches over one connection. Arguments containing spaces can be quoted, empty lines and lines starting with # are skipped. Prints one line per command to standard output, the compact result or an empty line if the command failed, in which case the error goes to standard error.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-stdinbatchsize=<n>", strprintf("Number of commands sent per JSON-RPC batch with -stdinbatch (default: %d)", DEFAULT_STDIN_BATCH_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-stdin", "Read extra arguments from standard input, one per line until EOF/Ctrl-D (recommended for sensitive information such as passphrases). When combined with -stdinrpcpass, the first line from standard input is used for the RPC password.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-stdinrpcpass", "Read RPC password from standard input as a single line. When combined with -stdin, the first line from standard input is used for the RPC password. When combined with -stdinwalletpassphrase, -stdinrpcpass consumes the first line, and -stdinwalletpassphrase consumes the second.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-stdinwalletpassphrase", "Read wallet passphrase from standard input as a single line. When combined with -stdin, the first line from standard input is used for the wallet passphrase.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -192,6 +196,7 @@ struct HTTPReply
     int status{0};
     int error{-1};
     std::string body;
+    bool done{false};
 };
 
 static std::string http_errorstring(int code)
@@ -218,6 +223,7 @@ static void http_request_done(struct evhttp_request *req, void *ctx)
 {
     HTTPReply *reply = static_cast<HTTPReply*>(ctx);
 
+    reply->done = true;
     if (req == nullptr) {
         /* If req is nullptr, it means an error occurred while connecting: the
          * error code will have been passed to http_error_cb.
@@ -745,7 +751,16 @@ public:
     }
 };
 
-static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, const std::vector<std::string>& args, const std::optional<std::string>& rpcwallet = {})
+/** Connection to the RPC server, which -stdinbatch reuses for all its requests */
+struct RPCConnection
+{
+    std::string host;
+    uint16_t port;
+    raii_event_base base;
+    raii_evhttp_connection evcon;
+};
+
+static RPCConnection OpenRPCConnection()
 {
     std::string host;
     // In preference order, we choose the following for the port:
@@ -775,6 +790,18 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
             evhttp_connection_set_timeout(evcon.get(), 5 * YEAR_IN_SECONDS);
         }
     }
+    return {host, port, std::move(base), std::move(evcon)};
+}
+
+/**
+ * Send a JSON-RPC request and return the parsed reply. With keep_alive the
+ * connection stays open for the next request, libevent reconnects if the
+ * server closed it in between.
+ */
+static UniValue SendRPCRequest(RPCConnection& conn, const std::string& strRequest, const std::optional<std::string>& rpcwallet, bool keep_alive)
+{
+    const std::string& host = conn.host;
+    const uint16_t port = conn.port;
 
     HTTPReply response;
     raii_evhttp_request req = obtain_evhttp_request(http_request_done, (void*)&response);
@@ -799,12 +826,11 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
     struct evkeyvalq* output_headers = evhttp_request_get_output_headers(req.get());
     assert(output_headers);
     evhttp_add_header(output_headers, "Host", host.c_str());
-    evhttp_add_header(output_headers, "Connection", "close");
+    if (!keep_alive) evhttp_add_header(output_headers, "Connection", "close");
     evhttp_add_header(output_headers, "Content-Type", "application/json");
     evhttp_add_header(output_headers, "Authorization", (std::string("Basic ") + EncodeBase64(strRPCUserColonPass)).c_str());
 
     // Attach request data
-    std::string strRequest = rh->PrepareRequest(strMethod, args).write() + "\n";
     struct evbuffer* output_buffer = evhttp_request_get_output_buffer(req.get());
     assert(output_buffer);
     evbuffer_add(output_buffer, strRequest.data(), strRequest.size());
@@ -820,13 +846,18 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
             throw CConnectionFailed("uri-encode failed");
         }
     }
-    int r = evhttp_make_request(evcon.get(), req.get(), EVHTTP_REQ_POST, endpoint.c_str());
+    int r = evhttp_make_request(conn.evcon.get(), req.get(), EVHTTP_REQ_POST, endpoint.c_str());
     req.release(); // ownership moved to evcon in above call
     if (r != 0) {
         throw CConnectionFailed("send http request failed");
     }
 
-    event_base_dispatch(base.get());
+    if (keep_alive) {
+        // The idle connection keeps the event loop busy, so stop at the reply
+        while (!response.done && event_base_loop(conn.base.get(), EVLOOP_ONCE) == 0) {}
+    } else {
+        event_base_dispatch(conn.base.get());
+    }
 
     if (response.status == 0) {
         std::string responseErrorMessage;
@@ -853,6 +884,13 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
     UniValue valReply(UniValue::VSTR);
     if (!valReply.read(response.body))
         throw std::runtime_error("couldn't parse reply from server");
+    return valReply;
+}
+
+static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, const std::vector<std::string>& args, const std::optional<std::string>& rpcwallet = {})
+{
+    RPCConnection conn = OpenRPCConnection();
+    UniValue valReply = SendRPCRequest(conn, rh->PrepareRequest(strMethod, args).write() + "\n", rpcwallet, /*keep_alive=*/false);
     UniValue reply = rh->ProcessReply(valReply);
     if (reply.empty())
         throw std::runtime_error("expected reply to have result, error and id properties");
@@ -1126,6 +1164,124 @@ static void SetGenerateToAddressArgs(const std::string& address, std::vector<std
     args.emplace(args.begin() + 1, address);
 }
 
+/**
+ * Split a -stdinbatch line into words at whitespace. Single quotes keep
+ * everything up to the closing quote, double quotes keep everything but a
+ * backslash escapes the next character.
+ */
+static std::vector<std::string> SplitCommandLine(const std::string& line)
+{
+    std::vector<std::string> words;
+    std::string word;
+    bool in_word{false};
+    char quote{0};
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quote == '\'') {
+            if (c == '\'') quote = 0; else word += c;
+        } else if (c == '\\' && i + 1 < line.size()) {
+            word += line[++i];
+            in_word = true;
+        } else if (quote == '"') {
+            if (c == '"') quote = 0; else word += c;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            in_word = true;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            if (in_word) words.push_back(std::move(word));
+            word.clear();
+            in_word = false;
+        } else {
+            word += c;
+            in_word = true;
+        }
+    }
+    if (quote) throw std::runtime_error("unterminated quote");
+    if (in_word) words.push_back(std::move(word));
+    return words;
+}
+
+/**
+ * Run the commands read from stdin with -stdinbatch, sending them in batches
+ * over one kept-alive connection and printing the results in input order.
+ * Returns the exit code of the first failed command, or 0.
+ */
+static int StdinBatchRPC()
+{
+    const size_t batch_size = std::max<int64_t>(gArgs.GetIntArg("-stdinbatchsize", DEFAULT_STDIN_BATCH_SIZE), 1);
+    const bool named = gArgs.GetBoolArg("-named", DEFAULT_NAMED);
+    std::optional<std::string> wallet_name{};
+    if (gArgs.IsArgSet("-rpcwallet")) wallet_name = gArgs.GetArg("-rpcwallet", "");
+    RPCConnection conn = OpenRPCConnection();
+
+    int nRet = 0;
+    auto print_error = [&](int64_t line_number, const UniValue& error) {
+        std::string strPrint;
+        int code = EXIT_FAILURE;
+        ParseError(error, strPrint, code);
+        tfm::format(std::cerr, "line %d: %s\n", line_number, strPrint);
+        if (nRet == 0) nRet = code;
+    };
+
+    int64_t line_number = 0;
+    bool eof = false;
+    while (!eof) {
+        // Commands of this batch by line number, those that failed to parse have an error instead
+        std::vector<std::pair<int64_t, UniValue>> commands;
+        UniValue batch(UniValue::VARR);
+        std::string line;
+        while (commands.size() < batch_size) {
+            if (!std::getline(std::cin, line)) {
+                eof = true;
+                break;
+            }
+            ++line_number;
+            try {
+                std::vector<std::string> args = SplitCommandLine(line);
+                if (args.empty() || args[0][0] == '#') continue;
+                const std::string method = args[0];
+                args.erase(args.begin());
+                batch.push_back(JSONRPCRequestObj(method, named ? RPCConvertNamedValues(method, args) : RPCConvertValues(method, args), line_number));
+                commands.emplace_back(line_number, NullUniValue);
+            } catch (const std::exception& e) {
+                commands.emplace_back(line_number, JSONRPCError(RPC_INVALID_PARAMETER, e.what()));
+            }
+        }
+        if (commands.empty()) continue;
+
+        std::map<int64_t, UniValue> replies;
+        if (!batch.empty()) {
+            const UniValue reply = SendRPCRequest(conn, batch.write() + "\n", wallet_name, /*keep_alive=*/true);
+            if (!reply.isArray()) {
+                // The whole batch was rejected
+                throw std::runtime_error(strprintf("server returned an error for the batch: %s", reply.write()));
+            }
+            for (const UniValue& entry : reply.getValues()) {
+                const UniValue& id = entry.find_value("id");
+                if (id.isNum()) replies[id.getInt<int64_t>()] = entry;
+            }
+        }
+
+        std::string output;
+        for (const auto& [number, parse_error] : commands) {
+            if (!parse_error.isNull()) {
+                print_error(number, parse_error);
+            } else if (auto it = replies.find(number); it == replies.end()) {
+                print_error(number, JSONRPCError(RPC_MISC_ERROR, "no reply from server"));
+            } else if (const UniValue& error = it->second.find_value("error"); !error.isNull()) {
+                print_error(number, error);
+            } else {
+                const UniValue& result = it->second.find_value("result");
+                if (!result.isNull()) output += result.isStr() ? result.get_str() : result.write();
+            }
+            // A failed command leaves an empty line, to keep the output aligned with the input
+            output += '\n';
+        }
+        std::cout << output << std::flush;
+    }
+    return nRet;
+}
+
 static int CommandLineRPC(int argc, char *argv[])
 {
     std::string strPrint;
@@ -1151,6 +1307,12 @@ static int CommandLineRPC(int argc, char *argv[])
             }
             gArgs.ForceSetArg("-rpcpassword", rpcPass);
         }
+        if (gArgs.GetBoolArg("-stdinbatch", false)) {
+            if (argc > 1 || gArgs.GetBoolArg("-stdin", false)) {
+                throw std::runtime_error("-stdinbatch reads the commands from standard input, it can't be combined with a command or -stdin");
+            }
+            return StdinBatchRPC();
+        }
         std::vector<std::string> args = std::vector<std::string>(&argv[1], &argv[argc]);
         if (gArgs.GetBoolArg("-stdinwalletpassphrase", false)) {
             NO_STDIN_ECHO();
@@ -158,6 +158,16 @@ void LevelDB::commit(std::unique_ptr<WriteBatchFace> _batch)
     checkStatus(status);
 }
 
+void LevelDB::sync()
+{
+    // An empty synchronous write flushes the log holding all earlier writes
+    leveldb::WriteOptions writeOptions = m_writeOptions;
+    writeOptions.sync = true;
+    leveldb::WriteBatch batch;
+    auto const status = m_db->Write(writeOptions, &batch);
+    checkStatus(status);
+}
+
 void LevelDB::forEach(std::function<bool(Slice, Slice)> _f) const
 {
     std::unique_ptr<leveldb::Iterator> itr(m_db->NewIterator(m_readOptions));
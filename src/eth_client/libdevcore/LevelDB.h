@@ -33,6 +33,7 @@ public:
 
     std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
     void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+    void sync() override;
 
     void forEach(std::function<bool(Slice, Slice)> _f) const override;
 
@@ -85,6 +85,12 @@ void OverlayDB::commit()
     }
 }
 
+void OverlayDB::sync()
+{
+    if (m_db)
+        m_db->sync();
+}
+
 bytes OverlayDB::lookupAux(h256 const& _h) const
 {
     bytes ret = StateCacheDB::lookupAux(_h);
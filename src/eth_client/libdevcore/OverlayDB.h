@@ -34,6 +34,7 @@ public:
 
     void commit();
 	void rollback();
+    void sync();
 
 	std::string lookup(h256 const& _h) const;
 	bool exists(h256 const& _h) const;
@@ -46,6 +46,10 @@ public:
     virtual std::unique_ptr<WriteBatchFace> createWriteBatch() const = 0;
     virtual void commit(std::unique_ptr<WriteBatchFace> _batch) = 0;
 
+    // Make all previous writes durable, as they may have been committed
+    // without waiting for the disk.
+    virtual void sync() {}
+
     // A database must implement the `forEach` method that allows the caller
     // to pass in a function `f`, which will be called with the key and value
     // of each record in the database. If `f` returns false, the `forEach`
@@ -19,6 +19,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -26,6 +27,30 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Larger requests are not parsed on the event loop thread to pick their work queue */
+static const size_t MAX_RPC_CLASSIFY_SIZE = 64 * 1024;
+
+/** Work classes of the methods that don't belong to the default queue, -rpcworkclass can override them */
+static const std::map<std::string, HTTPWorkClass> DEFAULT_RPC_WORK_CLASSES{
+    {"dumptxoutset", HTTPWorkClass::SLOW},
+    {"getaddressbalance", HTTPWorkClass::SLOW},
+    {"getaddressdeltas", HTTPWorkClass::SLOW},
+    {"getaddresstxids", HTTPWorkClass::SLOW},
+    {"getaddressutxos", HTTPWorkClass::SLOW},
+    {"getblockstats", HTTPWorkClass::SLOW},
+    {"gettxoutsetinfo", HTTPWorkClass::SLOW},
+    {"importdescriptors", HTTPWorkClass::SLOW},
+    {"importmulti", HTTPWorkClass::SLOW},
+    {"rescanblockchain", HTTPWorkClass::SLOW},
+    {"scantxoutset", HTTPWorkClass::SLOW},
+    {"searchlogs", HTTPWorkClass::SLOW},
+    {"verifychain", HTTPWorkClass::SLOW},
+    {"waitforblock", HTTPWorkClass::LONGPOLL},
+    {"waitforblockheight", HTTPWorkClass::LONGPOLL},
+    {"waitforlogs", HTTPWorkClass::LONGPOLL},
+    {"waitfornewblock", HTTPWorkClass::LONGPOLL},
+};
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -72,6 +97,8 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 /* RPC Auth Whitelist */
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
+/* Work class by method, only written before the HTTP server starts */
+static std::map<std::string, HTTPWorkClass> g_rpc_work_classes;
 
 static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id)
 {
@@ -206,6 +233,7 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
+            jreq.allowStreaming = true;
             UniValue result = tableRPC.execute(jreq);
 
             if (jreq.isLongPolling) {
@@ -213,6 +241,11 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 return true;
             }
 
+            // The reply was streamed by the handler
+            if (req->ReplySent()) {
+                return true;
+            }
+
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
 
@@ -304,16 +337,63 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+HTTPWorkClass GetRPCWorkClass(const UniValue& request, const std::map<std::string, HTTPWorkClass>& classes)
+{
+    HTTPWorkClass work_class{HTTPWorkClass::DEFAULT};
+    if (request.isArray()) {
+        // A batch takes as long as its slowest call
+        for (size_t i = 0; i < request.size(); ++i) {
+            work_class = std::max(work_class, GetRPCWorkClass(request[i], classes));
+        }
+    } else if (request.isObject()) {
+        const UniValue& method = request.find_value("method");
+        if (method.isStr()) {
+            auto it = classes.find(method.get_str());
+            if (it != classes.end()) work_class = it->second;
+        }
+    }
+    return work_class;
+}
+
+static HTTPWorkClass ClassifyJSONRPC(const HTTPRequest* req)
+{
+    if (req->GetRequestMethod() != HTTPRequest::POST) return HTTPWorkClass::DEFAULT;
+    std::optional<std::string> body = req->PeekBody(MAX_RPC_CLASSIFY_SIZE);
+    UniValue valRequest;
+    if (!body || !valRequest.read(*body)) return HTTPWorkClass::DEFAULT;
+    return GetRPCWorkClass(valRequest, g_rpc_work_classes);
+}
+
+static bool InitRPCWorkClasses()
+{
+    g_rpc_work_classes = DEFAULT_RPC_WORK_CLASSES;
+    for (const std::string& strWorkClass : gArgs.GetArgs("-rpcworkclass")) {
+        auto pos = strWorkClass.find(':');
+        std::optional<HTTPWorkClass> work_class;
+        if (pos != std::string::npos) {
+            work_class = ParseHTTPWorkClass(strWorkClass.substr(pos + 1));
+        }
+        if (pos == 0 || !work_class) {
+            LogPrintf("Invalid -rpcworkclass argument %s.\n", strWorkClass);
+            return false;
+        }
+        g_rpc_work_classes[strWorkClass.substr(0, pos)] = *work_class;
+    }
+    return true;
+}
+
 bool StartHTTPRPC(const std::any& context)
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    if (!InitRPCWorkClasses())
+        return false;
 
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    RegisterHTTPHandler("/", true, handle_rpc, ClassifyJSONRPC);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, ClassifyJSONRPC);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -5,7 +5,13 @@
 #ifndef BITCOIN_HTTPRPC_H
 #define BITCOIN_HTTPRPC_H
 
+#include <httpserver.h>
+
 #include <any>
+#include <map>
+#include <string>
+
+class UniValue;
 
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
@@ -19,6 +25,9 @@ void InterruptHTTPRPC();
  */
 void StopHTTPRPC();
 
+/** Work class of a JSON-RPC request by its method, or the slowest of its calls for a batch */
+HTTPWorkClass GetRPCWorkClass(const UniValue& request, const std::map<std::string, HTTPWorkClass>& classes);
+
 /** Start HTTP REST subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -18,28 +18,41 @@
 #include <rpc/server.h> // For HTTP status codes
 #include <sync.h>
 #include <util/check.h>
+#include <util/fs.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/syserror.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <bit>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifndef WIN32
+#include <sys/un.h>
+#endif
 
 #include <event2/buffer.h>
 #include <event2/bufferevent.h>
 #include <event2/http.h>
 #include <event2/http_struct.h>
 #include <event2/keyvalq_struct.h>
+#include <event2/listener.h>
 #include <event2/thread.h>
 #include <event2/util.h>
 
@@ -48,25 +61,11 @@
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
-/** HTTP request work item */
-class HTTPWorkItem final : public HTTPClosure
+/** Add a value to the power of two bucket it falls in */
+static void AddToHistogram(std::vector<uint64_t>& histogram, uint64_t value)
 {
-public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
-    {
-    }
-    void operator()() override
-    {
-        func(req.get(), path);
-    }
-
-    std::unique_ptr<HTTPRequest> req;
-
-private:
-    std::string path;
-    HTTPRequestHandler func;
-};
+    histogram[std::min<size_t>(std::bit_width(value), histogram.size() - 1)]++;
+}
 
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
@@ -77,13 +76,20 @@ class WorkQueue
 private:
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
+    std::deque<std::pair<SteadyClock::time_point, std::unique_ptr<WorkItem>>> queue GUARDED_BY(cs);
     bool running GUARDED_BY(cs){true};
     const size_t maxDepth;
+    HTTPWorkQueueStats stats GUARDED_BY(cs);
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : maxDepth(_maxDepth)
+    WorkQueue(HTTPWorkClass work_class, size_t _maxDepth, int threads) : maxDepth(_maxDepth)
     {
+        stats.work_class = work_class;
+        stats.threads = threads;
+        stats.max_depth = maxDepth;
+        stats.depth_histogram.resize(HTTP_WORK_HISTOGRAM_BUCKETS);
+        stats.wait_histogram.resize(HTTP_WORK_HISTOGRAM_BUCKETS);
+        stats.run_histogram.resize(HTTP_WORK_HISTOGRAM_BUCKETS);
     }
     /** Precondition: worker threads have all stopped (they have been joined).
      */
@@ -93,9 +99,12 @@ public:
     {
         LOCK(cs);
         if (!running || queue.size() >= maxDepth) {
+            ++stats.rejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        AddToHistogram(stats.depth_histogram, queue.size());
+        queue.emplace_back(SteadyClock::now(), std::unique_ptr<WorkItem>(item));
+        stats.peak_depth = std::max(stats.peak_depth, queue.size());
         cond.notify_one();
         return true;
     }
@@ -104,16 +113,28 @@ public:
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            SteadyClock::time_point start;
             {
                 WAIT_LOCK(cs, lock);
                 while (running && queue.empty())
                     cond.wait(lock);
                 if (!running && queue.empty())
                     break;
-                i = std::move(queue.front());
+                start = SteadyClock::now();
+                AddToHistogram(stats.wait_histogram, Ticks<std::chrono::milliseconds>(start - queue.front().first));
+                i = std::move(queue.front().second);
                 queue.pop_front();
             }
+            if (i->Abandoned()) {
+                i->Cancel();
+                WITH_LOCK(cs, ++stats.cancelled);
+                continue;
+            }
             (*i)();
+            const auto run_time{Ticks<std::chrono::milliseconds>(SteadyClock::now() - start)};
+            LOCK(cs);
+            AddToHistogram(stats.run_histogram, run_time);
+            ++stats.processed;
         }
     }
     /** Interrupt and exit loops */
@@ -123,17 +144,41 @@ public:
         running = false;
         cond.notify_all();
     }
+    HTTPWorkQueueStats GetStats() EXCLUSIVE_LOCKS_REQUIRED(!cs)
+    {
+        LOCK(cs);
+        HTTPWorkQueueStats result{stats};
+        result.depth = queue.size();
+        return result;
+    }
 };
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPWorkClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPWorkClassifier classifier;
+};
+
+/** Arguments configuring the work queue of each class, in HTTPWorkClass order */
+struct HTTPWorkQueueArgs
+{
+    HTTPWorkClass work_class;
+    const char* threads_arg;
+    int default_threads;
+    const char* depth_arg;
+    int default_depth;
+    const char* thread_name;
+};
+static const HTTPWorkQueueArgs HTTP_WORK_QUEUE_ARGS[]{
+    {HTTPWorkClass::DEFAULT, "-rpcthreads", DEFAULT_HTTP_THREADS, "-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE, "httpworker"},
+    {HTTPWorkClass::SLOW, "-rpcslowthreads", DEFAULT_HTTP_SLOW_THREADS, "-rpcslowworkqueue", DEFAULT_HTTP_SLOW_WORKQUEUE, "httpslow"},
+    {HTTPWorkClass::LONGPOLL, "-rpclongpollthreads", DEFAULT_HTTP_LONGPOLL_THREADS, "-rpclongpollworkqueue", DEFAULT_HTTP_LONGPOLL_WORKQUEUE, "httplongpoll"},
 };
 
 /** HTTP module state */
@@ -144,13 +189,15 @@ static struct event_base* eventBase = nullptr;
 static struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
+//! Work queues for handling longer requests off the event loop thread, by work class
+static std::map<HTTPWorkClass, std::unique_ptr<WorkQueue<HTTPClosure>>> g_work_queues;
 //! Handlers for (sub)paths
 static GlobalMutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
 //! Bound listening sockets
 static std::vector<evhttp_bound_socket *> boundSockets;
+//! Paths of the bound Unix domain sockets, removed when the server stops
+static std::vector<fs::path> g_unix_socket_paths;
 
 /**
  * @brief Helps keep track of open `evhttp_connection`s with active `evhttp_requests`
@@ -193,6 +240,11 @@ public:
         auto it{m_tracker.find(Assert(conn))};
         if (it != m_tracker.end()) RemoveConnectionInternal(it);
     }
+    //! Whether the connection is still open with active requests
+    bool HasConnection(const evhttp_connection* conn) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        return WITH_LOCK(m_mutex, return m_tracker.count(conn) > 0);
+    }
     size_t CountActiveConnections() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         return WITH_LOCK(m_mutex, return m_tracker.size());
@@ -207,6 +259,39 @@ public:
 //! Track active requests
 static HTTPRequestTracker g_requests;
 
+/** HTTP request work item */
+class HTTPWorkItem final : public HTTPClosure
+{
+public:
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const evhttp_connection* _conn, const std::string &_path, const HTTPRequestHandler& _func):
+        req(std::move(_req)), conn(_conn), path(_path), func(_func)
+    {
+    }
+    void operator()() override
+    {
+        func(req.get(), path);
+    }
+    bool Abandoned() const override
+    {
+        // A connection freed while the request was queued leaves the request
+        // alive but detached, replying to it just frees it
+        return !g_requests.HasConnection(conn);
+    }
+    void Cancel() override
+    {
+        LogPrint(BCLog::HTTP, "Dropping request for %s, client %s disconnected\n",
+                 SanitizeString(req->GetURI(), SAFE_CHARS_URI).substr(0, 100), req->GetPeer().ToStringAddrPort());
+        req->WriteReply(HTTP_SERVICE_UNAVAILABLE);
+    }
+
+    std::unique_ptr<HTTPRequest> req;
+
+private:
+    const evhttp_connection* conn;
+    std::string path;
+    HTTPRequestHandler func;
+};
+
 /** Check if a network address is allowed to access the HTTP server */
 static bool ClientAllowed(const CNetAddr& netaddr)
 {
@@ -241,6 +326,32 @@ static bool InitHTTPAllowList()
     return true;
 }
 
+/** Whether a connection came in on a Unix domain socket, which only local processes can reach */
+static bool IsUnixSocketConnection(evhttp_connection* conn)
+{
+#ifndef WIN32
+    bufferevent* bev = conn ? evhttp_connection_get_bufferevent(conn) : nullptr;
+    if (!bev) return false;
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    return getsockname(bufferevent_getfd(bev), (struct sockaddr*)&addr, &len) == 0 && addr.ss_family == AF_UNIX;
+#else
+    return false;
+#endif
+}
+
+#ifndef WIN32
+/** Whether a Unix domain socket refuses connections, because the process that bound it is gone */
+static bool IsUnixSocketStale(const struct sockaddr_un& addr)
+{
+    const int fd{socket(AF_UNIX, SOCK_STREAM, 0)};
+    if (fd < 0) return false;
+    const bool stale{connect(fd, (const struct sockaddr*)&addr, sizeof(addr)) != 0 && errno == ECONNREFUSED};
+    close(fd);
+    return stale;
+}
+#endif
+
 /** HTTP request method as string - use for logging only */
 std::string RequestMethodString(HTTPRequest::RequestMethod m)
 {
@@ -259,6 +370,33 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     assert(false);
 }
 
+std::string HTTPWorkClassString(HTTPWorkClass work_class)
+{
+    switch (work_class) {
+    case HTTPWorkClass::DEFAULT:
+        return "default";
+    case HTTPWorkClass::SLOW:
+        return "slow";
+    case HTTPWorkClass::LONGPOLL:
+        return "longpoll";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::optional<HTTPWorkClass> ParseHTTPWorkClass(const std::string& str)
+{
+    for (const HTTPWorkQueueArgs& args : HTTP_WORK_QUEUE_ARGS) {
+        if (str == HTTPWorkClassString(args.work_class)) return args.work_class;
+    }
+    return std::nullopt;
+}
+
+/** HTTP connection close callback, stops tracking the requests of the connection */
+static void http_connection_close_cb(evhttp_connection* conn, void* arg)
+{
+    g_requests.RemoveConnection(conn);
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -269,9 +407,7 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
         evhttp_request_set_on_complete_cb(req, [](struct evhttp_request* req, void*) {
             g_requests.RemoveRequest(req);
         }, nullptr);
-        evhttp_connection_set_closecb(conn, [](evhttp_connection* conn, void* arg) {
-            g_requests.RemoveConnection(conn);
-        }, nullptr);
+        evhttp_connection_set_closecb(conn, http_connection_close_cb, nullptr);
     }
 
     // Disable reading to work around a libevent bug, fixed in 2.1.9
@@ -287,8 +423,8 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
     }
     auto hreq{std::make_unique<HTTPRequest>(req, *static_cast<const util::SignalInterrupt*>(arg))};
 
-    // Early address-based allow check
-    if (!ClientAllowed(hreq->GetPeer())) {
+    // Early address-based allow check, Unix socket access is controlled by the file permissions
+    if (!IsUnixSocketConnection(conn) && !ClientAllowed(hreq->GetPeer())) {
         LogPrint(BCLog::HTTP, "HTTP request from %s rejected: Client network is not allowed RPC access\n",
                  hreq->GetPeer().ToStringAddrPort());
         hreq->WriteReply(HTTP_FORBIDDEN);
@@ -326,12 +462,16 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
+        const HTTPWorkClass work_class{i->classifier ? i->classifier(hreq.get()) : HTTPWorkClass::DEFAULT};
+        auto queue{g_work_queues.find(work_class)};
+        if (queue == g_work_queues.end()) queue = g_work_queues.find(HTTPWorkClass::DEFAULT);
+        assert(queue != g_work_queues.end());
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), conn, path, i->handler));
+        if (queue->second->Enqueue(item.get())) {
             item.release(); /* if true, queue took ownership */
         } else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            const HTTPWorkQueueArgs& args{HTTP_WORK_QUEUE_ARGS[static_cast<size_t>(queue->first)]};
+            LogPrintf("WARNING: request rejected because http %s work queue depth exceeded, it can be increased with the %s= setting\n", HTTPWorkClassString(queue->first), args.depth_arg);
             item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
         }
     } else {
@@ -357,7 +497,7 @@ static void ThreadHTTP(struct event_base* base)
 }
 
 /** Bind HTTP server to specified addresses */
-static bool HTTPBindAddresses(struct evhttp* http)
+static bool HTTPBindAddresses(struct event_base* base, struct evhttp* http)
 {
     uint16_t http_port{static_cast<uint16_t>(gArgs.GetIntArg("-rpcport", BaseParams().RPCPort()))};
     std::vector<std::pair<std::string, uint16_t>> endpoints;
@@ -395,13 +535,67 @@ static bool HTTPBindAddresses(struct evhttp* http)
             LogPrintf("Binding RPC on address %s port %i failed.\n", i->first, i->second);
         }
     }
+
+    // Bind Unix domain sockets, for local clients that don't need TCP
+    for (const std::string& strRPCUnix : gArgs.GetArgs("-rpcunix")) {
+#ifndef WIN32
+        const fs::path path{AbsPathForConfigVal(gArgs, fs::PathFromString(strRPCUnix))};
+        const std::string str_path{fs::PathToString(path)};
+        struct sockaddr_un addr{};
+        if (str_path.size() >= sizeof(addr.sun_path)) {
+            LogPrintf("Binding RPC on Unix socket %s failed, the path is too long.\n", str_path);
+            continue;
+        }
+        addr.sun_family = AF_UNIX;
+        std::copy(str_path.begin(), str_path.end(), addr.sun_path);
+
+        // Remove a socket left behind by an unclean shutdown, but never the one of a running process
+        std::error_code ec;
+        if (fs::is_socket(path, ec)) {
+            if (!IsUnixSocketStale(addr)) {
+                LogPrintf("Binding RPC on Unix socket %s failed, the socket is in use.\n", str_path);
+                continue;
+            }
+            fs::remove(path, ec);
+        }
+
+        // Only the user running the node may connect. The umask makes the socket private from
+        // its creation, the chmod makes sure of it whatever the umask was.
+        LogPrintf("Binding RPC on Unix socket %s\n", str_path);
+        const mode_t old_umask{umask(S_IRWXG | S_IRWXO)};
+        evconnlistener* listener = evconnlistener_new_bind(base, nullptr, nullptr, LEV_OPT_CLOSE_ON_FREE | LEV_OPT_CLOSE_ON_EXEC,
+                                                           -1, (struct sockaddr*)&addr, sizeof(addr));
+        umask(old_umask);
+        if (!listener) {
+            LogPrintf("Binding RPC on Unix socket %s failed.\n", str_path);
+            continue;
+        }
+        if (chmod(str_path.c_str(), S_IRUSR | S_IWUSR) != 0) {
+            LogPrintf("Binding RPC on Unix socket %s failed, unable to restrict its permissions: %s\n", str_path, SysErrorString(errno));
+            evconnlistener_free(listener);
+            fs::remove(path, ec);
+            continue;
+        }
+        evhttp_bound_socket* bind_handle = evhttp_bind_listener(http, listener);
+        if (bind_handle) {
+            boundSockets.push_back(bind_handle);
+            g_unix_socket_paths.push_back(path);
+        } else {
+            evconnlistener_free(listener);
+            fs::remove(path, ec);
+            LogPrintf("Binding RPC on Unix socket %s failed.\n", str_path);
+        }
+#else
+        LogPrintf("Binding RPC on Unix socket %s failed, Unix sockets are not supported on this platform.\n", strRPCUnix);
+#endif
+    }
     return !boundSockets.empty();
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, const char* thread_name, int worker_num)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    util::ThreadRename(strprintf("%s.%i", thread_name, worker_num));
     queue->Run();
 }
 
@@ -457,16 +651,21 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     evhttp_set_max_body_size(http, MAX_SIZE);
     evhttp_set_gencb(http, http_request_cb, (void*)&interrupt);
 
-    if (!HTTPBindAddresses(http)) {
+    if (!HTTPBindAddresses(base_ctr.get(), http)) {
         LogPrintf("Unable to bind any endpoint for RPC server\n");
         return false;
     }
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
-
-    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    for (const HTTPWorkQueueArgs& args : HTTP_WORK_QUEUE_ARGS) {
+        // Only the default queue is required, the others can be disabled
+        const long min_threads{args.work_class == HTTPWorkClass::DEFAULT ? 1L : 0L};
+        int threads = std::max((long)gArgs.GetIntArg(args.threads_arg, args.default_threads), min_threads);
+        if (threads == 0) continue;
+        int workQueueDepth = std::max((long)gArgs.GetIntArg(args.depth_arg, args.default_depth), 1L);
+        LogDebug(BCLog::HTTP, "creating %s work queue of depth %d\n", HTTPWorkClassString(args.work_class), workQueueDepth);
+        g_work_queues[args.work_class] = std::make_unique<WorkQueue<HTTPClosure>>(args.work_class, workQueueDepth, threads);
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -486,12 +685,20 @@ static std::vector<std::thread> g_thread_http_workers;
 
 void StartHTTPServer()
 {
-    int rpcThreads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    int rpcThreads = g_work_queues.at(HTTPWorkClass::DEFAULT)->GetStats().threads;
     LogInfo("Starting HTTP server with %d worker threads\n", rpcThreads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
+    for (const HTTPWorkQueueArgs& args : HTTP_WORK_QUEUE_ARGS) {
+        auto it{g_work_queues.find(args.work_class)};
+        if (it == g_work_queues.end()) continue;
+        const int threads{it->second->GetStats().threads};
+        if (args.work_class != HTTPWorkClass::DEFAULT) {
+            LogPrint(BCLog::HTTP, "Starting %d %s worker threads\n", threads, HTTPWorkClassString(args.work_class));
+        }
+        for (int i = 0; i < threads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, it->second.get(), args.thread_name, i);
+        }
     }
 }
 
@@ -502,15 +709,15 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (g_work_queue) {
-        g_work_queue->Interrupt();
+    for (const auto& [work_class, queue] : g_work_queues) {
+        queue->Interrupt();
     }
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (g_work_queue) {
+    if (!g_work_queues.empty()) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread : g_thread_http_workers) {
             thread.join();
@@ -523,6 +730,11 @@ void StopHTTPServer()
         evhttp_del_accept_socket(eventHTTP, socket);
     }
     boundSockets.clear();
+    for (const fs::path& path : g_unix_socket_paths) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    g_unix_socket_paths.clear();
     {
         if (const auto n_connections{g_requests.CountActiveConnections()}; n_connections != 0) {
             LogPrint(BCLog::HTTP, "Waiting for %d connections to stop HTTP server\n", n_connections);
@@ -544,10 +756,19 @@ void StopHTTPServer()
         event_base_free(eventBase);
         eventBase = nullptr;
     }
-    g_work_queue.reset();
+    g_work_queues.clear();
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    std::vector<HTTPWorkQueueStats> result;
+    for (const auto& [work_class, queue] : g_work_queues) {
+        result.push_back(queue->GetStats());
+    }
+    return result;
+}
+
 struct event_base* EventBase()
 {
     return eventBase;
@@ -582,8 +803,43 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+/** State of a chunked reply, shared between the worker thread and the event loop */
+struct HTTPChunkState
+{
+    struct evhttp_request* req;
+
+    std::mutex cs;
+    std::condition_variable cv;
+    //! Whether the client closed the connection, guarded by cs
+    bool connClosed{false};
+    //! Bytes written to the connection, guarded by cs
+    size_t bytesSent{0};
+
+    //! Bytes handed to evhttp, only used by the event loop
+    size_t bytesScheduled{0};
+    //! Keeps the state alive for the C callbacks of evhttp until the reply
+    //! is ended on the event loop, only used by the event loop
+    std::shared_ptr<HTTPChunkState> self;
+
+    explicit HTTPChunkState(struct evhttp_request* _req) : req(_req) {}
+
+    void setConnClosed()
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        connClosed = true;
+        cv.notify_all();
+    }
+
+    void setBytesSent()
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        bytesSent = bytesScheduled;
+        cv.notify_all();
+    }
+};
+
 HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrupt& interrupt, bool _replySent)
-    : req(_req), m_interrupt(interrupt), replySent(_replySent), startedChunkTransfer(false), connClosed(false)
+    : req(_req), m_interrupt(interrupt), replySent(_replySent), startedChunkTransfer(false)
 {
 }
 
@@ -597,60 +853,19 @@ HTTPRequest::~HTTPRequest()
     // evhttpd cleans up the request, as long as a reply was sent.
 }
 
-void HTTPRequest::waitClientClose() {
-    LogPrint(BCLog::HTTPPOLL, "wait for connection close\n");
-
-    // wait at most 5 seconds for client to close
-    for (int i = 0; i < 10 && IsRPCRunning() && !isConnClosed(); i++) {
-        std::unique_lock<std::mutex> lock(cs);
-        closeCv.wait_for(lock, std::chrono::milliseconds(500));
+bool HTTPRequest::WaitChunksSent(size_t max_pending) {
+    if (!chunkState) return true;
+    std::unique_lock<std::mutex> lock(chunkState->cs);
+    while (!chunkState->connClosed && IsRPCRunning() && chunkBytesQueued - chunkState->bytesSent > max_pending) {
+        chunkState->cv.wait_for(lock, std::chrono::milliseconds(500));
     }
-
-    if (isConnClosed()) {
-        LogPrint(BCLog::HTTPPOLL, "wait for connection close, ok\n");
-    } else if (!IsRPCRunning()) {
-        LogPrint(BCLog::HTTPPOLL, "wait for connection close, RPC stopped\n");
-    } else {
-        LogPrint(BCLog::HTTPPOLL, "wait for connection close, timeout after 5 seconds\n");
-    }
-}
-
-void HTTPRequest::startDetectClientClose() {
-    LogPrint(BCLog::HTTPPOLL, "start detect http connection close\n");
-    // will need to call evhttp_send_reply_end to clean this up
-    auto conn = evhttp_request_get_connection(req);
-
-   // evhttp_connection_set_closecb does not reliably detect client connection close unless we write to it.
-   //
-   // This problem is supposedly resolved in 2.1.8. See: https://github.com/libevent/libevent/issues/78
-   //
-   // But we should just write to the socket to test liveness. This is useful for long-poll RPC calls to see
-   // if they should terminate the request early.
-   //
-   // More weirdness: if process received SIGTERM, the http event loop (in HTTPThread) returns prematurely with 1.
-   // In which case evhttp_send_reply_end doesn't seem to get called, and evhttp_connection_set_closecb is
-   // not called. BUT when the event base is freed, this callback IS called, and HTTPRequest is already freed.
-   //
-   // So, waitClientClose and startDetectClientClose should just not do anything if RPC is shutting down.
-   evhttp_connection_set_closecb(conn, [](struct evhttp_connection *conn, void *data) {
-       LogPrint(BCLog::HTTPPOLL, "http connection close detected\n");
-
-       if (IsRPCRunning()) {
-           auto req = (HTTPRequest*) data;
-           req->setConnClosed();
-       }
-   }, (void *) this);
-}
-
-void HTTPRequest::setConnClosed() {
-    std::lock_guard<std::mutex> lock(cs);
-    connClosed = true;
-    closeCv.notify_all();
+    return !chunkState->connClosed && IsRPCRunning();
 }
 
 bool HTTPRequest::isConnClosed() {
-    std::lock_guard<std::mutex> lock(cs);
-    return connClosed;
+    if (!chunkState) return false;
+    std::lock_guard<std::mutex> lock(chunkState->cs);
+    return chunkState->connClosed;
 }
 
 bool HTTPRequest::isChunkMode() {
@@ -668,6 +883,20 @@ std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr) cons
         return std::make_pair(false, "");
 }
 
+std::optional<std::string> HTTPRequest::PeekBody(size_t max_size) const
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = evbuffer_get_length(buf);
+    if (size > max_size)
+        return std::nullopt;
+    std::string rv(size, '\0');
+    if (evbuffer_copyout(buf, rv.data(), size) != (ev_ssize_t)size)
+        return std::nullopt;
+    return rv;
+}
+
 std::string HTTPRequest::ReadBody()
 {
     struct evbuffer* buf = evhttp_request_get_input_buffer(req);
@@ -702,19 +931,19 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 void HTTPRequest::ChunkEnd() {
     assert(startedChunkTransfer && !replySent);
 
-    HTTPEvent* ev = new HTTPEvent(eventBase, true, NULL,
-            std::bind(evhttp_send_reply_end, req));
-
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, NULL, [state = chunkState] {
+        // Nothing refers to the state once the reply is ended: the usual close
+        // callback is restored and evhttp replaces the chunk write callback.
+        auto conn = evhttp_request_get_connection(state->req);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, http_connection_close_cb, nullptr);
+        }
+        evhttp_send_reply_end(state->req);
+        state->self.reset();
+    });
     ev->trigger(0);
 
-    // If HTTPRequest is destroyed before connection is closed, evhttp seems to get messed up.
-    // We wait here for connection close before returning back to the handler, where HTTPRequest will be reclaimed.
-    waitClientClose();
-
     replySent = true;
-    // `WriteReply` sets req to 0 to prevent req from being freed. But this is not enough in the case of long-polling.
-    // Something is still freed to early.
-    // req = 0;
 }
 
 void HTTPRequest::Chunk(const std::string& chunk) {
@@ -723,21 +952,48 @@ void HTTPRequest::Chunk(const std::string& chunk) {
     int status = 200;
 
     if (!startedChunkTransfer) {
-        HTTPEvent* ev = new HTTPEvent(eventBase, true, NULL,
-                std::bind(evhttp_send_reply_start, req, status,
-                        (const char*) NULL));
+        chunkState = std::make_shared<HTTPChunkState>(req);
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, NULL, [state = chunkState, status] {
+            state->self = state;
+            evhttp_send_reply_start(state->req, status, (const char*) NULL);
+
+            // evhttp_connection_set_closecb does not reliably detect client connection close unless we write to it.
+            //
+            // This problem is supposedly resolved in 2.1.8. See: https://github.com/libevent/libevent/issues/78
+            //
+            // But we should just write to the socket to test liveness. This is useful for long-poll RPC calls to see
+            // if they should terminate the request early.
+            //
+            // If the process received SIGTERM, the http event loop may return before the reply is ended, and the
+            // callback is called when the event base is freed. The state is kept alive for it until the reply is
+            // ended, so it doesn't refer to freed memory, but it should not do anything if RPC is shutting down.
+            LogPrint(BCLog::HTTPPOLL, "start detect http connection close\n");
+            evhttp_connection_set_closecb(evhttp_request_get_connection(state->req), [](struct evhttp_connection *conn, void *data) {
+                LogPrint(BCLog::HTTPPOLL, "http connection close detected\n");
+                http_connection_close_cb(conn, nullptr);
+
+                if (IsRPCRunning()) {
+                    static_cast<HTTPChunkState*>(data)->setConnClosed();
+                }
+            }, (void *) state.get());
+        });
         ev->trigger(0);
 
-        startDetectClientClose();
         startedChunkTransfer = true;
     }
 
-
     if (chunk.size() > 0) {
         auto databuf = evbuffer_new(); // HTTPEvent will free this buffer
         evbuffer_add(databuf, chunk.data(), chunk.size());
-        HTTPEvent* ev = new HTTPEvent(eventBase, true, databuf,
-                std::bind(evhttp_send_reply_chunk, req, databuf));
+        chunkBytesQueued += chunk.size();
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, databuf, [state = chunkState, databuf, queued = chunkBytesQueued] {
+            // The callback runs once the output buffer of the connection is
+            // drained, which means every chunk scheduled so far was written.
+            state->bytesScheduled = queued;
+            evhttp_send_reply_chunk_with_cb(state->req, databuf, [](struct evhttp_connection *conn, void *data) {
+                static_cast<HTTPChunkState*>(data)->setBytesSent();
+            }, (void *) state.get());
+        });
         ev->trigger(0);
     }
 }
@@ -852,11 +1108,11 @@ std::optional<std::string> GetQueryParameterFromUri(const char* uri, const std::
     return result;
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
     LOCK(g_httppathhandlers_mutex);
-    pathHandlers.emplace_back(prefix, exactMatch, handler);
+    pathHandlers.emplace_back(prefix, exactMatch, handler, classifier);
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -6,10 +6,11 @@
 #define BITCOIN_HTTPSERVER_H
 
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
-#include <mutex>
-#include <condition_variable>
+#include <cstdint>
+#include <vector>
 
 namespace util {
 class SignalInterrupt;
@@ -18,11 +19,16 @@ class SignalInterrupt;
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+static const int DEFAULT_HTTP_SLOW_THREADS=2;
+static const int DEFAULT_HTTP_SLOW_WORKQUEUE=16;
+static const int DEFAULT_HTTP_LONGPOLL_THREADS=4;
+static const int DEFAULT_HTTP_LONGPOLL_WORKQUEUE=16;
 
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkState;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -41,16 +47,59 @@ void StopHTTPServer();
 /** Change logging level for libevent. */
 void UpdateHTTPServerLogging(bool enable);
 
+/** Requests of each class have their own work queue and worker threads, so
+ * that expensive or waiting requests can't hold up the cheap ones. A class
+ * configured without threads shares the queue of DEFAULT.
+ */
+enum class HTTPWorkClass {
+    DEFAULT,  //!< Served by -rpcthreads
+    SLOW,     //!< Index scans and other expensive requests, served by -rpcslowthreads
+    LONGPOLL, //!< Requests that wait for an event, served by -rpclongpollthreads
+};
+std::string HTTPWorkClassString(HTTPWorkClass work_class);
+std::optional<HTTPWorkClass> ParseHTTPWorkClass(const std::string& str);
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work queue of a request, called on the event loop thread */
+typedef std::function<HTTPWorkClass(const HTTPRequest* req)> HTTPWorkClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests go to the DEFAULT work queue unless a classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Number of buckets of the work queue histograms. Bucket 0 counts zeros,
+ * bucket i counts values in [2^(i-1), 2^i) and the last one everything larger.
+ */
+static constexpr size_t HTTP_WORK_HISTOGRAM_BUCKETS{17};
+
+/** Counters of a work queue since the server started */
+struct HTTPWorkQueueStats
+{
+    HTTPWorkClass work_class;
+    int threads{0};
+    size_t max_depth{0};
+    size_t depth{0};
+    size_t peak_depth{0};
+    uint64_t processed{0};
+    //! Requests rejected because the queue was full
+    uint64_t rejected{0};
+    //! Requests dropped because the client disconnected while they were queued
+    uint64_t cancelled{0};
+    //! Queue depth found by each new request
+    std::vector<uint64_t> depth_histogram;
+    //! Milliseconds spent waiting in the queue
+    std::vector<uint64_t> wait_histogram;
+    //! Milliseconds spent running the handler
+    std::vector<uint64_t> run_histogram;
+};
+
+/** Get the counters of the work queues of the running server */
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -66,13 +115,12 @@ private:
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
     bool startedChunkTransfer;
-    bool connClosed;
 
-    std::mutex cs;
-    std::condition_variable closeCv;
-
-    void startDetectClientClose();
-    void waitClientClose();
+    //! State of the chunked reply, shared with the callbacks of the event
+    //! loop, which may still run after this request is destroyed
+    std::shared_ptr<HTTPChunkState> chunkState;
+    //! Bytes passed to Chunk, only used by the worker thread
+    size_t chunkBytesQueued{0};
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -86,7 +134,6 @@ public:
         PUT
     };
 
-    void setConnClosed();
     bool isConnClosed();
     bool isChunkMode();
 
@@ -119,6 +166,12 @@ public:
      */
     std::pair<bool, std::string> GetHeader(const std::string& hdr) const;
 
+    /**
+     * Copy the request body without consuming it, or std::nullopt if it is
+     * larger than max_size.
+     */
+    std::optional<std::string> PeekBody(size_t max_size) const;
+
     /**
      * Read request body.
      *
@@ -150,10 +203,18 @@ public:
     void Chunk(const std::string& chunk);
 
     /**
-	 * End chunk transfer.
-	 */
+     * End chunk transfer. The reply is finished on the event loop, this
+     * doesn't wait for the client.
+     */
     void ChunkEnd();
 
+    /**
+     * Wait until at most max_pending bytes of the chunks are still to be
+     * written to the connection, to bound the memory used by a streamed reply.
+     * Returns false if the connection was closed or RPC is shutting down.
+     */
+    bool WaitChunksSent(size_t max_pending);
+
     /**
      * Is reply sent?
      */
@@ -180,6 +241,10 @@ class HTTPClosure
 {
 public:
     virtual void operator()() = 0;
+    /** Whether the closure should be dropped instead of run, e.g. because its client went away */
+    virtual bool Abandoned() const { return false; }
+    /** Called instead of running an abandoned closure */
+    virtual void Cancel() {}
     virtual ~HTTPClosure() {}
 };
 
@@ -0,0 +1,307 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/delegationindex.h>
+
+#include <chain.h>
+#include <common/args.h>
+#include <logging.h>
+#include <qtum/storageresults.h>
+#include <serialize.h>
+#include <util/convert.h>
+#include <validation.h>
+
+#include <optional>
+#include <set>
+
+static constexpr uint8_t DB_DELEGATE{'d'};
+static constexpr uint8_t DB_STAKER{'s'};
+static constexpr uint8_t DB_UNDO{'u'};
+
+std::unique_ptr<DelegationIndex> g_delegation_index;
+
+namespace {
+
+struct DBDelegation {
+    Delegation delegation;
+
+    SERIALIZE_METHODS(DBDelegation, obj)
+    {
+        READWRITE(obj.delegation.staker, obj.delegation.fee, obj.delegation.blockHeight, obj.delegation.PoD);
+    }
+};
+
+struct DBStakerKey {
+    uint160 staker;
+    uint160 delegate;
+
+    SERIALIZE_METHODS(DBStakerKey, obj)
+    {
+        uint8_t prefix{DB_STAKER};
+        READWRITE(prefix);
+        if (prefix != DB_STAKER) {
+            throw std::ios_base::failure("Invalid format for delegationindex DB staker key");
+        }
+
+        READWRITE(obj.staker, obj.delegate);
+    }
+};
+
+struct DBHeightKey {
+    int height;
+
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_UNDO);
+        ser_writedata32be(s, height);
+    }
+};
+
+//! State of a delegate before a block changed it
+struct DBUndoEntry {
+    uint160 delegate;
+    bool found{false};
+    DBDelegation prev;
+
+    SERIALIZE_METHODS(DBUndoEntry, obj)
+    {
+        READWRITE(obj.delegate, obj.found, obj.prev);
+    }
+};
+
+//! Change of a delegate, from the indexed state to the new one
+using DelegationChanges = std::map<uint160, std::pair<std::optional<Delegation>, std::optional<Delegation>>>;
+
+std::optional<Delegation> ReadDelegation(const CDBWrapper& db, const uint160& delegate)
+{
+    DBDelegation value;
+    if (!db.Read(std::make_pair(DB_DELEGATE, delegate), value)) return std::nullopt;
+    return value.delegation;
+}
+
+std::optional<Delegation>& GetChange(const CDBWrapper& db, DelegationChanges& changes, const uint160& delegate)
+{
+    auto it = changes.find(delegate);
+    if (it == changes.end()) {
+        const std::optional<Delegation> indexed{ReadDelegation(db, delegate)};
+        it = changes.emplace(delegate, std::make_pair(indexed, indexed)).first;
+    }
+    return it->second.second;
+}
+
+void WriteChanges(CDBBatch& batch, const DelegationChanges& changes)
+{
+    for (const auto& [delegate, change] : changes) {
+        const auto& [from, to] = change;
+        if (from == to) continue;
+        if (from) {
+            batch.Erase(DBStakerKey{from->staker, delegate});
+        }
+        if (to) {
+            batch.Write(std::make_pair(DB_DELEGATE, delegate), DBDelegation{*to});
+            batch.Write(DBStakerKey{to->staker, delegate}, DBDelegation{*to});
+        } else {
+            batch.Erase(std::make_pair(DB_DELEGATE, delegate));
+        }
+    }
+}
+
+} // namespace
+
+DelegationIndex::DelegationIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "delegationindex")
+{
+    fs::path path{gArgs.GetDataDirNet() / "indexes" / "delegation"};
+    fs::create_directories(path);
+
+    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+void DelegationIndex::ReadDelegationEvents(const interfaces::BlockInfo& block, std::vector<DelegationEvent>& events) const
+{
+    // The receipts are only stored for blocks on the active chain
+    LOCK(cs_main);
+    for (const CTransactionRef& tx : block.data->vtx) {
+        if (!tx->HasCreateOrCall()) continue;
+        for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))) {
+            if (receipt.blockHash != block.hash) continue;
+            for (const dev::eth::LogEntry& log : receipt.logs) {
+                DelegationEvent event;
+                if (m_delegation.GetDelegationEvent(log, event)) {
+                    events.push_back(event);
+                }
+            }
+        }
+    }
+}
+
+bool DelegationIndex::CustomInit(const std::optional<interfaces::BlockKey>& block)
+{
+    LOCK(m_tip_mutex);
+    m_tip = block ? block->hash : uint256();
+    return true;
+}
+
+bool DelegationIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+
+    std::vector<DelegationEvent> events;
+    ReadDelegationEvents(block, events);
+    if (events.empty()) {
+        LOCK(m_tip_mutex);
+        m_tip = block.hash;
+        return true;
+    }
+
+    DelegationChanges changes;
+    std::vector<DBUndoEntry> undo;
+    for (const DelegationEvent& event : events) {
+        const uint160& delegate = event.item.delegate;
+        const bool first_change{changes.count(delegate) == 0};
+        std::optional<Delegation>& state{GetChange(*m_db, changes, delegate)};
+        if (first_change) {
+            undo.push_back(DBUndoEntry{delegate, state.has_value(), DBDelegation{state.value_or(Delegation{})}});
+        }
+        if (event.type == DELEGATION_ADD) {
+            state = static_cast<const Delegation&>(event.item);
+        } else if (event.type == DELEGATION_REMOVE) {
+            state.reset();
+        }
+    }
+
+    CDBBatch batch(*m_db);
+    WriteChanges(batch, changes);
+    batch.Write(DBHeightKey(block.height), std::make_pair(block.hash, undo));
+
+    // Lookups at the previous block don't see the changes of this one
+    LOCK(m_tip_mutex);
+    if (!m_db->WriteBatch(batch)) return false;
+    m_tip = block.hash;
+    return true;
+}
+
+bool DelegationIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    std::vector<uint256> hashes;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+        for (; iter_tip && iter_tip->nHeight > new_tip.height; iter_tip = iter_tip->pprev) {
+            hashes.push_back(iter_tip->GetBlockHash());
+        }
+    }
+
+    // Restore the delegates of the disconnected blocks, newest first
+    DelegationChanges changes;
+    CDBBatch batch(*m_db);
+    int height = current_tip.height;
+    for (const uint256& hash : hashes) {
+        std::pair<uint256, std::vector<DBUndoEntry>> undo;
+        if (m_db->Read(DBHeightKey(height), undo)) {
+            if (undo.first != hash) {
+                return error("%s: undo data at height %d belongs to block %s, expected %s",
+                             __func__, height, undo.first.ToString(), hash.ToString());
+            }
+            for (const DBUndoEntry& entry : undo.second) {
+                std::optional<Delegation>& state{GetChange(*m_db, changes, entry.delegate)};
+                if (entry.found) {
+                    state = entry.prev.delegation;
+                } else {
+                    state.reset();
+                }
+            }
+            batch.Erase(DBHeightKey(height));
+        }
+        --height;
+    }
+
+    WriteChanges(batch, changes);
+
+    LOCK(m_tip_mutex);
+    if (!m_db->WriteBatch(batch)) return false;
+    m_tip = new_tip.hash;
+    return true;
+}
+
+bool DelegationIndex::FindDelegation(const uint160& delegate, Delegation& delegation) const
+{
+    std::optional<Delegation> value{ReadDelegation(*m_db, delegate)};
+    if (!value) return false;
+    delegation = std::move(*value);
+    return true;
+}
+
+bool DelegationIndex::FindDelegationsForStaker(const uint160& staker, std::map<uint160, Delegation>& delegations) const
+{
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBStakerKey{staker, uint160()});
+    for (; db_it->Valid(); db_it->Next()) {
+        DBStakerKey key;
+        if (!db_it->GetKey(key) || key.staker != staker) break;
+
+        DBDelegation value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: unable to read value for delegate %s", __func__, key.delegate.GetReverseHex());
+        }
+        delegations[key.delegate] = value.delegation;
+    }
+    return true;
+}
+
+bool DelegationIndex::FilterDelegations(const IDelegationFilter& filter, const uint256& block_hash, std::map<uint160, Delegation>& delegations) const
+{
+    // Seek the delegations of the stakers or delegates the filter can match
+    std::set<uint160> stakers, delegates;
+    const bool by_staker{filter.GetStakers(stakers)};
+    const bool by_delegate{!by_staker && filter.GetDelegates(delegates)};
+
+    // The index updates from the validation queue, so it can be behind the
+    // chain tip the caller sees even once synced. The filter may lock the
+    // wallet, so it only matches the delegations once they are read.
+    std::map<uint160, Delegation> found;
+    {
+        LOCK(m_tip_mutex);
+        if (m_tip != block_hash) return false;
+
+        if (by_staker) {
+            for (const uint160& staker : stakers) {
+                if (!FindDelegationsForStaker(staker, found)) return false;
+            }
+        } else if (by_delegate) {
+            for (const uint160& delegate : delegates) {
+                if (std::optional<Delegation> delegation{ReadDelegation(*m_db, delegate)}) {
+                    found[delegate] = std::move(*delegation);
+                }
+            }
+        } else {
+            std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+            db_it->Seek(std::make_pair(DB_DELEGATE, uint160()));
+            for (; db_it->Valid(); db_it->Next()) {
+                std::pair<uint8_t, uint160> key;
+                if (!db_it->GetKey(key) || key.first != DB_DELEGATE) break;
+
+                DBDelegation value;
+                if (!db_it->GetValue(value)) {
+                    return error("%s: unable to read value for delegate %s", __func__, key.second.GetReverseHex());
+                }
+                found[key.second] = value.delegation;
+            }
+        }
+    }
+
+    for (const auto& [delegate, delegation] : found) {
+        DelegationEvent event;
+        static_cast<Delegation&>(event.item) = delegation;
+        event.item.delegate = delegate;
+        event.type = DELEGATION_ADD;
+        if (filter.Match(event)) {
+            delegations[delegate] = delegation;
+        }
+    }
+    return true;
+}
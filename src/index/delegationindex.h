@@ -0,0 +1,76 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_DELEGATIONINDEX_H
+#define BITCOIN_INDEX_DELEGATIONINDEX_H
+
+#include <index/base.h>
+#include <qtum/qtumdelegation.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+static constexpr bool DEFAULT_DELEGATIONINDEX{false};
+
+/**
+ * DelegationIndex keeps the current state of the delegation contract, the
+ * delegation of every delegate with its staker, fee and proof of delegation,
+ * keyed by delegate and by staker.
+ *
+ * It is updated from the AddDelegation and RemoveDelegation events in the
+ * receipts of each connected block, so it needs -logevents. The previous
+ * state of the delegates changed by a block is kept to rewind it on reorgs.
+ */
+class DelegationIndex : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+    QtumDelegation m_delegation;
+
+    /// Block the delegations in the database are at, changed with them
+    mutable Mutex m_tip_mutex;
+    uint256 m_tip GUARDED_BY(m_tip_mutex);
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    /// Read the delegation events of a connected block, in the order they were emitted.
+    virtual void ReadDelegationEvents(const interfaces::BlockInfo& block, std::vector<DelegationEvent>& events) const;
+
+    bool CustomInit(const std::optional<interfaces::BlockKey>& block) override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit DelegationIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the delegation of a delegate. Returns false if it has none.
+    bool FindDelegation(const uint160& delegate, Delegation& delegation) const;
+
+    /// Look up all delegations to a staker, by delegate.
+    bool FindDelegationsForStaker(const uint160& staker, std::map<uint160, Delegation>& delegations) const;
+
+    /**
+     * Look up the delegations matching a filter at a block, by delegate. Only
+     * the stakers or delegates listed by the filter are looked up when it
+     * lists them. Returns false unless the index is at that block, e.g. while
+     * it is catching up with the chain or hasn't processed the last connected
+     * block yet, in which case the caller should fall back to replaying the
+     * delegation events.
+     */
+    bool FilterDelegations(const IDelegationFilter& filter, const uint256& block_hash, std::map<uint160, Delegation>& delegations) const;
+};
+
+/// The global delegation index. May be null.
+extern std::unique_ptr<DelegationIndex> g_delegation_index;
+
+#endif // BITCOIN_INDEX_DELEGATIONINDEX_H
@@ -79,17 +79,39 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         return false;
     }
 
-    AutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
+    // Open at the meta header so compressed blocks can be recognized
+    AutoFile file{m_chainstate->m_blockman.OpenBlockFile({postx.nFile, postx.nPos - static_cast<unsigned int>(node::BLOCK_SERIALIZATION_HEADER_SIZE)}, true)};
     if (file.IsNull()) {
         return error("%s: OpenBlockFile failed", __func__);
     }
     CBlockHeader header;
     try {
-        file >> header;
-        if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
-            return error("%s: fseek(...) failed", __func__);
+        MessageStartChars blk_start;
+        unsigned int blk_size;
+        file >> blk_start >> blk_size;
+        if (blk_size & node::BLOCK_COMPRESSED_FLAG) {
+            // Compressed blocks have to be inflated before the transaction offset can be used
+            const unsigned int compressed_size{blk_size & ~node::BLOCK_COMPRESSED_FLAG};
+            if (compressed_size > MAX_SIZE) {
+                return error("%s: Compressed block too large", __func__);
+            }
+            std::vector<uint8_t> compressed(compressed_size);
+            file.read(MakeWritableByteSpan(compressed));
+            std::vector<uint8_t> block_data;
+            if (!node::DecompressBlockData(compressed, block_data)) {
+                return error("%s: Failed to decompress block", __func__);
+            }
+            DataStream block_stream{block_data};
+            block_stream >> header;
+            block_stream.ignore(postx.nTxOffset);
+            block_stream >> TX_WITH_WITNESS(tx);
+        } else {
+            file >> header;
+            if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
+                return error("%s: fseek(...) failed", __func__);
+            }
+            file >> TX_WITH_WITNESS(tx);
         }
-        file >> TX_WITH_WITNESS(tx);
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s", __func__, e.what());
     }
@@ -14,6 +14,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <set>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
@@ -116,6 +117,13 @@ struct BlockInfo {
     BlockInfo(const uint256& hash LIFETIMEBOUND) : hash(hash) {}
 };
 
+//! Contract event log from a transaction receipt, with hex encoded fields.
+struct ContractLog {
+    std::string address;
+    std::vector<std::string> topics;
+    std::string data;
+};
+
 //! Interface giving clients (wallet processes, maybe other analysis tools in
 //! the future) ability to access to the chain state, receive notifications,
 //! estimate fees, and submit transactions.
@@ -182,6 +190,14 @@ public:
     //! or std::nullopt if the block filter for this block couldn't be found.
     virtual std::optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) = 0;
 
+    //! Returns whether the address index is enabled.
+    virtual bool hasAddressIndex() = 0;
+
+    //! Add the heights of the blocks in [start_height, end_height] with transactions
+    //! paying to or spending from any of the scripts, as found in the address index.
+    //! Returns false if the index is not enabled or a script can't be looked up in it.
+    virtual bool findAddressIndexHeights(const std::vector<CScript>& scripts, int start_height, int end_height, std::set<int>& heights) = 0;
+
     //! Return whether node has the block and optionally return block metadata
     //! or contents.
     virtual bool findBlock(const uint256& hash, const FoundBlock& block={}) = 0;
@@ -425,6 +441,9 @@ public:
     //! get stake weight.
     virtual uint64_t getStakeWeight(const wallet::CWallet& wallet, uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr) = 0;
 
+    //! get the outputs delegated to the wallet that can stake, mature or not, with their value and height, and the tip they are read at.
+    virtual bool getDelegateStakeCoins(const wallet::CWallet& wallet, std::map<COutPoint, std::pair<CAmount, int>>& coins, int& height) = 0;
+
     //! refresh delegates.
     virtual void refreshDelegates(wallet::CWallet *pwallet, bool myDelegates, bool stakerDelegates) = 0;
 
@@ -440,6 +459,9 @@ public:
 
     //! verify delegation for an address.
     virtual bool verifyDelegation(const uint160& address, const Delegation& delegation) = 0;
+
+    //! Get the event logs of a transaction executed in a block, needs -logevents.
+    virtual std::vector<ContractLog> getContractLogs(const uint256& txid, const uint256& block_hash) = 0;
 };
 
 //! Interface to let node manage chain clients (wallets, or maybe tools for
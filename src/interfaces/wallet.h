@@ -339,6 +339,12 @@ public:
     //! Clean token transaction entries in the wallet
     virtual bool cleanTokenTxEntries() = 0;
 
+    //! Get the token balance tracked from the event logs, if known at the last processed block and not due for a check against the contract.
+    virtual bool getTokenBalance(const uint256& id, uint256& balance) = 0;
+
+    //! Set the token balance read from the contract at a block height.
+    virtual bool setTokenBalance(const uint256& id, const uint256& balance, int height) = 0;
+
     //! Check if token transaction is mine
     virtual bool isTokenTxMine(const TokenTx &wtx) = 0;
 
@@ -24,6 +24,8 @@ struct BlockManagerOpts {
     bool fast_prune{false};
     const fs::path blocks_dir;
     Notifications& notifications;
+    //! Deflate level used for newly stored blocks, 0 stores them uncompressed
+    int block_compression_level{0};
 };
 
 } // namespace kernel
@@ -46,6 +46,8 @@ struct ChainstateManagerOpts {
     Notifications& notifications;
     //! Number of script check worker threads. Zero means no parallel verification.
     int worker_threads_num{0};
+    //! Number of threads deserializing blocks ahead of acceptance during -reindex. Zero disables prefetching.
+    int reindex_parse_threads{0};
 };
 
 } // namespace kernel
@@ -3739,10 +3739,22 @@ std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage()
     msgs.splice(msgs.begin(), m_msg_process_queue, m_msg_process_queue.begin());
     m_msg_process_queue_size -= msgs.front().m_raw_message_size;
     fPauseRecv = m_msg_process_queue_size > m_recv_flood_size;
+    if (m_msg_process_queue_peeked > 0) --m_msg_process_queue_peeked;
 
     return std::make_pair(std::move(msgs.front()), !m_msg_process_queue.empty());
 }
 
+std::vector<DataStream> CNode::PeekNewMessages(const std::string& msg_type, size_t max_msgs)
+{
+    LOCK(m_msg_process_queue_mutex);
+    std::vector<DataStream> result;
+    auto it{std::next(m_msg_process_queue.begin(), m_msg_process_queue_peeked)};
+    for (; it != m_msg_process_queue.end() && result.size() < max_msgs; ++it, ++m_msg_process_queue_peeked) {
+        if (it->m_type == msg_type) result.push_back(it->m_recv);
+    }
+    return result;
+}
+
 bool CConnman::NodeFullyConnected(const CNode* pnode)
 {
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
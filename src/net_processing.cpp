@@ -23,6 +23,7 @@
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <node/blockstorage.h>
+#include <node/txpreverifier.h>
 #include <node/txreconciliation.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
@@ -856,6 +857,9 @@ private:
     TxRequestTracker m_txrequest GUARDED_BY(::cs_main);
     std::unique_ptr<TxReconciliationTracker> m_txreconciliation;
 
+    /** Pre-verifies the signatures of tx messages waiting in the peers' queues, nullptr if disabled. */
+    std::unique_ptr<node::TxPreverifier> m_tx_preverifier;
+
     /** The height of the best chain */
     std::atomic<int> m_best_height{-1};
     /** The time of the best chain tip block */
@@ -2119,6 +2123,14 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
+    if (opts.tx_verify_threads > 0) {
+        // Skip the transactions that ProcessMessage would not validate again
+        auto is_known = [this](const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+            AssertLockHeld(::cs_main);
+            return AlreadyHaveTx(GenTxid::Wtxid(tx.GetWitnessHash()));
+        };
+        m_tx_preverifier = std::make_unique<node::TxPreverifier>(chainman, pool, is_known, opts.tx_verify_threads);
+    }
 }
 
 void PeerManagerImpl::StartScheduledTasks(CScheduler& scheduler)
@@ -2515,12 +2527,15 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         pblock = a_recent_block;
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
-        // as the network format matches the format on disk
-        std::vector<uint8_t> block_data;
-        if (!m_chainman.m_blockman.ReadRawBlockFromDisk(block_data, pindex->GetBlockPos())) {
+        // as the network format matches the format on disk. Read it straight into the
+        // payload of the outgoing message, which is then moved (not copied) into the
+        // send queue and transport.
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        if (!m_chainman.m_blockman.ReadRawBlockFromDisk(msg.data, pindex->GetBlockPos())) {
             assert(!"cannot load block from disk");
         }
-        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, Span{block_data});
+        PushMessage(pfrom, std::move(msg));
         // Don't set pblock as we've sent the block
     } else {
         // Send block from disk
@@ -5363,6 +5378,14 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     CNetMessage& msg{poll_result->first};
     bool fMoreWork = poll_result->second;
 
+    // Verify the signatures of the transactions queued behind this message
+    // in parallel, so that their acceptance finds them in the signature cache
+    if (fMoreWork && m_tx_preverifier && !RejectIncomingTxs(*pfrom) && !m_chainman.IsInitialBlockDownload()) {
+        for (DataStream& tx_data : pfrom->PeekNewMessages(NetMsgType::TX, MAX_TX_VERIFY_LOOKAHEAD)) {
+            m_tx_preverifier->Add(std::move(tx_data));
+        }
+    }
+
     TRACE6(net, inbound_message,
         pfrom->GetId(),
         pfrom->m_addr_name.c_str(),
@@ -21,6 +21,11 @@ static const uint32_t DEFAULT_MAX_ORPHAN_TRANSACTIONS{100};
 /** Default number of non-mempool transactions to keep around for block reconstruction. Includes
     orphan, replaced, and rejected transactions. */
 static const uint32_t DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN{100};
+/** Default for -txverifythreads, number of threads pre-verifying relayed transactions (0 = disabled) */
+static constexpr int DEFAULT_TX_VERIFY_THREADS{2};
+static constexpr int MAX_TX_VERIFY_THREADS{16};
+/** Maximum number of queued tx messages of a peer that are pre-verified at a time */
+static constexpr size_t MAX_TX_VERIFY_LOOKAHEAD{100};
 static const bool DEFAULT_PEERBLOOMFILTERS = false;
 static const bool DEFAULT_PEERBLOCKFILTERS = false;
 /** Threshold for marking a node to be discouraged, e.g. disconnected and added to the discouragement filter. */
@@ -72,6 +77,8 @@ public:
         //! Number of non-mempool transactions to keep around for block reconstruction. Includes
         //! orphan, replaced, and rejected transactions.
         uint32_t max_extra_txs{DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN};
+        //! Number of threads verifying the signatures of queued tx messages ahead of mempool acceptance
+        int tx_verify_threads{DEFAULT_TX_VERIFY_THREADS};
         //! Whether all P2P messages are captured to disk
         bool capture_messages{false};
         //! Whether or not the internal RNG behaves deterministically (this is
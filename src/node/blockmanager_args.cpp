@@ -33,6 +33,12 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
 
+    int64_t compression_level{args.GetIntArg("-blockcompression", opts.block_compression_level)};
+    if (compression_level < 0 || compression_level > MAX_BLOCK_COMPRESSION_LEVEL) {
+        return util::Error{strprintf(_("Invalid -blockcompression level %d (must be between 0 and %d)."), compression_level, MAX_BLOCK_COMPRESSION_LEVEL)};
+    }
+    opts.block_compression_level = static_cast<int>(compression_level);
+
     return {};
 }
 } // namespace node
@@ -0,0 +1,194 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockprefetcher.h>
+
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <span.h>
+#include <tinyformat.h>
+#include <util/threadnames.h>
+
+#include <exception>
+#include <utility>
+
+namespace node {
+
+BlockFilePrefetcher::BlockFilePrefetcher(std::FILE* file, const MessageStartChars& message_start, unsigned int max_block_size, int parse_threads)
+    : m_file{file}, m_message_start{message_start}, m_max_block_size{max_block_size}
+{
+    m_scan_thread = std::thread([this]() {
+        util::ThreadRename("reindexscan");
+        ThreadScan();
+    });
+    m_parse_threads.reserve(parse_threads);
+    for (int n = 0; n < parse_threads; ++n) {
+        m_parse_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("reindexparse.%i", n));
+            ThreadParse();
+        });
+    }
+}
+
+BlockFilePrefetcher::~BlockFilePrefetcher()
+{
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_cv.notify_all();
+    m_scan_thread.join();
+    for (std::thread& t : m_parse_threads) {
+        t.join();
+    }
+}
+
+void BlockFilePrefetcher::ThreadScan()
+{
+    // Mirrors the record scanning in ChainstateManager::LoadExternalBlockFile
+    try {
+        BufferedFile blkdat{m_file, 2 * m_max_block_size, m_max_block_size + BLOCK_SERIALIZATION_HEADER_SIZE};
+        uint64_t nRewind = blkdat.GetPos();
+        while (!blkdat.eof()) {
+            if (WITH_LOCK(m_mutex, return m_request_stop)) break;
+
+            blkdat.SetPos(nRewind);
+            nRewind++;
+            blkdat.SetLimit();
+            unsigned int nSize = 0;
+            bool compressed = false;
+            try {
+                MessageStartChars buf;
+                blkdat.FindByte(std::byte(m_message_start[0]));
+                nRewind = blkdat.GetPos() + 1;
+                blkdat >> buf;
+                if (buf != m_message_start) {
+                    continue;
+                }
+                blkdat >> nSize;
+                compressed = nSize & BLOCK_COMPRESSED_FLAG;
+                nSize &= ~BLOCK_COMPRESSED_FLAG;
+                if (nSize < (compressed ? sizeof(uint32_t) : 80) || nSize > m_max_block_size)
+                    continue;
+            } catch (const std::exception&) {
+                // end of file
+                break;
+            }
+            try {
+                const uint64_t nBlockPos{blkdat.GetPos()};
+                blkdat.SetLimit(nBlockPos + nSize);
+                std::vector<uint8_t> data(nSize);
+                blkdat.read(MakeWritableByteSpan(data));
+                nRewind = nBlockPos + nSize;
+
+                WAIT_LOCK(m_mutex, lock);
+                // Keep at least one record in flight, so a single large block can't stall the scanner
+                while (!m_request_stop && !m_records.empty() && m_bytes_ahead + nSize > MAX_PREFETCH_BYTES) {
+                    m_cv.wait(lock);
+                }
+                if (m_request_stop) break;
+                m_records.emplace(nBlockPos, Record{.size = nSize, .compressed = compressed, .data = std::move(data)});
+                m_parse_queue.push_back(nBlockPos);
+                m_bytes_ahead += nSize;
+                m_scan_pos = nRewind;
+            } catch (const std::exception&) {
+                // truncated record, keep scanning after its magic bytes like the loader does
+            }
+            m_cv.notify_all();
+        }
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::REINDEX, "%s: stopped scanning block file: %s\n", __func__, e.what());
+    }
+    WITH_LOCK(m_mutex, m_scan_done = true);
+    m_cv.notify_all();
+}
+
+void BlockFilePrefetcher::ThreadParse()
+{
+    while (true) {
+        uint64_t pos;
+        bool compressed;
+        std::vector<uint8_t> data;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (!m_request_stop && m_parse_queue.empty()) {
+                m_cv.wait(lock);
+            }
+            if (m_request_stop) return;
+            pos = m_parse_queue.front();
+            m_parse_queue.pop_front();
+            auto it{m_records.find(pos)};
+            if (it == m_records.end()) continue; // already dropped by the loader
+            compressed = it->second.compressed;
+            data = std::move(it->second.data);
+        }
+
+        auto block{std::make_shared<CBlock>()};
+        try {
+            if (compressed) {
+                std::vector<uint8_t> block_data;
+                if (!DecompressBlockData(data, block_data)) {
+                    block.reset();
+                } else {
+                    SpanReader{block_data} >> TX_WITH_WITNESS(*block);
+                }
+            } else {
+                // The loader continues right after the parsed block, so the
+                // result is only interchangeable when it fills the whole record
+                SpanReader reader{data};
+                reader >> TX_WITH_WITNESS(*block);
+                if (!reader.empty()) block.reset();
+            }
+        } catch (const std::exception&) {
+            block.reset();
+        }
+
+        {
+            LOCK(m_mutex);
+            auto it{m_records.find(pos)};
+            if (it != m_records.end()) {
+                it->second.block = std::move(block);
+                it->second.parsed = true;
+            }
+        }
+        m_cv.notify_all();
+    }
+}
+
+void BlockFilePrefetcher::ReleaseLocked(uint64_t pos)
+{
+    AssertLockHeld(m_mutex);
+    auto end{m_records.lower_bound(pos)};
+    for (auto it{m_records.begin()}; it != end; ++it) {
+        m_bytes_ahead -= it->second.size;
+    }
+    m_records.erase(m_records.begin(), end);
+}
+
+void BlockFilePrefetcher::Release(uint64_t pos)
+{
+    WITH_LOCK(m_mutex, ReleaseLocked(pos));
+    m_cv.notify_all();
+}
+
+std::shared_ptr<CBlock> BlockFilePrefetcher::Take(uint64_t block_pos, unsigned int size)
+{
+    WAIT_LOCK(m_mutex, lock);
+    ReleaseLocked(block_pos);
+    m_cv.notify_all();
+    // Wait for the scanner to reach the record, unless it went past it without finding it
+    while (!m_request_stop && !m_scan_done && m_scan_pos <= block_pos) {
+        m_cv.wait(lock);
+    }
+    auto it{m_records.find(block_pos)};
+    if (it == m_records.end() || it->second.size != size) return nullptr;
+    while (!m_request_stop && !it->second.parsed) {
+        m_cv.wait(lock);
+    }
+    std::shared_ptr<CBlock> block{std::move(it->second.block)};
+    m_bytes_ahead -= it->second.size;
+    m_records.erase(it);
+    m_cv.notify_all();
+    return block;
+}
+
+} // namespace node
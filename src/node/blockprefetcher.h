@@ -0,0 +1,108 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKPREFETCHER_H
+#define BITCOIN_NODE_BLOCKPREFETCHER_H
+
+#include <kernel/messagestartchars.h>
+#include <streams.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CBlock;
+
+namespace node {
+
+/** Amount of serialized block data the prefetcher may hold ahead of the loader */
+static constexpr size_t MAX_PREFETCH_BYTES{64 << 20};
+
+/**
+ * Reads and deserializes the blocks of a block file ahead of
+ * ChainstateManager::LoadExternalBlockFile, so that file I/O, parsing and
+ * transaction hashing overlap with block acceptance during -reindex.
+ *
+ * A scanner thread locates block records in its own handle on the file the
+ * same way the loader does and hands them to a pool of parser threads. The
+ * loader keeps scanning the file itself and decides what to accept, in the
+ * same order as without prefetching. It only uses a pre-parsed block when
+ * one exists for exactly the record it is looking at, so the outcome is the
+ * same even if the scanner disagrees about where records are. A compressed
+ * record is only inflated here: the loader takes its block up front to read
+ * the header.
+ */
+class BlockFilePrefetcher
+{
+public:
+    /**
+     * @param[in] file            File to read, ownership is taken.
+     * @param[in] message_start   Network magic that starts each record.
+     * @param[in] max_block_size  Records larger than this are skipped.
+     * @param[in] parse_threads   Number of deserialization threads.
+     */
+    BlockFilePrefetcher(std::FILE* file, const MessageStartChars& message_start, unsigned int max_block_size, int parse_threads);
+    ~BlockFilePrefetcher();
+
+    BlockFilePrefetcher(const BlockFilePrefetcher&) = delete;
+    BlockFilePrefetcher& operator=(const BlockFilePrefetcher&) = delete;
+
+    /**
+     * Return the block parsed from the record of size `size` (without the
+     * compression flag) whose payload starts at `block_pos`, waiting for it
+     * if it is still being read or parsed. Records before `block_pos` are
+     * dropped. Returns nullptr if there is no matching record or it did not
+     * deserialize cleanly; the caller then parses the block itself.
+     */
+    std::shared_ptr<CBlock> Take(uint64_t block_pos, unsigned int size) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop all records before `pos`, which the loader has moved past. */
+    void Release(uint64_t pos) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Record {
+        unsigned int size;
+        bool compressed;
+        //! Payload as read from disk, freed once parsed
+        std::vector<uint8_t> data;
+        //! Parsed block, nullptr if deserialization failed
+        std::shared_ptr<CBlock> block;
+        bool parsed{false};
+    };
+
+    void ThreadScan() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void ThreadParse() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void ReleaseLocked(uint64_t pos) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    AutoFile m_file;
+    const MessageStartChars m_message_start;
+    const unsigned int m_max_block_size;
+
+    Mutex m_mutex;
+    //! Signalled whenever a record is added, parsed or dropped
+    std::condition_variable m_cv;
+    //! Records by payload position
+    std::map<uint64_t, Record> m_records GUARDED_BY(m_mutex);
+    //! Positions of records waiting for a parser thread
+    std::deque<uint64_t> m_parse_queue GUARDED_BY(m_mutex);
+    //! Serialized bytes of all records in m_records
+    size_t m_bytes_ahead GUARDED_BY(m_mutex){0};
+    //! File position the scanner continues from
+    uint64_t m_scan_pos GUARDED_BY(m_mutex){0};
+    bool m_scan_done GUARDED_BY(m_mutex){false};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_scan_thread;
+    std::vector<std::thread> m_parse_threads;
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKPREFETCHER_H
@@ -8,6 +8,7 @@
 #include <chain.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <dbwrapper.h>
 #include <flatfile.h>
 #include <hash.h>
@@ -41,6 +42,9 @@
 #include <map>
 #include <unordered_map>
 
+#include <cryptopp/zdeflate.h>
+#include <cryptopp/zinflate.h>
+
 namespace kernel {
 static constexpr uint8_t DB_BLOCK_FILES{'f'};
 static constexpr uint8_t DB_BLOCK_INDEX{'b'};
@@ -1427,6 +1431,73 @@ bool BlockManager::FindUndoPos(BlockValidationState& state, int nFile, FlatFileP
     return true;
 }
 
+namespace {
+/** Crypto++ sink appending to a byte vector, so (de)compression needs no intermediate string */
+class ByteVectorSink : public CryptoPP::Bufferless<CryptoPP::Sink>
+{
+    std::vector<uint8_t>& m_out;
+
+public:
+    explicit ByteVectorSink(std::vector<uint8_t>& out) : m_out{out} {}
+
+    size_t Put2(const unsigned char* in, size_t length, int message_end, bool blocking) override
+    {
+        m_out.insert(m_out.end(), in, in + length);
+        return 0;
+    }
+};
+
+/**
+ * Read the serialization header in front of the block at pos. On success the
+ * file is positioned at the start of the block payload.
+ */
+bool ReadBlockHeader(AutoFile& filein, const MessageStartChars& message_start, const FlatFilePos& pos, unsigned int& blk_size)
+{
+    MessageStartChars blk_start;
+    filein >> blk_start >> blk_size;
+
+    if (blk_start != message_start) {
+        return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                     HexStr(blk_start),
+                     HexStr(message_start));
+    }
+
+    if ((blk_size & ~BLOCK_COMPRESSED_FLAG) > MAX_SIZE) {
+        return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
+                     blk_size & ~BLOCK_COMPRESSED_FLAG, MAX_SIZE);
+    }
+    return true;
+}
+} // namespace
+
+std::vector<uint8_t> CompressBlockData(Span<const uint8_t> block, int level)
+{
+    std::vector<uint8_t> compressed(sizeof(uint32_t));
+    compressed.reserve(block.size() / 2);
+    WriteLE32(compressed.data(), block.size());
+    CryptoPP::Deflator deflator{new ByteVectorSink{compressed}, level};
+    deflator.Put(block.data(), block.size());
+    deflator.MessageEnd();
+    return compressed;
+}
+
+bool DecompressBlockData(Span<const uint8_t> compressed, std::vector<uint8_t>& block)
+{
+    block.clear();
+    if (compressed.size() < sizeof(uint32_t)) return false;
+    const uint32_t block_size{ReadLE32(compressed.data())};
+    if (block_size > MAX_SIZE) return false;
+    block.reserve(block_size);
+    try {
+        CryptoPP::Inflator inflator{new ByteVectorSink{block}};
+        inflator.Put(compressed.data() + sizeof(uint32_t), compressed.size() - sizeof(uint32_t));
+        inflator.MessageEnd();
+    } catch (const CryptoPP::Exception&) {
+        return false;
+    }
+    return block.size() == block_size;
+}
+
 bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
 {
     // Open history file to append
@@ -1450,6 +1521,29 @@ bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
     return true;
 }
 
+bool BlockManager::WriteCompressedBlockToDisk(Span<const uint8_t> compressed_block, FlatFilePos& pos) const
+{
+    // Open history file to append
+    AutoFile fileout{OpenBlockFile(pos)};
+    if (fileout.IsNull()) {
+        return error("WriteCompressedBlockToDisk: OpenBlockFile failed");
+    }
+
+    // Write index header, flagging the payload as compressed
+    unsigned int nSize = compressed_block.size() | BLOCK_COMPRESSED_FLAG;
+    fileout << GetParams().MessageStart() << nSize;
+
+    // Write compressed block
+    long fileOutPos = ftell(fileout.Get());
+    if (fileOutPos < 0) {
+        return error("WriteCompressedBlockToDisk: ftell failed");
+    }
+    pos.nPos = (unsigned int)fileOutPos;
+    fileout.write(MakeByteSpan(compressed_block));
+
+    return true;
+}
+
 bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationState& state, CBlockIndex& block)
 {
     AssertLockHeld(::cs_main);
@@ -1492,19 +1586,36 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
 }
 
 template <typename Block>
-bool BlockManager::ReadBlockFromDisk(Block& block, const FlatFilePos& pos) const
+bool BlockManager::ReadBlockFromDisk(Block& block, const FlatFilePos& pos, unsigned int* stored_size) const
 {
     block.SetNull();
 
-    // Open history file to read
-    AutoFile filein{OpenBlockFile(pos, true)};
+    // Open history file to read, starting at the meta header in front of the block
+    FlatFilePos hpos = pos;
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    AutoFile filein{OpenBlockFile(hpos, true)};
     if (filein.IsNull()) {
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
     }
 
     // Read block
     try {
-        filein >> TX_WITH_WITNESS(block);
+        unsigned int blk_size;
+        if (!ReadBlockHeader(filein, GetParams().MessageStart(), pos, blk_size)) {
+            return false;
+        }
+        if (stored_size) *stored_size = blk_size & ~BLOCK_COMPRESSED_FLAG;
+        if (blk_size & BLOCK_COMPRESSED_FLAG) {
+            std::vector<uint8_t> compressed(blk_size & ~BLOCK_COMPRESSED_FLAG);
+            filein.read(MakeWritableByteSpan(compressed));
+            std::vector<uint8_t> block_data;
+            if (!DecompressBlockData(compressed, block_data)) {
+                return error("%s: Failed to decompress block at %s", __func__, pos.ToString());
+            }
+            SpanReader{block_data} >> TX_WITH_WITNESS(block);
+        } else {
+            filein >> TX_WITH_WITNESS(block);
+        }
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
@@ -1548,24 +1659,21 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     }
 
     try {
-        MessageStartChars blk_start;
         unsigned int blk_size;
-
-        filein >> blk_start >> blk_size;
-
-        if (blk_start != GetParams().MessageStart()) {
-            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
-                         HexStr(blk_start),
-                         HexStr(GetParams().MessageStart()));
+        if (!ReadBlockHeader(filein, GetParams().MessageStart(), pos, blk_size)) {
+            return false;
         }
 
-        if (blk_size > MAX_SIZE) {
-            return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
-                         blk_size, MAX_SIZE);
+        if (blk_size & BLOCK_COMPRESSED_FLAG) {
+            std::vector<uint8_t> compressed(blk_size & ~BLOCK_COMPRESSED_FLAG);
+            filein.read(MakeWritableByteSpan(compressed));
+            if (!DecompressBlockData(compressed, block)) {
+                return error("%s: Failed to decompress block at %s", __func__, pos.ToString());
+            }
+        } else {
+            block.resize(blk_size); // Zeroing of memory is intentional here
+            filein.read(MakeWritableByteSpan(block));
         }
-
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read(MakeWritableByteSpan(block));
     } catch (const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -1573,13 +1681,28 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     return true;
 }
 
-FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp)
+FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp, std::optional<unsigned int> stored_size)
 {
     unsigned int nBlockSize = ::GetSerializeSize(TX_WITH_WITNESS(block));
     FlatFilePos blockPos;
     const auto position_known {dbp != nullptr};
+    std::vector<uint8_t> compressed_block;
+    if (!position_known && m_opts.block_compression_level > 0) {
+        std::vector<uint8_t> block_data;
+        block_data.reserve(nBlockSize);
+        VectorWriter{block_data, 0, TX_WITH_WITNESS(block)};
+        compressed_block = CompressBlockData(block_data, m_opts.block_compression_level);
+        // Only keep the compressed form when it actually saves space
+        if (compressed_block.size() < nBlockSize) {
+            nBlockSize = compressed_block.size();
+        } else {
+            compressed_block.clear();
+        }
+    }
     if (position_known) {
         blockPos = *dbp;
+        // The block found on disk may be stored compressed, account for the length of its record
+        if (stored_size) nBlockSize = *stored_size;
     } else {
         // when known, blockPos.nPos points at the offset of the block data in the blk file. that already accounts for
         // the serialization header present in the file (the 4 magic message start bytes + the 4 length bytes = 8 bytes = BLOCK_SERIALIZATION_HEADER_SIZE).
@@ -1591,7 +1714,7 @@ FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, cons
         return FlatFilePos();
     }
     if (!position_known) {
-        if (!WriteBlockToDisk(block, blockPos)) {
+        if (!(compressed_block.empty() ? WriteBlockToDisk(block, blockPos) : WriteCompressedBlockToDisk(compressed_block, blockPos))) {
             m_opts.notifications.fatalError("Failed to write block");
             return FlatFilePos();
         }
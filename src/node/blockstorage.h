@@ -144,6 +144,22 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 /** Size of header written by WriteBlockToDisk before a serialized CBlock */
 static constexpr size_t BLOCK_SERIALIZATION_HEADER_SIZE = std::tuple_size_v<MessageStartChars> + sizeof(unsigned int);
 
+/** Bit set in the size field of the serialization header when the block that follows is compressed */
+static constexpr unsigned int BLOCK_COMPRESSED_FLAG = 0x80000000;
+/** Default deflate level for newly stored blocks (0 = store uncompressed) */
+static constexpr int DEFAULT_BLOCK_COMPRESSION_LEVEL{0};
+/** Highest deflate level accepted by -blockcompression */
+static constexpr int MAX_BLOCK_COMPRESSION_LEVEL{9};
+
+/**
+ * Compress a serialized block for storage in a blk file. The result starts
+ * with the uncompressed size (4 bytes, little endian) followed by a raw
+ * deflate stream.
+ */
+std::vector<uint8_t> CompressBlockData(Span<const uint8_t> block, int level);
+/** Reverse CompressBlockData. Returns false if the data is malformed or too large. */
+bool DecompressBlockData(Span<const uint8_t> compressed, std::vector<uint8_t>& block);
+
 extern std::atomic_bool fReindex;
 
 // Because validation code takes pointers to the map's CBlockIndex objects, if
@@ -233,6 +249,7 @@ private:
     AutoFile OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
     bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const;
+    bool WriteCompressedBlockToDisk(Span<const uint8_t> compressed_block, FlatFilePos& pos) const;
     bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const;
 
     /* Calculate the block/rev files to delete based on height specified by user with RPC command pruneblockchain */
@@ -380,8 +397,9 @@ public:
     bool WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationState& state, CBlockIndex& block)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    /** Store block on disk. If dbp is not nullptr, then it provides the known position of the block within a block file on disk. */
-    FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp);
+    /** Store block on disk. If dbp is not nullptr, then it provides the known position of the block within a block file on disk,
+     *  and stored_size the length of its record there (compressed or not). Without it the block is assumed to be stored uncompressed. */
+    FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp, std::optional<unsigned int> stored_size = std::nullopt);
 
     /** Whether running in -prune mode. */
     [[nodiscard]] bool IsPruneMode() const { return m_prune_mode; }
@@ -438,8 +456,9 @@ public:
     bool CheckSync(int nHeight, const CBlockIndex *pindexBest) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Functions for disk access for blocks */
+    /** Read the block at pos. If stored_size is not nullptr, it is set to the length of its record on disk (compressed or not). */
     template <typename Block>
-    bool ReadBlockFromDisk(Block& block, const FlatFilePos& pos) const;
+    bool ReadBlockFromDisk(Block& block, const FlatFilePos& pos, unsigned int* stored_size = nullptr) const;
     bool ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) const;
     bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
 
@@ -53,6 +53,8 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
     opts.worker_threads_num = std::clamp(script_threads - 1, 0, MAX_SCRIPTCHECK_THREADS);
     LogPrintf("Script verification uses %d additional threads\n", opts.worker_threads_num);
 
+    opts.reindex_parse_threads = std::clamp<int>(args.GetIntArg("-reindexparsethreads", DEFAULT_REINDEX_PARSE_THREADS), 0, MAX_REINDEX_PARSE_THREADS);
+
     return {};
 }
 } // namespace node
@@ -14,6 +14,10 @@ class ArgsManager;
 static constexpr int MAX_SCRIPTCHECK_THREADS{15};
 /** -par default (number of script-checking threads, 0 = auto) */
 static constexpr int DEFAULT_SCRIPTCHECK_THREADS{0};
+/** Maximum number of block deserialization threads used during -reindex */
+static constexpr int MAX_REINDEX_PARSE_THREADS{8};
+/** -reindexparsethreads default (0 = read and parse blocks on the import thread only) */
+static constexpr int DEFAULT_REINDEX_PARSE_THREADS{2};
 
 namespace node {
 [[nodiscard]] util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManager::Options& opts);
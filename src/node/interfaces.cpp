@@ -75,6 +75,7 @@
 
 using interfaces::BlockTip;
 using interfaces::Chain;
+using interfaces::ContractLog;
 using interfaces::FoundBlock;
 using interfaces::Handler;
 using interfaces::MakeSignalHandler;
@@ -656,6 +657,30 @@ public:
         if (index == nullptr || !block_filter_index->LookupFilter(index, filter)) return std::nullopt;
         return filter.GetFilter().MatchAny(filter_set);
     }
+    bool hasAddressIndex() override
+    {
+        return fAddressIndex;
+    }
+    bool findAddressIndexHeights(const std::vector<CScript>& scripts, int start_height, int end_height, std::set<int>& heights) override
+    {
+        if (!fAddressIndex) return false;
+        for (const CScript& script : scripts) {
+            // Same keys as ConnectBlock writes to the index
+            CTxDestination dest;
+            if (!ExtractDestination(COutPoint(), script, dest)) return false;
+            valtype bytesID(std::visit(DataVisitor(), dest));
+            if (bytesID.empty()) return false;
+            valtype addressBytes(32);
+            std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
+
+            std::vector<std::pair<CAddressIndexKey, CAmount>> address_index;
+            if (!GetAddressIndex(uint256(addressBytes), GetAddressIndexType(dest), address_index, chainman().m_blockman, std::max(start_height, 1), end_height)) return false;
+            for (const auto& [key, value] : address_index) {
+                if (key.blockHeight >= start_height && key.blockHeight <= end_height) heights.insert(key.blockHeight);
+            }
+        }
+        return true;
+    }
     bool findBlock(const uint256& hash, const FoundBlock& block) override
     {
         WAIT_LOCK(cs_main, lock);
@@ -954,6 +979,10 @@ public:
     {
         return GetStakeWeight(wallet, pStakerWeight, pDelegateWeight);
     }
+    bool getDelegateStakeCoins(const wallet::CWallet& wallet, std::map<COutPoint, std::pair<CAmount, int>>& coins, int& height) override
+    {
+        return GetDelegateStakeCoins(wallet, coins, height);
+    }
     void refreshDelegates(wallet::CWallet *pwallet, bool myDelegates, bool stakerDelegates) override
     {
         RefreshDelegates(pwallet, myDelegates, stakerDelegates);
@@ -976,6 +1005,24 @@ public:
     {
         return QtumDelegation::VerifyDelegation(address, delegation);
     }
+    std::vector<ContractLog> getContractLogs(const uint256& txid, const uint256& block_hash) override
+    {
+        std::vector<ContractLog> result;
+        if (!fLogEvents) return result;
+        LOCK(::cs_main);
+        for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(txid))) {
+            if (receipt.blockHash != block_hash) continue;
+            for (const dev::eth::LogEntry& log : receipt.logs) {
+                ContractLog& contract_log = result.emplace_back();
+                contract_log.address = log.address.hex();
+                for (const dev::h256& topic : log.topics) {
+                    contract_log.topics.push_back(topic.hex());
+                }
+                contract_log.data = HexStr(log.data);
+            }
+        }
+        return result;
+    }
     NodeContext& m_node;
 };
 } // namespace
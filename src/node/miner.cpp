@@ -29,6 +29,7 @@
 #include <key_io.h>
 #include <qtum/qtumledger.h>
 #include <qtum/qtumdelegation.h>
+#include <index/delegationindex.h>
 #ifdef ENABLE_WALLET
 #include <wallet/wallet.h>
 #include <wallet/receive.h>
@@ -36,6 +37,8 @@
 #endif
 
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <utility>
 
 namespace node {
@@ -767,6 +770,12 @@ void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSele
         // contain anything that is inBlock.
         assert(!inBlock.count(iter->GetSharedTx()->GetHash()));
 
+        // Contract txs are ordered after all other txs, so only packages of
+        // contract txs are left. Those are selected by addContractPackageTxs.
+        if (iter->GetTx().GetCreateOrCall() > CTransaction::OpNone) {
+            break;
+        }
+
         uint64_t packageSize = iter->GetSizeWithAncestors();
         CAmount packageFees = iter->GetModFeesWithAncestors();
         int64_t packageSigOpsCost = iter->GetSigOpCostWithAncestors();
@@ -778,7 +787,7 @@ void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSele
 
         if (packageFees < m_options.blockMinFeeRate.GetFee(packageSize)) {
             // Everything else we might consider has a lower fee rate
-            return;
+            break;
         }
 
         if (!TestPackage(packageSize, packageSigOpsCost)) {
@@ -859,6 +868,149 @@ void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSele
         // Update transactions that depend on each of these
         nDescendantsUpdated += UpdatePackagesForAdded(mempool, ancestors, mapModifiedTx);
     }
+
+    addContractPackageTxs(mempool, failedTx, nPackagesSelected, nDescendantsUpdated, minGasPrice, pblock);
+}
+
+double GasPackageScore(const GasPackageInfo& package, uint64_t remaining_size, uint64_t remaining_gas, double gas_used_ratio)
+{
+    gas_used_ratio = std::clamp(gas_used_ratio, 0.0, 1.0);
+    const double expected_fees = package.fees - (1 - gas_used_ratio) * package.gas_stipend;
+    double cost = (double)package.size / std::max<uint64_t>(remaining_size, 1);
+    if (package.gas_limit > 0) {
+        cost += gas_used_ratio * package.gas_limit / std::max<uint64_t>(remaining_gas, 1);
+    }
+    return expected_fees / std::max(cost, std::numeric_limits<double>::min());
+}
+
+// Greedy selection for the two-dimensional knapsack of block size and block
+// gas. Contract packages are ranked by GasPackageScore, which is recomputed
+// against the remaining capacity before each pick. How much of its gas limit
+// a contract uses is only known after executing it, so the score uses the
+// ratio observed for the contracts added so far, while a package is only
+// tried if its whole gas limit still fits under the soft block gas limit.
+void BlockAssembler::addContractPackageTxs(const CTxMemPool& mempool, std::set<Txid>& failedTx, int& nPackagesSelected, int& nDescendantsUpdated, uint64_t minGasPrice, CBlock* pblock)
+{
+    AssertLockHeld(mempool.cs);
+
+    struct Candidate {
+        CTxMemPool::setEntries package;
+        GasPackageInfo info;
+        int64_t sigOpsCost{0};
+        bool stale{true};
+    };
+    std::map<CTxMemPool::txiter, Candidate, CompareIteratorByHash> candidates;
+
+    const auto& index = mempool.mapTx.get<ancestor_score_or_gas_price>();
+    for (auto mi = index.rbegin(); mi != index.rend() && mi->GetTx().GetCreateOrCall() > CTransaction::OpNone; ++mi) {
+        const Txid& hash = mi->GetSharedTx()->GetHash();
+        if (!inBlock.count(hash) && !failedTx.count(hash)) {
+            candidates.emplace(mempool.mapTx.iterator_to(*mi), Candidate{});
+        }
+    }
+
+    uint64_t executedGasLimit = 0;
+    uint64_t executedGasUsed = 0;
+
+    while (!candidates.empty()) {
+        if (nTimeLimit != 0 && GetAdjustedTimeSeconds() >= nTimeLimit - nBytecodeTimeBuffer) {
+            return;
+        }
+
+        const uint64_t remainingGas = bceResult.usedGas < softBlockGasLimit ? softBlockGasLimit - bceResult.usedGas : 0;
+        const uint64_t remainingSize = (m_options.nBlockMaxWeight - std::min<uint64_t>(nBlockWeight, m_options.nBlockMaxWeight)) / WITNESS_SCALE_FACTOR;
+        const double gasUsedRatio = executedGasLimit > 0 ? (double)executedGasUsed / executedGasLimit : 1.0;
+
+        auto best = candidates.end();
+        double bestScore = 0;
+        for (auto cit = candidates.begin(); cit != candidates.end();) {
+            Candidate& candidate = cit->second;
+            if (candidate.stale) {
+                candidate.package = mempool.AssumeCalculateMemPoolAncestors(__func__, *cit->first, CTxMemPool::Limits::NoLimits(), /*fSearchForParents=*/false);
+                onlyUnconfirmed(candidate.package);
+                candidate.package.insert(cit->first);
+                candidate.info = GasPackageInfo{};
+                candidate.sigOpsCost = 0;
+                candidate.stale = false;
+                bool failed = false;
+                for (CTxMemPool::txiter it : candidate.package) {
+                    failed |= failedTx.count(it->GetSharedTx()->GetHash()) > 0;
+                    candidate.info.size += it->GetTxSize();
+                    candidate.info.fees += it->GetModifiedFee();
+                    candidate.info.gas_limit += it->GetGasLimit();
+                    candidate.info.gas_stipend += it->GetMinGasPrice() * (CAmount)it->GetGasLimit();
+                    candidate.sigOpsCost += it->GetSigOpCost();
+                }
+                if (failed) {
+                    cit = candidates.erase(cit);
+                    continue;
+                }
+            }
+            // The block only fills up, so a package that doesn't fit now never will,
+            // unless some of its ancestors get added, which marks it stale again
+            if (candidate.info.gas_limit > remainingGas || !TestPackage(candidate.info.size, candidate.sigOpsCost)) {
+                cit = candidates.erase(cit);
+                continue;
+            }
+            if (candidate.info.fees >= m_options.blockMinFeeRate.GetFee(candidate.info.size)) {
+                const double score = GasPackageScore(candidate.info, remainingSize, remainingGas, gasUsedRatio);
+                if (best == candidates.end() || score > bestScore) {
+                    best = cit;
+                    bestScore = score;
+                }
+            }
+            ++cit;
+        }
+        if (best == candidates.end()) {
+            break;
+        }
+
+        const CTxMemPool::txiter iter = best->first;
+        const CTxMemPool::setEntries ancestors = std::move(best->second.package);
+        candidates.erase(best);
+
+        if (!TestPackageTransactions(ancestors)) {
+            failedTx.insert(iter->GetSharedTx()->GetHash());
+            continue;
+        }
+
+        std::vector<CTxMemPool::txiter> sortedEntries;
+        SortForBlock(ancestors, sortedEntries);
+
+        const uint64_t usedGasBefore = bceResult.usedGas;
+        bool wasAdded = true;
+        for (CTxMemPool::txiter entry : sortedEntries) {
+            if (entry->GetTx().HasCreateOrCall()) {
+                wasAdded = AttemptToAddContractToBlock(entry, minGasPrice, pblock);
+                if (!wasAdded) {
+                    failedTx.insert(entry->GetSharedTx()->GetHash());
+                    failedTx.insert(iter->GetSharedTx()->GetHash());
+                    break;
+                }
+                executedGasLimit += entry->GetGasLimit();
+            } else {
+                AddToBlock(entry);
+            }
+        }
+        executedGasUsed += bceResult.usedGas - usedGasBefore;
+        if (wasAdded) {
+            ++nPackagesSelected;
+        }
+
+        // The packages of the descendants changed, and some of them may only fit now
+        for (CTxMemPool::txiter entry : sortedEntries) {
+            CTxMemPool::setEntries descendants;
+            mempool.CalculateDescendants(entry, descendants);
+            for (CTxMemPool::txiter desc : descendants) {
+                if (inBlock.count(desc->GetSharedTx()->GetHash())) {
+                    candidates.erase(desc);
+                } else {
+                    ++nDescendantsUpdated;
+                    candidates[desc].stale = true;
+                }
+            }
+        }
+    }
 }
 
 bool CanStake()
@@ -902,6 +1054,23 @@ public:
 
         return true;
     }
+
+    static void GetWalletKeys(wallet::CWallet *pwallet, std::set<uint160>& keys)
+    {
+        // The key of every public key hash script of the wallet, the watch only included
+        LOCK(pwallet->cs_wallet);
+        for(wallet::ScriptPubKeyMan* spk_man : pwallet->GetAllScriptPubKeyMans())
+        {
+            for(const CScript& script : spk_man->GetScriptPubKeys())
+            {
+                CTxDestination dest;
+                if(ExtractDestination(script, dest) && std::holds_alternative<PKHash>(dest))
+                {
+                    keys.insert(uint160(std::get<PKHash>(dest)));
+                }
+            }
+        }
+    }
 };
 
 class DelegationsStaker : public DelegationFilterBase
@@ -978,6 +1147,13 @@ public:
         return CheckAddressList(type, allowList, excludeList, event);
     }
 
+    bool GetStakers(std::set<uint160>& stakers) const override
+    {
+        // Only the keys of the wallet can be stakers
+        GetWalletKeys(pwallet, stakers);
+        return true;
+    }
+
     bool CheckAddressList(const int& _type, const std::vector<uint160>& _allowList, const std::vector<uint160>& _excludeList, const DelegationEvent& event) const
     {
         switch (_type) {
@@ -994,7 +1170,7 @@ public:
         return false;
     }
 
-    void Update(int32_t nHeight)
+    void Update(int32_t nHeight, const uint256& hashTip)
     {
         if(pwallet->fUpdatedSuperStaker)
         {
@@ -1005,6 +1181,13 @@ public:
         }
 
         std::map<uint160, Delegation> delegations_staker;
+        if(g_delegation_index && g_delegation_index->FilterDelegations(*this, hashTip, delegations_staker))
+        {
+            // The delegation index is at the tip, no need to replay the events
+            pwallet->updateDelegationsStaker(delegations_staker);
+            return;
+        }
+
         int checkpointSpan = Params().GetConsensus().CheckpointSpan(nHeight);
         if(nHeight <= checkpointSpan)
         {
@@ -1062,9 +1245,22 @@ public:
         return pwallet->HasPrivateKey(PKHash(event.item.delegate), fAllowWatchOnly);
     }
 
-    void Update(int32_t nHeight)
+    bool GetDelegates(std::set<uint160>& delegates) const override
     {
-        if(fLogEvents)
+        // Only the keys of the wallet can be delegates
+        GetWalletKeys(pwallet, delegates);
+        return true;
+    }
+
+    void Update(int32_t nHeight, const uint256& hashTip)
+    {
+        std::map<uint160, Delegation> my_delegations;
+        if(g_delegation_index && g_delegation_index->FilterDelegations(*this, hashTip, my_delegations))
+        {
+            // The delegation index is at the tip, no need to replay the events
+            SetMyDelegations(my_delegations);
+        }
+        else if(fLogEvents)
         {
             // When log events are enabled, search the log events to get complete list of my delegations
             int checkpointSpan = Params().GetConsensus().CheckpointSpan(nHeight);
@@ -1073,7 +1269,7 @@ public:
                 // Get delegations from events
                 std::vector<DelegationEvent> events;
                 qtumDelegations.FilterDelegationEvents(events, *this, pwallet->chain().chainman());
-                pwallet->m_my_delegations = qtumDelegations.DelegationsFromEvents(events);
+                SetMyDelegations(qtumDelegations.DelegationsFromEvents(events));
             }
             else
             {
@@ -1090,8 +1286,9 @@ public:
                 // Update the wallet delegations
                 std::vector<DelegationEvent> events;
                 qtumDelegations.FilterDelegationEvents(events, *this, pwallet->chain().chainman(), cacheHeight + 1);
-                pwallet->m_my_delegations = cacheMyDelegations;
-                qtumDelegations.UpdateDelegationsFromEvents(events, pwallet->m_my_delegations);
+                my_delegations = cacheMyDelegations;
+                qtumDelegations.UpdateDelegationsFromEvents(events, my_delegations);
+                SetMyDelegations(my_delegations);
             }
         }
         else
@@ -1132,7 +1329,7 @@ public:
                 }
 
                 // Update my delegations list
-                pwallet->m_my_delegations = cacheMyDelegations;
+                SetMyDelegations(cacheMyDelegations);
                 cacheHeight = nHeight;
             }
         }
@@ -1154,6 +1351,12 @@ public:
         }
     }
 
+    void SetMyDelegations(const std::map<uint160, Delegation>& my_delegations)
+    {
+        LOCK(pwallet->cs_wallet);
+        pwallet->SetMyDelegations(my_delegations);
+    }
+
 private:
 
     wallet::CWallet *pwallet;
@@ -1348,7 +1551,8 @@ bool SignBlock(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet, const CA
     bool found = false;
     {
         LOCK(cs_main);
-        found = wallet::CreateCoinStake(wallet, pblock->nBits, nTotalFees, nTimeBlock, txCoinStake, pkhash, setCoins, setSelectedCoins, setDelegateCoins, selectedOnly, !privateKeysDisabled, vchPoD, headerPrevout);
+        // The coinstake made when trying is only used for its output script, it is signed once the block is filled
+        found = wallet::CreateCoinStake(wallet, pblock->nBits, nTotalFees, nTimeBlock, txCoinStake, pkhash, setCoins, setSelectedCoins, setDelegateCoins, selectedOnly, !privateKeysDisabled && !tryOnly, vchPoD, headerPrevout);
     }
     if (found)
     {
@@ -1361,6 +1565,11 @@ bool SignBlock(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet, const CA
             pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
             pblock->prevoutStake = headerPrevout;
 
+            // Keep the wallet from spending the coins of the coinstake until the block is submitted
+            wallet.m_staking_coins_in_use.clear();
+            for(const CTxIn& txin : pblock->vtx[1]->vin)
+                wallet.m_staking_coins_in_use.insert(txin.prevout);
+
             if(tryOnly)
                 return true;
 
@@ -1474,6 +1683,7 @@ public:
     uint32_t beginningTime = 0;
     uint32_t endingTime = 0;
     uint32_t waitBestHeaderAttempts = 0;
+    SteadyClock::time_point kernelFoundTime;
 
     std::shared_ptr<CBlock> pblock;
     std::unique_ptr<CBlockTemplate> pblocktemplate;
@@ -1588,11 +1798,15 @@ public:
                     // Check if block can be created
                     if(CanCreateBlock(blockTime))
                     {
-                        // Create new block
-                        if(!CreateNewBlock(blockTime)) break;
+                        d->kernelFoundTime = SteadyClock::now();
 
-                        // Sign new block
-                        if(SignNewBlock(blockTime)) break;
+                        // Create and sign new block
+                        bool created = CreateNewBlock(blockTime);
+                        bool submitted = created && SignNewBlock(blockTime);
+
+                        // The coins of the coinstake can be spent again
+                        WITH_LOCK(d->pwallet->cs_wallet, d->pwallet->m_staking_coins_in_use.clear());
+                        if(!created || submitted) break;
                     }
                 }
             }
@@ -1761,12 +1975,13 @@ protected:
         bool fOfflineStakeEnabled = (d->nHeight > d->nOfflineStakeHeight) && d->fDelegationsContract;
         if(fOfflineStakeEnabled)
         {
-            d->myDelegations.Update(nHeightTip);
+            d->myDelegations.Update(nHeightTip, d->pindexPrev->GetBlockHash());
         }
         wallet::SelectCoinsForStaking(*d->pwallet, d->nTargetValue, d->setCoins, nValueIn);
+        d->pwallet->CacheStakeKeys(d->setCoins);
         if(d->fSuperStake && fOfflineStakeEnabled)
         {
-            d->delegationsStaker.Update(nHeightTip);
+            d->delegationsStaker.Update(nHeightTip, d->pindexPrev->GetBlockHash());
             std::map<uint160, CAmount> mDelegateWeight;
             wallet::SelectDelegateCoinsForStaking(*d->pwallet, d->setDelegateCoins, mDelegateWeight);
             d->pwallet->updateDelegationsWeight(mDelegateWeight);
@@ -1943,6 +2158,11 @@ protected:
         d->mapSolveBlockTime[blockTime] = false;
 
         if (SignBlock(d->pblockfilled, *(d->pwallet), d->nTotalFees, blockTime, d->setCoins, d->mapSolveSelectedCoins[blockTime], d->mapSolveDelegateCoins[blockTime], true)) {
+            // Time taken to create and sign the block after the kernel was found
+            const int64_t latency{Ticks<std::chrono::milliseconds>(SteadyClock::now() - d->kernelFoundTime)};
+            d->pwallet->m_last_coin_stake_latency = latency;
+            LogPrint(BCLog::COINSTAKE, "ThreadStakeMiner(): block signed %d ms after finding the kernel\n", latency);
+
             // Should always reach here unless we spent too much time processing transactions and the timestamp is now invalid
             // CheckStake also does CheckBlock and AcceptBlock to propagate it to the network
             bool validBlock = false;
@@ -1977,6 +2197,7 @@ protected:
             if(validBlock) {
                 if(!CheckStake(d->pblockfilled, *(d->pwallet)))
                     d->forceUpdate = true;
+                LogPrint(BCLog::COINSTAKE, "ThreadStakeMiner(): block submitted %d ms after finding the kernel\n", Ticks<std::chrono::milliseconds>(SteadyClock::now() - d->kernelFoundTime));
                 // Update the search time when new valid block is created, needed for status bar icon
                 d->pwallet->m_last_coin_stake_search_time = d->pblockfilled->GetBlockTime();
             }
@@ -2057,22 +2278,24 @@ void RefreshDelegates(wallet::CWallet *pwallet, bool refreshMyDelegates, bool re
         int nOfflineStakeHeight = Params().GetConsensus().nOfflineStakeHeight;
         bool fDelegationsContract = !Params().GetConsensus().delegationsAddress.IsNull();
         int32_t nHeight = 0;
+        uint256 hashTip;
         {
             LOCK(cs_main);
             nHeight = pwallet->chain().getHeight().value_or(0);
+            if(const CBlockIndex* pindexTip = pwallet->chain().getTip()) hashTip = pindexTip->GetBlockHash();
         }
         bool fOfflineStakeEnabled = ((nHeight + 1) > nOfflineStakeHeight) && fDelegationsContract;
         if(fOfflineStakeEnabled)
         {
             if(refreshMyDelegates)
             {
-                myDelegations.Update(nHeight);
+                myDelegations.Update(nHeight, hashTip);
             }
 
             if(refreshStakerDelegates)
             {
                 bool fUpdatedSuperStaker = pwallet->fUpdatedSuperStaker;
-                delegationsStaker.Update(nHeight);
+                delegationsStaker.Update(nHeight, hashTip);
                 pwallet->fUpdatedSuperStaker = fUpdatedSuperStaker;
             }
         }
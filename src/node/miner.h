@@ -198,6 +198,26 @@ struct CompareTxIterByAncestorCount {
     }
 };
 
+/** Resources and fees of a package in the gas-aware stage of block assembly */
+struct GasPackageInfo {
+    //! Virtual size of the package
+    uint64_t size{0};
+    //! Modified fees of the package, including the full gas stipend of its contract txs
+    CAmount fees{0};
+    //! Sum of the gas limits of the contract txs of the package
+    uint64_t gas_limit{0};
+    //! Gas stipend of the contract txs at their minimum gas price, the unused part of it is refunded
+    CAmount gas_stipend{0};
+};
+
+/**
+ * Score of a package as an item of the two-dimensional knapsack of block
+ * size and block gas: its expected fees per combined share of the remaining
+ * size and gas it is expected to take. gas_used_ratio is the expected
+ * fraction of the gas limit that is used, and so not refunded.
+ */
+double GasPackageScore(const GasPackageInfo& package, uint64_t remaining_size, uint64_t remaining_gas, double gas_used_ratio);
+
 typedef boost::multi_index_container<
     CTxMemPoolModifiedEntry,
     boost::multi_index::indexed_by<
@@ -309,6 +329,10 @@ private:
       * Increments nPackagesSelected / nDescendantsUpdated with corresponding
       * statistics from the package selection (for logging statistics). */
     void addPackageTxs(const CTxMemPool& mempool, int& nPackagesSelected, int& nDescendantsUpdated, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
+    /** Add the packages left after addPackageTxs, which all contain contract txs, by their
+      * GasPackageScore against the remaining block size and soft block gas limit.
+      * Packages that can no longer fit are dropped without executing them. */
+    void addContractPackageTxs(const CTxMemPool& mempool, std::set<Txid>& failedTx, int& nPackagesSelected, int& nDescendantsUpdated, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
 
     /** Rebuild the coinbase/coinstake transaction to account for new gas refunds **/
     void RebuildRefundTransaction(CBlock* pblock);
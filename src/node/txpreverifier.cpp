@@ -0,0 +1,215 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txpreverifier.h>
+
+#include <coins.h>
+#include <consensus/amount.h>
+#include <consensus/tx_check.h>
+#include <consensus/validation.h>
+#include <policy/feerate.h>
+#include <policy/policy.h>
+#include <primitives/transaction.h>
+#include <script/interpreter.h>
+#include <tinyformat.h>
+#include <txmempool.h>
+#include <util/threadnames.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+
+namespace node {
+
+TxPreverifier::TxPreverifier(ChainstateManager& chainman, CTxMemPool& mempool, IsKnownFn is_known, int threads)
+    : m_chainman{chainman}, m_mempool{mempool}, m_is_known{std::move(is_known)}
+{
+    m_threads.reserve(threads);
+    for (int n = 0; n < threads; ++n) {
+        m_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("txverify.%i", n));
+            ThreadVerify();
+        });
+    }
+}
+
+TxPreverifier::~TxPreverifier()
+{
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_cv.notify_all();
+    for (std::thread& t : m_threads) {
+        t.join();
+    }
+}
+
+void TxPreverifier::Add(DataStream tx_data)
+{
+    {
+        LOCK(m_mutex);
+        if (m_queue.size() >= MAX_TX_PREVERIFY_QUEUE) return;
+        m_queue.push_back(std::move(tx_data));
+    }
+    m_cv.notify_one();
+}
+
+void TxPreverifier::VerifyQueued()
+{
+    while (true) {
+        std::vector<DataStream> batch;
+        {
+            LOCK(m_mutex);
+            if (m_queue.empty()) return;
+            while (!m_queue.empty() && batch.size() < MAX_TX_PREVERIFY_BATCH) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+        VerifyBatch(batch);
+    }
+}
+
+TxPreverifier::Stats TxPreverifier::GetStats() const
+{
+    Stats stats;
+    stats.verified = m_verified;
+    stats.invalid = m_invalid;
+    stats.filtered = m_filtered;
+    stats.known = m_known;
+    stats.missing_inputs = m_missing_inputs;
+    stats.low_fee = m_low_fee;
+    return stats;
+}
+
+void TxPreverifier::ThreadVerify()
+{
+    while (true) {
+        std::vector<DataStream> batch;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (!m_request_stop && m_queue.empty()) {
+                m_cv.wait(lock);
+            }
+            if (m_request_stop) return;
+            while (!m_queue.empty() && batch.size() < MAX_TX_PREVERIFY_BATCH) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+        VerifyBatch(batch);
+    }
+}
+
+void TxPreverifier::VerifyBatch(std::vector<DataStream>& batch)
+{
+    // Same checks as PreChecks, in the same order, which don't need the inputs
+    std::vector<CTransactionRef> txs;
+    txs.reserve(batch.size());
+    for (DataStream& tx_data : batch) {
+        CTransactionRef ptx;
+        try {
+            tx_data >> TX_WITH_WITNESS(ptx);
+        } catch (const std::exception&) {
+            // malformed, ProcessMessage deals with it
+            ++m_filtered;
+            continue;
+        }
+        const CTransaction& tx = *ptx;
+        TxValidationState state;
+        std::string reason;
+        if (!CheckTransaction(tx, state) || tx.IsCoinBase() || tx.IsCoinStake() ||
+            (m_mempool.m_require_standard && !IsStandardTx(tx, m_mempool.m_max_datacarrier_bytes, m_mempool.m_permit_bare_multisig, m_mempool.m_dust_relay_feerate, reason)) ||
+            ::GetSerializeSize(TX_NO_WITNESS(tx)) < MIN_STANDARD_TX_NONWITNESS_SIZE) {
+            ++m_filtered;
+            continue;
+        }
+        txs.push_back(std::move(ptx));
+    }
+    if (txs.empty()) return;
+
+    // Look up the spent outputs of the whole batch under one lock, skipping
+    // the transactions which are known or can't pay the mempool minimum fee
+    std::vector<std::vector<CTxOut>> spent_outputs(txs.size());
+    {
+        LOCK2(cs_main, m_mempool.cs);
+        CCoinsViewCache& tip = m_chainman.ActiveChainstate().CoinsTip();
+        CCoinsViewMemPool view{&tip, m_mempool};
+        const CFeeRate min_feerate{std::max(m_mempool.GetMinFee(), m_mempool.m_min_relay_feerate)};
+        std::vector<COutPoint> coins_to_uncache;
+        for (size_t i = 0; i < txs.size(); ++i) {
+            const CTransaction& tx = *txs[i];
+            if (m_is_known && m_is_known(tx)) {
+                ++m_known;
+                continue;
+            }
+
+            std::vector<CTxOut> outputs;
+            outputs.reserve(tx.vin.size());
+            CAmount value_in{0};
+            for (const CTxIn& txin : tx.vin) {
+                // Like mempool acceptance, don't leave the outputs read from disk in the cache
+                if (!tip.HaveCoinInCache(txin.prevout)) coins_to_uncache.push_back(txin.prevout);
+                Coin coin;
+                // Orphans are checked once their parents show up
+                if (!view.GetCoin(txin.prevout, coin)) break;
+                value_in += coin.out.nValue;
+                outputs.push_back(std::move(coin.out));
+            }
+            if (outputs.size() != tx.vin.size()) {
+                ++m_missing_inputs;
+                continue;
+            }
+
+            // The fee of contract transactions includes their gas, this is a lower bound of what acceptance requires
+            CAmount fee{value_in - tx.GetValueOut()};
+            m_mempool.ApplyDelta(tx.GetHash(), fee);
+            if (fee < min_feerate.GetFee(GetVirtualTransactionSize(tx))) {
+                ++m_low_fee;
+                continue;
+            }
+            spent_outputs[i] = std::move(outputs);
+        }
+        for (const COutPoint& outpoint : coins_to_uncache) {
+            tip.Uncache(outpoint);
+        }
+    }
+
+    for (size_t i = 0; i < txs.size(); ++i) {
+        const CTransaction& tx = *txs[i];
+        if (spent_outputs[i].size() != tx.vin.size()) continue;
+
+        // Standardness of the inputs, as in PreChecks
+        if (m_mempool.m_require_standard) {
+            CCoinsView dummy;
+            CCoinsViewCache inputs{&dummy};
+            for (size_t n = 0; n < tx.vin.size(); ++n) {
+                inputs.AddCoin(tx.vin[n].prevout, Coin{spent_outputs[i][n], /*nHeightIn=*/0, /*fCoinBaseIn=*/false, /*fCoinStakeIn=*/false}, /*possible_overwrite=*/true);
+            }
+            if (!AreInputsStandard(tx, inputs) || (tx.HasWitness() && !IsWitnessStandard(tx, inputs))) {
+                ++m_filtered;
+                continue;
+            }
+        }
+
+        // Same checks as CheckInputScripts with the flags of PolicyScriptChecks,
+        // storing the valid signatures in the signature cache
+        PrecomputedTransactionData txdata;
+        txdata.Init(tx, std::move(spent_outputs[i]));
+        bool valid{true};
+        for (unsigned int n = 0; valid && n < tx.vin.size(); n++) {
+            CScriptCheck check(txdata.m_spent_outputs[n], tx, n, STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheIn=*/true, &txdata);
+            valid = check();
+        }
+        for (unsigned int n = 0; valid && n < tx.vout.size(); n++) {
+            if (tx.vout[n].scriptPubKey.HasOpSender()) {
+                CScriptCheck check(tx, n, 0, /*cacheIn=*/true, &txdata);
+                valid = check();
+            }
+        }
+        ++(valid ? m_verified : m_invalid);
+    }
+}
+
+} // namespace node
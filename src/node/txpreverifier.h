@@ -0,0 +1,111 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_TXPREVERIFIER_H
+#define BITCOIN_NODE_TXPREVERIFIER_H
+
+#include <kernel/cs_main.h>
+#include <primitives/transaction.h>
+#include <streams.h>
+#include <sync.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+class ChainstateManager;
+class CTxMemPool;
+
+namespace node {
+
+/** Maximum number of transactions waiting to be pre-verified, more are dropped */
+static constexpr size_t MAX_TX_PREVERIFY_QUEUE{1000};
+/** Maximum number of transactions whose inputs are looked up under a single lock */
+static constexpr size_t MAX_TX_PREVERIFY_BATCH{16};
+
+/**
+ * Verifies the input scripts and signatures of relayed transactions on a
+ * pool of worker threads before they reach AcceptToMemoryPool.
+ *
+ * The scripts are only run for transactions which pass the same cheaper
+ * checks as mempool acceptance first, so that a peer can't make the node
+ * verify scripts of transactions it would refuse anyway:
+ * - the transaction checks and standardness, without any lock,
+ * - whether the transaction is already known or was recently rejected, its
+ *   spent outputs and its fee, in the chain tip and mempool under a single
+ *   lock for a batch of transactions,
+ * - the standardness of its inputs, without any lock.
+ *
+ * Valid signatures end up in the signature cache, so that the script checks
+ * which mempool acceptance still runs serially under cs_main find them there
+ * instead of verifying them again. Nothing else is kept and invalid
+ * transactions leave no trace, so acceptance results are the same with or
+ * without this.
+ */
+class TxPreverifier
+{
+public:
+    /** Whether a transaction is already known or was recently rejected, called with cs_main held */
+    using IsKnownFn = std::function<bool(const CTransaction&)>;
+
+    /** Number of transactions by outcome */
+    struct Stats {
+        //! Scripts run and valid
+        uint64_t verified{0};
+        //! Scripts run and invalid
+        uint64_t invalid{0};
+        //! Malformed, invalid or not standard, no script run
+        uint64_t filtered{0};
+        //! Already known or recently rejected, no script run
+        uint64_t known{0};
+        //! Spending unknown outputs, no script run
+        uint64_t missing_inputs{0};
+        //! Paying less than the mempool minimum fee, no script run
+        uint64_t low_fee{0};
+    };
+
+    TxPreverifier(ChainstateManager& chainman, CTxMemPool& mempool, IsKnownFn is_known, int threads);
+    ~TxPreverifier();
+
+    TxPreverifier(const TxPreverifier&) = delete;
+    TxPreverifier& operator=(const TxPreverifier&) = delete;
+
+    /** Queue the payload of a tx message, which is dropped if the queue is full. */
+    void Add(DataStream tx_data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Verify the queued transactions on the calling thread, for use without worker threads. */
+    void VerifyQueued() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex, !::cs_main);
+
+    Stats GetStats() const;
+
+private:
+    void ThreadVerify() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex, !::cs_main);
+    void VerifyBatch(std::vector<DataStream>& batch) EXCLUSIVE_LOCKS_REQUIRED(!::cs_main);
+
+    ChainstateManager& m_chainman;
+    CTxMemPool& m_mempool;
+    const IsKnownFn m_is_known;
+
+    std::atomic<uint64_t> m_verified{0};
+    std::atomic<uint64_t> m_invalid{0};
+    std::atomic<uint64_t> m_filtered{0};
+    std::atomic<uint64_t> m_known{0};
+    std::atomic<uint64_t> m_missing_inputs{0};
+    std::atomic<uint64_t> m_low_fee{0};
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<DataStream> m_queue GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_TXPREVERIFIER_H
@@ -3,14 +3,18 @@
 #include <interfaces/wallet.h>
 #include <validation.h>
 #include <qt/bitcoinunits.h>
+#include <qt/guiconstants.h>
+#include <qt/guiutil.h>
 #include <interfaces/node.h>
 #include <interfaces/handler.h>
 #include <algorithm>
+#include <map>
 
 #include <QDateTime>
 #include <QFont>
 #include <QDebug>
 #include <QThread>
+#include <QTimer>
 
 class DelegationItemEntry
 {
@@ -59,6 +63,13 @@ public:
     ~DelegationItemEntry()
     {}
 
+    bool hasSameInfo(const DelegationItemEntry &obj) const
+    {
+        return hash == obj.hash && createTime == obj.createTime && delegateAddress == obj.delegateAddress &&
+                stakerName == obj.stakerName && stakerAddress == obj.stakerAddress && fee == obj.fee &&
+                blockNumber == obj.blockNumber && createTxHash == obj.createTxHash && removeTxHash == obj.removeTxHash;
+    }
+
     uint256 hash;
     QDateTime createTime;
     QString delegateAddress;
@@ -74,25 +85,106 @@ public:
     qint32 status;
 };
 
+Q_DECLARE_METATYPE(DelegationItemEntry)
+
 class DelegationWorker : public QObject
 {
     Q_OBJECT
 public:
     WalletModel *walletModel;
     bool first;
+    //! Delegations shown by the model, only used from the worker thread once it is started
+    std::map<uint256, DelegationItemEntry> entries;
     DelegationWorker(WalletModel *_walletModel):
         walletModel(_walletModel), first(true) {}
 
 private Q_SLOTS:
-    void updateDelegationData(QString hash, QString delegateAddress, QString stakerAddress, quint8 fee, qint32 blockNumber)
+    void updateEntries(QStringList hashes)
+    {
+        for(const QString& hash : hashes)
+        {
+            updateEntry(hash);
+        }
+        Q_EMIT updateFinished();
+    }
+
+    void updateItems()
+    {
+        for(auto& item : entries)
+        {
+            updateItem(item.second);
+        }
+        Q_EMIT updateFinished();
+    }
+
+Q_SIGNALS:
+    // Signal that a delegation was added, updated or removed
+    void entryChanged(DelegationItemEntry entry, int status);
+
+    // Signal that item in changed
+    void itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint32 status);
+
+    // Signal that an update is done
+    void updateFinished();
+
+private:
+    void updateEntry(const QString &hash)
+    {
+        if(walletModel && walletModel->node().shutdownRequested())
+            return;
+
+        // Compare the delegation in the wallet with the one shown
+        uint256 updated;
+        updated.SetHex(hash.toStdString());
+        interfaces::DelegationInfo delegation = walletModel->wallet().getDelegation(updated);
+        bool inWallet = delegation.hash == updated;
+        std::map<uint256, DelegationItemEntry>::iterator it = entries.find(updated);
+
+        if(inWallet)
+        {
+            DelegationItemEntry delegationEntry(delegation);
+            if(it == entries.end())
+            {
+                it = entries.emplace(updated, delegationEntry).first;
+                Q_EMIT entryChanged(delegationEntry, CT_NEW);
+                updateItem(it->second);
+            }
+            else if(!it->second.hasSameInfo(delegationEntry))
+            {
+                // Only check the contract again when the fee or the height changed
+                bool checkContract = it->second.fee != delegationEntry.fee || it->second.blockNumber != delegationEntry.blockNumber;
+                delegationEntry.balance = it->second.balance;
+                delegationEntry.stake = it->second.stake;
+                delegationEntry.weight = it->second.weight;
+                delegationEntry.status = it->second.status;
+                it->second = delegationEntry;
+                Q_EMIT entryChanged(delegationEntry, CT_UPDATED);
+                if(checkContract)
+                {
+                    updateItem(it->second);
+                }
+            }
+        }
+        else if(it != entries.end())
+        {
+            DelegationItemEntry delegationEntry = it->second;
+            entries.erase(it);
+            Q_EMIT entryChanged(delegationEntry, CT_DELETED);
+        }
+    }
+
+    void updateItem(DelegationItemEntry& entry)
     {
         if(walletModel && walletModel->node().shutdownRequested())
             return;
 
         // Find delegation details
+        QString hash = QString::fromStdString(entry.hash.ToString());
         std::string sHash = hash.toStdString();
-        std::string sDelegateAddress = delegateAddress.toStdString();
-        std::string sStakerAddress = stakerAddress.toStdString();
+        std::string sDelegateAddress = entry.delegateAddress.toStdString();
+        std::string sStakerAddress = entry.stakerAddress.toStdString();
+        quint8 fee = entry.fee;
+        qint32 blockNumber = entry.blockNumber;
         interfaces::DelegationDetails details = walletModel->wallet().getDelegationDetails(sDelegateAddress);
 
         // Get delegation info
@@ -187,14 +279,18 @@ private Q_SLOTS:
             }
         }
 
-        std::string sAddress = delegateAddress.toStdString();
-        walletModel->wallet().getStakerAddressBalance(sAddress, balance, stake, weight);
-        Q_EMIT itemChanged(hash, balance, stake, weight, status);
-    }
+        walletModel->wallet().getStakerAddressBalance(sDelegateAddress, balance, stake, weight);
 
-Q_SIGNALS:
-    // Signal that item in changed
-    void itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint32 status);
+        // Only send the items that changed
+        if(entry.balance != balance || entry.stake != stake || entry.weight != weight || entry.status != status)
+        {
+            entry.balance = balance;
+            entry.stake = stake;
+            entry.weight = weight;
+            entry.status = status;
+            Q_EMIT itemChanged(hash, balance, stake, weight, status);
+        }
+    }
 };
 
 #include <qt/delegationitemmodel.moc>
@@ -231,10 +327,6 @@ public:
             for(interfaces::DelegationInfo delegation : wallet.getDelegations())
             {
                 DelegationItemEntry delegationItem(delegation);
-                if(parent)
-                {
-                    parent->updateDelegationData(delegationItem);
-                }
                 cachedDelegationItem.append(delegationItem);
             }
         }
@@ -261,6 +353,7 @@ public:
                 qWarning() << "DelegationItemPriv::updateEntry: Warning: Got CT_NEW, but entry is already in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginInsertRows(QModelIndex(), lowerIndex, lowerIndex);
             cachedDelegationItem.insert(lowerIndex, item);
             parent->endInsertRows();
@@ -284,6 +377,7 @@ public:
                 qWarning() << "DelegationItemPriv::updateEntry: Warning: Got CT_DELETED, but entry is not in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginRemoveRows(QModelIndex(), lowerIndex, upperIndex-1);
             cachedDelegationItem.erase(lower, upper);
             parent->endRemoveRows();
@@ -291,6 +385,23 @@ public:
         }
     }
 
+    int updateData(const uint256& hash, qint64 balance, qint64 stake, qint64 weight, qint32 status)
+    {
+        QList<DelegationItemEntry>::iterator it = std::lower_bound(
+            cachedDelegationItem.begin(), cachedDelegationItem.end(), hash, DelegationItemEntryLessThan());
+        if(it != cachedDelegationItem.end() && it->hash == hash &&
+                (it->balance != balance || it->stake != stake || it->weight != weight || it->status != status))
+        {
+            it->balance = balance;
+            it->stake = stake;
+            it->weight = weight;
+            it->status = status;
+            return it - cachedDelegationItem.begin();
+        }
+
+        return -1;
+    }
+
     int size()
     {
         return cachedDelegationItem.size();
@@ -313,19 +424,36 @@ DelegationItemModel::DelegationItemModel(WalletModel *parent):
     QAbstractItemModel(parent),
     walletModel(parent),
     priv(0),
-    worker(0)
+    worker(0),
+    notificationTimer(0),
+    pendingUpdates(0),
+    refreshRequested(false)
 {
     columns << tr("Delegate") << tr("Staker Name") << tr("Staker Address") << tr("Fee") << tr("Height") << tr("Time");
 
     priv = new DelegationItemPriv(this);
     priv->refreshDelegationItem(walletModel->wallet());
 
+    qRegisterMetaType<DelegationItemEntry>("DelegationItemEntry");
     worker = new DelegationWorker(walletModel);
+    for(const DelegationItemEntry& entry : priv->cachedDelegationItem)
+    {
+        worker->entries.emplace(entry.hash, entry);
+    }
     worker->moveToThread(&(t));
+    connect(worker, &DelegationWorker::entryChanged, this, &DelegationItemModel::entryChanged);
     connect(worker, &DelegationWorker::itemChanged, this, &DelegationItemModel::itemChanged);
+    connect(worker, &DelegationWorker::updateFinished, this, &DelegationItemModel::updateFinished);
 
     t.start();
 
+    // Get the delegations data
+    updateItems();
+
+    notificationTimer = new QTimer(this);
+    notificationTimer->setSingleShot(true);
+    connect(notificationTimer, &QTimer::timeout, this, &DelegationItemModel::processNotifications);
+
     subscribeToCoreSignals();
 }
 
@@ -449,23 +577,25 @@ QVariant DelegationItemModel::data(const QModelIndex &index, int role) const
 
 void DelegationItemModel::updateDelegationData(const QString &hash, int status, bool showDelegation)
 {
-    // Find delegation in wallet
-    uint256 updated;
-    updated.SetHex(hash.toStdString());
-    interfaces::DelegationInfo delegation =walletModel->wallet().getDelegation(updated);
-    showDelegation &= delegation.hash == updated;
+    Q_UNUSED(status);
+    Q_UNUSED(showDelegation);
 
-    DelegationItemEntry delegationEntry;
-    if(showDelegation)
-    {
-        delegationEntry = DelegationItemEntry(delegation);
-        updateDelegationData(delegationEntry);
-    }
-    else
+    // Collect the notifications, the worker updates the delegations in the wallet at every block
+    pendingNotifications.insert(hash);
+    if(!notificationTimer->isActive())
+        notificationTimer->start(NOTIFICATION_COALESCE_DELAY);
+}
+
+void DelegationItemModel::processNotifications()
+{
+    // Compare the notified delegations with the wallet in the worker, it only sends back the changes
+    QStringList hashes = pendingNotifications.values();
+    if(QMetaObject::invokeMethod(worker, "updateEntries", Qt::QueuedConnection,
+                                 Q_ARG(QStringList, hashes)))
     {
-        delegationEntry.hash = updated;
+        pendingUpdates++;
     }
-    priv->updateEntry(delegationEntry, status);
+    pendingNotifications.clear();
 }
 
 void DelegationItemModel::checkDelegationChanged()
@@ -473,17 +603,42 @@ void DelegationItemModel::checkDelegationChanged()
     if(!priv)
         return;
 
-    // Update delegation from contract
-    for(int i = 0; i < priv->cachedDelegationItem.size(); i++)
+    // Wait for the delegations of the previous blocks to be updated, and then update them once for all the new blocks
+    if(pendingUpdates > 0)
     {
-        DelegationItemEntry delegationEntry = priv->cachedDelegationItem[i];
-        updateDelegationData(delegationEntry);
+        refreshRequested = true;
+        return;
     }
+
+    // Update delegation from contract
+    updateItems();
 }
 
 void DelegationItemModel::emitDataChanged(int idx)
 {
-    Q_EMIT dataChanged(index(idx, 0, QModelIndex()), index(idx, columns.length()-1, QModelIndex()));
+    changedRows.insert(idx);
+}
+
+void DelegationItemModel::flushDataChanged()
+{
+    GUIUtil::emitRowsChanged(this, changedRows);
+    changedRows.clear();
+}
+
+void DelegationItemModel::updateFinished()
+{
+    if(pendingUpdates > 0)
+        pendingUpdates--;
+    if(pendingUpdates > 0)
+        return;
+
+    // All the delegations are updated, notify the views of the changed rows at once
+    flushDataChanged();
+    if(refreshRequested)
+    {
+        refreshRequested = false;
+        checkDelegationChanged();
+    }
 }
 
 struct DelegationNotification
@@ -527,15 +682,12 @@ void DelegationItemModel::unsubscribeFromCoreSignals()
     m_handler_delegation_changed->disconnect();
 }
 
-void DelegationItemModel::updateDelegationData(const DelegationItemEntry &entry)
+void DelegationItemModel::updateItems()
 {
-    QString hash = QString::fromStdString(entry.hash.ToString());
-    QMetaObject::invokeMethod(worker, "updateDelegationData", Qt::QueuedConnection,
-                              Q_ARG(QString, hash),
-                              Q_ARG(QString, entry.delegateAddress),
-                              Q_ARG(QString, entry.stakerAddress),
-                              Q_ARG(quint8, entry.fee),
-                              Q_ARG(qint32, entry.blockNumber));
+    if(QMetaObject::invokeMethod(worker, "updateItems", Qt::QueuedConnection))
+    {
+        pendingUpdates++;
+    }
 }
 
 QString DelegationItemModel::formatFee(const DelegationItemEntry *rec) const
@@ -543,6 +695,11 @@ QString DelegationItemModel::formatFee(const DelegationItemEntry *rec) const
     return QString("%1%").arg(rec->fee);
 }
 
+void DelegationItemModel::entryChanged(const DelegationItemEntry &entry, int status)
+{
+    priv->updateEntry(entry, status);
+}
+
 void DelegationItemModel::itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint32 status)
 {
     if(!priv)
@@ -551,19 +708,11 @@ void DelegationItemModel::itemChanged(QString hash, qint64 balance, qint64 stake
     uint256 updated;
     updated.SetHex(hash.toStdString());
 
-    // Update delegation
-    for(int i = 0; i < priv->cachedDelegationItem.size(); i++)
+    // Update delegation when its data changed
+    int index = priv->updateData(updated, balance, stake, weight, status);
+    if(index > -1)
     {
-        DelegationItemEntry delegationEntry = priv->cachedDelegationItem[i];
-        if(delegationEntry.hash == updated)
-        {
-            delegationEntry.balance = balance;
-            delegationEntry.stake = stake;
-            delegationEntry.weight = weight;
-            delegationEntry.status = status;
-            priv->cachedDelegationItem[i] = delegationEntry;
-            priv->updateEntry(delegationEntry, CT_UPDATED);
-        }
+        emitDataChanged(index);
     }
 }
 
@@ -2,11 +2,13 @@
 #define DELEGATIONITEMMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
 #include <QStringList>
 #include <QThread>
 #include <QtGlobal>
 
 #include <memory>
+#include <set>
 
 namespace interfaces {
 class Handler;
@@ -17,6 +19,10 @@ class DelegationItemPriv;
 class DelegationWorker;
 class DelegationItemEntry;
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 class DelegationItemModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -70,7 +76,6 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     /*@}*/
     
-    void updateDelegationData(const DelegationItemEntry& entry);
     void join();
 
 public Q_SLOTS:
@@ -79,10 +84,17 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void updateDelegationData(const QString &hash, int status, bool showDelegation);
+    void processNotifications();
+    void updateFinished();
 
 private:
-    /** Notify listeners that data changed. */
+    /** Notify listeners that data changed, once the pending updates are done. */
     void emitDataChanged(int index);
+    void flushDataChanged();
+    /** Apply a delegation added, updated or removed, as found by the worker. */
+    void entryChanged(const DelegationItemEntry& entry, int status);
+    /** Get the data of all the delegations in the worker, only the changed ones are sent back. */
+    void updateItems();
     void subscribeToCoreSignals();
     void unsubscribeFromCoreSignals();
     QString formatFee(const DelegationItemEntry *rec) const;
@@ -93,6 +105,15 @@ private:
     DelegationWorker* worker;
     QThread t;
     std::unique_ptr<interfaces::Handler> m_handler_delegation_changed;
+    //! Rows changed since the views were last notified
+    std::set<int> changedRows;
+    //! Delegations notified by the wallet, updated together after a short delay
+    QSet<QString> pendingNotifications;
+    QTimer *notificationTimer;
+    //! Updates sent to the worker and not done yet
+    int pendingUpdates;
+    //! Whether a new block came while delegations were still being updated
+    bool refreshRequested;
 
     friend class DelegationItemPriv;
 };
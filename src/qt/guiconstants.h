@@ -13,6 +13,9 @@ using namespace std::chrono_literals;
 /* A delay between model updates */
 static constexpr auto MODEL_UPDATE_DELAY{2000ms};
 
+/* A delay during which the wallet notifications of a list model are collected */
+static constexpr auto NOTIFICATION_COALESCE_DELAY{250ms};
+
 /* A delay between shutdown pollings */
 static constexpr auto SHUTDOWN_POLLING_DELAY{200ms};
 
@@ -38,6 +38,7 @@
 #endif
 
 #include <QAbstractButton>
+#include <QAbstractItemModel>
 #include <QAbstractItemView>
 #include <QApplication>
 #include <QClipboard>
@@ -1174,4 +1175,19 @@ int estimateNumberHeadersLeft(qint64 timeSpan, int bestHeaderHeight)
 
     return est_headers_left;
 }
+
+void emitRowsChanged(QAbstractItemModel* model, const std::set<int>& rows)
+{
+    const int lastColumn = model->columnCount() - 1;
+    for(auto it = rows.begin(); it != rows.end();)
+    {
+        int first = *it;
+        int last = first;
+        for(++it; it != rows.end() && *it == last + 1; ++it)
+        {
+            last = *it;
+        }
+        Q_EMIT model->dataChanged(model->index(first, 0), model->index(last, lastColumn));
+    }
+}
 } // namespace GUIUtil
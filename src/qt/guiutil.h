@@ -26,6 +26,7 @@
 
 #include <cassert>
 #include <chrono>
+#include <set>
 #include <utility>
 
 class PlatformStyle;
@@ -39,6 +40,7 @@ namespace interfaces
 
 QT_BEGIN_NAMESPACE
 class QAbstractButton;
+class QAbstractItemModel;
 class QAbstractItemView;
 class QAction;
 class QDateTime;
@@ -501,6 +503,13 @@ namespace GUIUtil
      */
     int estimateNumberHeadersLeft(qint64 timeSpan, int bestHeaderHeight);
 
+    /**
+     * @brief emitRowsChanged Notify the views that rows of a list model changed, once for each range of consecutive rows
+     * @param model List model
+     * @param rows Changed rows
+     */
+    void emitRowsChanged(QAbstractItemModel* model, const std::set<int>& rows);
+
 
 } // namespace GUIUtil
 
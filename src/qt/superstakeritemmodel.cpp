@@ -3,15 +3,19 @@
 #include <interfaces/wallet.h>
 #include <validation.h>
 #include <qt/bitcoinunits.h>
+#include <qt/guiconstants.h>
+#include <qt/guiutil.h>
 #include <interfaces/node.h>
 #include <interfaces/handler.h>
 #include <wallet/wallet.h>
 #include <algorithm>
+#include <map>
 
 #include <QDateTime>
 #include <QFont>
 #include <QDebug>
 #include <QThread>
+#include <QTimer>
 
 class SuperStakerItemEntry
 {
@@ -55,6 +59,12 @@ public:
     ~SuperStakerItemEntry()
     {}
 
+    bool hasSameInfo(const SuperStakerItemEntry &obj) const
+    {
+        return hash == obj.hash && stakerName == obj.stakerName && stakerAddress == obj.stakerAddress &&
+                minFee == obj.minFee && createTime == obj.createTime;
+    }
+
     uint256 hash;
     QString stakerName;
     QString stakerAddress;
@@ -67,17 +77,91 @@ public:
     QDateTime createTime;
 };
 
+Q_DECLARE_METATYPE(SuperStakerItemEntry)
+
 class SuperStakerWorker : public QObject
 {
     Q_OBJECT
 public:
     WalletModel *walletModel;
     bool first;
+    //! Super stakers shown by the model, only used from the worker thread once it is started
+    std::map<uint256, SuperStakerItemEntry> entries;
     SuperStakerWorker(WalletModel *_walletModel):
         walletModel(_walletModel), first(true) {}
 
 private Q_SLOTS:
-    void updateSuperStakerData(QString hash, QString stakerAddress)
+    void updateEntries(QStringList hashes)
+    {
+        for(const QString& hash : hashes)
+        {
+            updateEntry(hash);
+        }
+        Q_EMIT updateFinished();
+    }
+
+    void updateItems()
+    {
+        for(auto& item : entries)
+        {
+            updateItem(item.second);
+        }
+        Q_EMIT updateFinished();
+    }
+
+Q_SIGNALS:
+    // Signal that a super staker was added, updated or removed
+    void entryChanged(SuperStakerItemEntry entry, int status);
+
+    // Signal that item in changed
+    void itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint64 delegationsWeight, bool staking);
+
+    // Signal that an update is done
+    void updateFinished();
+
+private:
+    void updateEntry(const QString &hash)
+    {
+        if(walletModel && walletModel->node().shutdownRequested())
+            return;
+
+        // Compare the super staker in the wallet with the one shown
+        uint256 updated;
+        updated.SetHex(hash.toStdString());
+        interfaces::SuperStakerInfo superStaker = walletModel->wallet().getSuperStaker(updated);
+        bool inWallet = superStaker.hash == updated;
+        std::map<uint256, SuperStakerItemEntry>::iterator it = entries.find(updated);
+
+        if(inWallet)
+        {
+            SuperStakerItemEntry superStakerEntry(superStaker);
+            if(it == entries.end())
+            {
+                it = entries.emplace(updated, superStakerEntry).first;
+                Q_EMIT entryChanged(superStakerEntry, CT_NEW);
+                updateItem(it->second);
+            }
+            else if(!it->second.hasSameInfo(superStakerEntry))
+            {
+                // The staker address is part of the hash, the staker data stays the same
+                superStakerEntry.balance = it->second.balance;
+                superStakerEntry.stake = it->second.stake;
+                superStakerEntry.weight = it->second.weight;
+                superStakerEntry.delegationsWeight = it->second.delegationsWeight;
+                superStakerEntry.staking = it->second.staking;
+                it->second = superStakerEntry;
+                Q_EMIT entryChanged(superStakerEntry, CT_UPDATED);
+            }
+        }
+        else if(it != entries.end())
+        {
+            SuperStakerItemEntry superStakerEntry = it->second;
+            entries.erase(it);
+            Q_EMIT entryChanged(superStakerEntry, CT_DELETED);
+        }
+    }
+
+    void updateItem(SuperStakerItemEntry& entry)
     {
         if(walletModel && walletModel->node().shutdownRequested())
             return;
@@ -88,17 +172,22 @@ private Q_SLOTS:
         CAmount stake = 0;
         CAmount weight = 0;
         CAmount delegationsWeight = 0;
-        std::string sAddress = stakerAddress.toStdString();
-        uint256 id;
-        id.SetHex(hash.toStdString());
-        staking = walletModel->wallet().isSuperStakerStaking(id, delegationsWeight);
+        std::string sAddress = entry.stakerAddress.toStdString();
+        staking = walletModel->wallet().isSuperStakerStaking(entry.hash, delegationsWeight);
         walletModel->wallet().getStakerAddressBalance(sAddress, balance, stake, weight);
-        Q_EMIT itemChanged(hash, balance, stake, weight, delegationsWeight, staking);
-    }
 
-Q_SIGNALS:
-    // Signal that item in changed
-    void itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint64 delegationsWeight, bool staking);
+        // Only send the items that changed
+        if(entry.balance != balance || entry.stake != stake || entry.weight != weight ||
+                entry.delegationsWeight != delegationsWeight || entry.staking != staking)
+        {
+            entry.balance = balance;
+            entry.stake = stake;
+            entry.weight = weight;
+            entry.delegationsWeight = delegationsWeight;
+            entry.staking = staking;
+            Q_EMIT itemChanged(QString::fromStdString(entry.hash.ToString()), balance, stake, weight, delegationsWeight, staking);
+        }
+    }
 };
 
 #include <qt/superstakeritemmodel.moc>
@@ -135,10 +224,6 @@ public:
             for(interfaces::SuperStakerInfo superStaker : wallet.getSuperStakers())
             {
                 SuperStakerItemEntry superStakerItem(superStaker);
-                if(parent)
-                {
-                    parent->updateSuperStakerData(superStakerItem);
-                }
                 cachedSuperStakerItem.append(superStakerItem);
             }
         }
@@ -165,6 +250,7 @@ public:
                 qWarning() << "SuperStakerItemPriv::updateEntry: Warning: Got CT_NEW, but entry is already in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginInsertRows(QModelIndex(), lowerIndex, lowerIndex);
             cachedSuperStakerItem.insert(lowerIndex, item);
             parent->endInsertRows();
@@ -189,6 +275,7 @@ public:
                 qWarning() << "SuperStakerItemPriv::updateEntry: Warning: Got CT_DELETED, but entry is not in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginRemoveRows(QModelIndex(), lowerIndex, upperIndex-1);
             cachedSuperStakerItem.erase(lower, upper);
             parent->endRemoveRows();
@@ -196,6 +283,25 @@ public:
         }
     }
 
+    int updateData(const uint256& hash, qint64 balance, qint64 stake, qint64 weight, qint64 delegationsWeight, bool staking)
+    {
+        QList<SuperStakerItemEntry>::iterator it = std::lower_bound(
+            cachedSuperStakerItem.begin(), cachedSuperStakerItem.end(), hash, SuperStakerItemEntryLessThan());
+        if(it != cachedSuperStakerItem.end() && it->hash == hash &&
+                (it->balance != balance || it->stake != stake || it->weight != weight ||
+                 it->delegationsWeight != delegationsWeight || it->staking != staking))
+        {
+            it->balance = balance;
+            it->stake = stake;
+            it->weight = weight;
+            it->delegationsWeight = delegationsWeight;
+            it->staking = staking;
+            return it - cachedSuperStakerItem.begin();
+        }
+
+        return -1;
+    }
+
     int size()
     {
         return cachedSuperStakerItem.size();
@@ -218,19 +324,36 @@ SuperStakerItemModel::SuperStakerItemModel(WalletModel *parent):
     QAbstractItemModel(parent),
     walletModel(parent),
     priv(0),
-    worker(0)
+    worker(0),
+    notificationTimer(0),
+    pendingUpdates(0),
+    refreshRequested(false)
 {
     columns << tr("Staker Name") << tr("Staker Address") << tr("Minimum Fee") << tr("Staking");
 
     priv = new SuperStakerItemPriv(this);
     priv->refreshSuperStakerItem(walletModel->wallet());
 
+    qRegisterMetaType<SuperStakerItemEntry>("SuperStakerItemEntry");
     worker = new SuperStakerWorker(walletModel);
+    for(const SuperStakerItemEntry& entry : priv->cachedSuperStakerItem)
+    {
+        worker->entries.emplace(entry.hash, entry);
+    }
     worker->moveToThread(&(t));
+    connect(worker, &SuperStakerWorker::entryChanged, this, &SuperStakerItemModel::entryChanged);
     connect(worker, &SuperStakerWorker::itemChanged, this, &SuperStakerItemModel::itemChanged);
+    connect(worker, &SuperStakerWorker::updateFinished, this, &SuperStakerItemModel::updateFinished);
 
     t.start();
 
+    // Get the super stakers data
+    updateItems();
+
+    notificationTimer = new QTimer(this);
+    notificationTimer->setSingleShot(true);
+    connect(notificationTimer, &QTimer::timeout, this, &SuperStakerItemModel::processNotifications);
+
     subscribeToCoreSignals();
 }
 
@@ -346,23 +469,25 @@ QVariant SuperStakerItemModel::data(const QModelIndex &index, int role) const
 
 void SuperStakerItemModel::updateSuperStakerData(const QString &hash, int status, bool showSuperStaker)
 {
-    // Find superStaker in wallet
-    uint256 updated;
-    updated.SetHex(hash.toStdString());
-    interfaces::SuperStakerInfo superStaker =walletModel->wallet().getSuperStaker(updated);
-    showSuperStaker &= superStaker.hash == updated;
+    Q_UNUSED(status);
+    Q_UNUSED(showSuperStaker);
 
-    SuperStakerItemEntry superStakerEntry;
-    if(showSuperStaker)
-    {
-        superStakerEntry = SuperStakerItemEntry(superStaker);
-        updateSuperStakerData(superStakerEntry);
-    }
-    else
+    // Collect the notifications, the worker updates the super stakers in the wallet at every block
+    pendingNotifications.insert(hash);
+    if(!notificationTimer->isActive())
+        notificationTimer->start(NOTIFICATION_COALESCE_DELAY);
+}
+
+void SuperStakerItemModel::processNotifications()
+{
+    // Compare the notified super stakers with the wallet in the worker, it only sends back the changes
+    QStringList hashes = pendingNotifications.values();
+    if(QMetaObject::invokeMethod(worker, "updateEntries", Qt::QueuedConnection,
+                                 Q_ARG(QStringList, hashes)))
     {
-        superStakerEntry.hash = updated;
+        pendingUpdates++;
     }
-    priv->updateEntry(superStakerEntry, status);
+    pendingNotifications.clear();
 }
 
 void SuperStakerItemModel::checkSuperStakerChanged()
@@ -370,17 +495,42 @@ void SuperStakerItemModel::checkSuperStakerChanged()
     if(!priv)
         return;
 
-    // Update superStaker from contract
-    for(int i = 0; i < priv->cachedSuperStakerItem.size(); i++)
+    // Wait for the super stakers of the previous blocks to be updated, and then update them once for all the new blocks
+    if(pendingUpdates > 0)
     {
-        SuperStakerItemEntry superStakerEntry = priv->cachedSuperStakerItem[i];
-        updateSuperStakerData(superStakerEntry);
+        refreshRequested = true;
+        return;
     }
+
+    // Update superStaker from contract
+    updateItems();
 }
 
 void SuperStakerItemModel::emitDataChanged(int idx)
 {
-    Q_EMIT dataChanged(index(idx, 0, QModelIndex()), index(idx, columns.length()-1, QModelIndex()));
+    changedRows.insert(idx);
+}
+
+void SuperStakerItemModel::flushDataChanged()
+{
+    GUIUtil::emitRowsChanged(this, changedRows);
+    changedRows.clear();
+}
+
+void SuperStakerItemModel::updateFinished()
+{
+    if(pendingUpdates > 0)
+        pendingUpdates--;
+    if(pendingUpdates > 0)
+        return;
+
+    // All the super stakers are updated, notify the views of the changed rows at once
+    flushDataChanged();
+    if(refreshRequested)
+    {
+        refreshRequested = false;
+        checkSuperStakerChanged();
+    }
 }
 
 struct SuperStakerNotification
@@ -424,12 +574,12 @@ void SuperStakerItemModel::unsubscribeFromCoreSignals()
     m_handler_superstaker_changed->disconnect();
 }
 
-void SuperStakerItemModel::updateSuperStakerData(const SuperStakerItemEntry &entry)
+void SuperStakerItemModel::updateItems()
 {
-    QString hash = QString::fromStdString(entry.hash.ToString());
-    QMetaObject::invokeMethod(worker, "updateSuperStakerData", Qt::QueuedConnection,
-                              Q_ARG(QString, hash),
-                              Q_ARG(QString, entry.stakerAddress));
+    if(QMetaObject::invokeMethod(worker, "updateItems", Qt::QueuedConnection))
+    {
+        pendingUpdates++;
+    }
 }
 
 QString SuperStakerItemModel::formatMinFee(const SuperStakerItemEntry *rec) const
@@ -437,6 +587,11 @@ QString SuperStakerItemModel::formatMinFee(const SuperStakerItemEntry *rec) cons
     return QString("%1%").arg(rec->minFee);
 }
 
+void SuperStakerItemModel::entryChanged(const SuperStakerItemEntry &entry, int status)
+{
+    priv->updateEntry(entry, status);
+}
+
 void SuperStakerItemModel::itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint64 delegationsWeight, bool staking)
 {
     if(!priv)
@@ -445,20 +600,11 @@ void SuperStakerItemModel::itemChanged(QString hash, qint64 balance, qint64 stak
     uint256 updated;
     updated.SetHex(hash.toStdString());
 
-    // Update delegation
-    for(int i = 0; i < priv->cachedSuperStakerItem.size(); i++)
+    // Update super staker when its data changed
+    int index = priv->updateData(updated, balance, stake, weight, delegationsWeight, staking);
+    if(index > -1)
     {
-        SuperStakerItemEntry superStakerEntry = priv->cachedSuperStakerItem[i];
-        if(superStakerEntry.hash == updated)
-        {
-            superStakerEntry.balance = balance;
-            superStakerEntry.stake = stake;
-            superStakerEntry.weight = weight;
-            superStakerEntry.delegationsWeight = delegationsWeight;
-            superStakerEntry.staking = staking;
-            priv->cachedSuperStakerItem[i] = superStakerEntry;
-            priv->updateEntry(superStakerEntry, CT_UPDATED);
-        }
+        emitDataChanged(index);
     }
 }
 
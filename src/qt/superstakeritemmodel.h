@@ -2,10 +2,12 @@
 #define SUPERSTAKERITEMMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
 #include <QStringList>
 #include <QThread>
 
 #include <memory>
+#include <set>
 
 namespace interfaces {
 class Handler;
@@ -16,6 +18,10 @@ class SuperStakerItemPriv;
 class SuperStakerWorker;
 class SuperStakerItemEntry;
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 class SuperStakerItemModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -56,7 +62,6 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     /*@}*/
     
-    void updateSuperStakerData(const SuperStakerItemEntry& entry);
     void join();
 
 public Q_SLOTS:
@@ -65,10 +70,17 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void updateSuperStakerData(const QString &hash, int status, bool showSuperStaker);
+    void processNotifications();
+    void updateFinished();
 
 private:
-    /** Notify listeners that data changed. */
+    /** Notify listeners that data changed, once the pending updates are done. */
     void emitDataChanged(int index);
+    void flushDataChanged();
+    /** Apply a super staker added, updated or removed, as found by the worker. */
+    void entryChanged(const SuperStakerItemEntry& entry, int status);
+    /** Get the data of all the super stakers in the worker, only the changed ones are sent back. */
+    void updateItems();
     void subscribeToCoreSignals();
     void unsubscribeFromCoreSignals();
     QString formatMinFee(const SuperStakerItemEntry *rec) const;
@@ -79,6 +91,15 @@ private:
     SuperStakerWorker* worker;
     QThread t;
     std::unique_ptr<interfaces::Handler> m_handler_superstaker_changed;
+    //! Rows changed since the views were last notified
+    std::set<int> changedRows;
+    //! Super stakers notified by the wallet, updated together after a short delay
+    QSet<QString> pendingNotifications;
+    QTimer *notificationTimer;
+    //! Updates sent to the worker and not done yet
+    int pendingUpdates;
+    //! Whether a new block came while super stakers were still being updated
+    bool refreshRequested;
 
     friend class SuperStakerItemPriv;
 };
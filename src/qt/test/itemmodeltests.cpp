@@ -0,0 +1,190 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/test/itemmodeltests.h>
+#include <test/util/setup_common.h>
+
+#include <interfaces/chain.h>
+#include <interfaces/node.h>
+#include <interfaces/wallet.h>
+#include <qt/clientmodel.h>
+#include <qt/delegationitemmodel.h>
+#include <qt/optionsmodel.h>
+#include <qt/platformstyle.h>
+#include <qt/superstakeritemmodel.h>
+#include <qt/tokenitemmodel.h>
+#include <qt/walletmodel.h>
+
+#include <key.h>
+#include <key_io.h>
+#include <wallet/wallet.h>
+#include <wallet/test/util.h>
+
+#include <functional>
+
+#include <QAbstractItemModel>
+#include <QApplication>
+#include <QSignalSpy>
+
+using wallet::AddWallet;
+using wallet::CWallet;
+using wallet::CreateMockableWalletDatabase;
+using wallet::RemoveWallet;
+using wallet::WALLET_FLAG_DESCRIPTORS;
+using wallet::WalletContext;
+
+namespace
+{
+
+std::string NewAddress()
+{
+    CKey key = GenerateRandomKey();
+    return EncodeDestination(PKHash(key.GetPubKey()));
+}
+
+/**
+ * Add an entry to the wallet, update it and remove it, and check the signals of the model.
+ *
+ * The model is updated from a worker thread after the wallet notifications, so wait for
+ * each change to show up. Only the row of the entry is inserted, changed and removed.
+ */
+void CheckRowSignals(QAbstractItemModel& model, int role, const QVariant& updated_value,
+                     const std::function<void()>& add, const std::function<void()>& update, const std::function<void()>& remove)
+{
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+    QCOMPARE(model.rowCount(), 0);
+
+    // Add the entry
+    add();
+    QTRY_COMPARE(model.rowCount(), 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 0);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 0);
+
+    // Update the entry, the row changes in place
+    changed.clear();
+    update();
+    QTRY_COMPARE(model.index(0, 0).data(role), updated_value);
+    QTRY_VERIFY(changed.count() > 0);
+    for (const QList<QVariant>& args : changed) {
+        QCOMPARE(args.at(0).toModelIndex().row(), 0);
+        QCOMPARE(args.at(1).toModelIndex().row(), 0);
+    }
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(removed.count(), 0);
+
+    // Remove the entry
+    remove();
+    QTRY_COMPARE(model.rowCount(), 0);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(1).toInt(), 0);
+    QCOMPARE(removed.at(0).at(2).toInt(), 0);
+    QCOMPARE(inserted.count(), 1);
+}
+
+void TestTokenItemModel(WalletModel& walletModel)
+{
+    TokenItemModel& model = *walletModel.getTokenItemModel();
+    interfaces::TokenInfo token;
+    token.contract_address = "6b8bf98ff497c064e8f0bde13e0c4f5ed5bf8ce7";
+    token.sender_address = NewAddress();
+    token.token_name = "Test Token";
+    token.token_symbol = "TTK";
+    token.decimals = 8;
+
+    CheckRowSignals(model, TokenItemModel::NameRole, QString("Renamed Token"),
+        [&] { QVERIFY(walletModel.wallet().addTokenEntry(token)); },
+        [&] {
+            token.token_name = "Renamed Token";
+            QVERIFY(walletModel.wallet().addTokenEntry(token));
+        },
+        [&] { QVERIFY(walletModel.wallet().removeTokenEntry(model.index(0, 0).data(TokenItemModel::HashRole).toString().toStdString())); });
+}
+
+void TestDelegationItemModel(WalletModel& walletModel)
+{
+    DelegationItemModel& model = *walletModel.getDelegationItemModel();
+    interfaces::DelegationInfo delegation;
+    delegation.delegate_address = NewAddress();
+    delegation.staker_address = NewAddress();
+    delegation.staker_name = "Staker";
+    delegation.fee = 10;
+
+    CheckRowSignals(model, DelegationItemModel::FeeRole, QVariant(20),
+        [&] { QVERIFY(walletModel.wallet().addDelegationEntry(delegation)); },
+        [&] {
+            delegation.fee = 20;
+            QVERIFY(walletModel.wallet().addDelegationEntry(delegation));
+        },
+        [&] { QVERIFY(walletModel.wallet().removeDelegationEntry(model.index(0, 0).data(DelegationItemModel::HashRole).toString().toStdString())); });
+}
+
+void TestSuperStakerItemModel(WalletModel& walletModel)
+{
+    SuperStakerItemModel& model = *walletModel.getSuperStakerItemModel();
+    interfaces::SuperStakerInfo superStaker;
+    superStaker.staker_address = NewAddress();
+    superStaker.staker_name = "Super Staker";
+    superStaker.custom_config = true;
+    superStaker.min_fee = 5;
+
+    CheckRowSignals(model, SuperStakerItemModel::MinFeeRole, QVariant(15),
+        [&] { QVERIFY(walletModel.wallet().addSuperStakerEntry(superStaker)); },
+        [&] {
+            superStaker.min_fee = 15;
+            QVERIFY(walletModel.wallet().addSuperStakerEntry(superStaker));
+        },
+        [&] { QVERIFY(walletModel.wallet().removeSuperStakerEntry(model.index(0, 0).data(SuperStakerItemModel::HashRole).toString().toStdString())); });
+}
+
+void TestItemModels(interfaces::Node& node)
+{
+    TestChain100Setup test;
+    auto wallet_loader = interfaces::MakeWalletLoader(*test.m_node.chain, *Assert(test.m_node.args));
+    test.m_node.wallet_loader = wallet_loader.get();
+    node.setContext(&test.m_node);
+    const std::shared_ptr<CWallet> wallet = std::make_shared<CWallet>(node.context()->chain.get(), "", CreateMockableWalletDatabase());
+    wallet->LoadWallet();
+    wallet->SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+    {
+        LOCK(wallet->cs_wallet);
+        wallet->SetupDescriptorScriptPubKeyMans();
+    }
+
+    // Initialize relevant QT models.
+    std::unique_ptr<const PlatformStyle> platformStyle(PlatformStyle::instantiate("other"));
+    OptionsModel optionsModel(node);
+    bilingual_str error;
+    QVERIFY(optionsModel.Init(error));
+    ClientModel clientModel(node, &optionsModel);
+    WalletContext& context = *node.walletLoader().context();
+    AddWallet(context, wallet);
+    WalletModel walletModel(interfaces::MakeWallet(context, wallet), clientModel, platformStyle.get());
+    RemoveWallet(context, wallet, /* load_on_start= */ std::nullopt);
+
+    TestTokenItemModel(walletModel);
+    TestDelegationItemModel(walletModel);
+    TestSuperStakerItemModel(walletModel);
+}
+
+} // namespace
+
+void ItemModelTests::itemModelTests()
+{
+#ifdef Q_OS_MACOS
+    if (QApplication::platformName() == "minimal") {
+        // Disable for mac on "minimal" platform to avoid crashes inside the Qt
+        // framework when it tries to look up unimplemented cocoa functions,
+        // and fails to handle returned nulls
+        // (https://bugreports.qt.io/browse/QTBUG-49686).
+        QWARN("Skipping ItemModelTests on mac build with 'minimal' platform set due to Qt bugs. To run AppTests, invoke "
+              "with 'QT_QPA_PLATFORM=cocoa test_qtum-qt' on mac, or else use a linux or windows build.");
+        return;
+    }
+#endif
+    TestItemModels(m_node);
+}
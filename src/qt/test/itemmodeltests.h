@@ -0,0 +1,27 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_QT_TEST_ITEMMODELTESTS_H
+#define BITCOIN_QT_TEST_ITEMMODELTESTS_H
+
+#include <QObject>
+#include <QTest>
+
+namespace interfaces {
+class Node;
+} // namespace interfaces
+
+class ItemModelTests : public QObject
+{
+public:
+    explicit ItemModelTests(interfaces::Node& node) : m_node(node) {}
+    interfaces::Node& m_node;
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void itemModelTests();
+};
+
+#endif // BITCOIN_QT_TEST_ITEMMODELTESTS_H
@@ -4,16 +4,24 @@
 #include <interfaces/wallet.h>
 #include <validation.h>
 #include <qt/bitcoinunits.h>
+#include <qt/guiconstants.h>
+#include <qt/guiutil.h>
 #include <interfaces/node.h>
 #include <interfaces/handler.h>
 #include <algorithm>
+#include <map>
 #include <consensus/consensus.h>
 #include <chainparams.h>
+#include <util/convert.h>
 
 #include <QDateTime>
 #include <QFont>
 #include <QDebug>
 #include <QThread>
+#include <QTimer>
+
+/** Number of blocks after which the token transactions are searched again in the event logs */
+static const int TOKEN_TX_SEARCH_INTERVAL = 100;
 
 class TokenItemEntry
 {
@@ -47,6 +55,13 @@ public:
     ~TokenItemEntry()
     {}
 
+    bool hasSameInfo(const TokenItemEntry &obj) const
+    {
+        return hash == obj.hash && createTime == obj.createTime && contractAddress == obj.contractAddress &&
+                tokenName == obj.tokenName && tokenSymbol == obj.tokenSymbol && decimals == obj.decimals &&
+                senderAddress == obj.senderAddress;
+    }
+
     uint256 hash;
     QDateTime createTime;
     QString contractAddress;
@@ -57,6 +72,8 @@ public:
     int256_t balance;
 };
 
+Q_DECLARE_METATYPE(TokenItemEntry)
+
 class TokenTxWorker : public QObject
 {
     Q_OBJECT
@@ -64,10 +81,94 @@ public:
     WalletModel *walletModel;
     bool first;
     Token tokenAbi;
+    //! Tokens shown by the model, only used from the worker thread once it is started
+    std::map<uint256, TokenItemEntry> entries;
     TokenTxWorker(WalletModel *_walletModel):
         walletModel(_walletModel), first(true) {}
 
 private Q_SLOTS:
+    void updateEntries(QStringList hashes)
+    {
+        for(const QString& hash : hashes)
+        {
+            updateEntry(hash);
+        }
+        Q_EMIT updateFinished();
+    }
+
+    void updateBalances(bool tracked)
+    {
+        for(auto& item : entries)
+        {
+            updateTokenBalance(item.second, tracked);
+        }
+        Q_EMIT updateFinished();
+    }
+
+    void updateTokenTxEntries()
+    {
+        for(const auto& item : entries)
+        {
+            updateTokenTx(QString::fromStdString(item.first.ToString()));
+        }
+    }
+
+    void cleanTokenTxEntries()
+    {
+        if(walletModel && walletModel->node().shutdownRequested())
+            return;
+
+        if(walletModel) walletModel->wallet().cleanTokenTxEntries();
+    }
+
+Q_SIGNALS:
+    // Signal that a token was added, updated or removed
+    void entryChanged(TokenItemEntry entry, int status);
+
+    // Signal that balance in token changed
+    void balanceChanged(QString hash, QString balance);
+
+    // Signal that an update is done
+    void updateFinished();
+
+private:
+    void updateEntry(const QString &hash)
+    {
+        if(walletModel && walletModel->node().shutdownRequested())
+            return;
+
+        // Compare the token in the wallet with the one shown
+        uint256 updated;
+        updated.SetHex(hash.toStdString());
+        interfaces::TokenInfo token = walletModel->wallet().getToken(updated);
+        bool inWallet = token.hash == updated;
+        std::map<uint256, TokenItemEntry>::iterator it = entries.find(updated);
+
+        if(inWallet)
+        {
+            TokenItemEntry tokenEntry(token);
+            if(it == entries.end())
+            {
+                it = entries.emplace(updated, tokenEntry).first;
+                Q_EMIT entryChanged(tokenEntry, CT_NEW);
+                updateTokenBalance(it->second, false);
+            }
+            else if(!it->second.hasSameInfo(tokenEntry))
+            {
+                // The token holder is part of the hash, the balance stays the same
+                tokenEntry.balance = it->second.balance;
+                it->second = tokenEntry;
+                Q_EMIT entryChanged(tokenEntry, CT_UPDATED);
+            }
+        }
+        else if(it != entries.end())
+        {
+            TokenItemEntry tokenEntry = it->second;
+            entries.erase(it);
+            Q_EMIT entryChanged(tokenEntry, CT_DELETED);
+        }
+    }
+
     void updateTokenTx(const QString &hash)
     {
         if(walletModel && walletModel->node().shutdownRequested())
@@ -145,32 +246,44 @@ private Q_SLOTS:
         }
     }
 
-    void cleanTokenTxEntries()
+    void updateTokenBalance(TokenItemEntry& entry, bool tracked)
     {
         if(walletModel && walletModel->node().shutdownRequested())
             return;
 
-        if(walletModel) walletModel->wallet().cleanTokenTxEntries();
-    }
+        // Use the balance tracked by the wallet from the event logs when there is one
+        std::string strBalance;
+        uint256 trackedBalance;
+        bool fromLogs = tracked && walletModel->wallet().getTokenBalance(entry.hash, trackedBalance);
+        int height = walletModel->node().getNumBlocks();
+        if(fromLogs)
+        {
+            strBalance = uintTou256(trackedBalance).str();
+        }
+        else
+        {
+            tokenAbi.setAddress(entry.contractAddress.toStdString());
+            tokenAbi.setSender(entry.senderAddress.toStdString());
+            if(!tokenAbi.balanceOf(strBalance))
+                return;
 
-    void updateBalance(QString hash, QString contractAddress, QString senderAddress)
-    {
-        if(walletModel && walletModel->node().shutdownRequested())
-            return;
+            // Let the wallet track the balance from here on, unless the tip moved during the call
+            if(fLogEvents && !strBalance.empty() && height == walletModel->node().getNumBlocks())
+            {
+                walletModel->wallet().setTokenBalance(entry.hash, u256Touint(dev::u256(strBalance)), height);
+            }
+        }
 
-        tokenAbi.setAddress(contractAddress.toStdString());
-        tokenAbi.setSender(senderAddress.toStdString());
-        std::string strBalance;
-        if(tokenAbi.balanceOf(strBalance))
+        // Only send the balances that changed
+        if(strBalance.empty())
+            return;
+        int256_t balance(strBalance);
+        if(balance != entry.balance)
         {
-            QString balance = QString::fromStdString(strBalance);
-            Q_EMIT balanceChanged(hash, balance);
+            entry.balance = balance;
+            Q_EMIT balanceChanged(QString::fromStdString(entry.hash.ToString()), QString::fromStdString(strBalance));
         }
     }
-
-Q_SIGNALS:
-    // Signal that balance in token changed
-    void balanceChanged(QString hash, QString balance);
 };
 
 #include <qt/tokenitemmodel.moc>
@@ -207,32 +320,23 @@ public:
             for(interfaces::TokenInfo token : wallet.getTokens())
             {
                 TokenItemEntry tokenItem(token);
-                if(parent)
-                {
-                    parent->updateBalance(tokenItem);
-                }
                 cachedTokenItem.append(tokenItem);
             }
         }
         std::sort(cachedTokenItem.begin(), cachedTokenItem.end(), TokenItemEntryLessThan());
     }
 
-    void updateEntry(const TokenItemEntry &_item, int status)
+    void updateEntry(const TokenItemEntry &item, int status)
     {
-        // Find address / label in model
-        TokenItemEntry item;
+        // Find token in model
         QList<TokenItemEntry>::iterator lower = std::lower_bound(
-            cachedTokenItem.begin(), cachedTokenItem.end(), _item, TokenItemEntryLessThan());
+            cachedTokenItem.begin(), cachedTokenItem.end(), item, TokenItemEntryLessThan());
         QList<TokenItemEntry>::iterator upper = std::upper_bound(
-            cachedTokenItem.begin(), cachedTokenItem.end(), _item, TokenItemEntryLessThan());
+            cachedTokenItem.begin(), cachedTokenItem.end(), item, TokenItemEntryLessThan());
         int lowerIndex = (lower - cachedTokenItem.begin());
         int upperIndex = (upper - cachedTokenItem.begin());
         bool inModel = (lower != upper);
-        item = _item;
-        if(inModel)
-        {
-            item.balance = cachedTokenItem[lowerIndex].balance;
-        }
+        TokenItemEntry _item = item;
 
         switch(status)
         {
@@ -242,6 +346,7 @@ public:
                 qWarning() << "TokenItemPriv::updateEntry: Warning: Got CT_NEW, but entry is already in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginInsertRows(QModelIndex(), lowerIndex, lowerIndex);
             cachedTokenItem.insert(lowerIndex, item);
             parent->endInsertRows();
@@ -252,7 +357,8 @@ public:
                 qWarning() << "TokenItemPriv::updateEntry: Warning: Got CT_UPDATED, but entry is not in model";
                 break;
             }
-            cachedTokenItem[lowerIndex] = item;
+            _item.balance = cachedTokenItem[lowerIndex].balance;
+            cachedTokenItem[lowerIndex] = _item;
             parent->emitDataChanged(lowerIndex);
             break;
         case CT_DELETED:
@@ -261,6 +367,7 @@ public:
                 qWarning() << "TokenItemPriv::updateEntry: Warning: Got CT_DELETED, but entry is not in model";
                 break;
             }
+            parent->flushDataChanged();
             parent->beginRemoveRows(QModelIndex(), lowerIndex, upperIndex-1);
             cachedTokenItem.erase(lower, upper);
             parent->endRemoveRows();
@@ -274,15 +381,12 @@ public:
         updated.SetHex(hash.toStdString());
         int256_t val(balance.toStdString());
 
-        for(int i = 0; i < cachedTokenItem.size(); i++)
+        QList<TokenItemEntry>::iterator it = std::lower_bound(
+            cachedTokenItem.begin(), cachedTokenItem.end(), updated, TokenItemEntryLessThan());
+        if(it != cachedTokenItem.end() && it->hash == updated && it->balance != val)
         {
-            TokenItemEntry item = cachedTokenItem[i];
-            if(item.hash == updated && item.balance != val)
-            {
-                item.balance = val;
-                cachedTokenItem[i] = item;
-                return i;
-            }
+            it->balance = val;
+            return it - cachedTokenItem.begin();
         }
 
         return -1;
@@ -311,20 +415,38 @@ TokenItemModel::TokenItemModel(WalletModel *parent):
     walletModel(parent),
     priv(0),
     worker(0),
-    tokenTxCleaned(false)
+    tokenTxCleaned(false),
+    reconcileHeight(-1),
+    notificationTimer(0),
+    pendingUpdates(0),
+    refreshRequested(false)
 {
     columns << tr("Token Name") << tr("Token Symbol") << tr("Balance");
 
     priv = new TokenItemPriv(this);
     priv->refreshTokenItem(walletModel->wallet());
 
+    qRegisterMetaType<TokenItemEntry>("TokenItemEntry");
     worker = new TokenTxWorker(walletModel);
     worker->tokenAbi.setModel(walletModel);
+    for(const TokenItemEntry& entry : priv->cachedTokenItem)
+    {
+        worker->entries.emplace(entry.hash, entry);
+    }
     worker->moveToThread(&(t));
+    connect(worker, &TokenTxWorker::entryChanged, this, &TokenItemModel::entryChanged);
     connect(worker, &TokenTxWorker::balanceChanged, this, &TokenItemModel::balanceChanged);
+    connect(worker, &TokenTxWorker::updateFinished, this, &TokenItemModel::updateFinished);
 
     t.start();
 
+    // Get the balances
+    updateBalances(false);
+
+    notificationTimer = new QTimer(this);
+    notificationTimer->setSingleShot(true);
+    connect(notificationTimer, &QTimer::timeout, this, &TokenItemModel::processNotifications);
+
     subscribeToCoreSignals();
 }
 
@@ -424,23 +546,25 @@ QVariant TokenItemModel::data(const QModelIndex &index, int role) const
 
 void TokenItemModel::updateToken(const QString &hash, int status, bool showToken)
 {
-    // Find token in wallet
-    uint256 updated;
-    updated.SetHex(hash.toStdString());
-    interfaces::TokenInfo token =walletModel->wallet().getToken(updated);
-    showToken &= token.hash == updated;
-
-    TokenItemEntry tokenEntry;
-    if(showToken)
-    {
-        tokenEntry = TokenItemEntry(token);
-        updateBalance(tokenEntry);
-    }
-    else
+    Q_UNUSED(status);
+    Q_UNUSED(showToken);
+
+    // Collect the notifications, the wallet notifies each token it updates at every block
+    pendingNotifications.insert(hash);
+    if(!notificationTimer->isActive())
+        notificationTimer->start(NOTIFICATION_COALESCE_DELAY);
+}
+
+void TokenItemModel::processNotifications()
+{
+    // Compare the notified tokens with the wallet in the worker, it only sends back the changes
+    QStringList hashes = pendingNotifications.values();
+    if(QMetaObject::invokeMethod(worker, "updateEntries", Qt::QueuedConnection,
+                                 Q_ARG(QStringList, hashes)))
     {
-        tokenEntry.hash = updated;
+        pendingUpdates++;
     }
-    priv->updateEntry(tokenEntry, status);
+    pendingNotifications.clear();
 }
 
 void TokenItemModel::checkTokenBalanceChanged()
@@ -448,24 +572,30 @@ void TokenItemModel::checkTokenBalanceChanged()
     if(!priv)
         return;
 
-    // Update token balance
-    for(int i = 0; i < priv->cachedTokenItem.size(); i++)
+    // Wait for the balances of the previous blocks to be updated, and then update them once for all the new blocks
+    if(pendingUpdates > 0)
     {
-        TokenItemEntry tokenEntry = priv->cachedTokenItem[i];
-        updateBalance(tokenEntry);
+        refreshRequested = true;
+        return;
     }
 
+    // The wallet tracks the token balances and transactions from the event logs,
+    // the event logs are only searched at first and then from time to time to check them
+    int numBlocks = walletModel->node().getNumBlocks();
+    bool reconcile = !fLogEvents || reconcileHeight < 0 || numBlocks < reconcileHeight ||
+            numBlocks - reconcileHeight >= TOKEN_TX_SEARCH_INTERVAL;
+    if(reconcile)
+        reconcileHeight = numBlocks;
+
+    // Update token balance in the worker, from the balance tracked by the wallet when it has one,
+    // the wallet asks for a contract call when the balance is due for a check
+    updateBalances(fLogEvents);
+
     // Update token transactions
-    if(fLogEvents)
+    if(fLogEvents && reconcile)
     {
         // Search for token transactions
-        for(int i = 0; i < priv->cachedTokenItem.size(); i++)
-        {
-            TokenItemEntry tokenEntry = priv->cachedTokenItem[i];
-            QString hash = QString::fromStdString(tokenEntry.hash.ToString());
-            QMetaObject::invokeMethod(worker, "updateTokenTx", Qt::QueuedConnection,
-                                      Q_ARG(QString, hash));
-        }
+        QMetaObject::invokeMethod(worker, "updateTokenTxEntries", Qt::QueuedConnection);
 
         // Clean token transactions
         if(!tokenTxCleaned)
@@ -478,7 +608,29 @@ void TokenItemModel::checkTokenBalanceChanged()
 
 void TokenItemModel::emitDataChanged(int idx)
 {
-    Q_EMIT dataChanged(index(idx, 0, QModelIndex()), index(idx, columns.length()-1, QModelIndex()));
+    changedRows.insert(idx);
+}
+
+void TokenItemModel::flushDataChanged()
+{
+    GUIUtil::emitRowsChanged(this, changedRows);
+    changedRows.clear();
+}
+
+void TokenItemModel::updateFinished()
+{
+    if(pendingUpdates > 0)
+        pendingUpdates--;
+    if(pendingUpdates > 0)
+        return;
+
+    // All the balances are updated, notify the views of the changed rows at once
+    flushDataChanged();
+    if(refreshRequested)
+    {
+        refreshRequested = false;
+        checkTokenBalanceChanged();
+    }
 }
 
 struct TokenNotification
@@ -522,6 +674,11 @@ void TokenItemModel::unsubscribeFromCoreSignals()
     m_handler_token_changed->disconnect();
 }
 
+void TokenItemModel::entryChanged(const TokenItemEntry &entry, int status)
+{
+    priv->updateEntry(entry, status);
+}
+
 void TokenItemModel::balanceChanged(QString hash, QString balance)
 {
     int index = priv->updateBalance(hash, balance);
@@ -531,11 +688,13 @@ void TokenItemModel::balanceChanged(QString hash, QString balance)
     }
 }
 
-void TokenItemModel::updateBalance(const TokenItemEntry &entry)
+void TokenItemModel::updateBalances(bool tracked)
 {
-    QString hash = QString::fromStdString(entry.hash.ToString());
-    QMetaObject::invokeMethod(worker, "updateBalance", Qt::QueuedConnection,
-                              Q_ARG(QString, hash), Q_ARG(QString, entry.contractAddress), Q_ARG(QString, entry.senderAddress));
+    if(QMetaObject::invokeMethod(worker, "updateBalances", Qt::QueuedConnection,
+                                 Q_ARG(bool, tracked)))
+    {
+        pendingUpdates++;
+    }
 }
 
 void TokenItemModel::join()
@@ -2,10 +2,12 @@
 #define TOKENITEMMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
 #include <QStringList>
 #include <QThread>
 
 #include <memory>
+#include <set>
 
 namespace interfaces {
 class Handler;
@@ -17,6 +19,10 @@ class TokenItemPriv;
 class TokenTxWorker;
 class TokenItemEntry;
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 class TokenItemModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -51,7 +57,6 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     /*@}*/
     
-    void updateBalance(const TokenItemEntry& entry);
     void join();
 
 public Q_SLOTS:
@@ -60,10 +65,17 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void updateToken(const QString &hash, int status, bool showToken);
+    void processNotifications();
+    void updateFinished();
 
 private:
-    /** Notify listeners that data changed. */
+    /** Notify listeners that data changed, once the pending updates are done. */
     void emitDataChanged(int index);
+    void flushDataChanged();
+    /** Apply a token added, updated or removed, as found by the worker. */
+    void entryChanged(const TokenItemEntry& entry, int status);
+    /** Get the balances of all the tokens in the worker, only the changed ones are sent back. */
+    void updateBalances(bool tracked);
     void subscribeToCoreSignals();
     void unsubscribeFromCoreSignals();
 
@@ -75,6 +87,16 @@ private:
     QThread t;
     std::unique_ptr<interfaces::Handler> m_handler_token_changed;
     bool tokenTxCleaned;
+    int reconcileHeight;
+    //! Rows changed since the views were last notified
+    std::set<int> changedRows;
+    //! Tokens notified by the wallet, updated together after a short delay
+    QSet<QString> pendingNotifications;
+    QTimer *notificationTimer;
+    //! Updates sent to the worker and not done yet
+    int pendingUpdates;
+    //! Whether a new block came while balances were still being updated
+    bool refreshRequested;
 
     friend class TokenItemPriv;
 };
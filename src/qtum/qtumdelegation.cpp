@@ -319,6 +319,11 @@ bool QtumDelegation::FilterDelegationEvents(std::vector<DelegationEvent> &events
     return true;
 }
 
+bool QtumDelegation::GetDelegationEvent(const dev::eth::LogEntry &log, DelegationEvent &event) const
+{
+    return priv->GetDelegationEvent(log, event);
+}
+
 std::map<uint160, Delegation> QtumDelegation::DelegationsFromEvents(const std::vector<DelegationEvent> &events)
 {
     std::map<uint160, Delegation> delegations;
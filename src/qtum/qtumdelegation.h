@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <stdint.h>
 #include <uint256.h>
 #include <qtum/posutils.h>
@@ -11,6 +12,11 @@ class QtumDelegationPriv;
 class ContractABI;
 class ChainstateManager;
 class Chainstate;
+namespace dev {
+namespace eth {
+struct LogEntry;
+}
+}
 
 extern const std::string strDelegationsABI;
 const ContractABI &DelegationABI();
@@ -53,6 +59,20 @@ class IDelegationFilter
 {
 public:
     virtual bool Match(const DelegationEvent& event) const = 0;
+
+    /**
+     * @brief GetStakers List the stakers whose delegations can match the filter
+     * @param stakers List of stakers
+     * @return false when the delegations to any staker can match
+     */
+    virtual bool GetStakers(std::set<uint160>& stakers) const { return false; }
+
+    /**
+     * @brief GetDelegates List the delegates whose delegation can match the filter
+     * @param delegates List of delegates
+     * @return false when the delegation of any delegate can match
+     */
+    virtual bool GetDelegates(std::set<uint160>& delegates) const { return false; }
 };
 
 /**
@@ -99,6 +119,14 @@ public:
      */
     bool FilterDelegationEvents(std::vector<DelegationEvent>& events, const IDelegationFilter& filter, ChainstateManager &chainman, int fromBlock = 0, int toBlock = -1, int minconf = 0) const;
 
+    /**
+     * @brief GetDelegationEvent Parse a delegation event from a contract log
+     * @param log Log entry of a contract receipt
+     * @param event Output delegation event
+     * @return true if the log is a delegation contract event, false otherwise
+     */
+    bool GetDelegationEvent(const dev::eth::LogEntry& log, DelegationEvent& event) const;
+
     /**
      * @brief DelegationsFromEvents Get the delegations from the events
      * @param events Delegation event list
@@ -0,0 +1,225 @@
+#include <qtum/qtumsnapshot.h>
+#include <libdevcore/Address.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libethereum/SecureTrieDB.h>
+#include <logging.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <span.h>
+#include <util/convert.h>
+
+#include <exception>
+#include <optional>
+
+namespace {
+
+enum SnapshotRecord : uint8_t {
+    SNAPSHOT_END = 0,
+    SNAPSHOT_ACCOUNT = 1,
+    SNAPSHOT_STORAGE = 2,
+    SNAPSHOT_UTXO = 3,
+};
+
+//! Records between commits of the rebuilt tries to the databases
+constexpr uint64_t SNAPSHOT_COMMIT_INTERVAL{10000};
+
+template <unsigned N>
+void WriteHash(AutoFile& file, dev::FixedHash<N> const& hash)
+{
+    file.write(AsBytes(Span{hash.data(), N}));
+}
+
+template <unsigned N>
+void ReadHash(AutoFile& file, dev::FixedHash<N>& hash)
+{
+    file.read(AsWritableBytes(Span{hash.data(), N}));
+}
+
+void WriteBytes(AutoFile& file, Span<const uint8_t> data)
+{
+    WriteCompactSize(file, data.size());
+    file.write(AsBytes(data));
+}
+
+Span<const uint8_t> ToSpan(dev::bytesConstRef data)
+{
+    return {data.data(), data.size()};
+}
+
+//! An account whose storage is still being read
+struct PendingAccount
+{
+    dev::Address address;
+    dev::bytes rlp;
+    dev::h256 storage_root;
+};
+
+} // namespace
+
+ContractStateSnapshotStats WriteContractStateSnapshot(AutoFile& file,
+                                                      dev::OverlayDB state_db, const uint256& state_root,
+                                                      dev::OverlayDB utxo_db, const uint256& utxo_root,
+                                                      const std::function<void()>& interruption_point)
+{
+    ContractStateSnapshotStats stats;
+    file << COutPoint{};
+
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> state(&state_db, uintToh256(state_root));
+    for (auto const& account : state) {
+        if (stats.accounts++ % 1000 == 0) interruption_point();
+
+        dev::RLP rlp(account.second);
+        dev::h256 const storage_root = rlp[2].toHash<dev::h256>();
+        dev::h256 const code_hash = rlp[3].toHash<dev::h256>();
+        std::string const code = code_hash == dev::EmptySHA3 ? std::string() : state_db.lookup(code_hash);
+
+        file << uint8_t{SNAPSHOT_ACCOUNT};
+        WriteHash(file, account.first);
+        WriteBytes(file, ToSpan(account.second));
+        WriteBytes(file, MakeUCharSpan(code));
+
+        dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storage(&state_db, storage_root);
+        for (auto const& entry : storage) {
+            if (++stats.storage_entries % 10000 == 0) interruption_point();
+            file << uint8_t{SNAPSHOT_STORAGE};
+            WriteHash(file, entry.first);
+            WriteBytes(file, ToSpan(entry.second));
+        }
+    }
+    file << uint8_t{SNAPSHOT_END};
+
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> utxo(&utxo_db, uintToh256(utxo_root));
+    for (auto const& entry : utxo) {
+        if (stats.utxo_entries++ % 10000 == 0) interruption_point();
+        file << uint8_t{SNAPSHOT_UTXO};
+        WriteHash(file, entry.first);
+        WriteBytes(file, ToSpan(entry.second));
+    }
+    file << uint8_t{SNAPSHOT_END};
+
+    return stats;
+}
+
+bool LoadContractStateSnapshot(AutoFile& file,
+                               dev::OverlayDB state_db, const uint256& state_root,
+                               dev::OverlayDB utxo_db, const uint256& utxo_root,
+                               const std::function<bool()>& interrupted)
+{
+    ContractStateSnapshotStats stats;
+    try {
+        COutPoint marker;
+        file >> marker;
+        if (!marker.IsNull()) {
+            LogPrintf("[snapshot] bad contract state - no contract state after the coins\n");
+            return false;
+        }
+
+        dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> state(&state_db);
+        state.init();
+        dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storage(&state_db);
+        std::optional<PendingAccount> pending;
+
+        // Insert an account once its storage trie is complete
+        auto finish_account = [&]() -> bool {
+            if (!pending) return true;
+            if (storage.root() != pending->storage_root) {
+                LogPrintf("[snapshot] bad contract state - storage root mismatch for account %s\n", pending->address.hex());
+                return false;
+            }
+            state.insert(pending->address, pending->rlp);
+            pending.reset();
+            return true;
+        };
+
+        uint64_t records{0};
+        while (true) {
+            if (++records % SNAPSHOT_COMMIT_INTERVAL == 0) {
+                if (interrupted()) return false;
+                state_db.commit();
+            }
+
+            uint8_t type;
+            file >> type;
+            if (type == SNAPSHOT_END) break;
+
+            if (type == SNAPSHOT_ACCOUNT) {
+                if (!finish_account()) return false;
+                PendingAccount account;
+                dev::bytes code;
+                ReadHash(file, account.address);
+                file >> account.rlp >> code;
+
+                dev::RLP rlp(account.rlp);
+                if (!rlp.isList() || (rlp.itemCount() != 4 && rlp.itemCount() != 5)) {
+                    LogPrintf("[snapshot] bad contract state - malformed account %s\n", account.address.hex());
+                    return false;
+                }
+                account.storage_root = rlp[2].toHash<dev::h256>(dev::RLP::VeryStrict);
+                dev::h256 const code_hash = rlp[3].toHash<dev::h256>(dev::RLP::VeryStrict);
+                if (dev::sha3(code) != code_hash) {
+                    LogPrintf("[snapshot] bad contract state - code hash mismatch for account %s\n", account.address.hex());
+                    return false;
+                }
+                if (!code.empty()) {
+                    state_db.insert(code_hash, &code);
+                }
+                storage.init();
+                pending = std::move(account);
+                ++stats.accounts;
+            } else if (type == SNAPSHOT_STORAGE && pending) {
+                dev::h256 key;
+                dev::bytes value;
+                ReadHash(file, key);
+                file >> value;
+                storage.insert(key, value);
+                ++stats.storage_entries;
+            } else {
+                LogPrintf("[snapshot] bad contract state - unexpected record type %d\n", int{type});
+                return false;
+            }
+        }
+        if (!finish_account()) return false;
+        if (state.root() != uintToh256(state_root)) {
+            LogPrintf("[snapshot] bad contract state - state root %s does not match base block %s\n", state.root().hex(), state_root.ToString());
+            return false;
+        }
+
+        dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> utxo(&utxo_db);
+        utxo.init();
+        while (true) {
+            if (++records % SNAPSHOT_COMMIT_INTERVAL == 0) {
+                if (interrupted()) return false;
+                utxo_db.commit();
+            }
+
+            uint8_t type;
+            file >> type;
+            if (type == SNAPSHOT_END) break;
+            if (type != SNAPSHOT_UTXO) {
+                LogPrintf("[snapshot] bad contract state - unexpected record type %d\n", int{type});
+                return false;
+            }
+            dev::Address address;
+            dev::bytes value;
+            ReadHash(file, address);
+            file >> value;
+            utxo.insert(address, value);
+            ++stats.utxo_entries;
+        }
+        if (utxo.root() != uintToh256(utxo_root)) {
+            LogPrintf("[snapshot] bad contract state - UTXO root %s does not match base block %s\n", utxo.root().hex(), utxo_root.ToString());
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("[snapshot] bad contract state - %s\n", e.what());
+        return false;
+    }
+
+    state_db.commit();
+    utxo_db.commit();
+
+    LogPrintf("[snapshot] loaded contract state: %d accounts, %d storage entries, %d UTXO trie entries\n",
+              stats.accounts, stats.storage_entries, stats.utxo_entries);
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <libdevcore/OverlayDB.h>
+#include <streams.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * Contract state section of a UTXO snapshot, written after the coins.
+ *
+ * It starts with a null outpoint, which no coin has. A snapshot claiming
+ * more coins than it holds then stops at the contract state, and one
+ * claiming fewer finds a coin where the contract state should start.
+ *
+ * It holds every account of the state trie with its code and storage, and
+ * every entry of the UTXO trie, as of the snapshot base block. DGP parameters
+ * and delegations are contract storage, so they are included as well.
+ *
+ * The tries are rebuilt from these entries when the snapshot is loaded and
+ * only accepted if their roots match hashStateRoot and hashUTXORoot of the
+ * base block header.
+ */
+struct ContractStateSnapshotStats
+{
+    uint64_t accounts{0};
+    uint64_t storage_entries{0};
+    uint64_t utxo_entries{0};
+};
+
+/** Write the contract state at the given roots, calling interruption_point periodically. */
+ContractStateSnapshotStats WriteContractStateSnapshot(AutoFile& file,
+                                                      dev::OverlayDB state_db, const uint256& state_root,
+                                                      dev::OverlayDB utxo_db, const uint256& utxo_root,
+                                                      const std::function<void()>& interruption_point);
+
+/**
+ * Read the contract state section into the given databases and check it
+ * against the expected roots. The tries are content addressed, so the nodes
+ * added here don't affect any other state stored in the same databases.
+ * Returns false if the section is malformed, incomplete or interrupted.
+ */
+bool LoadContractStateSnapshot(AutoFile& file,
+                               dev::OverlayDB state_db, const uint256& state_root,
+                               dev::OverlayDB utxo_db, const uint256& utxo_root,
+                               const std::function<bool()>& interrupted);
@@ -584,6 +584,36 @@ bool QtumToken::burnEvents(std::vector<TokenEvent> &tokenEvents, int64_t fromBlo
     return execEvents(fromBlock, toBlock, minconf, d->evtBurn, tokenEvents);
 }
 
+bool QtumToken::parseEvent(const std::string &contractAddress, const std::vector<std::string> &topics, const std::string &data, TokenEvent &tokenEvent)
+{
+    // Match the log with the transfer or burn event
+    for(int func : {d->evtTransfer, d->evtBurn})
+    {
+        if(func == -1) continue;
+        const FunctionABI& function = d->ABI->functions[func];
+        size_t numTopics = function.numIndexed() + 1;
+        if(topics.size() < numTopics) continue;
+        if(topics[0] != function.selector()) continue;
+
+        // Fill the event, the block and transaction are known to the caller
+        tokenEvent.address = contractAddress;
+        if(numTopics > 1)
+        {
+            tokenEvent.sender = topics[1].substr(24);
+            ToQtumAddress(tokenEvent.sender, tokenEvent.sender);
+        }
+        if(numTopics > 2)
+        {
+            tokenEvent.receiver = topics[2].substr(24);
+            ToQtumAddress(tokenEvent.receiver, tokenEvent.receiver);
+        }
+        tokenEvent.value = ToUint256(data);
+        return true;
+    }
+
+    return false;
+}
+
 bool QtumToken::exec(const std::vector<std::string> &input, int func, std::vector<std::string> &output, bool sendTo)
 {
     // Convert the input data into hex encoded binary data
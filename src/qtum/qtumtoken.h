@@ -85,6 +85,7 @@ public:
     // ABI Events
     bool transferEvents(std::vector<TokenEvent>& tokenEvents, int64_t fromBlock = 0, int64_t toBlock = -1, int64_t minconf = 0);
     bool burnEvents(std::vector<TokenEvent>& tokenEvents, int64_t fromBlock = 0, int64_t toBlock = -1, int64_t minconf = 0);
+    bool parseEvent(const std::string& contractAddress, const std::vector<std::string>& topics, const std::string& data, TokenEvent& tokenEvent);
 
     // Static functions
     static bool ToHash160(const std::string& strQtumAddress, std::string& strHash160);
@@ -1,6 +1,8 @@
 #include <qtum/storageresults.h>
 #include <util/convert.h>
 #include <logging.h>
+#include <span.h>
+#include <streams.h>
 
 StorageResults::StorageResults(std::string const& _path){
 	path = _path + "/resultsDB";
@@ -42,15 +44,17 @@ void StorageResults::wipeResults(){
 
 void StorageResults::deleteResults(std::vector<CTransactionRef> const& txs){
 
+    leveldb::WriteBatch batch;
     for(CTransactionRef tx : txs){
         dev::h256 hashTx = uintToh256(tx->GetHash());
         m_cache_result.erase(hashTx);
 
         std::string keyTemp = hashTx.hex();
 	    leveldb::Slice key(keyTemp);
-        leveldb::Status status = db->Delete(leveldb::WriteOptions(), key);
-        assert(status.ok());
+        batch.Delete(key);
     }
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
 }
 
 std::vector<TransactionReceiptInfo> StorageResults::getResult(dev::h256 const& hashTx){
@@ -68,6 +72,9 @@ std::vector<TransactionReceiptInfo> StorageResults::getResult(dev::h256 const& h
 void StorageResults::commitResults(){
     if(m_cache_result.size()){
 
+        // Write the receipts of the whole block at once
+        leveldb::WriteBatch batch;
+
         for (auto const& i: m_cache_result){
             std::string valueTemp;
             std::string keyTemp = i.first.hex();
@@ -104,14 +111,24 @@ void StorageResults::commitResults(){
                 dev::bytes data = streamRLP.out();
                 std::string stringData(data.begin(), data.end());
                 leveldb::Slice value(stringData);
-                status = db->Put(leveldb::WriteOptions(), key, value);
-                assert(status.ok());
+                batch.Put(key, value);
             }
         }
+        leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+        assert(status.ok());
         m_cache_result.clear();
     }
 }
 
+void StorageResults::syncResults(){
+    // An empty synchronous write flushes the log holding all earlier writes
+    leveldb::WriteOptions options;
+    options.sync = true;
+    leveldb::WriteBatch batch;
+    leveldb::Status status = db->Write(options, &batch);
+    assert(status.ok());
+}
+
 bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result){
 
     std::string value;
@@ -188,3 +205,36 @@ dev::eth::LogEntries StorageResults::logEntriesDeserialize(logEntriesSerialize c
 	}
 	return result;
 }
+
+template <unsigned N>
+static void WriteHash(DataStream& stream, const dev::FixedHash<N>& hash)
+{
+    stream.write(AsBytes(Span{hash.data(), N}));
+}
+
+void SerializeReceipt(DataStream& stream, const TransactionReceiptInfo& receipt)
+{
+    stream << receipt.blockHash << receipt.blockNumber << receipt.transactionHash << receipt.transactionIndex << receipt.outputIndex;
+    WriteHash(stream, receipt.from);
+    WriteHash(stream, receipt.to);
+    stream << receipt.cumulativeGasUsed << receipt.gasUsed;
+    WriteHash(stream, receipt.contractAddress);
+    stream << static_cast<uint32_t>(receipt.excepted) << receipt.exceptedMessage;
+    WriteHash(stream, receipt.bloom);
+    WriteHash(stream, receipt.stateRoot);
+    WriteHash(stream, receipt.utxoRoot);
+    WriteCompactSize(stream, receipt.logs.size());
+    for (const dev::eth::LogEntry& log : receipt.logs) {
+        SerializeLogEntry(stream, log);
+    }
+}
+
+void SerializeLogEntry(DataStream& stream, const dev::eth::LogEntry& log)
+{
+    WriteHash(stream, log.address);
+    WriteCompactSize(stream, log.topics.size());
+    for (const dev::h256& topic : log.topics) {
+        WriteHash(stream, topic);
+    }
+    stream << log.data;
+}
@@ -1,10 +1,15 @@
+#pragma once
+
 #include <uint256.h>
 #include <primitives/transaction.h>
 #include <libethereum/State.h>
 #include <libethereum/Transaction.h>
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 #include <common/system.h>
 
+class DataStream;
+
 using logEntriesSerialize = std::vector<std::pair<dev::Address, std::pair<dev::h256s, dev::bytes>>>;
 
 struct TransactionReceiptInfo{
@@ -60,6 +65,8 @@ public:
 
 	void commitResults();
 
+	void syncResults();
+
     void clearCacheResult();
 
     void wipeResults();
@@ -78,3 +85,14 @@ private:
 
 	std::unordered_map<dev::h256, std::vector<TransactionReceiptInfo>> m_cache_result;
 };
+
+/**
+ * Binary form of a receipt for the REST and ZMQ interfaces, with the fields
+ * in the order of the JSON of gettransactionreceipt: hashes and addresses as
+ * raw bytes, integers little endian, the message with a CompactSize length
+ * and the logs last, each as written by SerializeLogEntry.
+ */
+void SerializeReceipt(DataStream& stream, const TransactionReceiptInfo& receipt);
+
+/** Binary form of a log: the address, a CompactSize count of topics, the topics and the data with a CompactSize length. */
+void SerializeLogEntry(DataStream& stream, const dev::eth::LogEntry& log);
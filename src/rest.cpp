@@ -16,11 +16,14 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <key_io.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <qtum/qtumstate.h>
 #include <rpc/blockchain.h>
+#include <rpc/contract_util.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
@@ -34,6 +37,10 @@
 #include <validation.h>
 
 #include <any>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
 #include <string>
 
 #include <univalue.h>
@@ -1001,6 +1008,254 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+//! Blocks that can be searched for logs with a single request
+static constexpr int MAX_REST_LOGS_BLOCKS = 10000;
+
+/**
+ * Reply in the requested format, with the binary data written by write_bin
+ * (also hex encoded for .hex) or the JSON built by to_json.
+ */
+static bool RESTReply(HTTPRequest* req, RESTResponseFormat rf,
+                      const std::function<void(DataStream&)>& write_bin,
+                      const std::function<UniValue()>& to_json)
+{
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        DataStream ss{};
+        write_bin(ss);
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ss.str());
+        return true;
+    }
+    case RESTResponseFormat::HEX: {
+        DataStream ss{};
+        write_bin(ss);
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, HexStr(ss) + "\n");
+        return true;
+    }
+    case RESTResponseFormat::JSON: {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, to_json().write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool RESTReplyReceipts(HTTPRequest* req, RESTResponseFormat rf, const std::vector<TransactionReceiptInfo>& receipts)
+{
+    return RESTReply(
+        req, rf,
+        [&](DataStream& ss) {
+            WriteCompactSize(ss, receipts.size());
+            for (const TransactionReceiptInfo& receipt : receipts) {
+                SerializeReceipt(ss, receipt);
+            }
+        },
+        [&] {
+            UniValue result(UniValue::VARR);
+            for (const TransactionReceiptInfo& receipt : receipts) {
+                UniValue tri(UniValue::VOBJ);
+                transactionReceiptInfoToJSON(receipt, tri);
+                result.push_back(tri);
+            }
+            return result;
+        });
+}
+
+static bool rest_receipt(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string hash_str;
+    const RESTResponseFormat rf = ParseDataFormat(hash_str, str_uri_part);
+
+    uint256 hash;
+    if (!ParseHashStr(hash_str, hash)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hash_str);
+    }
+    if (!fLogEvents) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Events indexing disabled");
+    }
+
+    const std::vector<TransactionReceiptInfo> receipts{WITH_LOCK(cs_main, return pstorageresult->getResult(uintToh256(hash)))};
+    return RESTReplyReceipts(req, rf, receipts);
+}
+
+static bool rest_logs(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    const std::vector<std::string> path = SplitString(param, '/');
+    if (path.size() != 2) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/logs/<FROM>/<TO>.<ext>?address=<ADDRESS>,...&minconf=<MINCONF>");
+    }
+    const auto from{ToIntegral<int>(path[0])};
+    const auto to{ToIntegral<int>(path[1])};
+    if (!from || !to || *from < 0 || *to < *from || *to - *from >= MAX_REST_LOGS_BLOCKS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Invalid block range, at most %d blocks can be searched: %s", MAX_REST_LOGS_BLOCKS, SanitizeString(param)));
+    }
+
+    std::set<dev::h160> addresses;
+    std::optional<int> minconf;
+    try {
+        for (const std::string& address : SplitString(req->GetQueryParameter("address").value_or(""), ',')) {
+            if (address.empty()) continue;
+            if (address.size() != 40 || !IsHex(address)) {
+                return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address));
+            }
+            addresses.insert(dev::h160(address));
+        }
+        minconf = ToIntegral<int>(req->GetQueryParameter("minconf").value_or("0"));
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    if (!minconf || *minconf < 0) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid minconf");
+    }
+    if (!fLogEvents) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Events indexing disabled");
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    std::vector<TransactionReceiptInfo> receipts;
+    try {
+        receipts = SearchLogReceipts(*from, *to, *minconf, addresses, /*topics=*/{}, *maybe_chainman);
+    } catch (const UniValue& error) {
+        return RESTERR(req, HTTP_BAD_REQUEST, error.find_value("message").get_str());
+    }
+    return RESTReplyReceipts(req, rf, receipts);
+}
+
+static bool rest_address(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    const std::vector<std::string> path = SplitString(param, '/');
+    if (path.size() != 2 || path[1] != "deltas") {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/address/<ADDRESS>/deltas.<ext>?start=<HEIGHT>&end=<HEIGHT>");
+    }
+    uint256 hash_bytes;
+    int type{0};
+    if (!DecodeIndexKey(path[0], hash_bytes, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(path[0]));
+    }
+
+    std::optional<std::string> raw_start, raw_end;
+    try {
+        raw_start = req->GetQueryParameter("start");
+        raw_end = req->GetQueryParameter("end");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    int start{0}, end{0};
+    if (raw_start || raw_end) {
+        const auto parsed_start{ToIntegral<int>(raw_start.value_or(""))};
+        const auto parsed_end{ToIntegral<int>(raw_end.value_or(""))};
+        if (!parsed_start || !parsed_end || *parsed_start <= 0 || *parsed_end < *parsed_start) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid block range, start and end are needed with 0 < start <= end");
+        }
+        start = *parsed_start;
+        end = *parsed_end;
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    std::vector<std::pair<CAddressIndexKey, CAmount>> address_index;
+    if (!GetAddressIndex(hash_bytes, type, address_index, maybe_chainman->m_blockman, start, end)) {
+        return RESTERR(req, HTTP_NOT_FOUND, "No information available for address");
+    }
+
+    return RESTReply(
+        req, rf,
+        [&](DataStream& ss) {
+            WriteCompactSize(ss, address_index.size());
+            for (const auto& [key, amount] : address_index) {
+                ss << key.txhash << key.index << key.txindex << key.blockHeight << key.spending << amount;
+            }
+        },
+        [&] {
+            UniValue deltas(UniValue::VARR);
+            for (const auto& [key, amount] : address_index) {
+                UniValue delta(UniValue::VOBJ);
+                delta.pushKV("satoshis", amount);
+                delta.pushKV("txid", key.txhash.GetHex());
+                delta.pushKV("index", (int)key.index);
+                delta.pushKV("blockindex", (int)key.txindex);
+                delta.pushKV("height", key.blockHeight);
+                delta.pushKV("address", path[0]);
+                deltas.push_back(delta);
+            }
+            return deltas;
+        });
+}
+
+static bool rest_storage(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string address_str;
+    const RESTResponseFormat rf = ParseDataFormat(address_str, str_uri_part);
+
+    if (address_str.size() != 40 || !IsHex(address_str)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address_str));
+    }
+    std::optional<std::string> raw_height;
+    try {
+        raw_height = req->GetQueryParameter("height");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+    std::map<dev::h256, std::pair<dev::u256, dev::u256>> storage;
+    {
+        LOCK(cs_main);
+        TemporaryState ts(globalState);
+        if (raw_height) {
+            const auto height{ToIntegral<int>(*raw_height)};
+            if (!height || *height < 0 || *height > chainman.ActiveChain().Height()) {
+                return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + SanitizeString(*raw_height));
+            }
+            const CBlockIndex* pindex = chainman.ActiveChain()[*height];
+            ts.SetRoot(uintToh256(pindex->hashStateRoot), uintToh256(pindex->hashUTXORoot));
+        }
+        const dev::Address address(address_str);
+        if (!globalState->addressInUse(address)) {
+            return RESTERR(req, HTTP_NOT_FOUND, address_str + " not found");
+        }
+        storage = globalState->storage(address);
+    }
+
+    return RESTReply(
+        req, rf,
+        [&](DataStream& ss) {
+            WriteCompactSize(ss, storage.size());
+            for (const auto& [hashed_key, entry] : storage) {
+                for (const dev::h256& hash : {hashed_key, dev::h256(entry.first), dev::h256(entry.second)}) {
+                    ss << Span{hash.data(), hash.size};
+                }
+            }
+        },
+        [&] {
+            UniValue result(UniValue::VOBJ);
+            for (const auto& [hashed_key, entry] : storage) {
+                UniValue e(UniValue::VOBJ);
+                e.pushKV(dev::toHex(dev::h256(entry.first)), dev::toHex(dev::h256(entry.second)));
+                result.pushKV(hashed_key.hex(), e);
+            }
+            return result;
+        });
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1017,6 +1272,10 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/receipt/", rest_receipt},
+      {"/rest/logs/", rest_logs},
+      {"/rest/address/", rest_address},
+      {"/rest/storage/", rest_storage},
 };
 
 void StartREST(const std::any& context)
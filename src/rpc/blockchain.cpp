@@ -20,6 +20,7 @@
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/delegationindex.h>
 #include <kernel/coinstats.h>
 #include <logging/timer.h>
 #include <net.h>
@@ -54,6 +55,7 @@
 #include <txdb.h>
 #include <util/convert.h>
 #include <qtum/qtumdelegation.h>
+#include <qtum/qtumsnapshot.h>
 #include <util/tokenstr.h>
 #include <rpc/contract_util.h>
 
@@ -280,19 +282,25 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
     return result;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity)
+//! Block fields, except for the transactions
+static UniValue blockInfoToJSON(const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex)
 {
     UniValue result = blockheaderToJSON(tip, blockindex);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(TX_NO_WITNESS(block)));
     result.pushKV("size", (int)::GetSerializeSize(TX_WITH_WITNESS(block)));
     result.pushKV("weight", (int)::GetBlockWeight(block));
-    UniValue txs(UniValue::VARR);
+    return result;
+}
 
+//! Pass the JSON of each transaction of the block to fn, one at a time
+template <typename Fn>
+static void blockTxsToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& blockindex, TxVerbosity verbosity, Fn&& fn)
+{
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
+                fn(UniValue{tx->GetHash().GetHex()});
             }
             break;
 
@@ -308,16 +316,41 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
                 const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
+                fn(std::move(objTx));
             }
             break;
     }
+}
 
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity)
+{
+    UniValue result = blockInfoToJSON(block, tip, blockindex);
+    UniValue txs(UniValue::VARR);
+    blockTxsToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) {
+        txs.push_back(std::move(tx));
+    });
     result.pushKV("tx", std::move(txs));
 
     return result;
 }
 
+void blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, UniValueStreamWriter& writer)
+{
+    const UniValue info = blockInfoToJSON(block, tip, blockindex);
+    writer.beginObject();
+    for (size_t i = 0; i < info.size(); ++i) {
+        writer.key(info.getKeys()[i]);
+        writer.value(info.getValues()[i]);
+    }
+    writer.key("tx");
+    writer.beginArray();
+    blockTxsToJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) {
+        writer.value(tx);
+    });
+    writer.end();
+    writer.end();
+}
+
 static RPCHelpMan getestimatedannualroi()
 {
     return RPCHelpMan{"getestimatedannualroi",
@@ -1085,6 +1118,13 @@ static RPCHelpMan getblock()
         tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
     }
 
+    // Transaction details make the result many times the size of the block
+    if (tx_verbosity != TxVerbosity::SHOW_TXID && StreamRPCReply(request, [&](UniValueStreamWriter& writer) {
+            blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, writer);
+        })) {
+        return NullUniValue;
+    }
+
     return blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity);
 },
     };
@@ -1451,7 +1491,31 @@ RPCHelpMan searchlogs()
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
-    return SearchLogs(request.params, chainman);
+
+    // Search the logs first, as nothing can fail once the reply is streamed
+    const std::vector<TransactionReceiptInfo> receipts = SearchLogReceipts(request.params, chainman);
+
+    // The receipts of a large block range don't fit in memory as UniValue objects.
+    // They are written without cs_main, which is only held for the search.
+    if (StreamRPCReply(request, [&](UniValueStreamWriter& writer) {
+            writer.beginArray();
+            for (const auto& receipt : receipts) {
+                UniValue tri(UniValue::VOBJ);
+                transactionReceiptInfoToJSON(receipt, tri);
+                writer.value(tri);
+            }
+            writer.end();
+        })) {
+        return NullUniValue;
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const auto& receipt : receipts) {
+        UniValue tri(UniValue::VOBJ);
+        transactionReceiptInfoToJSON(receipt, tri);
+        result.push_back(tri);
+    }
+    return result;
 },
     };
 }
@@ -1553,6 +1617,9 @@ RPCHelpMan getdelegationinfoforaddress()
 {
 
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    if (g_delegation_index) {
+        g_delegation_index->BlockUntilSyncedToCurrentChain();
+    }
     LOCK(cs_main);
 
     // Parse the public key hash address
@@ -1567,12 +1634,14 @@ RPCHelpMan getdelegationinfoforaddress()
         throw JSONRPCError(RPC_TYPE_ERROR, "Address does not refer to public key hash");
     }
 
-    // Get delegation for an address
+    // Get delegation for an address, from the index when it is in sync
     QtumDelegation qtumDelegation;
     Delegation delegation;
     PKHash pkhash = std::get<PKHash>(dest);
     uint160 address = uint160(pkhash);
-    if(!qtumDelegation.GetDelegation(address, delegation, chainman.ActiveChainstate())) {
+    if (g_delegation_index && g_delegation_index->GetSummary().synced) {
+        g_delegation_index->FindDelegation(address, delegation);
+    } else if(!qtumDelegation.GetDelegation(address, delegation, chainman.ActiveChainstate())) {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to get delegation");
     }
     bool verified = qtumDelegation.VerifyDelegation(address, delegation);
@@ -1629,7 +1698,8 @@ RPCHelpMan getdelegationsforstaker()
 {
     return RPCHelpMan{"getdelegationsforstaker",
                 "requires -logevents to be enabled\n"
-                "\nGet the current list of delegates for a super staker.\n",
+                "\nGet the current list of delegates for a super staker.\n"
+                "The list is read from the delegation index when -delegationindex is enabled.\n",
                 {
                     {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The qtum address string for staker"},
                 },
@@ -1657,6 +1727,9 @@ RPCHelpMan getdelegationsforstaker()
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
 
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    if (g_delegation_index) {
+        g_delegation_index->BlockUntilSyncedToCurrentChain();
+    }
     LOCK(cs_main);
 
     // Parse the public key hash address
@@ -1672,15 +1745,22 @@ RPCHelpMan getdelegationsforstaker()
     }
 
     // Get delegations for staker
-    QtumDelegation qtumDelegation;
-    std::vector<DelegationEvent> events;
     PKHash pkhash = std::get<PKHash>(dest);
     uint160 address = uint160(pkhash);
-    DelegationsStakerFilter filter(address);
-    if(!qtumDelegation.FilterDelegationEvents(events, filter, chainman)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to get delegations for staker");
+    std::map<uint160, Delegation> delegations;
+    if (g_delegation_index && g_delegation_index->GetSummary().synced) {
+        if(!g_delegation_index->FindDelegationsForStaker(address, delegations)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to get delegations for staker");
+        }
+    } else {
+        QtumDelegation qtumDelegation;
+        std::vector<DelegationEvent> events;
+        DelegationsStakerFilter filter(address);
+        if(!qtumDelegation.FilterDelegationEvents(events, filter, chainman)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to get delegations for staker");
+        }
+        delegations = qtumDelegation.DelegationsFromEvents(events);
     }
-    std::map<uint160, Delegation> delegations = qtumDelegation.DelegationsFromEvents(events);
 
     // Get chain parameters
     std::map<COutPoint, uint32_t> immatureStakes = GetImmatureStakes(chainman);
@@ -3585,7 +3665,7 @@ static RPCHelpMan dumptxoutset()
 {
     return RPCHelpMan{
         "dumptxoutset",
-        "Write the serialized UTXO set to a file.",
+        "Write the serialized UTXO set and contract state to a file.",
         {
             {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the output file. If relative, will be prefixed by datadir."},
         },
@@ -3598,6 +3678,8 @@ static RPCHelpMan dumptxoutset()
                     {RPCResult::Type::STR, "path", "the absolute path that the snapshot was written to"},
                     {RPCResult::Type::STR_HEX, "txoutset_hash", "the hash of the UTXO set contents"},
                     {RPCResult::Type::NUM, "nchaintx", "the number of transactions in the chain up to and including the base block"},
+                    {RPCResult::Type::NUM, "accounts_written", "the number of contract state accounts written in the snapshot"},
+                    {RPCResult::Type::NUM, "utxo_trie_entries_written", "the number of contract UTXO trie entries written in the snapshot"},
                 }
         },
         RPCExamples{
@@ -3647,6 +3729,8 @@ UniValue CreateUTXOSnapshot(
     std::unique_ptr<CCoinsViewCursor> pcursor;
     std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex* tip;
+    std::optional<dev::OverlayDB> state_db;
+    std::optional<dev::OverlayDB> utxo_db;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
@@ -3672,6 +3756,11 @@ UniValue CreateUTXOSnapshot(
 
         pcursor = chainstate.CoinsDB().Cursor();
         tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
+
+        // Trie nodes are never overwritten, so the contract state at the tip
+        // roots can be read after cs_main is released.
+        state_db = globalState->db();
+        utxo_db = globalState->dbUtxo();
     }
 
     LOG_TIME_SECONDS(strprintf("writing UTXO snapshot at height %s (%s) to file %s (via %s)",
@@ -3697,6 +3786,9 @@ UniValue CreateUTXOSnapshot(
         pcursor->Next();
     }
 
+    ContractStateSnapshotStats contract_stats{WriteContractStateSnapshot(afile,
+        *state_db, tip->hashStateRoot, *utxo_db, tip->hashUTXORoot, node.rpc_interruption_point)};
+
     afile.fclose();
 
     UniValue result(UniValue::VOBJ);
@@ -3706,6 +3798,8 @@ UniValue CreateUTXOSnapshot(
     result.pushKV("path", path.utf8string());
     result.pushKV("txoutset_hash", maybe_stats->hashSerialized.ToString());
     result.pushKV("nchaintx", tip->nChainTx);
+    result.pushKV("accounts_written", contract_stats.accounts);
+    result.pushKV("utxo_trie_entries_written", contract_stats.utxo_entries);
     return result;
 }
 
@@ -3760,7 +3854,11 @@ static RPCHelpMan loadtxoutset()
     }
 
     SnapshotMetadata metadata;
-    afile >> metadata;
+    try {
+        afile >> metadata;
+    } catch (const std::ios_base::failure& e) {
+        throw JSONRPCError(RPC_DESERIALIZATION_ERROR, strprintf("Unable to parse metadata: %s", e.what()));
+    }
 
     uint256 base_blockhash = metadata.m_base_blockhash;
     if (!chainman.GetParams().AssumeutxoForBlockhash(base_blockhash).has_value()) {
@@ -4172,21 +4270,21 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &getblockchaininfo},
         {"blockchain", &getchaintxstats},
         {"blockchain", &getblockstats},
-        {"blockchain", &getbestblockhash},
-        {"blockchain", &getblockcount},
-        {"blockchain", &getblock},
+        {"blockchain", &getbestblockhash, /*parallel=*/true},
+        {"blockchain", &getblockcount, /*parallel=*/true},
+        {"blockchain", &getblock, /*parallel=*/true},
         {"blockchain", &getblockfrompeer},
-        {"blockchain", &getblockhash},
-        {"blockchain", &getblockheader},
+        {"blockchain", &getblockhash, /*parallel=*/true},
+        {"blockchain", &getblockheader, /*parallel=*/true},
         {"blockchain", &getchaintips},
         {"blockchain", &getdifficulty},
         {"blockchain", &getdeploymentinfo},
-        {"blockchain", &gettxout},
+        {"blockchain", &gettxout, /*parallel=*/true},
         {"blockchain", &gettxoutsetinfo},
         {"blockchain", &pruneblockchain},
         {"blockchain", &verifychain},
-        {"blockchain", &getaccountinfo},
-        {"blockchain", &getstorage},
+        {"blockchain", &getaccountinfo, /*parallel=*/true},
+        {"blockchain", &getstorage, /*parallel=*/true},
         {"blockchain", &preciousblock},
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
@@ -4194,20 +4292,20 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
-        {"blockchain", &callcontract},
-        {"blockchain", &qrc20name},
-        {"blockchain", &qrc20symbol},
-        {"blockchain", &qrc20totalsupply},
-        {"blockchain", &qrc20decimals},
-        {"blockchain", &qrc20balanceof},
-        {"blockchain", &qrc20allowance},
+        {"blockchain", &callcontract, /*parallel=*/true},
+        {"blockchain", &qrc20name, /*parallel=*/true},
+        {"blockchain", &qrc20symbol, /*parallel=*/true},
+        {"blockchain", &qrc20totalsupply, /*parallel=*/true},
+        {"blockchain", &qrc20decimals, /*parallel=*/true},
+        {"blockchain", &qrc20balanceof, /*parallel=*/true},
+        {"blockchain", &qrc20allowance, /*parallel=*/true},
         {"blockchain", &qrc20listtransactions},
-        {"blockchain", &listcontracts},
-        {"blockchain", &gettransactionreceipt},
+        {"blockchain", &listcontracts, /*parallel=*/true},
+        {"blockchain", &gettransactionreceipt, /*parallel=*/true},
         {"blockchain", &searchlogs},
         {"blockchain", &waitforlogs},
         {"blockchain", &getestimatedannualroi},
-        {"blockchain", &getdelegationinfoforaddress},
+        {"blockchain", &getdelegationinfoforaddress, /*parallel=*/true},
         {"blockchain", &getdelegationsforstaker},
         {"hidden", &invalidateblock},
         {"hidden", &reconsiderblock},
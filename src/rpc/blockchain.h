@@ -20,6 +20,7 @@ class CBlock;
 class CBlockIndex;
 class Chainstate;
 class UniValue;
+class UniValueStreamWriter;
 namespace node {
 struct NodeContext;
 } // namespace node
@@ -39,6 +40,8 @@ void RPCNotifyBlockChange(const CBlockIndex*);
 
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
+/** Block description to JSON, written to a stream one transaction at a time. Same output as blockToJSON. */
+void blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, UniValueStreamWriter& writer) LOCKS_EXCLUDED(cs_main);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex) LOCKS_EXCLUDED(cs_main);
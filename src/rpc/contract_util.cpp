@@ -310,28 +310,21 @@ private:
 
 };
 
-UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
+std::vector<TransactionReceiptInfo> SearchLogReceipts(size_t fromBlock, size_t toBlock, size_t minconf,
+                                                      const std::set<dev::h160>& addresses, const std::vector<boost::optional<dev::h256>>& topics,
+                                                      ChainstateManager &chainman)
 {
-    if(!fLogEvents)
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
-
-    int curheight = 0;
-
     LOCK(cs_main);
 
-    SearchLogsParams params(_params);
-
     std::vector<std::vector<uint256>> hashesToBlock;
 
-    curheight = chainman.m_blockman.m_block_tree_db->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf, hashesToBlock, params.addresses, chainman);
+    int curheight = chainman.m_blockman.m_block_tree_db->ReadHeightIndex(fromBlock, toBlock, minconf, hashesToBlock, addresses, chainman);
 
     if (curheight == -1) {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
     }
 
-    UniValue result(UniValue::VARR);
-
-    auto topics = params.topics;
+    std::vector<TransactionReceiptInfo> result;
 
     std::set<uint256> dupes;
 
@@ -347,7 +340,7 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
 
             std::vector<TransactionReceiptInfo> receipts = pstorageresult->getResult(uintToh256(e));
 
-            for(const auto& receipt : receipts) {
+            for(auto& receipt : receipts) {
                 if(receipt.logs.empty()) {
                     continue;
                 }
@@ -379,9 +372,7 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
 
             push:
 
-                UniValue tri(UniValue::VOBJ);
-                transactionReceiptInfoToJSON(receipt, tri);
-                result.push_back(tri);
+                result.push_back(std::move(receipt));
             }
         }
     }
@@ -389,6 +380,32 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
     return result;
 }
 
+std::vector<TransactionReceiptInfo> SearchLogReceipts(const UniValue& _params, ChainstateManager &chainman)
+{
+    if(!fLogEvents)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
+
+    LOCK(cs_main);
+
+    SearchLogsParams params(_params);
+
+    return SearchLogReceipts(params.fromBlock, params.toBlock, params.minconf, params.addresses, params.topics, chainman);
+}
+
+UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
+{
+    std::vector<TransactionReceiptInfo> receipts = SearchLogReceipts(_params, chainman);
+
+    UniValue result(UniValue::VARR);
+    for(const auto& receipt : receipts) {
+        UniValue tri(UniValue::VOBJ);
+        transactionReceiptInfoToJSON(receipt, tri);
+        result.push_back(tri);
+    }
+
+    return result;
+}
+
 CallToken::CallToken(ChainstateManager &_chainman):
     chainman(_chainman)
 {
@@ -11,6 +11,14 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman);
 
 UniValue SearchLogs(const UniValue& params, ChainstateManager &chainman);
 
+/** Receipts matching the searchlogs params. Throws JSONRPCError for bad params or with -logevents disabled. */
+std::vector<TransactionReceiptInfo> SearchLogReceipts(const UniValue& params, ChainstateManager &chainman);
+
+/** Receipts with logs in the block range matching the filters, each transaction once. Throws JSONRPCError for a bad range. */
+std::vector<TransactionReceiptInfo> SearchLogReceipts(size_t fromBlock, size_t toBlock, size_t minconf,
+                                                      const std::set<dev::h160>& addresses, const std::vector<boost::optional<dev::h256>>& topics,
+                                                      ChainstateManager &chainman);
+
 void assignJSON(UniValue& entry, const TransactionReceiptInfo& resExec);
 
 void assignJSON(UniValue& logEntry, const dev::eth::LogEntry& log,
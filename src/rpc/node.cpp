@@ -11,6 +11,7 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/delegationindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
@@ -398,6 +399,10 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_delegation_index) {
+        result.pushKVs(SummaryToJSON(g_delegation_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
@@ -711,22 +716,41 @@ static RPCHelpMan getaddressdeltas()
         }
     }
 
-    UniValue deltas(UniValue::VARR);
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+    // Convert the addresses first, as nothing can fail once the reply is streamed
+    std::map<std::pair<int, uint256>, std::string> addressStrings;
+    for (const auto& entry : addressIndex) {
+        auto it = addressStrings.try_emplace({entry.first.type, entry.first.hashBytes}).first;
+        if (it->second.empty() && !getAddressFromIndex(entry.first.type, entry.first.hashBytes, it->second)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
         }
+    }
 
+    auto deltaToJSON = [&addressStrings](const std::pair<CAddressIndexKey, CAmount>& entry) {
         UniValue delta(UniValue::VOBJ);
-        delta.pushKV("satoshis", it->second);
-        delta.pushKV("txid", it->first.txhash.GetHex());
-        delta.pushKV("index", (int)it->first.index);
-        delta.pushKV("blockindex", (int)it->first.txindex);
-        delta.pushKV("height", it->first.blockHeight);
-        delta.pushKV("address", address);
-        deltas.push_back(delta);
+        delta.pushKV("satoshis", entry.second);
+        delta.pushKV("txid", entry.first.txhash.GetHex());
+        delta.pushKV("index", (int)entry.first.index);
+        delta.pushKV("blockindex", (int)entry.first.txindex);
+        delta.pushKV("height", entry.first.blockHeight);
+        delta.pushKV("address", addressStrings.at({entry.first.type, entry.first.hashBytes}));
+        return delta;
+    };
+
+    // The deltas of a busy address don't fit in memory as UniValue objects
+    if (!(includeChainInfo && start > 0 && end > 0) && StreamRPCReply(request, [&](UniValueStreamWriter& writer) {
+            writer.beginArray();
+            for (const auto& entry : addressIndex) {
+                writer.value(deltaToJSON(entry));
+            }
+            writer.end();
+        })) {
+        return NullUniValue;
+    }
+
+    UniValue deltas(UniValue::VARR);
+
+    for (const auto& entry : addressIndex) {
+        deltas.push_back(deltaToJSON(entry));
     }
 
     UniValue result(UniValue::VOBJ);
@@ -1263,12 +1287,12 @@ void RegisterNodeRPCCommands(CRPCTable& t)
         {"control", &getdgpinfo},
         {"util", &getindexinfo},
         {"util", &getblockhashes},
-        {"util", &getaddresstxids},
-        {"util", &getaddressdeltas},
-        {"util", &getaddressbalance},
-        {"util", &getaddressutxos},
-        {"util", &getaddressmempool},
-        {"util", &getspentinfo},
+        {"util", &getaddresstxids, /*parallel=*/true},
+        {"util", &getaddressdeltas, /*parallel=*/true},
+        {"util", &getaddressbalance, /*parallel=*/true},
+        {"util", &getaddressutxos, /*parallel=*/true},
+        {"util", &getaddressmempool, /*parallel=*/true},
+        {"util", &getspentinfo, /*parallel=*/true},
         {"util", &listconf},
         {"hidden", &setmocktime},
         {"hidden", &mockscheduler},
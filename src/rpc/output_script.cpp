@@ -222,7 +222,7 @@ static RPCHelpMan deriveaddresses()
 void RegisterOutputScriptRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
-        {"util", &validateaddress},
+        {"util", &validateaddress, /*parallel=*/true},
         {"util", &deriveaddresses},
         {"util", &getdescriptorinfo},
     };
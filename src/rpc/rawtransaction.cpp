@@ -2463,10 +2463,10 @@ RPCHelpMan descriptorprocesspsbt()
 void RegisterRawTransactionRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
-        {"rawtransactions", &getrawtransaction},
+        {"rawtransactions", &getrawtransaction, /*parallel=*/true},
         {"rawtransactions", &createrawtransaction},
-        {"rawtransactions", &decoderawtransaction},
-        {"rawtransactions", &decodescript},
+        {"rawtransactions", &decoderawtransaction, /*parallel=*/true},
+        {"rawtransactions", &decodescript, /*parallel=*/true},
         {"rawtransactions", &combinerawtransaction},
         {"rawtransactions", &signrawtransactionwithkey},
         {"rawtransactions", &signrawsendertransactionwithkey},
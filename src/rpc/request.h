@@ -37,6 +37,7 @@ public:
     std::string peerAddr;
     std::any context;
     bool isLongPolling = false;
+    bool allowStreaming = false;
     void *httpreq = nullptr;
 
     void parse(const UniValue& valRequest);
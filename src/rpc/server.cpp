@@ -19,15 +19,21 @@
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <httpserver.h>
 
 #include <boost/signals2/signal.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
 
 static GlobalMutex g_rpc_warmup_mutex;
@@ -54,6 +60,67 @@ struct RPCServerInfo
 
 static RPCServerInfo g_rpc_server_info;
 
+/**
+ * Threads helping the HTTP worker threads with the parallel calls of batches.
+ * A batch asks for at most -rpcbatchconcurrency - 1 of them and keeps working
+ * itself, so it finishes even when all helpers are busy with other batches.
+ */
+class RPCBatchPool
+{
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+public:
+    void Start(int threads) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_stop = false);
+        for (int n = 0; n < threads; ++n) {
+            m_threads.emplace_back([this, n]() {
+                util::ThreadRename(strprintf("rpcbatch.%i", n));
+                Run();
+            });
+        }
+    }
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+        m_threads.clear();
+        WITH_LOCK(m_mutex, m_tasks.clear());
+    }
+    size_t Size() const { return m_threads.size(); }
+    void Post(std::function<void()> task) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_tasks.push_back(std::move(task)));
+        m_cv.notify_one();
+    }
+
+private:
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            std::function<void()> task;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_tasks.empty(); });
+                if (m_stop) return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+static RPCBatchPool g_rpc_batch_pool;
+
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
@@ -258,9 +325,72 @@ static RPCHelpMan getrpcinfo()
     };
 }
 
+static UniValue HistogramToJSON(const std::vector<uint64_t>& histogram)
+{
+    UniValue result(UniValue::VARR);
+    for (uint64_t count : histogram) {
+        result.push_back(count);
+    }
+    return result;
+}
+
+static RPCHelpMan getrpcqueueinfo()
+{
+    const std::string histogram_doc{strprintf("in %d power of two buckets, bucket 0 counts zeros, bucket i counts values from 2^(i-1) to 2^i - 1 and the last bucket everything larger", HTTP_WORK_HISTOGRAM_BUCKETS)};
+    return RPCHelpMan{"getrpcqueueinfo",
+                "\nReturns counters of the work queues of the RPC server since it started.\n"
+                "Requests go to the queue of their method's class, see -rpcworkclass. A class without threads shares the default queue.\n",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ_DYN, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "class", "The work class, one of default, slow or longpoll",
+                        {
+                            {RPCResult::Type::NUM, "threads", "The number of worker threads"},
+                            {RPCResult::Type::NUM, "max_depth", "The maximum number of queued requests"},
+                            {RPCResult::Type::NUM, "depth", "The number of queued requests"},
+                            {RPCResult::Type::NUM, "peak_depth", "The highest number of queued requests"},
+                            {RPCResult::Type::NUM, "processed", "The number of requests handled"},
+                            {RPCResult::Type::NUM, "rejected", "The number of requests rejected because the queue was full"},
+                            {RPCResult::Type::NUM, "cancelled", "The number of requests dropped because the client disconnected while they were queued"},
+                            {RPCResult::Type::ARR, "depth_histogram", "The queue depth found by new requests, " + histogram_doc,
+                                {{RPCResult::Type::NUM, "", "The number of requests"}}},
+                            {RPCResult::Type::ARR, "wait_histogram", "The milliseconds requests waited in the queue, " + histogram_doc,
+                                {{RPCResult::Type::NUM, "", "The number of requests"}}},
+                            {RPCResult::Type::ARR, "run_histogram", "The milliseconds requests took to handle, " + histogram_doc,
+                                {{RPCResult::Type::NUM, "", "The number of requests"}}},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getrpcqueueinfo", "")
+                + HelpExampleRpc("getrpcqueueinfo", "")},
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    UniValue result(UniValue::VOBJ);
+    for (const HTTPWorkQueueStats& stats : GetHTTPWorkQueueStats()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("threads", stats.threads);
+        entry.pushKV("max_depth", (uint64_t)stats.max_depth);
+        entry.pushKV("depth", (uint64_t)stats.depth);
+        entry.pushKV("peak_depth", (uint64_t)stats.peak_depth);
+        entry.pushKV("processed", stats.processed);
+        entry.pushKV("rejected", stats.rejected);
+        entry.pushKV("cancelled", stats.cancelled);
+        entry.pushKV("depth_histogram", HistogramToJSON(stats.depth_histogram));
+        entry.pushKV("wait_histogram", HistogramToJSON(stats.wait_histogram));
+        entry.pushKV("run_histogram", HistogramToJSON(stats.run_histogram));
+        result.pushKV(HTTPWorkClassString(stats.work_class), entry);
+    }
+    return result;
+}
+    };
+}
+
 static const CRPCCommand vRPCCommands[]{
     /* Overall control/query calls */
     {"control", &getrpcinfo},
+    {"control", &getrpcqueueinfo},
     {"control", &help},
     {"control", &stop},
     {"control", &uptime},
@@ -297,6 +427,7 @@ void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     g_rpc_running = true;
+    g_rpc_batch_pool.Start(std::max<int64_t>(gArgs.GetIntArg("-rpcbatchconcurrency", DEFAULT_RPC_BATCH_CONCURRENCY), 1) - 1);
     g_rpcSignals.Started();
 }
 
@@ -319,6 +450,7 @@ void StopRPC()
     std::call_once(g_rpc_stop_flag, []() {
         LogPrint(BCLog::RPC, "Stopping RPC\n");
         WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
+        g_rpc_batch_pool.Stop();
         DeleteAuthCookie();
         g_rpcSignals.Stopped();
     });
@@ -393,6 +525,49 @@ HTTPRequest* JSONRPCRequestLong::req() {
     return (HTTPRequest*)httpreq;
 }
 
+bool StreamRPCReply(const JSONRPCRequest& request, const std::function<void(UniValueStreamWriter&)>& write_result)
+{
+    if (!request.allowStreaming || !request.httpreq || gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
+        return false;
+    }
+    HTTPRequest* req = (HTTPRequest*)request.httpreq;
+
+    // Thrown by the sink to stop writing once the client is gone
+    struct StreamClosed {};
+    // The reply starts with the first chunk, until then an error can still be
+    // returned as a regular JSON-RPC error reply
+    bool started{false};
+    UniValueStreamWriter writer([req, &started](std::string_view chunk) {
+        if (!started) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteHeader("Connection", "close");
+            started = true;
+        }
+        req->Chunk(std::string(chunk));
+        if (!req->WaitChunksSent(MAX_RPC_STREAM_PENDING)) throw StreamClosed{};
+    });
+    try {
+        writer.beginObject();
+        writer.key("result");
+        write_result(writer);
+        writer.key("error");
+        writer.value(NullUniValue);
+        writer.key("id");
+        writer.value(request.id);
+        writer.end();
+        writer.flush();
+        req->Chunk("\n");
+    } catch (const StreamClosed&) {
+        LogPrint(BCLog::RPC, "%s: client closed the connection\n", request.strMethod);
+    } catch (...) {
+        if (!started) throw;
+        // The client gets an incomplete reply, which fails to parse
+        LogPrintf("%s: streamed reply aborted by an error\n", request.strMethod);
+    }
+    req->ChunkEnd();
+    return true;
+}
+
 bool IsDeprecatedRPCEnabled(const std::string& method)
 {
     const std::vector<std::string> enabled_methods = gArgs.GetArgs("-deprecatedrpc");
@@ -423,12 +598,79 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+static bool IsBatchParallelCall(const UniValue& req)
+{
+    if (!req.isObject()) return false;
+    const UniValue& method = req.find_value("method");
+    return method.isStr() && tableRPC.isParallel(method.get_str());
+}
+
+/** Calls of a batch run by the HTTP worker thread and the helpers that joined it */
+struct RPCBatchRun
+{
+    Mutex mutex;
+    std::condition_variable cv;
+    size_t next GUARDED_BY(mutex);
+    const size_t end;
+    size_t running GUARDED_BY(mutex){0};
+    const JSONRPCRequest& jreq;
+    const UniValue& vReq;
+    std::vector<UniValue>& results;
+
+    RPCBatchRun(const JSONRPCRequest& _jreq, const UniValue& _vReq, std::vector<UniValue>& _results, size_t begin, size_t _end)
+        : next(begin), end(_end), jreq(_jreq), vReq(_vReq), results(_results) {}
+
+    //! Run calls until there are none left. Helpers that join late return
+    //! without touching the batch, which may be gone by then.
+    void Work() EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        while (true) {
+            size_t i;
+            {
+                LOCK(mutex);
+                if (next == end) return;
+                i = next++;
+                ++running;
+            }
+            results[i] = JSONRPCExecOne(jreq, vReq[i]);
+            WITH_LOCK(mutex, --running);
+            cv.notify_all();
+        }
+    }
+};
+
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    std::vector<UniValue> results(vReq.size());
+    size_t reqIdx = 0;
+    while (reqIdx < vReq.size()) {
+        // Consecutive read-only calls run at the same time, any other call
+        // runs on its own once all earlier calls are done
+        size_t end = reqIdx;
+        while (end < vReq.size() && IsBatchParallelCall(vReq[end])) ++end;
+        if (end - reqIdx < 2 || g_rpc_batch_pool.Size() == 0) {
+            end = std::max(end, reqIdx + 1);
+            for (; reqIdx < end; ++reqIdx) {
+                results[reqIdx] = JSONRPCExecOne(jreq, vReq[reqIdx]);
+            }
+            continue;
+        }
 
+        auto run = std::make_shared<RPCBatchRun>(jreq, vReq, results, reqIdx, end);
+        const size_t helpers{std::min(g_rpc_batch_pool.Size(), end - reqIdx - 1)};
+        for (size_t n = 0; n < helpers; ++n) {
+            g_rpc_batch_pool.Post([run]() { run->Work(); });
+        }
+        run->Work();
+        WAIT_LOCK(run->mutex, lock);
+        run->cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(run->mutex) { return run->running == 0; });
+        reqIdx = end;
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (UniValue& result : results) {
+        ret.push_back(std::move(result));
+    }
     return ret.write() + "\n";
 }
 
@@ -588,6 +830,13 @@ static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& req
     }
 }
 
+bool CRPCTable::isParallel(const std::string& name) const
+{
+    auto it = mapCommands.find(name);
+    if (it == mapCommands.end()) return false;
+    return std::all_of(it->second.begin(), it->second.end(), [](const CRPCCommand* command) { return command->parallel; });
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
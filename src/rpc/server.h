@@ -67,6 +67,25 @@ public:
      HTTPRequest* req();
 };
 
+/** Calls of a JSON-RPC batch that may run at the same time */
+static constexpr int DEFAULT_RPC_BATCH_CONCURRENCY{4};
+
+/** Bytes of a streamed reply that may wait to be written to the client */
+static constexpr size_t MAX_RPC_STREAM_PENDING{4 * 1024 * 1024};
+
+/**
+ * Stream the reply to a request with a large result to the HTTP client in
+ * chunks, instead of building the result as a UniValue first. write_result
+ * is called with the writer at the "result" member and must write a single
+ * value. An error thrown before the first chunk is written is reported as
+ * usual, but not after that, so any check that can fail must be done before.
+ *
+ * Returns false without writing anything if the reply can't be streamed, for
+ * requests of a batch or with -rpcdoccheck, and the handler returns its result
+ * as usual. Otherwise the handler returns NullUniValue, which isn't sent.
+ */
+bool StreamRPCReply(const JSONRPCRequest& request, const std::function<void(UniValueStreamWriter&)>& write_result);
+
 /** Throw JSONRPCError if RPC is not running */
 void RpcInterruptionPoint();
 
@@ -133,20 +152,21 @@ public:
     using Actor = std::function<bool(const JSONRPCRequest& request, UniValue& result, bool last_handler)>;
 
     //! Constructor taking Actor callback supporting multiple handlers.
-    CRPCCommand(std::string category, std::string name, Actor actor, std::vector<std::pair<std::string, bool>> args, intptr_t unique_id)
+    CRPCCommand(std::string category, std::string name, Actor actor, std::vector<std::pair<std::string, bool>> args, intptr_t unique_id, bool parallel = false)
         : category(std::move(category)), name(std::move(name)), actor(std::move(actor)), argNames(std::move(args)),
-          unique_id(unique_id)
+          unique_id(unique_id), parallel(parallel)
     {
     }
 
     //! Simplified constructor taking plain RpcMethodFnType function pointer.
-    CRPCCommand(std::string category, RpcMethodFnType fn)
+    CRPCCommand(std::string category, RpcMethodFnType fn, bool parallel = false)
         : CRPCCommand(
               category,
               fn().m_name,
               [fn](const JSONRPCRequest& request, UniValue& result, bool) { result = fn().HandleRequest(request); return true; },
               fn().GetArgNames(),
-              intptr_t(fn))
+              intptr_t(fn),
+              parallel)
     {
     }
 
@@ -164,6 +184,9 @@ public:
     //! appended after other arguments, see transformNamedArguments for details.
     std::vector<std::pair<std::string, bool>> argNames;
     intptr_t unique_id;
+    //! Whether calls of a batch to this method may run at the same time as
+    //! the calls to other such methods. Only set for read-only methods.
+    bool parallel;
 };
 
 /**
@@ -185,6 +208,12 @@ public:
      */
     UniValue execute(const JSONRPCRequest &request) const;
 
+    /**
+     * Whether the calls of a batch to a method may run in parallel, see
+     * CRPCCommand::parallel. False for unknown methods.
+     */
+    bool isParallel(const std::string& name) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
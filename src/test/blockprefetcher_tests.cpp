@@ -0,0 +1,109 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/consensus.h>
+#include <node/blockprefetcher.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <util/chaintype.h>
+#include <util/fs.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using node::BlockFilePrefetcher;
+
+BOOST_FIXTURE_TEST_SUITE(blockprefetcher_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(blockprefetcher_records)
+{
+    const auto params{CreateChainParams(ArgsManager{}, ChainType::MAIN)};
+    const MessageStartChars& magic{params->MessageStart()};
+
+    CBlock block{params->GenesisBlock()};
+    CBlock bigger_block{block};
+    bigger_block.vtx.push_back(block.vtx[0]);
+    const unsigned int block_size = ::GetSerializeSize(TX_WITH_WITNESS(block));
+    const unsigned int bigger_size = ::GetSerializeSize(TX_WITH_WITNESS(bigger_block));
+
+    // Two well-formed records separated by junk, then a record with trailing data
+    const fs::path path{m_path_root / "blk.dat"};
+    std::vector<uint64_t> positions;
+    {
+        AutoFile file{fsbridge::fopen(path, "wb")};
+        file << magic << block_size;
+        positions.push_back(std::ftell(file.Get()));
+        file << TX_WITH_WITNESS(block);
+        file << uint32_t{0xdeadbeef};
+        file << magic << bigger_size;
+        positions.push_back(std::ftell(file.Get()));
+        file << TX_WITH_WITNESS(bigger_block);
+        file << magic << block_size + 4;
+        positions.push_back(std::ftell(file.Get()));
+        file << TX_WITH_WITNESS(block) << uint32_t{0};
+    }
+
+    {
+        BlockFilePrefetcher prefetcher{fsbridge::fopen(path, "rb"), magic, dgpMaxBlockSerSize, /*parse_threads=*/2};
+        // Positions the scanner went past without finding a record, and size mismatches, are not served
+        BOOST_CHECK(!prefetcher.Take(positions[0] + 1, block_size));
+        BOOST_CHECK(!prefetcher.Take(positions[1], block_size));
+    }
+
+    BlockFilePrefetcher prefetcher{fsbridge::fopen(path, "rb"), magic, dgpMaxBlockSerSize, /*parse_threads=*/2};
+    const auto first{prefetcher.Take(positions[0], block_size)};
+    BOOST_REQUIRE(first);
+    BOOST_CHECK(first->GetHash() == block.GetHash());
+    BOOST_CHECK_EQUAL(first->vtx.size(), block.vtx.size());
+    const auto second{prefetcher.Take(positions[1], bigger_size)};
+    BOOST_REQUIRE(second);
+    BOOST_CHECK_EQUAL(second->vtx.size(), bigger_block.vtx.size());
+    // A block that does not fill its record is left to the loader
+    BOOST_CHECK(!prefetcher.Take(positions[2], block_size + 4));
+}
+
+BOOST_AUTO_TEST_CASE(blockprefetcher_compressed_records)
+{
+    const auto params{CreateChainParams(ArgsManager{}, ChainType::MAIN)};
+    const MessageStartChars& magic{params->MessageStart()};
+
+    CBlock block{params->GenesisBlock()};
+    for (int i = 0; i < 20; ++i) {
+        block.vtx.push_back(block.vtx[0]);
+    }
+    std::vector<uint8_t> block_data;
+    VectorWriter{block_data, 0, TX_WITH_WITNESS(block)};
+    const std::vector<uint8_t> compressed{node::CompressBlockData(block_data, /*level=*/6)};
+    BOOST_REQUIRE_LT(compressed.size(), block_data.size());
+    const unsigned int compressed_size = compressed.size();
+
+    // A compressed record, then one whose payload does not inflate
+    const fs::path path{m_path_root / "blk.dat"};
+    std::vector<uint64_t> positions;
+    {
+        AutoFile file{fsbridge::fopen(path, "wb")};
+        file << magic << (compressed_size | node::BLOCK_COMPRESSED_FLAG);
+        positions.push_back(std::ftell(file.Get()));
+        file.write(MakeByteSpan(compressed));
+        std::vector<uint8_t> corrupt{compressed};
+        corrupt.resize(corrupt.size() / 2);
+        file << magic << (static_cast<unsigned int>(corrupt.size()) | node::BLOCK_COMPRESSED_FLAG);
+        positions.push_back(std::ftell(file.Get()));
+        file.write(MakeByteSpan(corrupt));
+    }
+
+    // The loader takes the inflated block to read its header, so it inflates nothing itself
+    BlockFilePrefetcher prefetcher{fsbridge::fopen(path, "rb"), magic, dgpMaxBlockSerSize, /*parse_threads=*/2};
+    const auto inflated{prefetcher.Take(positions[0], compressed_size)};
+    BOOST_REQUIRE(inflated);
+    BOOST_CHECK(inflated->GetHash() == block.GetHash());
+    BOOST_CHECK_EQUAL(inflated->vtx.size(), block.vtx.size());
+    // A record that fails to inflate is left to the loader
+    BOOST_CHECK(!prefetcher.Take(positions[1], compressed.size() / 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,241 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/validation.h>
+#include <index/delegationindex.h>
+#include <interfaces/chain.h>
+#include <sync.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <condition_variable>
+#include <optional>
+
+namespace {
+
+/** Delegation index reading the events of each block height from a list instead of the receipts */
+class TestDelegationIndex : public DelegationIndex
+{
+public:
+    using DelegationIndex::DelegationIndex;
+
+    mutable Mutex m_mutex;
+    std::map<int, std::vector<DelegationEvent>> m_events GUARDED_BY(m_mutex);
+    //! Blocks from this height wait to be indexed, to leave the index behind the chain
+    std::optional<int> m_hold_height GUARDED_BY(m_mutex);
+    mutable std::condition_variable m_hold_cv;
+
+protected:
+    void ReadDelegationEvents(const interfaces::BlockInfo& block, std::vector<DelegationEvent>& events) const override
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_hold_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_hold_height || block.height < *m_hold_height; });
+        auto it = m_events.find(block.height);
+        if (it != m_events.end()) events = it->second;
+    }
+};
+
+class StakerFilter : public IDelegationFilter
+{
+public:
+    explicit StakerFilter(const std::set<uint160>& stakers) : m_stakers(stakers) {}
+
+    bool Match(const DelegationEvent& event) const override { return m_stakers.count(event.item.staker); }
+
+    bool GetStakers(std::set<uint160>& stakers) const override
+    {
+        stakers = m_stakers;
+        return true;
+    }
+
+private:
+    std::set<uint160> m_stakers;
+};
+
+class DelegateFilter : public IDelegationFilter
+{
+public:
+    explicit DelegateFilter(const std::set<uint160>& delegates) : m_delegates(delegates) {}
+
+    bool Match(const DelegationEvent& event) const override { return m_delegates.count(event.item.delegate); }
+
+    bool GetDelegates(std::set<uint160>& delegates) const override
+    {
+        delegates = m_delegates;
+        return true;
+    }
+
+private:
+    std::set<uint160> m_delegates;
+};
+
+class AnyFilter : public IDelegationFilter
+{
+public:
+    bool Match(const DelegationEvent& event) const override { return true; }
+};
+
+uint160 Key(uint8_t n)
+{
+    uint160 key;
+    *key.begin() = n;
+    return key;
+}
+
+DelegationEvent Event(DelegationType type, const uint160& delegate, const uint160& staker, uint8_t fee, int height)
+{
+    DelegationEvent event;
+    event.type = type;
+    event.item.delegate = delegate;
+    event.item.staker = staker;
+    event.item.fee = fee;
+    event.item.blockHeight = height;
+    event.item.PoD = std::vector<unsigned char>(65, fee);
+    return event;
+}
+
+void CheckDelegation(const DelegationIndex& index, const uint160& delegate, const std::optional<std::pair<uint160, uint8_t>>& expected)
+{
+    Delegation delegation;
+    BOOST_CHECK_EQUAL(index.FindDelegation(delegate, delegation), expected.has_value());
+    if (expected) {
+        BOOST_CHECK(delegation.staker == expected->first);
+        BOOST_CHECK_EQUAL(int{delegation.fee}, int{expected->second});
+        BOOST_CHECK(delegation.PoD == std::vector<unsigned char>(65, expected->second));
+    }
+}
+
+std::set<uint160> Delegates(const std::map<uint160, Delegation>& delegations)
+{
+    std::set<uint160> delegates;
+    for (const auto& [delegate, delegation] : delegations) {
+        delegates.insert(delegate);
+    }
+    return delegates;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(delegationindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(delegationindex_sync_and_rewind, TestChain100Setup)
+{
+    const uint160 staker_a{Key(1)}, staker_b{Key(2)};
+    const uint160 delegate_1{Key(11)}, delegate_2{Key(12)}, delegate_3{Key(13)};
+    const int tip_height{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Height())};
+
+    TestDelegationIndex index(interfaces::MakeChain(m_node), 1 << 20, true);
+    {
+        LOCK(index.m_mutex);
+        index.m_events[tip_height - 30] = {Event(DELEGATION_ADD, delegate_1, staker_a, 10, tip_height - 30),
+                                           Event(DELEGATION_ADD, delegate_2, staker_a, 10, tip_height - 30)};
+        index.m_events[tip_height - 20] = {Event(DELEGATION_ADD, delegate_3, staker_b, 10, tip_height - 20)};
+        index.m_events[tip_height - 10] = {Event(DELEGATION_REMOVE, delegate_2, staker_a, 10, tip_height - 10),
+                                           Event(DELEGATION_ADD, delegate_2, staker_b, 15, tip_height - 10)};
+    }
+    BOOST_REQUIRE(index.Init());
+    BOOST_REQUIRE(index.StartBackgroundSync());
+    IndexWaitSynced(index, *Assert(m_node.shutdown));
+
+    // The delegations of the existing blocks are indexed, by delegate and by staker
+    uint256 tip_hash{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash())};
+    CheckDelegation(index, delegate_1, std::make_pair(staker_a, 10));
+    CheckDelegation(index, delegate_2, std::make_pair(staker_b, 15));
+    CheckDelegation(index, delegate_3, std::make_pair(staker_b, 10));
+
+    std::map<uint160, Delegation> delegations;
+    BOOST_CHECK(index.FindDelegationsForStaker(staker_a, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_1}));
+    delegations.clear();
+    BOOST_CHECK(index.FindDelegationsForStaker(staker_b, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_2, delegate_3}));
+
+    // The filters are served from the staker and the delegate keys, or from a full scan
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(StakerFilter({staker_b, Key(3)}), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_2, delegate_3}));
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(DelegateFilter({delegate_1, Key(14)}), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_1}));
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(AnyFilter(), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_1, delegate_2, delegate_3}));
+
+    // A new block changes the delegations
+    {
+        LOCK(index.m_mutex);
+        index.m_events[tip_height + 1] = {Event(DELEGATION_REMOVE, delegate_3, staker_b, 10, tip_height + 1),
+                                          Event(DELEGATION_ADD, delegate_1, staker_a, 20, tip_height + 1),
+                                          Event(DELEGATION_ADD, delegate_3, staker_a, 30, tip_height + 1)};
+    }
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    CheckDelegation(index, delegate_1, std::make_pair(staker_a, 20));
+    CheckDelegation(index, delegate_3, std::make_pair(staker_a, 30));
+    delegations.clear();
+    BOOST_CHECK(index.FindDelegationsForStaker(staker_b, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_2}));
+
+    // Reorg down to the block before the one that moved delegate_2, the previous state is restored
+    for (int i = 0; i < 12; ++i) {
+        BlockValidationState state;
+        BOOST_CHECK(m_node.chainman->ActiveChainstate().InvalidateBlock(state, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())));
+    }
+    {
+        LOCK(index.m_mutex);
+        index.m_events.erase(tip_height - 10);
+        index.m_events.erase(tip_height + 1);
+    }
+    coinbaseKey.MakeNewKey(true);
+    for (int i = 0; i < 12; ++i) {
+        CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    }
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    CheckDelegation(index, delegate_1, std::make_pair(staker_a, 10));
+    CheckDelegation(index, delegate_2, std::make_pair(staker_a, 10));
+    CheckDelegation(index, delegate_3, std::make_pair(staker_b, 10));
+    tip_hash = WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(StakerFilter({staker_a}), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_1, delegate_2}));
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(StakerFilter({staker_b}), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_3}));
+
+    // The index updates from the validation queue, so it is behind the chain tip
+    // until it handles the new block. The filter fails at the new tip, and still
+    // gives the delegations of the block the index is at.
+    const uint256 prev_tip_hash{tip_hash};
+    const int next_height{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Height()) + 1};
+    {
+        LOCK(index.m_mutex);
+        index.m_hold_height = next_height;
+        index.m_events[next_height] = {Event(DELEGATION_REMOVE, delegate_1, staker_a, 10, next_height)};
+    }
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    tip_hash = WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+    delegations.clear();
+    BOOST_CHECK(!index.FilterDelegations(StakerFilter({staker_a}), tip_hash, delegations));
+    BOOST_CHECK(index.FilterDelegations(StakerFilter({staker_a}), prev_tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_1, delegate_2}));
+
+    // Once the block is indexed, the filter works at the new tip only
+    WITH_LOCK(index.m_mutex, index.m_hold_height.reset());
+    index.m_hold_cv.notify_all();
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    delegations.clear();
+    BOOST_CHECK(index.FilterDelegations(StakerFilter({staker_a}), tip_hash, delegations));
+    BOOST_CHECK(Delegates(delegations) == std::set<uint160>({delegate_2}));
+    BOOST_CHECK(!index.FilterDelegations(StakerFilter({staker_a}), prev_tip_hash, delegations));
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification.
+    SyncWithValidationInterfaceQueue();
+    index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
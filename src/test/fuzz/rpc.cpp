@@ -146,6 +146,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getrawmempool",
     "getrawtransaction",
     "getrpcinfo",
+    "getrpcqueueinfo",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
@@ -2,8 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <httprpc.h>
 #include <httpserver.h>
 #include <test/util/setup_common.h>
+#include <univalue.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -39,4 +41,30 @@ BOOST_AUTO_TEST_CASE(test_query_parameters)
     uri = "/rest/endpoint/someresource.json&p1=v1&p2=v2%";
     BOOST_CHECK_EXCEPTION(GetQueryParameterFromUri(uri.c_str(), "p1"), std::runtime_error, HasReason("URI parsing failed, it likely contained RFC 3986 invalid characters"));
 }
+
+BOOST_AUTO_TEST_CASE(test_work_classes)
+{
+    for (HTTPWorkClass work_class : {HTTPWorkClass::DEFAULT, HTTPWorkClass::SLOW, HTTPWorkClass::LONGPOLL}) {
+        BOOST_CHECK(ParseHTTPWorkClass(HTTPWorkClassString(work_class)) == work_class);
+    }
+    BOOST_CHECK(!ParseHTTPWorkClass("fast").has_value());
+
+    const std::map<std::string, HTTPWorkClass> classes{
+        {"searchlogs", HTTPWorkClass::SLOW},
+        {"waitforlogs", HTTPWorkClass::LONGPOLL},
+    };
+    auto work_class = [&](const std::string& json) {
+        UniValue request;
+        BOOST_REQUIRE(request.read(json));
+        return GetRPCWorkClass(request, classes);
+    };
+    BOOST_CHECK(work_class(R"({"method":"getblockcount"})") == HTTPWorkClass::DEFAULT);
+    BOOST_CHECK(work_class(R"({"method":"searchlogs","params":[]})") == HTTPWorkClass::SLOW);
+    BOOST_CHECK(work_class(R"({"method":1})") == HTTPWorkClass::DEFAULT);
+    BOOST_CHECK(work_class(R"([])") == HTTPWorkClass::DEFAULT);
+    // A batch goes to the queue of its slowest call
+    BOOST_CHECK(work_class(R"([{"method":"getblockcount"},{"method":"searchlogs"}])") == HTTPWorkClass::SLOW);
+    BOOST_CHECK(work_class(R"([{"method":"waitforlogs"},{"method":"searchlogs"}])") == HTTPWorkClass::LONGPOLL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,8 @@
 #include <consensus/tx_verify.h>
 #include <node/miner.h>
 #include <policy/policy.h>
+#include <pow.h>
+#include <qtum/qtumtransaction.h>
 #include <test/util/random.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
@@ -52,6 +54,20 @@ struct MinerTestingSetup : public TestingSetup {
     }
     BlockAssembler AssemblerForTest(CTxMemPool& tx_mempool);
 };
+
+struct GasMinerTestingSetup : public TestChain100Setup {
+    GasMinerTestingSetup() : TestChain100Setup{ChainType::UNITTEST, {"-staker-soft-block-gas-limit=250000"}} {}
+
+    //! Submit a transaction deploying an empty contract, paying its gas stipend and extra_fee
+    CTransactionRef SubmitContractTx(const CTransactionRef& coinbase, int64_t gas_limit, int64_t gas_price, CAmount extra_fee)
+    {
+        const CAmount fee{gas_limit * gas_price + extra_fee};
+        std::vector<CTxOut> outputs;
+        outputs.emplace_back(0, CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(gas_limit) << CScriptNum(gas_price) << std::vector<unsigned char>{0x00} << OP_CREATE);
+        outputs.emplace_back(coinbase->vout[0].nValue - fee, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+        return MakeTransactionRef(CreateValidMempoolTransaction({coinbase}, {COutPoint(coinbase->GetHash(), 0)}, /*input_height=*/0, {coinbaseKey}, outputs));
+    }
+};
 } // namespace miner_tests
 
 BOOST_FIXTURE_TEST_SUITE(miner_tests, MinerTestingSetup)
@@ -792,4 +808,61 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     TestPrioritisedMining(scriptPubKey, txFirst);
 }
 
+BOOST_AUTO_TEST_CASE(GasPackageScore_knapsack)
+{
+    using node::GasPackageInfo;
+    using node::GasPackageScore;
+
+    // The fees of contract packages include their gas stipend
+    const GasPackageInfo small_call{.size = 250, .fees = 5100000, .gas_limit = 100000, .gas_stipend = 5000000};
+    const GasPackageInfo large_call{.size = 250, .fees = 80300000, .gas_limit = 2000000, .gas_stipend = 80000000};
+    const GasPackageInfo payment{.size = 250, .fees = 5100000};
+
+    // A package that uses no gas beats a contract package with the same fees and size
+    BOOST_CHECK_GT(GasPackageScore(payment, 100000, 2000000, 1.0), GasPackageScore(small_call, 100000, 2000000, 1.0));
+
+    // With plenty of gas left the higher fees win, but once the remaining gas
+    // is scarce the package with the higher fees per gas is preferred
+    BOOST_CHECK_GT(GasPackageScore(large_call, 100000, 1000000000, 1.0), GasPackageScore(small_call, 100000, 1000000000, 1.0));
+    BOOST_CHECK_LT(GasPackageScore(large_call, 100000, 2000000, 1.0), GasPackageScore(small_call, 100000, 2000000, 1.0));
+
+    // Unused gas is refunded, so it lowers the expected fees of contract packages only
+    BOOST_CHECK_LT(GasPackageScore(small_call, 100000, 2000000, 0.5), GasPackageScore(small_call, 100000, 2000000, 1.0));
+    BOOST_CHECK_EQUAL(GasPackageScore(payment, 100000, 2000000, 0.5), GasPackageScore(payment, 100000, 2000000, 1.0));
+}
+
+BOOST_FIXTURE_TEST_CASE(CreateNewBlock_gas_package_order, GasMinerTestingSetup)
+{
+    // Mature the coinbases spent below
+    mineBlocks(3);
+
+    // The mempool orders the contract txs by gas price, so high_price comes
+    // before the others. Its fees per block gas are lower than the ones of
+    // high_fee though, and large_gas doesn't fit next to them under the soft
+    // block gas limit of 250000.
+    const CTransactionRef high_price{SubmitContractTx(m_coinbase_txns[0], 100000, 100, 1 * CENT)};
+    const CTransactionRef high_fee{SubmitContractTx(m_coinbase_txns[1], 100000, 40, 1 * COIN)};
+    const CTransactionRef large_gas{SubmitContractTx(m_coinbase_txns[2], 200000, 40, 1 * CENT)};
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 3U);
+
+    const CScript coinbase_script{GetScriptForRawPubKey(coinbaseKey.GetPubKey())};
+    std::unique_ptr<CBlockTemplate> pblocktemplate{BlockAssembler{m_node.chainman->ActiveChainstate(), m_node.mempool.get()}.CreateNewBlock(coinbase_script)};
+    BOOST_REQUIRE(pblocktemplate);
+    auto pblock{std::make_shared<CBlock>(pblocktemplate->block)};
+    BOOST_REQUIRE_EQUAL(pblock->vtx.size(), 3U);
+    BOOST_CHECK(pblock->vtx[1]->GetHash() == high_fee->GetHash());
+    BOOST_CHECK(pblock->vtx[2]->GetHash() == high_price->GetHash());
+
+    // The block is valid, and the package left out fits in the next one
+    pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
+    while (!CheckProofOfWork(pblock->GetHash(), pblock->nBits, m_node.chainman->GetConsensus())) ++pblock->nNonce;
+    BOOST_REQUIRE(m_node.chainman->ProcessNewBlock(pblock, /*force_processing=*/true, /*min_pow_checked=*/true, nullptr));
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 1U);
+
+    pblocktemplate = BlockAssembler{m_node.chainman->ActiveChainstate(), m_node.mempool.get()}.CreateNewBlock(coinbase_script);
+    BOOST_REQUIRE(pblocktemplate);
+    BOOST_REQUIRE_EQUAL(pblocktemplate->block.vtx.size(), 2U);
+    BOOST_CHECK(pblocktemplate->block.vtx[1]->GetHash() == large_gas->GetHash());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -16,6 +16,7 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/net.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
@@ -1564,4 +1565,45 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(peek_new_messages)
+{
+    auto& connman = static_cast<ConnmanTestMsg&>(*m_node.connman);
+    CNode peer{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/std::string{},
+               /*conn_type_in=*/ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+    const auto receive = [&](const std::string& msg_type, uint32_t payload) {
+        BOOST_REQUIRE(connman.ReceiveMsgFrom(peer, NetMsg::Make(msg_type, payload)));
+    };
+    const auto peek = [&](size_t max_msgs) {
+        std::vector<uint32_t> payloads;
+        for (DataStream& data : peer.PeekNewMessages(NetMsgType::TX, max_msgs)) {
+            payloads.push_back(ser_readdata32(data));
+        }
+        return payloads;
+    };
+
+    receive(NetMsgType::TX, 1);
+    receive(NetMsgType::PING, 2);
+    receive(NetMsgType::TX, 3);
+    BOOST_CHECK(peek(10) == std::vector<uint32_t>({1, 3}));
+    BOOST_CHECK(peek(10).empty());
+
+    // Messages are only returned once, also after earlier ones got polled
+    receive(NetMsgType::TX, 4);
+    BOOST_CHECK_EQUAL(peer.PollMessage()->first.m_type, NetMsgType::TX);
+    BOOST_CHECK(peek(10) == std::vector<uint32_t>({4}));
+
+    receive(NetMsgType::TX, 5);
+    receive(NetMsgType::TX, 6);
+    BOOST_CHECK(peek(1) == std::vector<uint32_t>({5}));
+    BOOST_CHECK(peek(1) == std::vector<uint32_t>({6}));
+    BOOST_CHECK(peek(1).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
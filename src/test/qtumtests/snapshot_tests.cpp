@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+#include <qtumtests/test_utils.h>
+#include <qtum/qtumsnapshot.h>
+#include <node/utxo_snapshot.h>
+#include <libdevcore/LevelDB.h>
+#include <libethereum/SecureTrieDB.h>
+#include <streams.h>
+
+namespace snapshotTest{
+
+dev::OverlayDB openDB(const fs::path& path){
+    return dev::OverlayDB(std::make_unique<dev::db::LevelDB>(fs::PathToString(path)));
+}
+
+BOOST_FIXTURE_TEST_SUITE(snapshot_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(contract_state_snapshot_roundtrip){
+    dev::OverlayDB stateDB = openDB(m_path_root / "state");
+    dev::OverlayDB utxoDB = openDB(m_path_root / "utxo");
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> state(&stateDB);
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> utxo(&utxoDB);
+    state.init();
+    utxo.init();
+
+    for(unsigned i = 0; i < 100; i++){
+        dev::Address address(dev::sha3(dev::u256(i)));
+        dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storage(&stateDB);
+        storage.init();
+        for(unsigned j = 0; j < i % 5; j++){
+            storage.insert(dev::h256(dev::u256(j)), dev::rlp(dev::u256(i * 100 + j + 1)));
+        }
+        dev::bytes code;
+        dev::h256 codeHash = dev::EmptySHA3;
+        if(i % 3 == 0){
+            code = dev::bytes(10 + i, dev::byte(i));
+            codeHash = dev::sha3(code);
+            stateDB.insert(codeHash, &code);
+        }
+        dev::RLPStream account(4);
+        account << dev::u256(i) << dev::u256(i * 7) << storage.root() << codeHash;
+        state.insert(address, account.out());
+        if(i % 2) utxo.insert(address, dev::rlp(dev::u256(i)));
+    }
+    stateDB.commit();
+    utxoDB.commit();
+    const uint256 stateRoot = h256Touint(state.root());
+    const uint256 utxoRoot = h256Touint(utxo.root());
+
+    const fs::path snapshotPath = m_path_root / "snapshot";
+    {
+        AutoFile file{fsbridge::fopen(snapshotPath, "wb")};
+        ContractStateSnapshotStats stats = WriteContractStateSnapshot(file, stateDB, stateRoot, utxoDB, utxoRoot, []{});
+        BOOST_CHECK_EQUAL(stats.accounts, 100U);
+        BOOST_CHECK_EQUAL(stats.storage_entries, 200U);
+        BOOST_CHECK_EQUAL(stats.utxo_entries, 50U);
+    }
+    {
+        AutoFile file{fsbridge::fopen(snapshotPath, "rb")};
+        BOOST_CHECK(LoadContractStateSnapshot(file, openDB(m_path_root / "state2"), stateRoot, openDB(m_path_root / "utxo2"), utxoRoot, []{ return false; }));
+    }
+
+    // A loaded trie is complete
+    dev::OverlayDB loadedDB = openDB(m_path_root / "state2");
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> loaded(&loadedDB, state.root());
+    size_t accounts = 0;
+    for(auto const& i : loaded){
+        BOOST_CHECK(i.second.toString() == state.at(i.first));
+        accounts++;
+    }
+    BOOST_CHECK_EQUAL(accounts, 100U);
+
+    // Roots that don't match the base block are rejected
+    {
+        AutoFile file{fsbridge::fopen(snapshotPath, "rb")};
+        BOOST_CHECK(!LoadContractStateSnapshot(file, openDB(m_path_root / "state3"), utxoRoot, openDB(m_path_root / "utxo3"), utxoRoot, []{ return false; }));
+    }
+
+    // A section that doesn't start with the null outpoint marker, like a left over coin, is rejected
+    {
+        AutoFile file{fsbridge::fopen(m_path_root / "coins", "wb")};
+        file << uint256::ONE << uint32_t{0};
+    }
+    {
+        AutoFile file{fsbridge::fopen(m_path_root / "coins", "rb")};
+        BOOST_CHECK(!LoadContractStateSnapshot(file, openDB(m_path_root / "state4"), stateRoot, openDB(m_path_root / "utxo4"), utxoRoot, []{ return false; }));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_metadata_version){
+    node::SnapshotMetadata metadata{uint256::ONE, 42};
+    DataStream stream{};
+    stream << metadata;
+
+    node::SnapshotMetadata read;
+    DataStream(stream) >> read;
+    BOOST_CHECK(read.m_base_blockhash == uint256::ONE);
+    BOOST_CHECK_EQUAL(read.m_coins_count, 42U);
+
+    // Snapshots of another version or without a header are rejected
+    DataStream other_version{stream};
+    other_version[node::SNAPSHOT_MAGIC_BYTES.size()] = std::byte{1};
+    BOOST_CHECK_THROW(other_version >> read, std::ios_base::failure);
+
+    DataStream no_header{};
+    no_header << uint256::ONE << uint64_t{42};
+    BOOST_CHECK_THROW(no_header >> read, std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
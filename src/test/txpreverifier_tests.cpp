@@ -0,0 +1,109 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <consensus/amount.h>
+#include <node/txpreverifier.h>
+#include <policy/policy.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+using node::TxPreverifier;
+
+BOOST_FIXTURE_TEST_SUITE(txpreverifier_tests, TestChain100Setup)
+
+static DataStream SerializeTx(const CMutableTransaction& mtx)
+{
+    DataStream tx_data;
+    tx_data << TX_WITH_WITNESS(mtx);
+    return tx_data;
+}
+
+BOOST_AUTO_TEST_CASE(preverify_outcomes)
+{
+    // Stands for the recent rejects filter of net_processing
+    std::set<uint256> known;
+    TxPreverifier preverifier{*m_node.chainman, *m_node.mempool,
+                              [&known](const CTransaction& tx) { return known.count(tx.GetWitnessHash()) > 0; },
+                              /*threads=*/0};
+    auto verify = [&](DataStream tx_data) {
+        preverifier.Add(std::move(tx_data));
+        preverifier.VerifyQueued();
+        return preverifier.GetStats();
+    };
+
+    const CScript spk{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CAmount coinbase_value{m_coinbase_txns[0]->vout[0].nValue};
+    CMutableTransaction tx{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/0, coinbaseKey, spk,
+                                                         coinbase_value - 1 * COIN, /*submit=*/false)};
+    const uint256 wtxid{CTransaction{tx}.GetWitnessHash()};
+
+    // Miss: a new transaction has its scripts verified
+    TxPreverifier::Stats stats{verify(SerializeTx(tx))};
+    BOOST_CHECK_EQUAL(stats.verified, 1U);
+
+    // Hit: a known or recently rejected transaction is skipped before looking at its inputs
+    known.insert(wtxid);
+    stats = verify(SerializeTx(tx));
+    BOOST_CHECK_EQUAL(stats.known, 1U);
+    BOOST_CHECK_EQUAL(stats.verified, 1U);
+
+    // Invalidation: once the filter is reset, e.g. on a new tip, it is verified again
+    known.clear();
+    stats = verify(SerializeTx(tx));
+    BOOST_CHECK_EQUAL(stats.known, 1U);
+    BOOST_CHECK_EQUAL(stats.verified, 2U);
+
+    // The signature no longer matches once an output changes
+    CMutableTransaction bad_sig{tx};
+    bad_sig.vout[0].nValue -= 1;
+    stats = verify(SerializeTx(bad_sig));
+    BOOST_CHECK_EQUAL(stats.invalid, 1U);
+
+    // The cheaper checks reject the following transactions before any script runs
+    CMutableTransaction non_standard{tx};
+    non_standard.nVersion = TX_MAX_STANDARD_VERSION + 1;
+    stats = verify(SerializeTx(non_standard));
+    BOOST_CHECK_EQUAL(stats.filtered, 1U);
+
+    DataStream malformed{SerializeTx(tx)};
+    malformed.resize(malformed.size() / 2);
+    stats = verify(std::move(malformed));
+    BOOST_CHECK_EQUAL(stats.filtered, 2U);
+
+    CMutableTransaction orphan{CreateValidMempoolTransaction(MakeTransactionRef(tx), /*input_vout=*/0, /*input_height=*/0, coinbaseKey, spk,
+                                                             coinbase_value - 2 * COIN, /*submit=*/false)};
+    stats = verify(SerializeTx(orphan));
+    BOOST_CHECK_EQUAL(stats.missing_inputs, 1U);
+
+    CMutableTransaction no_fee{CreateValidMempoolTransaction(m_coinbase_txns[1], /*input_vout=*/0, /*input_height=*/0, coinbaseKey, spk,
+                                                             m_coinbase_txns[1]->vout[0].nValue, /*submit=*/false)};
+    stats = verify(SerializeTx(no_fee));
+    BOOST_CHECK_EQUAL(stats.low_fee, 1U);
+
+    BOOST_CHECK_EQUAL(stats.verified, 2U);
+    BOOST_CHECK_EQUAL(stats.invalid, 1U);
+
+    // Acceptance gives the same result after the pre-verification
+    {
+        LOCK(cs_main);
+        const MempoolAcceptResult result{m_node.chainman->ProcessTransaction(MakeTransactionRef(tx))};
+        BOOST_CHECK(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+    }
+
+    // The parent is now in the mempool
+    stats = verify(SerializeTx(orphan));
+    BOOST_CHECK_EQUAL(stats.missing_inputs, 1U);
+    BOOST_CHECK_EQUAL(stats.verified, 3U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
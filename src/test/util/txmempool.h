@@ -25,6 +25,8 @@ struct TestMemPoolEntryHelper {
     bool spendsCoinbase{false};
     unsigned int sigOpCost{4};
     LockPoints lp;
+    CAmount minGasPrice{0};
+    uint64_t gasLimit{0};
 
     CTxMemPoolEntry FromTx(const CMutableTransaction& tx) const;
     CTxMemPoolEntry FromTx(const CTransactionRef& tx) const;
@@ -36,6 +38,8 @@ struct TestMemPoolEntryHelper {
     TestMemPoolEntryHelper& Sequence(uint64_t _seq) { m_sequence = _seq; return *this; }
     TestMemPoolEntryHelper& SpendsCoinbase(bool _flag) { spendsCoinbase = _flag; return *this; }
     TestMemPoolEntryHelper& SigOpsCost(unsigned int _sigopsCost) { sigOpCost = _sigopsCost; return *this; }
+    TestMemPoolEntryHelper& MinGasPrice(CAmount _minGasPrice) { minGasPrice = _minGasPrice; return *this; }
+    TestMemPoolEntryHelper& GasLimit(uint64_t _gasLimit) { gasLimit = _gasLimit; return *this; }
 };
 
 /** Check expected properties for every PackageMempoolAcceptResult, regardless of value. Returns
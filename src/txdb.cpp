@@ -90,6 +90,7 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase) {
     CDBBatch batch(*m_db);
+    const std::function<bool()> before_best_block = std::exchange(m_before_best_block, nullptr);
     size_t count = 0;
     size_t changed = 0;
     assert(!hashBlock.IsNull());
@@ -139,6 +140,18 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, boo
         }
     }
 
+    if (before_best_block) {
+        // Write the coins first, so that whatever the new best block waits for
+        // overlaps with the write of the coins.
+        LogPrint(BCLog::COINDB, "Writing batch of %.2f MiB before the best block\n", batch.SizeEstimate() * (1.0 / 1048576.0));
+        m_db->WriteBatch(batch);
+        batch.Clear();
+        if (!before_best_block()) {
+            LogPrintLevel(BCLog::COINDB, BCLog::Level::Error, "Not moving the best block of the coin database to %s\n", hashBlock.ToString());
+            return false;
+        }
+    }
+
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
@@ -14,6 +14,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -60,6 +61,7 @@ protected:
     DBParams m_db_params;
     CoinsViewOptions m_options;
     std::unique_ptr<CDBWrapper> m_db;
+    std::function<bool()> m_before_best_block;
 public:
     explicit CCoinsViewDB(DBParams db_params, CoinsViewOptions options);
 
@@ -70,6 +72,11 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase = true) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
 
+    //! Run before the next BatchWrite marks the database consistent with its
+    //! new best block, after the coins are written. If it returns false, the
+    //! write fails and the best block is not moved.
+    void SetBeforeBestBlock(std::function<bool()> before_best_block) { m_before_best_block = std::move(before_best_block); }
+
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
     size_t EstimateSize() const override;
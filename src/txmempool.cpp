@@ -511,6 +511,11 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 
     RemoveUnbroadcastTx(it->GetTx().GetHash(), true /* add logging because unchecked */);
 
+    if (fAddressIndex) {
+        removeAddressIndex(it->GetTx().GetHash());
+        removeSpentIndex(it->GetTx().GetHash());
+    }
+
     if (txns_randomized.size() > 1) {
         // Update idx_randomized of the to-be-moved entry.
         Assert(GetEntry(txns_randomized.back()->GetHash()))->idx_randomized = it->idx_randomized;
@@ -646,10 +651,6 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         }
         removeConflicts(*tx);
         ClearPrioritisation(tx->GetHash());
-        if(fAddressIndex) {
-            removeAddressIndex(tx->GetHash());
-            removeSpentIndex(tx->GetHash());
-        }
     }
     GetMainSignals().MempoolTransactionsRemovedForBlock(txs_removed_for_block, nBlockHeight);
     lastRollingFeeUpdate = GetTime();
@@ -1035,7 +1036,8 @@ void CCoinsViewMemPool::Reset()
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage +
+           memusage::DynamicUsage(mapAddress) + memusage::DynamicUsage(mapAddressInserted) + memusage::DynamicUsage(mapSpent) + memusage::DynamicUsage(mapSpentInserted) + cachedIndexUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked) {
@@ -1258,6 +1260,17 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
     std::vector<CMempoolAddressDeltaKey> inserted;
 
     uint256 txhash = tx.GetHash();
+    if (mapAddressInserted.count(txhash)) {
+        return;
+    }
+
+    auto insert = [&](const CMempoolAddressDeltaKey& key, const CMempoolAddressDelta& delta) EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        addressDeltaEntries& deltas = mapAddress[{key.addressBytes, key.type}];
+        if (deltas.emplace(key, delta).second) {
+            cachedIndexUsage += memusage::IncrementalDynamicUsage(deltas);
+            inserted.push_back(key);
+        }
+    };
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
         const CTxIn input = tx.vin[j];
         const CTxOut &prevout = view.GetOutputFor(input);
@@ -1273,8 +1286,7 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
             int addressIndexType = GetAddressIndexType(dest);
             CMempoolAddressDeltaKey key(addressIndexType, uint256(addressBytes), txhash, j, 1);
             CMempoolAddressDelta delta(entry.GetTime().count(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-            mapAddress.insert(std::make_pair(key, delta));
-            inserted.push_back(key);
+            insert(key, delta);
         }
     }
 
@@ -1291,22 +1303,22 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
             std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
             int addressIndexType = GetAddressIndexType(dest);
             CMempoolAddressDeltaKey key(addressIndexType, uint256(addressBytes), txhash, k, 0);
-            mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(entry.GetTime().count(), out.nValue)));
-            inserted.push_back(key);
+            insert(key, CMempoolAddressDelta(entry.GetTime().count(), out.nValue));
         }
     }
 
-    mapAddressInserted.insert(std::make_pair(txhash, inserted));
+    cachedIndexUsage += memusage::DynamicUsage(inserted);
+    mapAddressInserted.emplace(txhash, std::move(inserted));
 }
 
 bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint256, int> > &addresses, std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results)
 {
     LOCK(cs);
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        addressDeltaMap::iterator ait = mapAddress.lower_bound(CMempoolAddressDeltaKey((*it).second, (*it).first));
-        while (ait != mapAddress.end() && (*ait).first.addressBytes == (*it).first && (*ait).first.type == (*it).second) {
-            results.push_back(*ait);
-            ait++;
+        addressDeltaMap::const_iterator ait = mapAddress.find(*it);
+        if (ait != mapAddress.end()) {
+            // The entries of each address are in key order
+            results.insert(results.end(), ait->second.begin(), ait->second.end());
         }
     }
     return true;
@@ -1318,10 +1330,18 @@ bool CTxMemPool::removeAddressIndex(const uint256 txhash)
     addressDeltaMapInserted::iterator it = mapAddressInserted.find(txhash);
 
     if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
+        for (const CMempoolAddressDeltaKey& key : it->second) {
+            addressDeltaMap::iterator ait = mapAddress.find({key.addressBytes, key.type});
+            if (ait == mapAddress.end()) continue;
+            addressDeltaEntries& deltas = ait->second;
+            if (deltas.erase(key)) {
+                cachedIndexUsage -= memusage::IncrementalDynamicUsage(deltas);
+            }
+            if (deltas.empty()) {
+                mapAddress.erase(ait);
+            }
         }
+        cachedIndexUsage -= memusage::DynamicUsage(it->second);
         mapAddressInserted.erase(it);
     }
 
@@ -1336,6 +1356,9 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
     std::vector<CSpentIndexKey> inserted;
 
     uint256 txhash = tx.GetHash();
+    if (mapSpentInserted.count(txhash)) {
+        return;
+    }
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
         const CTxIn input = tx.vin[j];
         const CTxOut &prevout = view.GetOutputFor(input);
@@ -1373,11 +1396,12 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
         CSpentIndexKey key = CSpentIndexKey(input.prevout.hash, input.prevout.n);
         CSpentIndexValue value = CSpentIndexValue(txhash, j, -1, prevout.nValue, addressType, addressHash);
 
-        mapSpent.insert(std::make_pair(key, value));
+        mapSpent.emplace(key, value);
         inserted.push_back(key);
     }
 
-    mapSpentInserted.insert(std::make_pair(txhash, inserted));
+    cachedIndexUsage += memusage::DynamicUsage(inserted);
+    mapSpentInserted.emplace(txhash, std::move(inserted));
 }
 
 bool CTxMemPool::getSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) const
@@ -1399,10 +1423,10 @@ bool CTxMemPool::removeSpentIndex(const uint256 txhash)
     mapSpentIndexInserted::iterator it = mapSpentInserted.find(txhash);
 
     if (it != mapSpentInserted.end()) {
-        std::vector<CSpentIndexKey> keys = (*it).second;
-        for (std::vector<CSpentIndexKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapSpent.erase(*mit);
+        for (const CSpentIndexKey& key : it->second) {
+            mapSpent.erase(key);
         }
+        cachedIndexUsage -= memusage::DynamicUsage(it->second);
         mapSpentInserted.erase(it);
     }
 
@@ -17,6 +17,7 @@
 #include <policy/feerate.h>
 #include <policy/packages.h>
 #include <primitives/transaction.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <util/epochguard.h>
 #include <util/hasher.h>
@@ -36,6 +37,7 @@
 #include <set>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -50,14 +52,33 @@ static const uint32_t MEMPOOL_HEIGHT = 0x0FFFFFFF;
 bool TestLockPointValidity(CChain& active_chain, const LockPoints& lp) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 //////////////////////////////////////////////////////// // qtum
-struct CSpentIndexKeyCompare
+struct CSpentIndexKeyEqual
 {
     bool operator()(const CSpentIndexKey& a, const CSpentIndexKey& b) const {
-        if (a.txid == b.txid) {
-            return a.outputIndex < b.outputIndex;
-        } else {
-            return a.txid < b.txid;
-        }
+        return a.txid == b.txid && a.outputIndex == b.outputIndex;
+    }
+};
+
+class SaltedSpentIndexKeyHasher
+{
+private:
+    SaltedOutpointHasher hasher;
+
+public:
+    size_t operator()(const CSpentIndexKey& key) const noexcept {
+        return hasher(COutPoint(Txid::FromUint256(key.txid), key.outputIndex));
+    }
+};
+
+/** Hashes the (address hash, address type) pairs used to query the mempool address index */
+class SaltedMempoolAddressHasher
+{
+private:
+    SaltedTxidHasher hasher;
+
+public:
+    size_t operator()(const std::pair<uint256, int>& address) const {
+        return hasher(address.first) ^ static_cast<size_t>(address.second);
     }
 };
 
@@ -542,17 +563,30 @@ private:
     typedef std::map<txiter, setEntries, CompareIteratorByHash> cacheMap;
 
     //////////////////////////////////////////////////////////////// // qtum
-    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
-    addressDeltaMap mapAddress;
-
-    typedef std::map<uint256, std::vector<CMempoolAddressDeltaKey> > addressDeltaMapInserted;
-    addressDeltaMapInserted mapAddressInserted;
-
-    typedef std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare> mapSpentIndex;
-    mapSpentIndex mapSpent;
-
-    typedef std::map<uint256, std::vector<CSpentIndexKey> > mapSpentIndexInserted;
-    mapSpentIndexInserted mapSpentInserted;
+    // Address index entries grouped by (address hash, address type), in key order so that
+    // the entries of a transaction are removed in logarithmic time even for busy addresses
+    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaEntries;
+    typedef std::unordered_map<std::pair<uint256, int>, addressDeltaEntries, SaltedMempoolAddressHasher> addressDeltaMap;
+    addressDeltaMap mapAddress GUARDED_BY(cs);
+
+    typedef std::unordered_map<uint256, std::vector<CMempoolAddressDeltaKey>, SaltedTxidHasher> addressDeltaMapInserted;
+    addressDeltaMapInserted mapAddressInserted GUARDED_BY(cs);
+
+    // Spent index entries are allocated from a pool, like the coins cache
+    typedef std::unordered_map<CSpentIndexKey,
+                               CSpentIndexValue,
+                               SaltedSpentIndexKeyHasher,
+                               CSpentIndexKeyEqual,
+                               PoolAllocator<std::pair<const CSpentIndexKey, CSpentIndexValue>,
+                                             sizeof(std::pair<const CSpentIndexKey, CSpentIndexValue>) + sizeof(void*) * 4>> mapSpentIndex;
+    mapSpentIndex::allocator_type::ResourceType m_spent_index_resource;
+    mapSpentIndex mapSpent GUARDED_BY(cs){0, SaltedSpentIndexKeyHasher{}, CSpentIndexKeyEqual{}, &m_spent_index_resource};
+
+    typedef std::unordered_map<uint256, std::vector<CSpentIndexKey>, SaltedTxidHasher> mapSpentIndexInserted;
+    mapSpentIndexInserted mapSpentInserted GUARDED_BY(cs);
+
+    //! Sum of dynamic memory usage of the vectors in the address and spent indexes (NOT the maps themselves)
+    uint64_t cachedIndexUsage GUARDED_BY(cs){0};
     ////////////////////////////////////////////////////////////////
 
     void UpdateParent(txiter entry, txiter parent, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
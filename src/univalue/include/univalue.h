@@ -9,6 +9,7 @@
 #include <charconv>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -146,6 +147,41 @@ Int UniValue::getInt() const
     return result;
 }
 
+/**
+ * Incremental JSON writer for results too large to be built as a single
+ * UniValue. Objects and arrays are opened and closed explicitly and their
+ * members are written one at a time, giving the same output as a compact
+ * UniValue::write() of the whole result. The output is passed to the sink
+ * in pieces of about chunkSize bytes, so it is never held in full.
+ */
+class UniValueStreamWriter {
+public:
+    using Sink = std::function<void(std::string_view)>;
+
+    explicit UniValueStreamWriter(Sink sink, size_t chunkSize = 64 * 1024);
+
+    void beginObject();
+    void beginArray();
+    // Close the innermost open object or array
+    void end();
+    // Write the key of the next member of an object
+    void key(std::string_view key);
+    // Write a whole value, as an array element or after key()
+    void value(const UniValue& val);
+    // Pass the pending output to the sink
+    void flush();
+
+private:
+    Sink sink;
+    size_t chunkSize;
+    std::string buf;
+    std::vector<std::pair<bool, bool>> stack; // (is object, has members) per open container
+    bool afterKey{false};
+
+    void beginValue();
+    void endValue();
+};
+
 enum jtokentype {
     JTOK_ERR        = -1,
     JTOK_NONE       = 0,                           // eof
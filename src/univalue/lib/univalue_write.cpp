@@ -6,7 +6,10 @@
 #include <univalue_escapes.h>
 
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 static std::string json_escape(const std::string& inS)
@@ -112,3 +115,79 @@ void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel,
     s += "}";
 }
 
+
+UniValueStreamWriter::UniValueStreamWriter(Sink sinkIn, size_t chunkSizeIn)
+    : sink(std::move(sinkIn)), chunkSize(chunkSizeIn)
+{
+    buf.reserve(chunkSize);
+}
+
+void UniValueStreamWriter::beginValue()
+{
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (stack.empty())
+        return;
+    if (stack.back().first)
+        throw std::runtime_error("JSON object member written without a key");
+    if (stack.back().second)
+        buf += ",";
+    stack.back().second = true;
+}
+
+void UniValueStreamWriter::endValue()
+{
+    if (buf.size() >= chunkSize)
+        flush();
+}
+
+void UniValueStreamWriter::beginObject()
+{
+    beginValue();
+    buf += "{";
+    stack.emplace_back(true, false);
+}
+
+void UniValueStreamWriter::beginArray()
+{
+    beginValue();
+    buf += "[";
+    stack.emplace_back(false, false);
+}
+
+void UniValueStreamWriter::end()
+{
+    if (stack.empty() || afterKey)
+        throw std::runtime_error("JSON container closed while not open");
+    buf += stack.back().first ? "}" : "]";
+    stack.pop_back();
+    endValue();
+}
+
+void UniValueStreamWriter::key(std::string_view key)
+{
+    if (stack.empty() || !stack.back().first || afterKey)
+        throw std::runtime_error("JSON key written outside of an object");
+    if (stack.back().second)
+        buf += ",";
+    stack.back().second = true;
+    buf += "\"" + json_escape(std::string(key)) + "\":";
+    afterKey = true;
+}
+
+void UniValueStreamWriter::value(const UniValue& val)
+{
+    beginValue();
+    buf += val.write();
+    endValue();
+}
+
+void UniValueStreamWriter::flush()
+{
+    if (buf.empty())
+        return;
+    sink(buf);
+    buf.clear();
+}
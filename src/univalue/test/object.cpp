@@ -455,6 +455,57 @@ void univalue_readwrite()
     BOOST_CHECK(!v.read("{} 42"));
 }
 
+void univalue_streamwriter()
+{
+    UniValue v;
+    BOOST_CHECK(v.read(json1));
+
+    auto write_json1 = [&](UniValueStreamWriter& writer) {
+        writer.beginArray();
+        writer.value(v[0]);
+        writer.beginObject();
+        for (const std::string& key : v[1].getKeys()) {
+            writer.key(key);
+            writer.value(v[1][key]);
+        }
+        writer.end();
+        writer.beginArray();
+        writer.end();
+        writer.end();
+    };
+
+    // Tiny chunks, so that the sink is called for nearly every element
+    std::string out;
+    size_t chunks = 0;
+    UniValueStreamWriter writer([&](std::string_view chunk) {
+        out.append(chunk);
+        ++chunks;
+    }, 4);
+    write_json1(writer);
+    writer.flush();
+    BOOST_CHECK(chunks > 1);
+    BOOST_CHECK_EQUAL(out, "[1.10000000,{\"key1\":\"str\\u0000\",\"key2\":800,\"key3\":{\"name\":\"martian http://test.com\"}},[]]");
+
+    // Same output as a single write, held until flushed
+    out.clear();
+    UniValue copy(UniValue::VARR);
+    copy.push_back(v[0]);
+    copy.push_back(v[1]);
+    copy.push_back(UniValue(UniValue::VARR));
+    UniValueStreamWriter writer2([&](std::string_view chunk) { out.append(chunk); });
+    write_json1(writer2);
+    BOOST_CHECK(out.empty());
+    writer2.flush();
+    BOOST_CHECK_EQUAL(out, copy.write());
+
+    // Misuse
+    UniValueStreamWriter writer3([](std::string_view) {});
+    BOOST_CHECK_THROW(writer3.end(), std::runtime_error);
+    BOOST_CHECK_THROW(writer3.key("a"), std::runtime_error);
+    writer3.beginObject();
+    BOOST_CHECK_THROW(writer3.value(v[0]), std::runtime_error);
+}
+
 int main(int argc, char* argv[])
 {
     univalue_constructor();
@@ -464,5 +515,6 @@ int main(int argc, char* argv[])
     univalue_array();
     univalue_object();
     univalue_readwrite();
+    univalue_streamwriter();
     return 0;
 }
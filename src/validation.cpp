@@ -32,6 +32,7 @@
 #include <kernel/notifications_interface.h>
 #include <logging.h>
 #include <logging/timer.h>
+#include <node/blockprefetcher.h>
 #include <node/blockstorage.h>
 #include <node/utxo_snapshot.h>
 #include <node/transaction.h>
@@ -72,6 +73,7 @@
 #include <libethcore/ABI.h>
 #include <univalue.h>
 #include <util/signstr.h>
+#include <qtum/qtumsnapshot.h>
 #include <qtum/qtumutils.h>
 #include <common/args.h>
 #include <addresstype.h>
@@ -80,6 +82,7 @@
 #include <cassert>
 #include <chrono>
 #include <deque>
+#include <future>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -890,6 +893,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     int64_t nSigOpsCost = GetTransactionSigOpCost(tx, m_view, STANDARD_SCRIPT_VERIFY_FLAGS);
 
     dev::u256 txMinGasPrice = 0;
+    uint64_t txGasLimit = 0;
 
     //////////////////////////////////////////////////////////// // qtum
     if(!CheckOpSender(tx, chainparams, m_active_chainstate.m_chain.Height() + 1)){
@@ -958,6 +962,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
             gasAllTxs += qtumTransaction.gas();
             if(gasAllTxs > dev::u256(blockGasLimit))
                 return state.Invalid(TxValidationResult::TX_GAS_EXCEEDS_LIMIT, "bad-txns-gas-exceeds-blockgaslimit");
+            txGasLimit = (uint64_t)gasAllTxs;
 
             //don't allow less than DGP set minimum gas price to prevent MPoS greedy mining/spammers
             if(v.rootVM!=0 && (uint64_t)qtumTransaction.gasPrice() < minGasPrice)
@@ -991,7 +996,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     // reorg to be marked earlier than any child txs that were already in the mempool.
     const uint64_t entry_sequence = bypass_limits ? 0 : m_pool.GetSequence();
     entry.reset(new CTxMemPoolEntry(ptx, ws.m_base_fees, nAcceptTime, m_active_chainstate.m_chain.Height(), entry_sequence,
-                                    fSpendsCoinbase, nSigOpsCost, lock_points.value(), CAmount(txMinGasPrice)));
+                                    fSpendsCoinbase, nSigOpsCost, lock_points.value(), CAmount(txMinGasPrice), txGasLimit));
     ws.m_vsize = entry->GetTxSize();
 
     if (nSigOpsCost > dgpMaxTxSigOps)
@@ -2392,6 +2397,13 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     globalState->setRootUTXO(uintToh256(pindex->pprev->hashUTXORoot)); // qtum
 
     if(pfClean == NULL && fLogEvents){
+        m_block_receipts.clear();
+        for (const CTransactionRef& tx : block.vtx) {
+            if (tx->HasCreateOrCall()) {
+                std::vector<TransactionReceiptInfo> tri = pstorageresult->getResult(uintToh256(tx->GetHash()));
+                m_block_receipts.insert(m_block_receipts.end(), tri.begin(), tri.end());
+            }
+        }
         pstorageresult->deleteResults(block.vtx);
         m_blockman.m_block_tree_db->EraseHeightIndex(pindex->nHeight);
     }
@@ -3461,6 +3473,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
     std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
     std::map<dev::Address, std::pair<CHeightTxIndexKey, std::vector<uint256>>> heightIndexes;
+    m_block_receipts.clear();
     /////////////////////////////////////////////////////////
 
     uint64_t blockGasUsed = 0;
@@ -3714,6 +3727,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                     });
                 }
 
+                m_block_receipts.insert(m_block_receipts.end(), tri.begin(), tri.end());
                 pstorageresult->addResult(uintToh256(tx.GetHash()), tri);
             }
 
@@ -4102,6 +4116,19 @@ bool Chainstate::FlushStateToDisk(
         bool fPeriodicFlush = mode == FlushStateMode::PERIODIC && nNow > m_last_flush + DATABASE_FLUSH_INTERVAL;
         // Combine all conditions that result in a full cache flush.
         fDoFullFlush = (mode == FlushStateMode::ALWAYS) || fCacheLarge || fCacheCritical || fPeriodicFlush || fFlushForPrune;
+        // The contract state and receipts are committed to their databases
+        // after every block without waiting for the disk. Before the coins
+        // database moves its best block forward they must be durable too, so
+        // sync them in the background while the block index and the coins
+        // are written.
+        std::vector<std::future<void>> contract_db_syncs;
+        if (fDoFullFlush && !CoinsTip().GetBestBlock().IsNull() && globalState) {
+            contract_db_syncs.push_back(std::async(std::launch::async, [] { globalState->db().sync(); }));
+            contract_db_syncs.push_back(std::async(std::launch::async, [] { globalState->dbUtxo().sync(); }));
+            if (pstorageresult) {
+                contract_db_syncs.push_back(std::async(std::launch::async, [] { pstorageresult->syncResults(); }));
+            }
+        }
         // Write blocks and block index to disk.
         if (fDoFullFlush || fPeriodicWrite) {
             // Ensure we can write block index
@@ -4148,9 +4175,32 @@ bool Chainstate::FlushStateToDisk(
             if (!CheckDiskSpace(m_chainman.m_options.datadir, 48 * 2 * 2 * CoinsTip().GetCacheSize())) {
                 return FatalError(m_chainman.GetNotifications(), state, "Disk space is too low!", _("Disk space is too low!"));
             }
-            // Flush the chainstate (which may refer to block index entries).
-            if (!CoinsTip().Flush())
+            // Only wait for the contract state once the coins are written, just
+            // before the best block is moved.
+            std::string contract_db_error;
+            if (!contract_db_syncs.empty()) {
+                CoinsDB().SetBeforeBestBlock([&] {
+                    LOG_TIME_MILLIS_WITH_CATEGORY("wait for contract state sync", BCLog::BENCH);
+
+                    try {
+                        for (auto& sync : contract_db_syncs) {
+                            sync.get();
+                        }
+                    } catch (const std::exception& e) {
+                        contract_db_error = e.what();
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            // Flush the chainstate (which may refer to block index entries
+            // and contract state).
+            if (!CoinsTip().Flush()) {
+                if (!contract_db_error.empty()) {
+                    return FatalError(m_chainman.GetNotifications(), state, "Failed to write to contract state database: " + contract_db_error);
+                }
                 return FatalError(m_chainman.GetNotifications(), state, "Failed to write to coin database");
+            }
             m_last_flush = nNow;
             full_flush_completed = true;
             TRACE5(utxocache, flush,
@@ -4331,6 +4381,10 @@ bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTra
     // Let wallets know transactions went from 1-confirmed to
     // 0-confirmed or conflicted:
     GetMainSignals().BlockDisconnected(pblock, pindexDelete);
+    if (!m_block_receipts.empty()) {
+        GetMainSignals().BlockContractReceipts(pblock, pindexDelete, std::make_shared<const std::vector<TransactionReceiptInfo>>(std::move(m_block_receipts)), /*connected=*/false);
+        m_block_receipts.clear();
+    }
     return true;
 }
 
@@ -4342,6 +4396,7 @@ static SteadyClock::duration time_post_connect{};
 struct PerBlockConnectTrace {
     CBlockIndex* pindex = nullptr;
     std::shared_ptr<const CBlock> pblock;
+    std::shared_ptr<const std::vector<TransactionReceiptInfo>> receipts; // qtum
     PerBlockConnectTrace() = default;
 };
 /**
@@ -4358,12 +4413,15 @@ private:
 public:
     explicit ConnectTrace() : blocksConnected(1) {}
 
-    void BlockConnected(CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock) {
+    void BlockConnected(CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock, std::vector<TransactionReceiptInfo> receipts) {
         assert(!blocksConnected.back().pindex);
         assert(pindex);
         assert(pblock);
         blocksConnected.back().pindex = pindex;
         blocksConnected.back().pblock = std::move(pblock);
+        if (!receipts.empty()) {
+            blocksConnected.back().receipts = std::make_shared<const std::vector<TransactionReceiptInfo>>(std::move(receipts));
+        }
         blocksConnected.emplace_back();
     }
 
@@ -4484,7 +4542,8 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
         m_chainman.MaybeCompleteSnapshotValidation();
     }
 
-    connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
+    connectTrace.BlockConnected(pindexNew, std::move(pthisBlock), std::move(m_block_receipts));
+    m_block_receipts.clear();
     return true;
 }
 
@@ -4766,6 +4825,9 @@ bool Chainstate::ActivateBestChain(BlockValidationState& state, std::shared_ptr<
                 for (const PerBlockConnectTrace& trace : connectTrace.GetBlocksConnected()) {
                     assert(trace.pblock && trace.pindex);
                     GetMainSignals().BlockConnected(this->GetRole(), trace.pblock, trace.pindex);
+                    if (trace.receipts && this->GetRole() != ChainstateRole::BACKGROUND) {
+                        GetMainSignals().BlockContractReceipts(trace.pblock, trace.pindex, trace.receipts, /*connected=*/true);
+                    }
                 }
 
                 // This will have been toggled in
@@ -5980,7 +6042,7 @@ void ChainstateManager::ReportHeadersPresync(const arith_uint256& work, int64_t
 }
 
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
-bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked)
+bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked, std::optional<unsigned int> stored_size)
 {
     const CBlock& block = *pblock;
 
@@ -6091,7 +6153,7 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
     // Write block to history file
     if (fNewBlock) *fNewBlock = true;
     try {
-        FlatFilePos blockPos{m_blockman.SaveBlockToDisk(block, pindex->nHeight, dbp)};
+        FlatFilePos blockPos{m_blockman.SaveBlockToDisk(block, pindex->nHeight, dbp, stored_size)};
         if (blockPos.IsNull()) {
             state.Error(strprintf("%s: Failed to find position to write new block to disk", __func__));
             return false;
@@ -6664,6 +6726,14 @@ void ChainstateManager::LoadExternalBlockFile(
     const auto start{SteadyClock::now()};
     const CChainParams& params{GetParams()};
 
+    // During -reindex, read and deserialize the blocks of this file ahead of acceptance on background threads
+    std::unique_ptr<node::BlockFilePrefetcher> prefetcher;
+    if (dbp && !dbp->IsNull() && m_options.reindex_parse_threads > 0) {
+        if (std::FILE* prefetch_file{m_blockman.OpenBlockFile({dbp->nFile, 0}, true).release()}) {
+            prefetcher = std::make_unique<node::BlockFilePrefetcher>(prefetch_file, params.MessageStart(), dgpMaxBlockSerSize, m_options.reindex_parse_threads);
+        }
+    }
+
     int nLoaded = 0;
     try {
         BufferedFile blkdat{file_in, 2 * dgpMaxBlockSerSize, dgpMaxBlockSerSize + 8};
@@ -6677,6 +6747,7 @@ void ChainstateManager::LoadExternalBlockFile(
             nRewind++; // start one byte further next time, in case of failure
             blkdat.SetLimit(); // remove former limit
             unsigned int nSize = 0;
+            bool compressed = false;
             try {
                 // locate a header
                 MessageStartChars buf;
@@ -6688,7 +6759,9 @@ void ChainstateManager::LoadExternalBlockFile(
                 }
                 // read size
                 blkdat >> nSize;
-                if (nSize < 80 || nSize > dgpMaxBlockSerSize)
+                compressed = nSize & node::BLOCK_COMPRESSED_FLAG;
+                nSize &= ~node::BLOCK_COMPRESSED_FLAG;
+                if (nSize < (compressed ? sizeof(uint32_t) : 80) || nSize > dgpMaxBlockSerSize)
                     continue;
             } catch (const std::exception&) {
                 // no valid block header found; don't complain
@@ -6701,13 +6774,32 @@ void ChainstateManager::LoadExternalBlockFile(
                 if (dbp)
                     dbp->nPos = nBlockPos;
                 blkdat.SetLimit(nBlockPos + nSize);
+                // A compressed block is inflated up front, its header and body are then read from memory.
+                // The prefetcher already inflates it on its own threads, so its block is used instead.
+                std::vector<uint8_t> block_data;
+                std::shared_ptr<CBlock> prefetched;
+                if (compressed && prefetcher) prefetched = prefetcher->Take(nBlockPos, nSize);
+                if (compressed && !prefetched) {
+                    std::vector<uint8_t> compressed_data(nSize);
+                    blkdat.read(MakeWritableByteSpan(compressed_data));
+                    if (!node::DecompressBlockData(compressed_data, block_data)) {
+                        throw std::ios_base::failure("failed to decompress block");
+                    }
+                }
                 CBlockHeader header;
-                blkdat >> header;
+                if (prefetched) {
+                    header = prefetched->GetBlockHeader();
+                } else if (compressed) {
+                    SpanReader{block_data} >> header;
+                } else {
+                    blkdat >> header;
+                }
                 const uint256 hash{header.GetHash()};
                 // Skip the rest of this block (this may read from disk into memory); position to the marker before the
                 // next block, but it's still possible to rewind to the start of the current block (without a disk read).
                 nRewind = nBlockPos + nSize;
                 blkdat.SkipTo(nRewind);
+                if (prefetcher) prefetcher->Release(nBlockPos);
 
                 std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
 
@@ -6727,13 +6819,23 @@ void ChainstateManager::LoadExternalBlockFile(
                     const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
                     if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
                         // This block can be processed immediately; rewind to its start, read and deserialize it.
-                        blkdat.SetPos(nBlockPos);
-                        pblock = std::make_shared<CBlock>();
-                        blkdat >> TX_WITH_WITNESS(*pblock);
+                        // A block parsed by the prefetcher spans the whole record, so the stream is left at the
+                        // same position as after deserializing it here.
+                        pblock = std::move(prefetched);
+                        if (!pblock && prefetcher && !compressed) pblock = prefetcher->Take(nBlockPos, nSize);
+                        if (!pblock) {
+                            pblock = std::make_shared<CBlock>();
+                            if (compressed) {
+                                SpanReader{block_data} >> TX_WITH_WITNESS(*pblock);
+                            } else {
+                                blkdat.SetPos(nBlockPos);
+                                blkdat >> TX_WITH_WITNESS(*pblock);
+                            }
+                        }
                         nRewind = blkdat.GetPos();
 
                         BlockValidationState state;
-                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
+                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true, nSize)) {
                             nLoaded++;
                         }
                         if (state.IsError()) {
@@ -6797,12 +6899,13 @@ void ChainstateManager::LoadExternalBlockFile(
                     while (range.first != range.second) {
                         std::multimap<uint256, FlatFilePos>::iterator it = range.first;
                         std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
+                        unsigned int stored_size;
+                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second, &stored_size)) {
                             LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
                                     head.ToString());
                             LOCK(cs_main);
                             BlockValidationState dummy;
-                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
+                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true, stored_size)) {
                                 nLoaded++;
                                 queue.push_back(pblockrecursive->GetHash());
                             }
@@ -7480,12 +7583,18 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     while (coins_left > 0) {
         try {
             coins_file >> outpoint;
-            coins_file >> coin;
+            if (!outpoint.IsNull()) coins_file >> coin;
         } catch (const std::ios_base::failure&) {
             LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
                       coins_count - coins_left);
             return false;
         }
+        // The contract state section starts with a null outpoint
+        if (outpoint.IsNull()) {
+            LogPrintf("[snapshot] bad snapshot - contract state found after deserializing %d coins\n",
+                      coins_count - coins_left);
+            return false;
+        }
         if (coin.nHeight > base_height ||
             outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
         ) {
@@ -7542,6 +7651,18 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
+    // The contract state of the base block follows the coins. It is checked
+    // against the state roots in the base block header while it is loaded.
+    LogPrintf("[snapshot] loading contract state from snapshot %s\n", base_blockhash.ToString());
+    dev::OverlayDB state_db = WITH_LOCK(::cs_main, return globalState->db());
+    dev::OverlayDB utxo_db = WITH_LOCK(::cs_main, return globalState->dbUtxo());
+    if (!LoadContractStateSnapshot(coins_file,
+                                   state_db, snapshot_start_block->hashStateRoot,
+                                   utxo_db, snapshot_start_block->hashUTXORoot,
+                                   [&interrupt = m_interrupt] { return static_cast<bool>(interrupt); })) {
+        return false;
+    }
+
     bool out_of_coins{false};
     try {
         coins_file >> outpoint;
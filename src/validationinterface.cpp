@@ -255,6 +255,17 @@ void CMainSignals::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock
                           pindex->nHeight);
 }
 
+void CMainSignals::BlockContractReceipts(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::shared_ptr<const std::vector<TransactionReceiptInfo>>& receipts, bool connected)
+{
+    auto event = [pblock, pindex, receipts, connected, this] {
+        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.BlockContractReceipts(pblock, pindex, receipts, connected); });
+    };
+    ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s block height=%d connected=%d", __func__,
+                          pblock->GetHash().ToString(),
+                          pindex->nHeight,
+                          connected);
+}
+
 void CMainSignals::ChainStateFlushed(ChainstateRole role, const CBlockLocator &locator) {
     auto event = [role, locator, this] {
         m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.ChainStateFlushed(role, locator); });
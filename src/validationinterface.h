@@ -13,6 +13,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 class BlockValidationState;
 class CBlock;
@@ -23,6 +24,7 @@ class CScheduler;
 enum class MemPoolRemovalReason;
 struct RemovedMempoolTransactionInfo;
 struct NewMempoolTransactionInfo;
+struct TransactionReceiptInfo;
 
 /** Register subscriber */
 void RegisterValidationInterface(CValidationInterface* callbacks);
@@ -156,6 +158,15 @@ protected:
      * background chainstates should never disconnect blocks.
      */
     virtual void BlockDisconnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex* pindex) {}
+    /**
+     * Notifies listeners of the contract receipts of a block connected to or
+     * disconnected from the active chain, right after BlockConnected or
+     * BlockDisconnected. Only called with -logevents, for blocks with contract
+     * executions. (qtum)
+     *
+     * Called on a background thread.
+     */
+    virtual void BlockContractReceipts(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::shared_ptr<const std::vector<TransactionReceiptInfo>>& receipts, bool connected) {}
     /**
      * Notifies listeners of the new active block chain on-disk.
      *
@@ -216,6 +227,7 @@ public:
     void MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>&, unsigned int nBlockHeight);
     void BlockConnected(ChainstateRole, const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex);
     void BlockDisconnected(const std::shared_ptr<const CBlock> &, const CBlockIndex* pindex);
+    void BlockContractReceipts(const std::shared_ptr<const CBlock>&, const CBlockIndex* pindex, const std::shared_ptr<const std::vector<TransactionReceiptInfo>>& receipts, bool connected);
     void ChainStateFlushed(ChainstateRole, const CBlockLocator &);
     void BlockChecked(const CBlock&, const BlockValidationState&);
     void NewPoWValidBlock(const CBlockIndex *, const std::shared_ptr<const CBlock>&);
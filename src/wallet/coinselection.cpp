@@ -688,6 +688,20 @@ util::Result<SelectionResult> KnapsackSolver(std::vector<OutputGroup>& groups, c
 
     // Solve subset sum by stochastic approximation
     std::sort(applicable_groups.begin(), applicable_groups.end(), descending);
+
+    // Wallets with very many small outputs, like the staking rewards, would make the approximation
+    // take too long, so only search among the largest groups, as long as they still reach the target
+    if (applicable_groups.size() > KNAPSACK_MAX_GROUPS) {
+        size_t count = 0;
+        CAmount total = 0;
+        for (const OutputGroup& group : applicable_groups) {
+            if (count >= KNAPSACK_MAX_GROUPS && total >= nTargetValue + change_target) break;
+            total += group.GetSelectionAmount();
+            ++count;
+        }
+        applicable_groups.resize(count);
+        nTotalLower = total;
+    }
     std::vector<char> vfBest;
     CAmount nBest;
 
@@ -23,6 +23,8 @@ namespace wallet {
 static constexpr CAmount CHANGE_LOWER{50000};
 //! upper bound for randomly-chosen target change amount
 static constexpr CAmount CHANGE_UPPER{1000000};
+//! maximum number of groups smaller than the target searched by the knapsack solver, the largest ones are kept
+static constexpr size_t KNAPSACK_MAX_GROUPS{5000};
 
 /** A UTXO under consideration for use in funding a new transaction. */
 struct COutput {
@@ -0,0 +1,154 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/consolidate.h>
+
+#include <chainparams.h>
+#include <interfaces/chain.h>
+#include <policy/feerate.h>
+#include <util/moneystr.h>
+#include <util/translation.h>
+#include <wallet/coincontrol.h>
+#include <wallet/context.h>
+#include <wallet/fees.h>
+#include <wallet/spend.h>
+#include <wallet/wallet.h>
+
+#include <algorithm>
+#include <map>
+
+using interfaces::FoundBlock;
+
+namespace wallet {
+ConsolidationPlan PlanConsolidation(std::vector<ConsolidationCoin> coins, const ConsolidationParams& params)
+{
+    ConsolidationPlan plan;
+    if (params.excess == 0 || params.target_value <= 0) return plan;
+
+    // Spend the smallest outputs first, they have the least stake weight
+    std::sort(coins.begin(), coins.end(), [](const ConsolidationCoin& a, const ConsolidationCoin& b) {
+        return a.value < b.value;
+    });
+
+    const size_t max_inputs = std::min(CONSOLIDATE_MAX_INPUTS, params.excess + 1);
+    CAmount weight_budget = params.weight_budget;
+    for (const ConsolidationCoin& coin : coins) {
+        if (plan.inputs.size() >= max_inputs) break;
+        if (coin.has_weight) {
+            // The larger outputs don't fit in the budget either
+            if (coin.value > weight_budget) break;
+            weight_budget -= coin.value;
+        }
+        plan.inputs.push_back(coin.outpoint);
+        plan.total += coin.value;
+    }
+
+    if (plan.inputs.size() < 2) return {};
+    plan.outputs = std::max<CAmount>(1, plan.total / params.target_value);
+    return plan;
+}
+
+bool ConsolidateStakingCoins(CWallet& wallet)
+{
+    if (wallet.IsLocked() || wallet.m_wallet_unlock_staking_only) return false;
+    if (wallet.chain().isInitialBlockDownload()) return false;
+
+    // Only consolidate while the fees are at their lowest
+    CCoinControl coin_control;
+    const CFeeRate feerate = GetMinimumFeeRate(wallet, coin_control, /*feeCalc=*/nullptr);
+    if (feerate > std::max(wallet.m_consolidate_feerate, GetRequiredFeeRate(wallet))) return false;
+
+    // The coins are chosen and spent under the wallet lock, which the staker holds while it
+    // picks the coins of its coinstake, so both never spend the same coin
+    LOCK(wallet.cs_wallet);
+
+    // Wait for the wallet to catch up with the chain, the coins spent by the last blocks are only known then.
+    // The scheduler thread also delivers the notifications, so check it instead of blocking.
+    bool in_active_chain{false};
+    if (!wallet.chain().findBlock(wallet.GetLastBlockHash(), FoundBlock().inActiveChain(in_active_chain)) || !in_active_chain ||
+        wallet.chain().getHeight() != wallet.GetLastBlockHeight()) return false;
+
+    // Wait for the last consolidation to be confirmed
+    if (!wallet.m_last_consolidation_txid.IsNull()) {
+        auto it = wallet.mapWallet.find(wallet.m_last_consolidation_txid);
+        if (it != wallet.mapWallet.end() && wallet.GetTxDepthInMainChain(it->second) == 0 && it->second.InMempool()) return false;
+    }
+
+    std::map<uint160, std::vector<ConsolidationCoin>> coins_by_address;
+    size_t small_coins = 0;
+    CAmount mature_value = 0;
+    CAmount immature_value = 0;
+    const int coinbase_maturity = Params().GetConsensus().CoinbaseMaturity(wallet.GetLastBlockHeight() + 1);
+    for (const CStakeableCoin& coin : wallet.GetStakeableCoins()) {
+        if ((coin.mine & ISMINE_SPENDABLE) == ISMINE_NO) continue;
+
+        const bool has_weight = coin.value >= wallet.m_staker_min_utxo_size && wallet.GetTxDepthInMainChain(*coin.wtx) >= coinbase_maturity;
+        if (has_weight) {
+            mature_value += coin.value;
+        } else if (coin.wtx->mapValue.count("consolidation")) {
+            immature_value += coin.value;
+        }
+
+        if (coin.value >= wallet.m_staking_consolidate_value) continue;
+        ++small_coins;
+
+        // Skip the coins of the coinstake the staker is creating
+        const COutPoint prevout(coin.wtx->GetHash(), coin.n);
+        if (wallet.GetTxBlocksToMaturity(*coin.wtx) > 0 || wallet.IsLockedCoin(prevout) || wallet.m_staking_coins_in_use.count(prevout)) continue;
+        coins_by_address[coin.script.keyId].push_back({prevout, coin.value, has_weight});
+    }
+
+    if (small_coins <= (size_t)wallet.m_staking_consolidate_max_utxos || coins_by_address.empty()) return false;
+
+    // Consolidate the address with the most small outputs, the others are done in the next runs
+    auto address = std::max_element(coins_by_address.begin(), coins_by_address.end(), [](const auto& a, const auto& b) {
+        return a.second.size() < b.second.size();
+    });
+
+    // The consolidated outputs have no stake weight until they are mature, so only
+    // spend outputs with weight while that does not lower the weight too much
+    ConsolidationParams params;
+    params.excess = small_coins - wallet.m_staking_consolidate_max_utxos;
+    params.target_value = wallet.m_staking_consolidate_value;
+    params.weight_budget = std::max<CAmount>(0, mature_value / 100 * CONSOLIDATE_MAX_IMMATURE_PERCENT - immature_value);
+    const ConsolidationPlan plan = PlanConsolidation(std::move(address->second), params);
+    if (plan.inputs.empty()) return false;
+
+    const CTxDestination dest = PKHash(address->first);
+    for (const COutPoint& prevout : plan.inputs) {
+        coin_control.Select(prevout);
+    }
+    coin_control.m_allow_other_inputs = false;
+    coin_control.destChange = dest;
+    coin_control.m_feerate = feerate;
+    coin_control.fOverrideFeeRate = true;
+
+    // Split the total into outputs of about the target value, the last one pays the fee
+    std::vector<CRecipient> recipients;
+    const CAmount output_value = plan.total / plan.outputs;
+    for (int i = 0; i < plan.outputs; i++) {
+        const bool last = i == plan.outputs - 1;
+        recipients.push_back({dest, last ? plan.total - output_value * i : output_value, /*fSubtractFeeFromAmount=*/last});
+    }
+
+    auto res = CreateTransaction(wallet, recipients, /*change_pos=*/std::nullopt, coin_control);
+    if (!res) {
+        wallet.WalletLogPrintf("Failed to create the consolidation of %d staking outputs: %s\n", plan.inputs.size(), util::ErrorString(res).original);
+        return false;
+    }
+
+    wallet.CommitTransaction(res->tx, {{"consolidation", "1"}}, /*orderForm=*/{});
+    wallet.m_last_consolidation_txid = res->tx->GetHash();
+    wallet.WalletLogPrintf("Consolidated %d staking outputs of %s into %d in %s\n", plan.inputs.size(), FormatMoney(plan.total), plan.outputs, res->tx->GetHash().ToString());
+    return true;
+}
+
+void MaybeConsolidateStakingCoins(WalletContext& context)
+{
+    for (const std::shared_ptr<CWallet>& pwallet : GetWallets(context)) {
+        if (!pwallet->m_staking_consolidate) continue;
+        ConsolidateStakingCoins(*pwallet);
+    }
+}
+} // namespace wallet
@@ -0,0 +1,65 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_CONSOLIDATE_H
+#define BITCOIN_WALLET_CONSOLIDATE_H
+
+#include <consensus/amount.h>
+#include <primitives/transaction.h>
+
+#include <vector>
+
+namespace wallet {
+class CWallet;
+struct WalletContext;
+
+//! Maximum number of inputs of a consolidation transaction
+static constexpr size_t CONSOLIDATE_MAX_INPUTS{500};
+//! Maximum share (in percent) of the stake weight which may wait for the maturity of consolidated outputs
+static constexpr int CONSOLIDATE_MAX_IMMATURE_PERCENT{10};
+
+//! Small staking output of an address, which may be consolidated
+struct ConsolidationCoin {
+    COutPoint outpoint;
+    CAmount value{0};
+    //! Whether the output is mature and large enough to stake, so spending it lowers the stake weight
+    bool has_weight{false};
+};
+
+struct ConsolidationParams {
+    //! Number of outputs to remove from the wallet
+    size_t excess{0};
+    //! Value of the outputs created
+    CAmount target_value{0};
+    //! Value of the outputs with stake weight which may be spent
+    CAmount weight_budget{0};
+};
+
+struct ConsolidationPlan {
+    std::vector<COutPoint> inputs;
+    CAmount total{0};
+    //! Number of outputs of about the target value to split the total into
+    int outputs{0};
+};
+
+/**
+ * Choose the outputs of an address to spend in a consolidation, the smallest
+ * first. Outputs with stake weight are only spent within the weight budget.
+ * Returns an empty plan when there are less than two outputs to spend.
+ */
+ConsolidationPlan PlanConsolidation(std::vector<ConsolidationCoin> coins, const ConsolidationParams& params);
+
+/**
+ * Consolidate the small staking outputs of the address with the most of them,
+ * when the wallet has more than -stakingconsolidatemaxutxos of them. It waits
+ * for the fees to be low and for the last consolidation to be confirmed.
+ * Returns whether a transaction was committed.
+ */
+bool ConsolidateStakingCoins(CWallet& wallet);
+
+/** Consolidate the staking outputs of the wallets, run periodically by the scheduler. */
+void MaybeConsolidateStakingCoins(WalletContext& context);
+} // namespace wallet
+
+#endif // BITCOIN_WALLET_CONSOLIDATE_H
@@ -9,6 +9,7 @@
 #include <util/fs.h>
 #include <wallet/db.h>
 
+#include <algorithm>
 #include <exception>
 #include <fstream>
 #include <string>
@@ -145,6 +146,7 @@ void ReadDatabaseArgs(const ArgsManager& args, DatabaseOptions& options)
     options.use_unsafe_sync = args.GetBoolArg("-unsafesqlitesync", options.use_unsafe_sync);
     options.use_shared_memory = !args.GetBoolArg("-privdb", !options.use_shared_memory);
     options.max_log_mb = args.GetIntArg("-dblogsize", options.max_log_mb);
+    options.group_commit_ms = std::max<int64_t>(0, args.GetIntArg("-walletgroupcommit", options.group_commit_ms));
 }
 
 } // namespace wallet
@@ -191,6 +191,7 @@ struct DatabaseOptions {
     bool use_unsafe_sync = false;   //!< Disable file sync for faster performance.
     bool use_shared_memory = false; //!< Let other processes access the database.
     int64_t max_log_mb = 100;       //!< Max log size to allow before consolidating.
+    int64_t group_commit_ms = 0;    //!< Group the writes not flushed on close into transactions of up to this many milliseconds.
 };
 
 enum class DatabaseStatus {
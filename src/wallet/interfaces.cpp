@@ -1320,6 +1320,17 @@ public:
     {
         return m_wallet->CleanTokenTxEntries();
     }
+    bool getTokenBalance(const uint256& id, uint256& balance) override
+    {
+        std::optional<uint256> value = m_wallet->GetTokenBalance(id);
+        if (!value) return false;
+        balance = *value;
+        return true;
+    }
+    bool setTokenBalance(const uint256& id, const uint256& balance, int height) override
+    {
+        return m_wallet->SetTokenBalance(id, balance, height);
+    }
     void setEnabledStaking(bool enabled) override
     {
         m_wallet->m_enabled_staking = enabled;
@@ -12,6 +12,7 @@
 #include <util/fs.h>
 #include <util/string.h>
 #include <util/translation.h>
+#include <wallet/consolidate.h>
 #include <wallet/context.h>
 #include <wallet/spend.h>
 #include <wallet/wallet.h>
@@ -152,6 +153,9 @@ void StartWallets(WalletContext& context)
         context.scheduler->scheduleEvery([&context] { MaybeCompactWalletDB(context); }, 500ms);
     }
     context.scheduler->scheduleEvery([&context] { MaybeResendWalletTxs(context); }, 1min);
+    if (context.args->GetBoolArg("-stakingconsolidate", DEFAULT_STAKING_CONSOLIDATE)) {
+        context.scheduler->scheduleEvery([&context] { MaybeConsolidateStakingCoins(context); }, 10min);
+    }
 }
 
 void FlushWallets(WalletContext& context)
@@ -7,6 +7,7 @@
 #include <common/system.h>
 #include <util/signstr.h>
 #include <util/tokenstr.h>
+#include <util/convert.h>
 #include <wallet/rpc/util.h>
 #include <wallet/wallet.h>
 #include <wallet/coincontrol.h>
@@ -1613,6 +1614,138 @@ RPCHelpMan qrc20burnfrom()
     };
 }
 
+RPCHelpMan addtoken()
+{
+    return RPCHelpMan{"addtoken",
+                "\nAdd a QRC20 token to the wallet, for a token owner address of the wallet. The token name, symbol and decimals are read from the contract.\n"
+                "With -logevents, the wallet then tracks the token transactions and the token balance from the event logs of the connected blocks.\n",
+                {
+                    {"contractaddress", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The contract address."},
+                    {"owneraddress", RPCArg::Type::STR, RPCArg::Optional::NO, "The token owner qtum address."},
+                },
+                RPCResult{
+                    RPCResult::Type::STR_HEX, "hash", "The token id in the wallet"},
+                RPCExamples{
+                    HelpExampleCli("addtoken", "\"eb23c0b3e6042821da281a2e2364feb22dd543e3\" \"QX1GkJdye9WoUnrE2v6ZQhQ72EUVDtGXQX\"")
+            + HelpExampleRpc("addtoken", "\"eb23c0b3e6042821da281a2e2364feb22dd543e3\" \"QX1GkJdye9WoUnrE2v6ZQhQ72EUVDtGXQX\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return NullUniValue;
+
+    CTokenInfo tokenInfo;
+    tokenInfo.strContractAddress = request.params[0].get_str();
+    tokenInfo.strSenderAddress = request.params[1].get_str();
+
+    // The token owner address must be of the wallet
+    CTxDestination dest = DecodeDestination(tokenInfo.strSenderAddress);
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid Qtum address");
+    }
+    if (!WITH_LOCK(pwallet->cs_wallet, return pwallet->IsMine(dest))) {
+        throw JSONRPCError(RPC_WALLET_ERROR, "The token owner address is not in the wallet");
+    }
+
+    // Read the token description from the contract
+    CallToken token(pwallet->chain().chainman());
+    token.setAddress(tokenInfo.strContractAddress);
+    uint32_t decimals;
+    if (!token.name(tokenInfo.strTokenName) || !token.symbol(tokenInfo.strTokenSymbol) || !token.decimals(decimals) || decimals > 77)
+        throw JSONRPCError(RPC_MISC_ERROR, "Fail to get the token name, symbol and decimals");
+    tokenInfo.nDecimals = decimals;
+
+    if (WITH_LOCK(pwallet->cs_wallet, return pwallet->mapToken.count(tokenInfo.GetHash()))) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "The token already exists with the specified contract and owner addresses");
+    }
+    if (!pwallet->AddTokenEntry(tokenInfo)) {
+        throw JSONRPCError(RPC_WALLET_ERROR, "Fail to add the token");
+    }
+
+    return tokenInfo.GetHash().GetHex();
+},
+    };
+}
+
+RPCHelpMan checktokenbalance()
+{
+    return RPCHelpMan{"checktokenbalance",
+                "\nRead the balance of a token of the wallet from the contract and compare it with the balance tracked from the event logs,\n"
+                "which is updated transfer by transfer as blocks are connected. When the tracked balance is unknown, does not match\n"
+                "or is due for a check, after a reorg or every " + ToString(TOKEN_BALANCE_RECONCILE_INTERVAL) + " blocks, it is set to the contract balance.\n",
+                {
+                    {"contractaddress", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The contract address."},
+                    {"owneraddress", RPCArg::Type::STR, RPCArg::Optional::NO, "The token owner qtum address."},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR, "balance", /*optional=*/true, "The tracked balance, if it is known and not due for a check"},
+                        {RPCResult::Type::STR, "contractbalance", "The balance read from the contract"},
+                        {RPCResult::Type::BOOL, "consistent", "'false' if the tracked balance does not match the contract balance"},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("checktokenbalance", "\"eb23c0b3e6042821da281a2e2364feb22dd543e3\" \"QX1GkJdye9WoUnrE2v6ZQhQ72EUVDtGXQX\"")
+            + HelpExampleRpc("checktokenbalance", "\"eb23c0b3e6042821da281a2e2364feb22dd543e3\" \"QX1GkJdye9WoUnrE2v6ZQhQ72EUVDtGXQX\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return NullUniValue;
+
+    if (!fLogEvents)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    std::string contract = request.params[0].get_str();
+    std::string owner = request.params[1].get_str();
+    uint256 tokenHash;
+    uint32_t decimals{0};
+    int height{-1};
+    {
+        LOCK(pwallet->cs_wallet);
+        auto it = std::find_if(pwallet->mapToken.begin(), pwallet->mapToken.end(), [&](const auto& entry) {
+            return entry.second.strContractAddress == contract && entry.second.strSenderAddress == owner;
+        });
+        if (it == pwallet->mapToken.end()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "The token is not in the wallet");
+        }
+        tokenHash = it->first;
+        decimals = it->second.nDecimals;
+        height = pwallet->GetLastBlockHeight();
+    }
+    std::optional<uint256> tracked = pwallet->GetTokenBalance(tokenHash);
+
+    // Read the balance at the last block processed by the wallet
+    CallToken token(pwallet->chain().chainman());
+    token.setAddress(contract);
+    token.setSender(owner);
+    std::string strBalance;
+    if (!token.balanceOf(strBalance))
+        throw JSONRPCError(RPC_MISC_ERROR, "Fail to get balance");
+    if (pwallet->chain().getHeight() != height)
+        throw JSONRPCError(RPC_MISC_ERROR, "The chain tip changed while reading the balance");
+    uint256 balance = u256Touint(dev::u256(strBalance));
+    const bool consistent = !tracked || *tracked == balance;
+
+    UniValue obj(UniValue::VOBJ);
+    if (tracked) obj.pushKV("balance", FormatToken(decimals, dev::s256(uintTou256(*tracked))));
+    obj.pushKV("contractbalance", FormatToken(decimals, dev::s256(uintTou256(balance))));
+    obj.pushKV("consistent", consistent);
+
+    if (!tracked || !consistent) {
+        pwallet->SetTokenBalance(tokenHash, balance, height);
+    }
+
+    return obj;
+},
+    };
+}
+
 Span<const CRPCCommand> GetContractRPCCommands()
 {
 // clang-format off
@@ -1628,6 +1761,8 @@ static const CRPCCommand commands[] =
     { "wallet",             &qrc20transferfrom,               },
     { "wallet",             &qrc20burn,                       },
     { "wallet",             &qrc20burnfrom,                   },
+    { "wallet",             &addtoken,                        },
+    { "wallet",             &checktokenbalance,               },
 };
 // clang-format on
     return commands;
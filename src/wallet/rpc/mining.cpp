@@ -131,6 +131,7 @@ RPCHelpMan getstakinginfo()
                         {RPCResult::Type::NUM, "delegateweight", "Delegate weight"},
                         {RPCResult::Type::NUM, "netstakeweight", "Network stake weight"},
                         {RPCResult::Type::NUM, "expectedtime", "Expected time to earn reward"},
+                        {RPCResult::Type::NUM, "latency", /*optional=*/true, "Milliseconds from finding a kernel to signing the block, for the last block created by the staker (only present if a block was ever created)"},
                     }
                 },
                 RPCExamples{
@@ -181,6 +182,64 @@ RPCHelpMan getstakinginfo()
     obj.pushKV("netstakeweight", (uint64_t)nNetworkWeight);
 
     obj.pushKV("expectedtime", nExpectedTime);
+    const int64_t latency{pwallet->m_last_coin_stake_latency};
+    if (latency >= 0) obj.pushKV("latency", latency);
+
+    return obj;
+},
+    };
+}
+
+RPCHelpMan checkstakeweight()
+{
+    return RPCHelpMan{"checkstakeweight",
+                "\nCompute the stake weight of the wallet from its coins and delegations and compare it with the weight reported by getstakinginfo,\n"
+                "which is updated coin by coin as the wallet and the chain change. If they differ, the reported weight is computed again.",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "weight", "The reported staker weight"},
+                        {RPCResult::Type::NUM, "delegateweight", "The reported delegate weight"},
+                        {RPCResult::Type::NUM, "computedweight", "The computed staker weight"},
+                        {RPCResult::Type::NUM, "computeddelegateweight", "The computed delegate weight"},
+                        {RPCResult::Type::BOOL, "consistent", "'true' if the reported weight matches the computed weight"},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("checkstakeweight", "")
+            + HelpExampleRpc("checkstakeweight", "")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return NullUniValue;
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    LOCK(pwallet->cs_wallet);
+    uint64_t nWeight = 0;
+    uint64_t nDelegateWeight = 0;
+    pwallet->GetStakeWeight(&nWeight, &nDelegateWeight);
+    uint64_t nComputedWeight = 0;
+    uint64_t nComputedDelegateWeight = 0;
+    pwallet->ComputeStakeWeight(&nComputedWeight, &nComputedDelegateWeight);
+    const bool consistent = nWeight == nComputedWeight && nDelegateWeight == nComputedDelegateWeight;
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("weight", nWeight);
+    obj.pushKV("delegateweight", nDelegateWeight);
+    obj.pushKV("computedweight", nComputedWeight);
+    obj.pushKV("computeddelegateweight", nComputedDelegateWeight);
+    obj.pushKV("consistent", consistent);
+
+    if (!consistent) {
+        pwallet->WalletLogPrintf("checkstakeweight: weight %d/%d does not match computed weight %d/%d\n",
+                                 nWeight, nDelegateWeight, nComputedWeight, nComputedDelegateWeight);
+        pwallet->MarkStakeWeightDirty();
+    }
 
     return obj;
 },
@@ -195,6 +254,7 @@ static const CRPCCommand commands[] =
   //  ------------------    ------------------------
     { "mining",             &getmininginfo,                  },
     { "mining",             &getstakinginfo,                 },
+    { "mining",             &checkstakeweight,               },
 };
 // clang-format on
     return commands;
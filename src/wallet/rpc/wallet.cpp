@@ -452,12 +452,14 @@ static RPCHelpMan reservebalance()
             nAmount = (nAmount / CENT) * CENT;  // round to cent
             if (nAmount < 0)
                 throw std::runtime_error("amount cannot be negative.\n");
+            LOCK(pwallet->cs_wallet);
             pwallet->m_reserve_balance = nAmount;
         }
         else
         {
             if (request.params.size() > 1)
                 throw std::runtime_error("cannot specify amount to turn off reserve.\n");
+            LOCK(pwallet->cs_wallet);
             pwallet->m_reserve_balance = 0;
         }
     }
@@ -499,6 +501,7 @@ static RPCHelpMan getwalletinfo()
                         {
                             {RPCResult::Type::NUM, "duration", "elapsed seconds since scan start"},
                             {RPCResult::Type::NUM, "progress", "scanning progress percentage [0.0, 1.0]"},
+                            {RPCResult::Type::NUM, "eta", /*optional=*/true, "estimated seconds until the scan completes, once it has made some progress"},
                         }, /*skip_type_check=*/true},
                         {RPCResult::Type::BOOL, "descriptors", "whether this wallet uses descriptors for scriptPubKey management"},
                         {RPCResult::Type::BOOL, "external_signer", "whether this wallet is configured to use an external signer such as a hardware wallet"},
@@ -571,8 +574,13 @@ static RPCHelpMan getwalletinfo()
     obj.pushKV("avoid_reuse", pwallet->IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE));
     if (pwallet->IsScanning()) {
         UniValue scanning(UniValue::VOBJ);
-        scanning.pushKV("duration", Ticks<std::chrono::seconds>(pwallet->ScanningDuration()));
-        scanning.pushKV("progress", pwallet->ScanningProgress());
+        const auto duration{pwallet->ScanningDuration()};
+        const double progress{pwallet->ScanningProgress()};
+        scanning.pushKV("duration", Ticks<std::chrono::seconds>(duration));
+        scanning.pushKV("progress", progress);
+        if (progress > 0) {
+            scanning.pushKV("eta", int64_t(Ticks<SecondsDouble>(duration) * (1 - progress) / progress));
+        }
         obj.pushKV("scanning", scanning);
     } else {
         obj.pushKV("scanning", false);
@@ -2860,25 +2860,35 @@ bool DescriptorScriptPubKeyMan::SignTransactionStake(CMutableTransaction &tx, co
 bool LegacyScriptPubKeyMan::SignBlockStake(CBlock &block, const PKHash &pkhash, bool compact) const
 {
     CKey key;
-    if (!GetKey(ToKeyID(pkhash), key)) {
+    if (!GetStakeKey(pkhash, key)) {
         return false;
     }
 
     return ::SignBlockStake(block, key, compact);
 }
 
+bool LegacyScriptPubKeyMan::GetStakeKey(const PKHash &pkhash, CKey &key) const
+{
+    return GetKey(ToKeyID(pkhash), key);
+}
+
 bool DescriptorScriptPubKeyMan::SignBlockStake(CBlock &block, const PKHash &pkhash, bool compact) const
 {
-    std::unique_ptr<FlatSigningProvider> keys = GetSigningProvider(GetScriptForDestination(pkhash), true);
-    if (!keys) {
+    CKey key;
+    if (!GetStakeKey(pkhash, key)) {
         return false;
     }
 
-    CKey key;
-    if (!keys->GetKey(ToKeyID(pkhash), key)) {
+    return ::SignBlockStake(block, key, compact);
+}
+
+bool DescriptorScriptPubKeyMan::GetStakeKey(const PKHash &pkhash, CKey &key) const
+{
+    std::unique_ptr<FlatSigningProvider> keys = GetSigningProvider(GetScriptForDestination(pkhash), true);
+    if (!keys) {
         return false;
     }
 
-    return ::SignBlockStake(block, key, compact);
+    return keys->GetKey(ToKeyID(pkhash), key);
 }
 } // namespace wallet
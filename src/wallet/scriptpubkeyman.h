@@ -251,6 +251,8 @@ public:
     virtual bool SignTransactionStake(CMutableTransaction& tx, const std::vector<std::pair<CTxOut,unsigned int>>& coins) const { return false; }
     /** Creates new coinstake block signature and adds it to the header. Returns whether the block was signed */
     virtual bool SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact) const { return false; }
+    /** Get the private key of a staking address, to sign coinstakes and blocks with it. */
+    virtual bool GetStakeKey(const PKHash& pkhash, CKey& key) const { return false; }
 
     virtual uint256 GetID() const { return uint256(); }
 
@@ -432,6 +434,7 @@ public:
     bool SignTransactionOutput(CMutableTransaction& tx, int sighash, std::map<int, std::string>& output_errors) const override;
     bool SignTransactionStake(CMutableTransaction& tx, const std::vector<std::pair<CTxOut,unsigned int>>& coins) const override;
     bool SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact) const override;
+    bool GetStakeKey(const PKHash& pkhash, CKey& key) const override;
 
     uint256 GetID() const override;
 
@@ -662,6 +665,7 @@ public:
     bool SignTransactionOutput(CMutableTransaction& tx, int sighash, std::map<int, std::string>& output_errors) const override;
     bool SignTransactionStake(CMutableTransaction& tx, const std::vector<std::pair<CTxOut,unsigned int>>& coins) const override;
     bool SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact) const override;
+    bool GetStakeKey(const PKHash& pkhash, CKey& key) const override;
 
     uint256 GetID() const override;
 
@@ -317,13 +317,15 @@ CoinsResult AvailableCoins(const CWallet& wallet,
     const int max_depth = {coinControl ? coinControl->m_max_depth : DEFAULT_MAX_DEPTH};
     const bool only_safe = {coinControl ? !coinControl->m_include_unsafe_inputs : true};
     const bool can_grind_r = wallet.CanGrindR();
+    // The input size is computed with the maximum signature size when watch-only inputs are allowed
+    const bool use_max_sig = !can_grind_r || (coinControl && coinControl->fAllowWatchOnly);
     std::vector<COutPoint> outpoints;
 
     std::set<uint256> trusted_parents;
-    for (const auto& entry : wallet.mapWallet)
+    // Walk the unspent outputs of the wallet, the transactions spent in full are not indexed
+    for (const auto& [txid, indexed_outputs] : wallet.GetSpendableCoins())
     {
-        const uint256& txid = entry.first;
-        const CWalletTx& wtx = entry.second;
+        const CWalletTx& wtx = wallet.mapWallet.at(txid);
 
         if (wallet.IsTxImmature(wtx) && !params.include_immature_coinbase)
             continue;
@@ -380,7 +382,7 @@ CoinsResult AvailableCoins(const CWallet& wallet,
 
         bool tx_from_me = CachedTxIsFromMe(wallet, wtx, ISMINE_ALL);
 
-        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        for (unsigned int i : indexed_outputs) {
             const CTxOut& output = wtx.tx->vout[i];
             const COutPoint outpoint(Txid::FromUint256(txid), i);
 
@@ -407,9 +409,13 @@ CoinsResult AvailableCoins(const CWallet& wallet,
                 continue;
             }
 
-            std::unique_ptr<SigningProvider> provider = wallet.GetSolvingProvider(output.scriptPubKey);
+            // The input size and type only depend on the script, so reuse them for the outputs
+            // paying to a script already seen, like the many rewards of a staking address
+            const CSpendInfo* cached_info = wallet.GetCachedSpendInfo(output.scriptPubKey, use_max_sig);
+            std::unique_ptr<SigningProvider> provider;
+            if (!cached_info) provider = wallet.GetSolvingProvider(output.scriptPubKey);
 
-            int input_bytes = CalculateMaximumSignedInputSize(output, COutPoint(), provider.get(), can_grind_r, coinControl);
+            int input_bytes = cached_info ? cached_info->input_bytes : CalculateMaximumSignedInputSize(output, COutPoint(), provider.get(), can_grind_r, coinControl);
             // Because CalculateMaximumSignedInputSize infers a solvable descriptor to get the satisfaction size,
             // it is safe to assume that this input is solvable if input_bytes is greater than -1.
             bool solvable = input_bytes > -1;
@@ -418,23 +424,31 @@ CoinsResult AvailableCoins(const CWallet& wallet,
             // Filter by spendable outputs only
             if (!spendable && params.only_spendable) continue;
 
-            // Obtain script type
-            std::vector<std::vector<uint8_t>> script_solutions;
-            TxoutType type = Solver(output.scriptPubKey, script_solutions);
-
-            // If the output is P2SH and solvable, we want to know if it is
-            // a P2SH (legacy) or one of P2SH-P2WPKH, P2SH-P2WSH (P2SH-Segwit). We can determine
-            // this from the redeemScript. If the output is not solvable, it will be classified
-            // as a P2SH (legacy), since we have no way of knowing otherwise without the redeemScript
-            bool is_from_p2sh{false};
-            if (type == TxoutType::SCRIPTHASH && solvable) {
-                CScript script;
-                if (!provider->GetCScript(CScriptID(uint160(script_solutions[0])), script)) continue;
-                type = Solver(script, script_solutions);
-                is_from_p2sh = true;
+            CSpendInfo spend_info;
+            if (cached_info) {
+                spend_info = *cached_info;
+            } else {
+                // Obtain script type
+                std::vector<std::vector<uint8_t>> script_solutions;
+                spend_info.input_bytes = input_bytes;
+                spend_info.type = Solver(output.scriptPubKey, script_solutions);
+
+                // If the output is P2SH and solvable, we want to know if it is
+                // a P2SH (legacy) or one of P2SH-P2WPKH, P2SH-P2WSH (P2SH-Segwit). We can determine
+                // this from the redeemScript. If the output is not solvable, it will be classified
+                // as a P2SH (legacy), since we have no way of knowing otherwise without the redeemScript
+                if (spend_info.type == TxoutType::SCRIPTHASH && solvable) {
+                    CScript script;
+                    if (!provider->GetCScript(CScriptID(uint160(script_solutions[0])), script)) continue;
+                    spend_info.type = Solver(script, script_solutions);
+                    spend_info.is_from_p2sh = true;
+                }
+
+                // Scripts which are not solvable yet may become so when keys are imported
+                if (solvable) wallet.CacheSpendInfo(output.scriptPubKey, use_max_sig, spend_info);
             }
 
-            result.Add(GetOutputType(type, is_from_p2sh),
+            result.Add(GetOutputType(spend_info.type, spend_info.is_from_p2sh),
                        COutput(outpoint, output, nDepth, input_bytes, spendable, solvable, safeTx, wtx.GetTxTime(), tx_from_me, feerate));
 
             outpoints.push_back(outpoint);
@@ -114,7 +114,7 @@ Mutex SQLiteDatabase::g_sqlite_mutex;
 int SQLiteDatabase::g_sqlite_count = 0;
 
 SQLiteDatabase::SQLiteDatabase(const fs::path& dir_path, const fs::path& file_path, const DatabaseOptions& options, bool mock)
-    : WalletDatabase(), m_mock(mock), m_dir_path(fs::PathToString(dir_path)), m_file_path(fs::PathToString(file_path)), m_write_semaphore(1), m_use_unsafe_sync(options.use_unsafe_sync)
+    : WalletDatabase(), m_mock(mock), m_dir_path(fs::PathToString(dir_path)), m_file_path(fs::PathToString(file_path)), m_group_commit_interval(options.group_commit_ms), m_write_semaphore(1), m_use_unsafe_sync(options.use_unsafe_sync)
 {
     {
         LOCK(g_sqlite_mutex);
@@ -158,6 +158,13 @@ void SQLiteBatch::SetupSQLStatements()
         {&m_delete_prefix_stmt, "DELETE FROM main WHERE instr(key, ?) = 1"},
     };
 
+    // Reuse the statements of a closed batch if there are any
+    if (const auto cached{m_database.TakeCachedStatements()}) {
+        for (size_t i = 0; i < statements.size(); ++i) {
+            *statements[i].first = (*cached)[i];
+        }
+    }
+
     for (const auto& [stmt_prepared, stmt_text] : statements) {
         if (*stmt_prepared == nullptr) {
             int res = sqlite3_prepare_v2(m_database.m_db, stmt_text, -1, stmt_prepared, nullptr);
@@ -300,6 +307,18 @@ void SQLiteDatabase::Open()
         SetPragma(m_db, "synchronous", "OFF", "Failed to set synchronous mode to OFF");
     }
 
+    if (UseGroupCommit()) {
+        // Commits to the write-ahead log only need to be synced at checkpoints,
+        // a crash can lose the last ones but leaves the database consistent
+        SetPragma(m_db, "journal_mode", "WAL", "Failed to set the journal mode to WAL");
+        if (!m_use_unsafe_sync) {
+            SetPragma(m_db, "synchronous", "NORMAL", "Failed to set synchronous mode to NORMAL");
+        }
+    } else {
+        // The journal mode is persistent, go back to the default if it was changed
+        SetPragma(m_db, "journal_mode", "DELETE", "Failed to set the journal mode to DELETE");
+    }
+
     // Make the table for our key-value pairs
     // First check that the main table exists
     sqlite3_stmt* check_main_stmt{nullptr};
@@ -340,13 +359,22 @@ void SQLiteDatabase::Open()
 
 bool SQLiteDatabase::Rewrite(const char* skip)
 {
+    // VACUUM can't run inside a transaction
+    m_write_semaphore.wait();
+    CommitGroupTxn();
     // Rewrite the database using the VACUUM command: https://sqlite.org/lang_vacuum.html
     int ret = sqlite3_exec(m_db, "VACUUM", nullptr, nullptr, nullptr);
+    m_write_semaphore.post();
     return ret == SQLITE_OK;
 }
 
 bool SQLiteDatabase::Backup(const std::string& dest) const
 {
+    // The connection can't be copied while it is writing
+    m_write_semaphore.wait();
+    CommitGroupTxn();
+    m_write_semaphore.post();
+
     sqlite3* db_copy;
     int res = sqlite3_open(dest.c_str(), &db_copy);
     if (res != SQLITE_OK) {
@@ -374,6 +402,9 @@ bool SQLiteDatabase::Backup(const std::string& dest) const
 
 void SQLiteDatabase::Close()
 {
+    CommitGroupTxn();
+    FinalizeCachedStatements();
+
     int res = sqlite3_close(m_db);
     if (res != SQLITE_OK) {
         throw std::runtime_error(strprintf("SQLiteDatabase: Failed to close database: %s\n", sqlite3_errstr(res)));
@@ -381,12 +412,96 @@ void SQLiteDatabase::Close()
     m_db = nullptr;
 }
 
-bool SQLiteDatabase::HasActiveTxn()
+bool SQLiteDatabase::HasActiveTxn() const
 {
     // 'sqlite3_get_autocommit' returns true by default, and false if a transaction has begun and not been committed or rolled back.
     return m_db && sqlite3_get_autocommit(m_db) == 0;
 }
 
+bool SQLiteDatabase::BeginGroupWrite()
+{
+    if (!m_group_txn) {
+        int res = sqlite3_exec(m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+        if (res != SQLITE_OK) {
+            LogPrintf("SQLiteDatabase: Failed to begin the group transaction: %s\n", sqlite3_errstr(res));
+            return false;
+        }
+        m_group_txn = true;
+        m_group_txn_start = SteadyClock::now();
+        m_group_txn_writes = 0;
+    }
+    ++m_group_txn_writes;
+    return true;
+}
+
+bool SQLiteDatabase::CommitGroupTxn() const
+{
+    if (!m_group_txn) return true;
+
+    // SQLite rolls back the transaction on some errors
+    if (!HasActiveTxn()) {
+        m_group_txn = false;
+        LogPrintf("SQLiteDatabase: The group transaction was rolled back\n");
+        return false;
+    }
+    // On failure, e.g. while a cursor is reading, the transaction stays open to be committed later
+    int res = sqlite3_exec(m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+    if (res != SQLITE_OK) {
+        LogPrintf("SQLiteDatabase: Failed to commit the group transaction: %s\n", sqlite3_errstr(res));
+        return false;
+    }
+    m_group_txn = false;
+    return true;
+}
+
+bool SQLiteDatabase::GroupTxnDue() const
+{
+    return m_group_txn && (m_group_txn_writes >= MAX_GROUP_COMMIT_WRITES || SteadyClock::now() - m_group_txn_start >= m_group_commit_interval);
+}
+
+void SQLiteDatabase::Flush()
+{
+    if (!m_db) return;
+    m_write_semaphore.wait();
+    CommitGroupTxn();
+    m_write_semaphore.post();
+}
+
+bool SQLiteDatabase::PeriodicFlush()
+{
+    // Called once the wallet has not been written for a while
+    if (!UseGroupCommit() || !m_db || !m_write_semaphore.try_wait()) return false;
+    bool ret = CommitGroupTxn();
+    m_write_semaphore.post();
+    return ret;
+}
+
+std::optional<std::array<sqlite3_stmt*, 5>> SQLiteDatabase::TakeCachedStatements()
+{
+    LOCK(m_statements_mutex);
+    if (m_cached_statements.empty()) return std::nullopt;
+    std::array<sqlite3_stmt*, 5> statements = m_cached_statements.back();
+    m_cached_statements.pop_back();
+    return statements;
+}
+
+void SQLiteDatabase::CacheStatements(const std::array<sqlite3_stmt*, 5>& statements)
+{
+    LOCK(m_statements_mutex);
+    m_cached_statements.push_back(statements);
+}
+
+void SQLiteDatabase::FinalizeCachedStatements()
+{
+    LOCK(m_statements_mutex);
+    for (const auto& statements : m_cached_statements) {
+        for (sqlite3_stmt* stmt : statements) {
+            sqlite3_finalize(stmt);
+        }
+    }
+    m_cached_statements.clear();
+}
+
 int SQliteExecHandler::Exec(SQLiteDatabase& database, const std::string& statement)
 {
     return sqlite3_exec(database.m_db, statement.data(), nullptr, nullptr, nullptr);
@@ -394,12 +509,12 @@ int SQliteExecHandler::Exec(SQLiteDatabase& database, const std::string& stateme
 
 std::unique_ptr<DatabaseBatch> SQLiteDatabase::MakeBatch(bool flush_on_close)
 {
-    // We ignore flush_on_close because we don't do manual flushing for SQLite
-    return std::make_unique<SQLiteBatch>(*this);
+    // Without flush_on_close the writes can be grouped, there is no manual flushing otherwise
+    return std::make_unique<SQLiteBatch>(*this, flush_on_close);
 }
 
-SQLiteBatch::SQLiteBatch(SQLiteDatabase& database)
-    : m_database(database)
+SQLiteBatch::SQLiteBatch(SQLiteDatabase& database, bool flush_on_close)
+    : m_database(database), m_flush_on_close(flush_on_close)
 {
     // Make sure we have a db handle
     assert(m_database.m_db);
@@ -424,6 +539,12 @@ void SQLiteBatch::Close()
         }
     }
 
+    // Keep the prepared statements for the next batch, unless the connection is refreshed
+    if (!force_conn_refresh && m_database.m_db && m_read_stmt && m_insert_stmt && m_overwrite_stmt && m_delete_stmt && m_delete_prefix_stmt) {
+        m_database.CacheStatements({m_read_stmt, m_insert_stmt, m_overwrite_stmt, m_delete_stmt, m_delete_prefix_stmt});
+        m_read_stmt = m_insert_stmt = m_overwrite_stmt = m_delete_stmt = m_delete_prefix_stmt = nullptr;
+    }
+
     // Free all of the prepared statements
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "read"},
@@ -499,20 +620,48 @@ bool SQLiteBatch::WriteKey(DataStream&& key, DataStream&& value, bool overwrite)
     if (!BindBlobToStatement(stmt, 1, key, "key")) return false;
     if (!BindBlobToStatement(stmt, 2, value, "value")) return false;
 
+    return StepWrite(stmt);
+}
+
+bool SQLiteBatch::StepWrite(sqlite3_stmt* stmt)
+{
     // Acquire semaphore if not previously acquired when creating a transaction.
     if (!m_txn) m_database.m_write_semaphore.wait();
 
+    // Writes which don't need to be flushed join the group transaction, the
+    // others commit it first so that the writes reach the disk in order. When
+    // the group can't be committed the durable write would join it, so fail.
+    // A group rolled back by SQLite is gone, the write then goes in its own
+    // transaction.
+    bool group{false};
+    if (!m_txn) {
+        if (!m_flush_on_close && m_database.UseGroupCommit()) {
+            group = m_database.BeginGroupWrite();
+        } else if (!m_database.CommitGroupTxn() && m_database.HasActiveTxn()) {
+            LogPrintf("%s: Unable to commit the group transaction before a durable write\n", __func__);
+            m_database.m_write_semaphore.post();
+            return false;
+        }
+    }
+
     // Execute
     int res = sqlite3_step(stmt);
     sqlite3_clear_bindings(stmt);
     sqlite3_reset(stmt);
-    if (res != SQLITE_DONE) {
+    bool ret{res == SQLITE_DONE};
+    if (!ret) {
         LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
     }
 
+    // The write is lost with the group when SQLite rolled it back. A commit
+    // which failed otherwise leaves the group open to be committed later.
+    if (group && (m_database.GroupTxnDue() || !m_database.HasActiveTxn())) {
+        if (!m_database.CommitGroupTxn() && !m_database.HasActiveTxn()) ret = false;
+    }
+
     if (!m_txn) m_database.m_write_semaphore.post();
 
-    return res == SQLITE_DONE;
+    return ret;
 }
 
 bool SQLiteBatch::ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob)
@@ -523,20 +672,7 @@ bool SQLiteBatch::ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob)
     // Bind: leftmost parameter in statement is index 1
     if (!BindBlobToStatement(stmt, 1, blob, "key")) return false;
 
-    // Acquire semaphore if not previously acquired when creating a transaction.
-    if (!m_txn) m_database.m_write_semaphore.wait();
-
-    // Execute
-    int res = sqlite3_step(stmt);
-    sqlite3_clear_bindings(stmt);
-    sqlite3_reset(stmt);
-    if (res != SQLITE_DONE) {
-        LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
-    }
-
-    if (!m_txn) m_database.m_write_semaphore.post();
-
-    return res == SQLITE_DONE;
+    return StepWrite(stmt);
 }
 
 bool SQLiteBatch::EraseKey(DataStream&& key)
@@ -654,6 +790,12 @@ bool SQLiteBatch::TxnBegin()
 {
     if (!m_database.m_db || m_txn) return false;
     m_database.m_write_semaphore.wait();
+    // The group transaction can't be nested in this one
+    if (!m_database.CommitGroupTxn() && m_database.HasActiveTxn()) {
+        LogPrintf("SQLiteBatch: Failed to begin the transaction\n");
+        m_database.m_write_semaphore.post();
+        return false;
+    }
     Assert(!m_database.HasActiveTxn());
     int res = Assert(m_exec_handler)->Exec(m_database, "BEGIN TRANSACTION");
     if (res != SQLITE_OK) {
@@ -6,8 +6,11 @@
 #define BITCOIN_WALLET_SQLITE_H
 
 #include <sync.h>
+#include <util/time.h>
 #include <wallet/db.h>
 
+#include <array>
+
 struct bilingual_str;
 
 struct sqlite3_stmt;
@@ -16,6 +19,9 @@ struct sqlite3;
 namespace wallet {
 class SQLiteDatabase;
 
+//! Maximum number of writes grouped into one transaction before it is committed
+static constexpr size_t MAX_GROUP_COMMIT_WRITES{10000};
+
 /** RAII class that provides a database cursor */
 class SQLiteCursor : public DatabaseCursor
 {
@@ -52,6 +58,9 @@ private:
     SQLiteDatabase& m_database;
     std::unique_ptr<SQliteExecHandler> m_exec_handler{std::make_unique<SQliteExecHandler>()};
 
+    //! Whether the writes of this batch have to be committed as they are made, see SQLiteDatabase::m_group_commit_interval
+    const bool m_flush_on_close;
+
     sqlite3_stmt* m_read_stmt{nullptr};
     sqlite3_stmt* m_insert_stmt{nullptr};
     sqlite3_stmt* m_overwrite_stmt{nullptr};
@@ -72,6 +81,7 @@ private:
 
     void SetupSQLStatements();
     bool ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob);
+    bool StepWrite(sqlite3_stmt* stmt);
 
     bool ReadKey(DataStream&& key, DataStream& value) override;
     bool WriteKey(DataStream&& key, DataStream&& value, bool overwrite = true) override;
@@ -80,7 +90,7 @@ private:
     bool ErasePrefix(Span<const std::byte> prefix) override;
 
 public:
-    explicit SQLiteBatch(SQLiteDatabase& database);
+    explicit SQLiteBatch(SQLiteDatabase& database, bool flush_on_close = true);
     ~SQLiteBatch() override { Close(); }
 
     void SetExecHandler(std::unique_ptr<SQliteExecHandler>&& handler) { m_exec_handler = std::move(handler); }
@@ -119,6 +129,23 @@ private:
 
     void Cleanup() noexcept EXCLUSIVE_LOCKS_REQUIRED(!g_sqlite_mutex);
 
+    /**
+     * Writes of batches made without flush_on_close (block and rescan processing,
+     * token tracking) are grouped into one transaction, which is committed once it
+     * is this old, before any other write or transaction, and on Flush or Close.
+     * Zero commits each write on its own. The group transaction is only touched
+     * while holding m_write_semaphore.
+     */
+    const std::chrono::milliseconds m_group_commit_interval;
+    mutable bool m_group_txn{false};
+    SteadyClock::time_point m_group_txn_start;
+    size_t m_group_txn_writes{0};
+
+    //! Prepared statements of closed batches, reused by the next ones instead of preparing them again
+    Mutex m_statements_mutex;
+    std::vector<std::array<sqlite3_stmt*, 5>> m_cached_statements GUARDED_BY(m_statements_mutex);
+    void FinalizeCachedStatements() EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+
 public:
     SQLiteDatabase() = delete;
 
@@ -129,7 +156,7 @@ public:
 
     // Batches must acquire this semaphore on writing, and release when done writing.
     // This ensures that only one batch is modifying the database at a time.
-    CSemaphore m_write_semaphore;
+    mutable CSemaphore m_write_semaphore;
 
     bool Verify(bilingual_str& error);
 
@@ -150,16 +177,16 @@ public:
      */
     bool Backup(const std::string& dest) const override;
 
-    /** No-ops
+    /** Commit the group transaction, if any
      *
-     * SQLite always flushes everything to the database file after each transaction
+     * Otherwise SQLite flushes everything to the database file after each transaction
      * (each Read/Write/Erase that we do is its own transaction unless we called
-     * TxnBegin) so there is no need to have Flush or Periodic Flush.
-     *
-     * There is no DB env to reload, so ReloadDbEnv has nothing to do
+     * TxnBegin) so there is nothing to flush.
      */
-    void Flush() override {}
-    bool PeriodicFlush() override { return false; }
+    void Flush() override;
+    bool PeriodicFlush() override;
+
+    /** No-op, there is no DB env to reload */
     void ReloadDbEnv() override {}
 
     void IncrementUpdateCounter() override { ++nUpdateCounter; }
@@ -171,7 +198,21 @@ public:
     std::unique_ptr<DatabaseBatch> MakeBatch(bool flush_on_close = true) override;
 
     /** Return true if there is an on-going txn in this connection */
-    bool HasActiveTxn();
+    bool HasActiveTxn() const;
+
+    /** Open the group transaction if needed and count a write in it, the caller holds m_write_semaphore */
+    bool BeginGroupWrite();
+    /** Commit the group transaction if there is one, the caller holds m_write_semaphore */
+    bool CommitGroupTxn() const;
+    /** Whether the group transaction is due to be committed */
+    bool GroupTxnDue() const;
+    /** Whether writes not flushed on close are grouped */
+    bool UseGroupCommit() const { return m_group_commit_interval.count() > 0; }
+
+    /** Take cached prepared statements, if any */
+    std::optional<std::array<sqlite3_stmt*, 5>> TakeCachedStatements() EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+    /** Keep reset prepared statements for reuse */
+    void CacheStatements(const std::array<sqlite3_stmt*, 5>& statements) EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
 
     sqlite3* m_db{nullptr};
     bool m_use_unsafe_sync;
@@ -52,6 +52,7 @@ void StopStake(CWallet& wallet)
 
 bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, PKHash& pkhash, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, std::vector<COutPoint>& setSelectedCoins, bool selectedOnly, bool sign, COutPoint& headerPrevout)
 {
+    AssertLockHeld(wallet.cs_wallet);
     bool fAllowWatchOnly = wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
     CBlockIndex* pindexPrev = wallet.chain().getTip();
     arith_uint256 bnTargetPerCoinDay;
@@ -120,6 +121,9 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
         // Search backward in time from the given txNew timestamp
         // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
         COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+        // Skip the coins spent by the wallet since they were selected, like by a consolidation
+        if (wallet.IsSpent(prevoutStake))
+            continue;
         if (CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, wallet.chain().getCoinsTip(), cache, wallet.chain().chainman().ActiveChainstate()))
         {
             // Found a kernel
@@ -144,12 +148,13 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
                 // convert to pay to public key type
                 uint160 hash160(vSolutions[0]);
                 pkhash = PKHash(hash160);
-                CPubKey pubKeyStake;
-                if (!wallet.HasPrivateKey(pkhash, fAllowWatchOnly) || !wallet.GetPubKey(pkhash, pubKeyStake))
+                const CStakeKey* stakeKey = wallet.GetStakeKey(pkhash, fAllowWatchOnly);
+                if (!stakeKey)
                 {
                     LogPrint(BCLog::COINSTAKE, "CreateCoinStake : failed to get key for kernel type=%d\n", (int)whichType);
                     break;  // unable to find corresponding public key
                 }
+                const CPubKey& pubKeyStake = stakeKey->pubKey;
                 scriptPubKeyOut << pubKeyStake.getvch() << OP_CHECKSIG;
                 aggregateScriptPubKeyHashKernel = scriptPubKeyKernel;
             }
@@ -159,12 +164,13 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
                 CPubKey pubKey(vchPubKey);
                 uint160 hash160(Hash160(vchPubKey));
                 pkhash = PKHash(hash160);
-                CPubKey pubKeyStake;
-                if (!wallet.HasPrivateKey(pkhash, fAllowWatchOnly) || !wallet.GetPubKey(pkhash, pubKeyStake))
+                const CStakeKey* stakeKey = wallet.GetStakeKey(pkhash, fAllowWatchOnly);
+                if (!stakeKey)
                 {
                     LogPrint(BCLog::COINSTAKE, "CreateCoinStake : failed to get key for kernel type=%d\n", (int)whichType);
                     break;  // unable to find corresponding public key
                 }
+                const CPubKey& pubKeyStake = stakeKey->pubKey;
 
                 if (pubKeyStake != pubKey)
                 {
@@ -211,6 +217,9 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
             // Do not add additional significant input
             if (pcoin.first->tx->vout[pcoin.second].nValue >= GetStakeCombineThreshold())
                 continue;
+            // Do not add inputs spent by the wallet since they were selected
+            if (wallet.IsSpent(COutPoint(pcoin.first->GetHash(), pcoin.second)))
+                continue;
 
             txNew.vin.push_back(CTxIn(pcoin.first->GetHash(), pcoin.second));
             nCredit += pcoin.first->tx->vout[pcoin.second].nValue;
@@ -358,12 +367,13 @@ bool CreateCoinStakeFromDelegate(CWallet& wallet, unsigned int nBits, const CAmo
                     return error("CreateCoinStake: Failed to find delegation");
 
                 pkhash = PKHash(delegation.staker);
-                CPubKey pubKeyStake;
-                if (!wallet.HasPrivateKey(pkhash, fAllowWatchOnly) || !wallet.GetPubKey(pkhash, pubKeyStake))
+                const CStakeKey* stakeKey = wallet.GetStakeKey(pkhash, fAllowWatchOnly);
+                if (!stakeKey)
                 {
                     LogPrint(BCLog::COINSTAKE, "CreateCoinStake : failed to get staker key for kernel type=%d\n", (int)whichType);
                     break;  // unable to find corresponding public key
                 }
+                const CPubKey& pubKeyStake = stakeKey->pubKey;
                 scriptPubKeyStaker << pubKeyStake.getvch() << OP_CHECKSIG;
             }
             if (whichType == TxoutType::PUBKEY)
@@ -375,12 +385,13 @@ bool CreateCoinStakeFromDelegate(CWallet& wallet, unsigned int nBits, const CAmo
                     return error("CreateCoinStake: Failed to find delegation");
 
                 pkhash = PKHash(delegation.staker);
-                CPubKey pubKeyStake;
-                if (!wallet.HasPrivateKey(pkhash, fAllowWatchOnly) || !wallet.GetPubKey(pkhash, pubKeyStake))
+                const CStakeKey* stakeKey = wallet.GetStakeKey(pkhash, fAllowWatchOnly);
+                if (!stakeKey)
                 {
                     LogPrint(BCLog::COINSTAKE, "CreateCoinStake : failed to get staker key for kernel type=%d\n", (int)whichType);
                     break;  // unable to find corresponding public key
                 }
+                const CPubKey& pubKeyStake = stakeKey->pubKey;
 
                 scriptPubKeyStaker << pubKeyStake.getvch() << OP_CHECKSIG;
             }
@@ -497,47 +508,60 @@ bool CreateCoinStake(CWallet& wallet, unsigned int nBits, const CAmount& nTotalF
     return false;
 }
 
-void AvailableCoinsForStaking(const CWallet& wallet, const std::vector<uint256>& maturedTx, size_t from, size_t to, const std::map<COutPoint, uint32_t>& immatureStakes, std::vector<std::pair<const CWalletTx *, unsigned int> >& vCoins, std::map<COutPoint, CScriptCache>* insertScriptCache, bool isDescriptorWallet, std::map<uint160, bool>* insertAddressStake)
+void AvailableCoinsForStaking(const CWallet& wallet, const std::map<COutPoint, uint32_t>& immatureStakes, std::vector<std::pair<const CWalletTx *, unsigned int> >& vCoins) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
 {
-    for(size_t i = from; i < to; i++)
+    bool isDescriptorWallet = wallet.IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS);
+    int nHeight = wallet.GetLastBlockHeight() + 1;
+    int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
+    const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+    const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
+
+    // The indexed coins are confirmed, unspent and have a public key hash script
+    for (const CStakeableCoin& coin : wallet.GetStakeableCoins())
     {
-        auto it = wallet.mapWallet.find(maturedTx[i]);
-        if(it == wallet.mapWallet.end()) continue;
-        const uint256& wtxid = it->first;
-        const CWalletTx* pcoin = &(*it).second;
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            COutPoint prevout = COutPoint(Txid::FromUint256(wtxid), i);
-            isminetype mine = wallet.IsMine(pcoin->tx->vout[i]);
-            if (!(wallet.IsSpent(prevout)) && mine != ISMINE_NO &&
-                !wallet.IsLockedCoin(prevout) && (pcoin->tx->vout[i].nValue > 0) &&
-                // Check if the staking coin is dust
-                pcoin->tx->vout[i].nValue >= wallet.m_staker_min_utxo_size)
-            {
-                // Get the script data for the coin
-                const CScriptCache& scriptCache = wallet.GetScriptCache(prevout, pcoin->tx->vout[i].scriptPubKey, insertScriptCache);
+        // Check if the staking coin is dust, the coins are sorted by value
+        if (coin.value < wallet.m_staker_min_utxo_size)
+            break;
 
-                // Check that the script is not a contract script
-                if(scriptCache.contract || !scriptCache.keyIdOk)
-                    continue;
+        if ((coin.mine & is_mine_filter) == ISMINE_NO)
+            continue;
+
+        // Check the coin maturity
+        if (wallet.GetTxDepthInMainChain(*coin.wtx) < coinbaseMaturity || wallet.GetTxBlocksToMaturity(*coin.wtx) > 0)
+            continue;
 
-                // Check that the address is not delegated to other staker
-                if(wallet.m_my_delegations.find(scriptCache.keyId) != wallet.m_my_delegations.end())
-                    continue;
+        COutPoint prevout = COutPoint(coin.wtx->GetHash(), coin.n);
+        if (wallet.IsLockedCoin(prevout))
+            continue;
 
-                // Check that both pkh and pk descriptors are present
-                if(isDescriptorWallet && !wallet.HasAddressStakeScripts(scriptCache.keyId, insertAddressStake))
-                    continue;
+        // Check that the address is not delegated to other staker
+        if(wallet.m_my_delegations.find(coin.script.keyId) != wallet.m_my_delegations.end())
+            continue;
 
-                // Check prevout maturity
-                if(immatureStakes.find(prevout) == immatureStakes.end())
+        // Check that both pkh and pk descriptors are present
+        if(isDescriptorWallet)
+        {
+            bool hasAddressInCache = wallet.addressStakeCache.find(coin.script.keyId) != wallet.addressStakeCache.end();
+            if(!wallet.HasAddressStakeScripts(coin.script.keyId))
+            {
+                if(!hasAddressInCache)
                 {
-                    // Check if script is spendable
-                    bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && scriptCache.solvable);
-                    if(spendable)
-                        vCoins.push_back(std::make_pair(pcoin, i));
+                    // Log warning that descriptor is missing
+                    std::string strAddress = EncodeDestination(PKHash(coin.script.keyId));
+                    wallet.WalletLogPrintf("Both pkh and pk descriptors are needed for %s address to do staking\n", strAddress);
                 }
+                continue;
             }
         }
+
+        // Check prevout maturity
+        if(immatureStakes.find(prevout) == immatureStakes.end())
+        {
+            // Check if script is spendable
+            bool spendable = ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((coin.mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && coin.script.solvable);
+            if(spendable)
+                vCoins.push_back(std::make_pair(coin.wtx, coin.n));
+        }
     }
 }
 
@@ -555,24 +579,9 @@ bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<u
         CAmount weight = 0;
         mDelegateWeight[it->first] = weight;
 
-        // Get super staker custom configuration
-        CAmount staking_min_utxo_value = wallet.m_staking_min_utxo_value;
-        uint8_t staking_min_fee = wallet.m_staking_min_fee;
-        for (std::map<uint256, CSuperStakerInfo>::const_iterator it=mapStakers.begin(); it!=mapStakers.end(); it++)
-        {
-            if(it->second.stakerAddress == delegation->staker)
-            {
-                CSuperStakerInfo info = it->second;
-                if(info.fCustomConfig)
-                {
-                    staking_min_utxo_value = info.nMinDelegateUtxo;
-                    staking_min_fee = info.nMinFee;
-                }
-            }
-        }
-
-        // Check for min staking fee
-        if(delegation->fee < staking_min_fee)
+        // Check for min staking fee and get the min utxo value
+        CAmount staking_min_utxo_value = 0;
+        if(!wallet.GetDelegationStakingFilter(*delegation, mapStakers, staking_min_utxo_value))
             continue;
 
         // Decode address
@@ -614,122 +623,79 @@ bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<u
     return true;
 }
 
-void AvailableAddress(const CWallet& wallet, const std::vector<uint256> &maturedTx, size_t from, size_t to, std::map<uint160, bool> &mapAddress, std::map<COutPoint, CScriptCache> *insertScriptCache)
+bool GetDelegateStakeCoins(const CWallet& wallet, std::map<COutPoint, std::pair<CAmount, int>>& coins, int& height)
 {
-    for(size_t i = from; i < to; i++)
+    AssertLockHeld(wallet.cs_wallet);
+    coins.clear();
+
+    // Read the outputs at a single tip, the address index is written when blocks are connected
+    LOCK(cs_main);
+    height = wallet.chain().chainman().ActiveChain().Height();
+    for(const auto& [keyid, delegation] : wallet.m_delegations_staker)
     {
-        auto it = wallet.mapWallet.find(maturedTx[i]);
-        if(it == wallet.mapWallet.end()) continue;
-        const uint256& wtxid = it->first;
-        const CWalletTx* pcoin = &(*it).second;
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            COutPoint prevout = COutPoint(Txid::FromUint256(wtxid), i);
-            isminetype mine = wallet.IsMine(pcoin->tx->vout[i]);
-            if (!(wallet.IsSpent(prevout)) && mine != ISMINE_NO &&
-                !wallet.IsLockedCoin(prevout) && (pcoin->tx->vout[i].nValue > 0) &&
-                // Check if the staking coin is dust
-                pcoin->tx->vout[i].nValue >= wallet.m_staker_min_utxo_size)
-            {
-                // Get the script data for the coin
-                const CScriptCache& scriptCache = wallet.GetScriptCache(prevout, pcoin->tx->vout[i].scriptPubKey, insertScriptCache);
+        CAmount staking_min_utxo_value = 0;
+        if(!wallet.GetDelegationStakingFilter(delegation, wallet.mapSuperStaker, staking_min_utxo_value))
+            continue;
 
-                // Check that the script is not a contract script
-                if(scriptCache.contract || !scriptCache.keyIdOk)
-                    continue;
+        // Decode address
+        uint256 hashBytes;
+        int type = 0;
+        if (!DecodeIndexKey(EncodeDestination(PKHash(keyid)), hashBytes, type)) {
+            return error("Invalid address");
+        }
 
-                bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && scriptCache.solvable);
-                if(spendable)
-                {
-                    if(mapAddress.find(scriptCache.keyId) == mapAddress.end())
-                    {
-                        mapAddress[scriptCache.keyId] = true;
-                    }
-                }
-            }
+        // Get address utxos
+        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+        if (!GetAddressUnspent(hashBytes, type, unspentOutputs, wallet.chain().chainman().m_blockman)) {
+            return error("No information available for address");
+        }
+
+        // Add the utxos of at least the minimum value, mature or not
+        for (const auto& [key, value] : unspentOutputs) {
+            if(value.satoshis < staking_min_utxo_value)
+                continue;
+
+            coins[COutPoint(Txid::FromUint256(key.txhash), key.index)] = std::make_pair(value.satoshis, value.blockHeight);
         }
     }
+
+    return true;
 }
 
-bool SelectCoinsForStaking(const CWallet& wallet, CAmount &nTargetValue, std::set<std::pair<const CWalletTx *, unsigned int> > &setCoinsRet, CAmount &nValueRet)
+void AvailableAddress(const CWallet& wallet, std::map<uint160, bool> &mapAddress) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
 {
-    std::vector<std::pair<const CWalletTx *, unsigned int> > vCoins;
-    vCoins.clear();
-
-    bool isDescriptorWallet = wallet.IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS);
-    int nHeight = wallet.GetLastBlockHeight() + 1;
-    int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
-    std::map<COutPoint, uint32_t> immatureStakes = wallet.chain().getImmatureStakes();
-    std::vector<uint256> maturedTx;
     const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
     const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
-    for (auto it = wallet.mapWallet.begin(); it != wallet.mapWallet.end(); ++it)
-    {
-        // Check the cached data for available coins for the tx
-        const CWalletTx* pcoin = &(*it).second;
-        const CAmount tx_credit_mine{CachedTxGetAvailableCredit(wallet, *pcoin, is_mine_filter | ISMINE_NO)};
-        if(tx_credit_mine == 0)
-            continue;
-
-        const uint256& wtxid = it->first;
-        int nDepth = wallet.GetTxDepthInMainChain(*pcoin);
 
-        if (nDepth < 1)
-            continue;
+    for (const CStakeableCoin& coin : wallet.GetStakeableCoins())
+    {
+        // Check if the staking coin is dust, the coins are sorted by value
+        if (coin.value < wallet.m_staker_min_utxo_size)
+            break;
 
-        if (nDepth < coinbaseMaturity)
+        if ((coin.mine & is_mine_filter) == ISMINE_NO || wallet.GetTxBlocksToMaturity(*coin.wtx) > 0)
             continue;
 
-        if (wallet.GetTxBlocksToMaturity(*pcoin) > 0)
+        if (wallet.IsLockedCoin(COutPoint(coin.wtx->GetHash(), coin.n)))
             continue;
 
-        maturedTx.push_back(wtxid);
-    }
-
-    size_t listSize = maturedTx.size();
-    int numThreads = std::min(wallet.m_num_threads, (int)listSize);
-    if(numThreads < 2)
-    {
-        AvailableCoinsForStaking(wallet, maturedTx, 0, listSize, immatureStakes, vCoins, nullptr, isDescriptorWallet, nullptr);
-    }
-    else
-    {
-        size_t chunk = listSize / numThreads;
-        for(int i = 0; i < numThreads; i++)
+        bool spendable = ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((coin.mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && coin.script.solvable);
+        if(spendable)
         {
-            size_t from = i * chunk;
-            size_t to = i == (numThreads -1) ? listSize : from + chunk;
-            wallet.threads.create_thread([&wallet, from, to, &maturedTx, &immatureStakes, &vCoins, isDescriptorWallet]{
-                std::vector<std::pair<const CWalletTx *, unsigned int> > tmpCoins;
-                std::map<COutPoint, CScriptCache> tmpInsertScriptCache;
-                std::map<uint160, bool> tmpInsertAddressStake;
-                AvailableCoinsForStaking(wallet, maturedTx, from, to, immatureStakes, tmpCoins, &tmpInsertScriptCache, isDescriptorWallet, &tmpInsertAddressStake);
-
-                LOCK(wallet.cs_worker);
-                vCoins.insert(vCoins.end(), tmpCoins.begin(), tmpCoins.end());
-                if((int32_t)wallet.prevoutScriptCache.size() > wallet.m_staker_max_utxo_script_cache)
-                {
-                    wallet.prevoutScriptCache.clear();
-                }
-                wallet.prevoutScriptCache.insert(tmpInsertScriptCache.begin(), tmpInsertScriptCache.end());
-
-                // Insert the stake address cache and print warnings
-                for(std::map<uint160, bool>::iterator it = tmpInsertAddressStake.begin(); it != tmpInsertAddressStake.end(); ++it)
-                {
-                    if(wallet.addressStakeCache.find(it->first) == wallet.addressStakeCache.end())
-                    {
-                        if(!it->second)
-                        {
-                            // Log warning that descriptor is missing
-                            std::string strAddress = EncodeDestination(PKHash(it->first));
-                            wallet.WalletLogPrintf("Both pkh and pk descriptors are needed for %s address to do staking\n", strAddress);
-                        }
-                        wallet.addressStakeCache[it->first] = it->second;
-                    }
-                }
-            });
+            if(mapAddress.find(coin.script.keyId) == mapAddress.end())
+            {
+                mapAddress[coin.script.keyId] = true;
+            }
         }
-        wallet.threads.join_all();
     }
+}
+
+bool SelectCoinsForStaking(const CWallet& wallet, CAmount &nTargetValue, std::set<std::pair<const CWalletTx *, unsigned int> > &setCoinsRet, CAmount &nValueRet)
+{
+    LOCK(wallet.cs_wallet);
+    std::vector<std::pair<const CWalletTx *, unsigned int> > vCoins;
+    std::map<COutPoint, uint32_t> immatureStakes = wallet.chain().getImmatureStakes();
+    AvailableCoinsForStaking(wallet, immatureStakes, vCoins);
 
     setCoinsRet.clear();
     nValueRet = 0;
@@ -832,58 +798,8 @@ bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint>
 
 void SelectAddress(const CWallet& wallet, std::map<uint160, bool> &mapAddress)
 {
-    std::vector<uint256> maturedTx;
-    const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
-    const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
-    for (auto it = wallet.mapWallet.begin(); it != wallet.mapWallet.end(); ++it)
-    {
-        // Check the cached data for available coins for the tx
-        const CWalletTx* pcoin = &(*it).second;
-        const CAmount tx_credit_mine{CachedTxGetAvailableCredit(wallet, *pcoin, is_mine_filter | ISMINE_NO)};
-        if(tx_credit_mine == 0)
-            continue;
-
-        const uint256& wtxid = it->first;
-        int nDepth = wallet.GetTxDepthInMainChain(*pcoin);
-
-        if (nDepth < 1)
-            continue;
-
-        if (wallet.GetTxBlocksToMaturity(*pcoin) > 0)
-            continue;
-
-        maturedTx.push_back(wtxid);
-    }
-
-    size_t listSize = maturedTx.size();
-    int numThreads = std::min(wallet.m_num_threads, (int)listSize);
-    if(numThreads < 2)
-    {
-        AvailableAddress(wallet, maturedTx, 0, listSize, mapAddress, nullptr);
-    }
-    else
-    {
-        size_t chunk = listSize / numThreads;
-        for(int i = 0; i < numThreads; i++)
-        {
-            size_t from = i * chunk;
-            size_t to = i == (numThreads -1) ? listSize : from + chunk;
-            wallet.threads.create_thread([&wallet, from, to, &maturedTx, &mapAddress]{
-                std::map<uint160, bool> tmpAddresses;
-                std::map<COutPoint, CScriptCache> tmpInsertScriptCache;
-                AvailableAddress(wallet, maturedTx, from, to, tmpAddresses, &tmpInsertScriptCache);
-
-                LOCK(wallet.cs_worker);
-                mapAddress.insert(tmpAddresses.begin(), tmpAddresses.end());
-                if((int32_t)wallet.prevoutScriptCache.size() > wallet.m_staker_max_utxo_script_cache)
-                {
-                    wallet.prevoutScriptCache.clear();
-                }
-                wallet.prevoutScriptCache.insert(tmpInsertScriptCache.begin(), tmpInsertScriptCache.end());
-            });
-        }
-        wallet.threads.join_all();
-    }
+    LOCK(wallet.cs_wallet);
+    AvailableAddress(wallet, mapAddress);
 }
 
 void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<COutPoint> &prevouts, CBlockIndex *pindexPrev )
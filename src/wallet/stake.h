@@ -27,6 +27,9 @@ void SelectAddress(const CWallet& wallet, std::map<uint160, bool>& mapAddress);
 //! update miner stake cache.
 void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<COutPoint>& prevouts, CBlockIndex* pindexPrev);
 
+//! get the outputs delegated to the wallet that can stake, mature or not, with their value and height, and the tip they are read at.
+bool GetDelegateStakeCoins(const CWallet& wallet, std::map<COutPoint, std::pair<CAmount, int>>& coins, int& height);
+
 //! get stake weight.
 uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr);
 
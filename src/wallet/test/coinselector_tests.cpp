@@ -811,6 +811,26 @@ BOOST_AUTO_TEST_CASE(knapsack_solver_test)
     }
 }
 
+// Tests that the knapsack solver only searches among the largest groups of a wallet with very many small coins
+BOOST_AUTO_TEST_CASE(knapsack_many_small_groups)
+{
+    FastRandomContext rand{};
+    std::unique_ptr<CWallet> wallet = NewWallet(m_node);
+
+    CoinsResult available_coins;
+    for (size_t i = 0; i < KNAPSACK_MAX_GROUPS; i++) {
+        add_coin(available_coins, *wallet, 1 * CENT);
+        add_coin(available_coins, *wallet, 2 * CENT);
+    }
+
+    const auto result = KnapsackSolver(KnapsackGroupOutputs(available_coins, *wallet, filter_standard), 1000 * CENT, CENT, rand);
+    BOOST_CHECK(result);
+    BOOST_CHECK_GE(result->GetSelectedValue(), 1000 * CENT);
+    for (const auto& coin : result->GetInputSet()) {
+        BOOST_CHECK_EQUAL(coin->txout.nValue, 2 * CENT);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(ApproximateBestSubset)
 {
     FastRandomContext rand{};
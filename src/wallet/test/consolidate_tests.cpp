@@ -0,0 +1,56 @@
+// Copyright (c) 2024-present The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/amount.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <wallet/consolidate.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(consolidate_tests, BasicTestingSetup)
+
+static void AddCoins(std::vector<ConsolidationCoin>& coins, int count, CAmount value, bool has_weight)
+{
+    for (int i = 0; i < count; ++i) {
+        coins.push_back({COutPoint(Txid::FromUint256(InsecureRand256()), 0), value, has_weight});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(plan_consolidation)
+{
+    std::vector<ConsolidationCoin> coins;
+    AddCoins(coins, 30, COIN, /*has_weight=*/true);
+    AddCoins(coins, 50, COIN / 100, /*has_weight=*/false);
+
+    ConsolidationParams params;
+    params.target_value = 10 * COIN;
+
+    // Nothing to do when the wallet has no more outputs than the target
+    BOOST_CHECK(PlanConsolidation(coins, params).inputs.empty());
+
+    // The outputs without stake weight are spent first, the others are kept out of the budget
+    params.excess = 70;
+    params.weight_budget = 0;
+    ConsolidationPlan plan = PlanConsolidation(coins, params);
+    BOOST_CHECK_EQUAL(plan.inputs.size(), 50U);
+    BOOST_CHECK_EQUAL(plan.total, COIN / 2);
+    BOOST_CHECK_EQUAL(plan.outputs, 1);
+
+    // Outputs with stake weight are spent within the budget, and split into outputs of the target value
+    params.weight_budget = 25 * COIN;
+    plan = PlanConsolidation(coins, params);
+    BOOST_CHECK_EQUAL(plan.inputs.size(), 71U);
+    BOOST_CHECK_EQUAL(plan.total, 21 * COIN + COIN / 2);
+    BOOST_CHECK_EQUAL(plan.outputs, 2);
+
+    // A single output is not consolidated
+    params.excess = 10;
+    coins.resize(1);
+    BOOST_CHECK(PlanConsolidation(coins, params).inputs.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
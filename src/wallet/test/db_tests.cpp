@@ -357,6 +357,62 @@ BOOST_AUTO_TEST_CASE(concurrent_txn_dont_interfere)
     BOOST_CHECK(handler2->Read(key, read_value));
     BOOST_CHECK_EQUAL(read_value, value2);
 }
+
+BOOST_AUTO_TEST_CASE(group_commit)
+{
+    DatabaseOptions options;
+    options.group_commit_ms = 60 * 1000;
+    DatabaseStatus status;
+    bilingual_str error;
+    std::unique_ptr<SQLiteDatabase> database = MakeSQLiteDatabase(m_path_root / "sqlite", options, status, error);
+
+    std::string value = "value";
+    std::string read_value;
+
+    // Writes of batches not flushed on close join the group transaction
+    std::unique_ptr<DatabaseBatch> batch = database->MakeBatch(/*flush_on_close=*/false);
+    BOOST_CHECK(batch->Write(std::string("key"), value));
+    BOOST_CHECK(batch->Write(std::string("key2"), value));
+    BOOST_CHECK(database->HasActiveTxn());
+    batch.reset();
+    BOOST_CHECK(database->HasActiveTxn());
+
+    // And are seen by the other batches of the connection
+    std::unique_ptr<DatabaseBatch> batch2 = database->MakeBatch();
+    BOOST_CHECK(batch2->Read(std::string("key"), read_value));
+    BOOST_CHECK_EQUAL(read_value, value);
+
+    // A durable write commits the group first
+    BOOST_CHECK(batch2->Write(std::string("key3"), value));
+    BOOST_CHECK(!database->HasActiveTxn());
+
+    // Flush commits the group
+    std::unique_ptr<DatabaseBatch> batch3 = database->MakeBatch(/*flush_on_close=*/false);
+    BOOST_CHECK(batch3->Erase(std::string("key2")));
+    BOOST_CHECK(database->HasActiveTxn());
+    database->Flush();
+    BOOST_CHECK(!database->HasActiveTxn());
+
+    // A transaction can begin while the group is open, the group is committed
+    // and the transaction can be aborted without losing the grouped writes
+    BOOST_CHECK(batch3->Write(std::string("key4"), value));
+    BOOST_CHECK(batch2->TxnBegin());
+    BOOST_CHECK(batch2->Write(std::string("key5"), value));
+    BOOST_CHECK(batch2->TxnAbort());
+    BOOST_CHECK(batch2->Exists(std::string("key4")));
+    BOOST_CHECK(!batch2->Exists(std::string("key5")));
+    BOOST_CHECK(!batch2->Exists(std::string("key2")));
+
+    // The group is committed when the database is closed
+    BOOST_CHECK(batch3->Write(std::string("key6"), value));
+    batch2.reset();
+    batch3.reset();
+    database->Close();
+    BOOST_CHECK(!database->HasActiveTxn());
+    database->Open();
+    BOOST_CHECK(database->MakeBatch()->Read(std::string("key6"), read_value));
+    BOOST_CHECK_EQUAL(read_value, value);
+}
 #endif // USE_SQLITE
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -641,6 +641,135 @@ BOOST_FIXTURE_TEST_CASE(ListCoinsTest, ListCoinsTestingSetup)
     BOOST_CHECK_EQUAL(list.begin()->second.size(), 2U);
 }
 
+static std::set<COutPoint> StakeableOutpoints(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    std::set<COutPoint> outpoints;
+    const std::vector<CStakeableCoin>& coins = wallet.GetStakeableCoins();
+    for (size_t i = 0; i < coins.size(); ++i) {
+        if (i > 0) BOOST_CHECK(coins[i - 1].value >= coins[i].value);
+        BOOST_CHECK_EQUAL(coins[i].value, coins[i].wtx->tx->vout[coins[i].n].nValue);
+        outpoints.emplace(coins[i].wtx->GetHash(), coins[i].n);
+    }
+    return outpoints;
+}
+
+BOOST_FIXTURE_TEST_CASE(StakeableCoinsTest, ListCoinsTestingSetup)
+{
+    // The index holds the same coins as a scan of the wallet
+    auto scan = [&]() EXCLUSIVE_LOCKS_REQUIRED(wallet->cs_wallet) {
+        std::set<COutPoint> outpoints;
+        for (const auto& [txid, wtx] : wallet->mapWallet) {
+            if (!wtx.isConfirmed()) continue;
+            for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
+                COutPoint prevout(wtx.GetHash(), i);
+                if (wtx.tx->vout[i].nValue > 0 && wallet->IsMine(wtx.tx->vout[i]) != ISMINE_NO && !wallet->IsSpent(prevout)) {
+                    outpoints.insert(prevout);
+                }
+            }
+        }
+        return outpoints;
+    };
+    std::set<COutPoint> before;
+    {
+        LOCK(wallet->cs_wallet);
+        before = StakeableOutpoints(*wallet);
+        BOOST_CHECK(!before.empty());
+        BOOST_CHECK(before == scan());
+    }
+
+    // Spending a coin updates the index with the spent input and the change
+    const CWalletTx& wtx = AddTx(CRecipient{PubKeyDestination{{}}, 1 * COIN, /*subtract_fee=*/false});
+    {
+        LOCK(wallet->cs_wallet);
+        std::set<COutPoint> after = StakeableOutpoints(*wallet);
+        BOOST_CHECK(after == scan());
+        for (const CTxIn& txin : wtx.tx->vin) {
+            BOOST_CHECK(before.count(txin.prevout));
+            BOOST_CHECK(!after.count(txin.prevout));
+        }
+        BOOST_CHECK(std::any_of(after.begin(), after.end(), [&](const COutPoint& prevout) { return prevout.hash == wtx.GetHash(); }));
+
+        // Locked coins stay indexed, the staker skips them
+        wallet->LockCoin(*after.begin());
+        BOOST_CHECK(StakeableOutpoints(*wallet) == after);
+
+        // The index is built again when the whole wallet is marked dirty
+        wallet->MarkDirty();
+        BOOST_CHECK(StakeableOutpoints(*wallet) == after);
+    }
+}
+
+static std::set<COutPoint> SpendableOutpoints(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    std::set<COutPoint> outpoints;
+    for (const auto& [txid, outputs] : wallet.GetSpendableCoins()) {
+        BOOST_CHECK(!outputs.empty());
+        for (unsigned int n : outputs) {
+            outpoints.emplace(Txid::FromUint256(txid), n);
+        }
+    }
+    return outpoints;
+}
+
+BOOST_FIXTURE_TEST_CASE(SpendableCoinsTest, ListCoinsTestingSetup)
+{
+    // The index holds the same outputs as a scan of the wallet
+    auto scan = [&]() EXCLUSIVE_LOCKS_REQUIRED(wallet->cs_wallet) {
+        std::set<COutPoint> outpoints;
+        for (const auto& [txid, wtx] : wallet->mapWallet) {
+            for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
+                COutPoint prevout(wtx.GetHash(), i);
+                if (wallet->IsMine(wtx.tx->vout[i]) != ISMINE_NO && !wallet->IsSpent(prevout)) {
+                    outpoints.insert(prevout);
+                }
+            }
+        }
+        return outpoints;
+    };
+    std::set<COutPoint> before;
+    {
+        LOCK(wallet->cs_wallet);
+        before = SpendableOutpoints(*wallet);
+        BOOST_CHECK(!before.empty());
+        BOOST_CHECK(before == scan());
+    }
+
+    // Keep the spending transaction out of the mempool, so it can be abandoned
+    wallet->SetBroadcastTransactions(false);
+    CTransactionRef tx;
+    {
+        CCoinControl dummy;
+        auto res = CreateTransaction(*wallet, {CRecipient{PubKeyDestination{{}}, 1 * COIN, /*subtract_fee=*/false}}, /*change_pos=*/std::nullopt, dummy);
+        BOOST_REQUIRE(res);
+        tx = res->tx;
+    }
+    wallet->CommitTransaction(tx, {}, {});
+
+    LOCK(wallet->cs_wallet);
+
+    // Spending a coin updates the index with the spent input and the change
+    const std::set<COutPoint> spent = SpendableOutpoints(*wallet);
+    BOOST_CHECK(spent == scan());
+    for (const CTxIn& txin : tx->vin) {
+        BOOST_CHECK(before.count(txin.prevout));
+        BOOST_CHECK(!spent.count(txin.prevout));
+    }
+    BOOST_CHECK(std::any_of(spent.begin(), spent.end(), [&](const COutPoint& prevout) { return prevout.hash == tx->GetHash(); }));
+
+    // Abandoning the spending transaction gives the inputs back
+    BOOST_CHECK(wallet->AbandonTransaction(tx->GetHash()));
+    const std::set<COutPoint> abandoned = SpendableOutpoints(*wallet);
+    BOOST_CHECK(abandoned == scan());
+    for (const CTxIn& txin : tx->vin) {
+        BOOST_CHECK(abandoned.count(txin.prevout));
+    }
+
+    // The index is built again when the whole wallet is marked dirty
+    wallet->MarkDirty();
+    BOOST_CHECK(SpendableOutpoints(*wallet) == abandoned);
+    BOOST_CHECK(SpendableOutpoints(*wallet) == scan());
+}
+
 void TestCoinsResult(ListCoinsTest& context, OutputType out_type, CAmount amount,
                      std::map<OutputType, size_t>& expected_coins_sizes)
 {
@@ -33,6 +33,7 @@
 #include <primitives/transaction.h>
 #include <psbt.h>
 #include <pubkey.h>
+#include <qtum/qtumtoken.h>
 #include <random.h>
 #include <script/descriptor.h>
 #include <script/interpreter.h>
@@ -59,6 +60,7 @@
 #include <util/moneystr.h>
 #include <util/result.h>
 #include <util/string.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <util/convert.h>
 #include <util/translation.h>
@@ -76,6 +78,7 @@
 #include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <exception>
 #include <optional>
 #include <stdexcept>
@@ -360,6 +363,156 @@ private:
         }
     }
 };
+
+/**
+ * Selects the blocks a rescan has to inspect from the address index, which
+ * lists the heights of the transactions paying to or spending from each
+ * script. Scripts derived by keypool top-ups are looked up as they appear.
+ */
+class AddressIndexRescanFilter
+{
+public:
+    AddressIndexRescanFilter(const CWallet& wallet, int start_height, int end_height)
+        : m_wallet(wallet), m_start_height(start_height), m_end_height(end_height)
+    {
+        // like the block filters, only descriptor wallets can tell which scripts are new
+        assert(!m_wallet.IsLegacy());
+
+        for (auto spkm : m_wallet.GetAllScriptPubKeyMans()) {
+            auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(spkm)};
+            assert(desc_spkm != nullptr);
+            AddScriptPubKeys(desc_spkm, start_height);
+            if (desc_spkm->IsHDEnabled()) {
+                m_last_range_ends.emplace(desc_spkm->GetID(), desc_spkm->GetEndRange());
+            }
+        }
+    }
+
+    void UpdateIfNeeded(int height)
+    {
+        for (const auto& [desc_spkm_id, last_range_end] : m_last_range_ends) {
+            auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(m_wallet.GetScriptPubKeyMan(desc_spkm_id))};
+            assert(desc_spkm != nullptr);
+            int32_t current_range_end{desc_spkm->GetEndRange()};
+            if (current_range_end > last_range_end) {
+                AddScriptPubKeys(desc_spkm, height, last_range_end);
+                m_last_range_ends.at(desc_spkm->GetID()) = current_range_end;
+            }
+        }
+    }
+
+    //! Whether the block at a height has wallet transactions, or std::nullopt
+    //! if the index can't tell, so that the block has to be inspected.
+    std::optional<bool> MatchesBlock(int height) const
+    {
+        if (!m_complete || height < m_start_height || height > m_end_height) return std::nullopt;
+        return m_heights.count(height) > 0;
+    }
+
+    bool IsComplete() const { return m_complete; }
+
+private:
+    const CWallet& m_wallet;
+    const int m_start_height;
+    const int m_end_height;
+    std::map<uint256, int32_t> m_last_range_ends;
+    std::set<int> m_heights;
+    //! False once a script could not be looked up in the index
+    bool m_complete{true};
+
+    void AddScriptPubKeys(const DescriptorScriptPubKeyMan* desc_spkm, int from_height, int32_t last_range_end = 0)
+    {
+        const auto script_pub_keys{desc_spkm->GetScriptPubKeys(last_range_end)};
+        const std::vector<CScript> scripts(script_pub_keys.begin(), script_pub_keys.end());
+        if (!m_wallet.chain().findAddressIndexHeights(scripts, from_height, m_end_height, m_heights)) {
+            m_complete = false;
+        }
+    }
+};
+
+/**
+ * Reads the blocks a rescan is going to inspect on a few threads ahead of it,
+ * so that reading and deserializing them overlaps with the wallet updates,
+ * which are still applied one block at a time in chain order.
+ */
+class RescanBlockPrefetcher
+{
+public:
+    RescanBlockPrefetcher(interfaces::Chain& chain, int threads) : m_chain(chain)
+    {
+        for (int n = 0; n < threads; ++n) {
+            m_threads.emplace_back([this, n]() {
+                util::ThreadRename(strprintf("rescan.%i", n));
+                ThreadRead();
+            });
+        }
+    }
+
+    ~RescanBlockPrefetcher()
+    {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_cv.notify_all();
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+    }
+
+    //! Queue a block to be read
+    void Add(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            LOCK(m_mutex);
+            if (!m_blocks.emplace(block_hash, std::nullopt).second) return;
+            m_queue.push_back(block_hash);
+        }
+        m_cv.notify_all();
+    }
+
+    //! Wait for a queued block to be read. Returns false if it was not queued.
+    bool Take(const uint256& block_hash, CBlock& block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        auto it = m_blocks.find(block_hash);
+        if (it == m_blocks.end()) return false;
+        while (!it->second) {
+            m_cv.wait(lock);
+        }
+        block = std::move(*it->second);
+        m_blocks.erase(it);
+        return true;
+    }
+
+private:
+    interfaces::Chain& m_chain;
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<uint256> m_queue GUARDED_BY(m_mutex);
+    //! Queued blocks, set once they are read
+    std::map<uint256, std::optional<CBlock>> m_blocks GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void ThreadRead() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            uint256 block_hash;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                while (!m_request_stop && m_queue.empty()) {
+                    m_cv.wait(lock);
+                }
+                if (m_request_stop) return;
+                block_hash = m_queue.front();
+                m_queue.pop_front();
+            }
+            // A block that can't be read is left null, for the scan to record the failure
+            CBlock block;
+            m_chain.findBlock(block_hash, FoundBlock().data(block));
+            WITH_LOCK(m_mutex, m_blocks[block_hash] = std::move(block));
+            m_cv.notify_all();
+        }
+    }
+};
 } // namespace
 
 std::shared_ptr<CWallet> LoadWallet(WalletContext& context, const std::string& name, std::optional<bool> load_on_start, const DatabaseOptions& options, DatabaseStatus& status, bilingual_str& error, std::vector<bilingual_str>& warnings)
@@ -996,6 +1149,9 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+        m_stakeable_coins_rebuild = true;
+        m_spendable_coins_rebuild = true;
+        m_spend_info_cache.clear();
     }
 }
 
@@ -1155,6 +1311,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
             desc_tx->MarkDirty();
             batch.WriteTx(*desc_tx);
             MarkInputsDirty(desc_tx->tx);
+            MarkStakeableCoinsDirty(*desc_tx->tx);
             for (unsigned int i = 0; i < desc_tx->tx->vout.size(); ++i) {
                 COutPoint outpoint(desc_tx->GetHash(), i);
                 std::pair<TxSpends::const_iterator, TxSpends::const_iterator> range = mapTxSpends.equal_range(outpoint);
@@ -1205,6 +1362,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
+    MarkStakeableCoinsDirty(*wtx.tx);
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1442,6 +1600,7 @@ void CWallet::RecursiveUpdateTxState(const uint256& tx_hash, const TryUpdatingSt
         TxUpdate update_state = try_updating_state(wtx);
         if (update_state != TxUpdate::UNCHANGED) {
             wtx.MarkDirty();
+            MarkStakeableCoinsDirty(*wtx.tx);
             batch.WriteTx(wtx);
             // Iterate over all its outputs, and update those tx states as well (if applicable)
             for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
@@ -1546,6 +1705,12 @@ void CWallet::blockConnected(ChainstateRole role, const interfaces::BlockInfo& b
     m_last_block_processed_height = block.height;
     m_last_block_processed = block.hash;
 
+    // Delegated outputs are added and spent by any transaction of the block
+    ConnectDelegateStakeCoins(block);
+
+    // Token transfers are tracked regardless of the wallet birthday
+    SyncTokenLogs(block);
+
     // No need to scan block if it was created before the wallet birthday.
     // Uses chain max time and twice the grace period to adjust time for block time variability.
     if (block.chain_time_max < m_birth_time.load() - (TIMESTAMP_WINDOW * 2)) return;
@@ -1568,6 +1733,12 @@ void CWallet::blockDisconnected(const interfaces::BlockInfo& block)
     // future with a stickier abandoned state or even removing abandontransaction call.
     m_last_block_processed_height = block.height - 1;
     m_last_block_processed = *Assert(block.prev_hash);
+    DisconnectDelegateStakeCoins(block);
+
+    // The receipts of the block are gone, read the token balances again
+    for (auto it = m_token_balances.begin(); it != m_token_balances.end();) {
+        it = it->second.height >= block.height ? m_token_balances.erase(it) : std::next(it);
+    }
 
     int disconnect_height = block.height;
 
@@ -1912,17 +2083,31 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     uint256 block_hash = start_block;
     ScanResult result;
 
+    fAbortRescan = false;
+    ShowProgress(strprintf("%s " + _("Rescanning…").translated, GetDisplayName()), 0); // show rescan progress in GUI as dialog or on splashscreen, if rescan required on startup (e.g. due to corruption)
+    uint256 tip_hash = WITH_LOCK(cs_wallet, return GetLastBlockHash());
+    int end_height = WITH_LOCK(cs_wallet, return GetLastBlockHeight());
+    uint256 end_hash = tip_hash;
+    if (max_height) {
+        chain().findAncestorByHeight(tip_hash, *max_height, FoundBlock().hash(end_hash));
+        end_height = std::min(end_height, *max_height);
+    }
+
+    std::unique_ptr<AddressIndexRescanFilter> address_rescan_filter;
+    if (!IsLegacy() && chain().hasAddressIndex()) {
+        address_rescan_filter = std::make_unique<AddressIndexRescanFilter>(*this, start_height, end_height);
+        if (!address_rescan_filter->IsComplete()) address_rescan_filter.reset();
+    }
     std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
     if (!IsLegacy() && chain().hasBlockFilterIndex(BlockFilterType::BASIC)) fast_rescan_filter = std::make_unique<FastWalletRescanFilter>(*this);
 
     WalletLogPrintf("Rescan started from block %s... (%s)\n", start_block.ToString(),
+                    address_rescan_filter ? "fast variant using the address index" :
                     fast_rescan_filter ? "fast variant using block filters" : "slow variant inspecting all blocks");
 
-    fAbortRescan = false;
-    ShowProgress(strprintf("%s " + _("Rescanning…").translated, GetDisplayName()), 0); // show rescan progress in GUI as dialog or on splashscreen, if rescan required on startup (e.g. due to corruption)
-    uint256 tip_hash = WITH_LOCK(cs_wallet, return GetLastBlockHash());
-    uint256 end_hash = tip_hash;
-    if (max_height) chain().findAncestorByHeight(tip_hash, *max_height, FoundBlock().hash(end_hash));
+    // Blocks that are going to be inspected are read ahead, up to the end of the scan range
+    RescanBlockPrefetcher prefetcher(chain(), RESCAN_PREFETCH_THREADS);
+    int prefetch_height = start_height;
     double progress_begin = chain().guessVerificationProgress(block_hash);
     double progress_end = chain().guessVerificationProgress(end_hash);
     double progress_current = progress_begin;
@@ -1943,8 +2128,30 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
         }
 
+        for (; prefetch_height <= end_height && prefetch_height <= block_height + RESCAN_PREFETCH_BLOCKS; ++prefetch_height) {
+            if (prefetch_height < block_height) continue;
+            if (address_rescan_filter && address_rescan_filter->MatchesBlock(prefetch_height) == false) continue;
+            uint256 prefetch_hash;
+            if (!chain().findAncestorByHeight(end_hash, prefetch_height, FoundBlock().hash(prefetch_hash))) break;
+            if (!address_rescan_filter && fast_rescan_filter && fast_rescan_filter->MatchesBlock(prefetch_hash) == false) continue;
+            prefetcher.Add(prefetch_hash);
+        }
+
         bool fetch_block{true};
-        if (fast_rescan_filter) {
+        std::optional<bool> matches_address_index;
+        if (address_rescan_filter) {
+            address_rescan_filter->UpdateIfNeeded(block_height);
+            matches_address_index = address_rescan_filter->MatchesBlock(block_height);
+        }
+        if (matches_address_index.has_value()) {
+            if (*matches_address_index) {
+                LogPrint(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (address index matched)\n", block_height, block_hash.ToString());
+            } else {
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+                fetch_block = false;
+            }
+        } else if (fast_rescan_filter) {
             fast_rescan_filter->UpdateIfNeeded();
             auto matches_block{fast_rescan_filter->MatchesBlock(block_hash)};
             if (matches_block.has_value()) {
@@ -1970,7 +2177,9 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         if (fetch_block) {
             // Read block data
             CBlock block;
-            chain().findBlock(block_hash, FoundBlock().data(block));
+            if (!prefetcher.Take(block_hash, block)) {
+                chain().findBlock(block_hash, FoundBlock().data(block));
+            }
 
             if (!block.IsNull()) {
                 LOCK(cs_wallet);
@@ -2197,30 +2406,248 @@ const CScriptCache& CWallet::GetScriptCache(const COutPoint& prevout, const CScr
         }
 
         // The script check for utxo is expensive operations, so cache the data for further use
-        CScriptCache scriptCache;
-        scriptCache.contract = scriptPubKey.HasOpCall() || scriptPubKey.HasOpCreate();
-        if(!scriptCache.contract)
+        insertScriptCache[prevout] = MakeScriptCache(scriptPubKey);
+        return insertScriptCache[prevout];
+    }
+
+    return it->second;
+}
+
+CScriptCache CWallet::MakeScriptCache(const CScript& scriptPubKey) const
+{
+    CScriptCache scriptCache;
+    scriptCache.contract = scriptPubKey.HasOpCall() || scriptPubKey.HasOpCreate();
+    if(!scriptCache.contract)
+    {
+        scriptCache.keyId = ToKeyID(ExtractPublicKeyHash(scriptPubKey, &(scriptCache.keyIdOk)));
+        if(scriptCache.keyIdOk)
         {
-            scriptCache.keyId = ToKeyID(ExtractPublicKeyHash(scriptPubKey, &(scriptCache.keyIdOk)));
-            if(scriptCache.keyIdOk)
+            std::unique_ptr<SigningProvider> provider = GetSolvingProvider(scriptPubKey);
+            if(provider)
             {
-                std::unique_ptr<SigningProvider> provider = GetSolvingProvider(scriptPubKey);
-                if(provider)
-                {
-                    auto inferred = InferDescriptor(scriptPubKey, *provider);
-                    scriptCache.solvable = inferred ? inferred->IsSolvable() : false;
-                }
-                else
-                {
-                    scriptCache.solvable = false;
-                }
+                auto inferred = InferDescriptor(scriptPubKey, *provider);
+                scriptCache.solvable = inferred ? inferred->IsSolvable() : false;
+            }
+            else
+            {
+                scriptCache.solvable = false;
             }
         }
-        insertScriptCache[prevout] = scriptCache;
-        return insertScriptCache[prevout];
     }
+    return scriptCache;
+}
 
-    return it->second;
+const std::vector<CStakeableCoin>& CWallet::GetStakeableCoins() const
+{
+    AssertLockHeld(cs_wallet);
+    UpdateStakeableCoins();
+    if(!m_stakeable_coins_unsorted)
+    {
+        return m_stakeable_coins_sorted;
+    }
+
+    m_stakeable_coins_unsorted = false;
+    m_stakeable_coins_sorted.clear();
+    for(const auto& [txid, coins] : m_stakeable_coins)
+    {
+        m_stakeable_coins_sorted.insert(m_stakeable_coins_sorted.end(), coins.begin(), coins.end());
+    }
+    std::stable_sort(m_stakeable_coins_sorted.begin(), m_stakeable_coins_sorted.end(), [](const CStakeableCoin& a, const CStakeableCoin& b) {
+        return a.value > b.value;
+    });
+    return m_stakeable_coins_sorted;
+}
+
+void CWallet::UpdateStakeableCoins() const
+{
+    AssertLockHeld(cs_wallet);
+
+    // The coins mature later after the maturity changes at a fork height
+    const int maturity = m_last_block_processed_height >= 0 ? Params().GetConsensus().CoinbaseMaturity(m_last_block_processed_height + 1) : 0;
+    if(maturity != m_stake_weight_maturity)
+    {
+        m_stake_weight_maturity = maturity;
+        m_stakeable_coins_rebuild = true;
+        m_delegate_stake_coins_rebuild = true;
+    }
+
+    if(m_stakeable_coins_rebuild)
+    {
+        m_stakeable_coins.clear();
+        m_stakeable_coins_dirty.clear();
+        m_staker_weight.Clear();
+        for(const auto& [txid, wtx] : mapWallet)
+        {
+            IndexStakeableCoins(wtx);
+        }
+        m_stakeable_coins_rebuild = false;
+        m_stakeable_coins_unsorted = true;
+    }
+    else if(!m_stakeable_coins_dirty.empty())
+    {
+        for(const uint256& txid : m_stakeable_coins_dirty)
+        {
+            UnindexStakeableCoins(txid);
+            auto it = mapWallet.find(txid);
+            if(it != mapWallet.end())
+            {
+                IndexStakeableCoins(it->second);
+            }
+        }
+        m_stakeable_coins_dirty.clear();
+        m_stakeable_coins_unsorted = true;
+    }
+}
+
+void CWallet::IndexStakeableCoins(const CWalletTx& wtx) const
+{
+    AssertLockHeld(cs_wallet);
+    if(!wtx.isConfirmed())
+        return;
+
+    // Same checks as AvailableCoinsForStaking, except the maturity which depends on the tip
+    const bool isDescriptorWallet = IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS);
+    const bool include_watch_only = GetLegacyScriptPubKeyMan() && IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+    const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
+    const bool coinbase = wtx.IsCoinBase() || wtx.IsCoinStake();
+    const int mature_height = wtx.state<TxStateConfirmed>()->confirmed_block_height + m_stake_weight_maturity - 1 + (coinbase ? 1 : 0);
+
+    std::vector<CStakeableCoin> coins;
+    for(unsigned int i = 0; i < wtx.tx->vout.size(); i++)
+    {
+        const CTxOut& txout = wtx.tx->vout[i];
+        if(txout.nValue <= 0)
+            continue;
+
+        CStakeableCoin coin;
+        coin.mine = IsMine(txout);
+        if(coin.mine == ISMINE_NO || IsSpent(COutPoint(wtx.GetHash(), i)))
+            continue;
+
+        // Contract outputs and scripts without a public key hash can't stake
+        coin.script = MakeScriptCache(txout.scriptPubKey);
+        if(coin.script.contract || !coin.script.keyIdOk)
+            continue;
+
+        coin.wtx = &wtx;
+        coin.n = i;
+        coin.value = txout.nValue;
+        coin.mature_height = mature_height;
+
+        bool spendable = ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((coin.mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && coin.script.solvable);
+        if(spendable && coin.value >= m_staker_min_utxo_size && (coin.mine & is_mine_filter) != ISMINE_NO &&
+           !IsLockedCoin(COutPoint(wtx.GetHash(), i)) && m_my_delegations.find(coin.script.keyId) == m_my_delegations.end() &&
+           (!isDescriptorWallet || HasAddressStakeScripts(coin.script.keyId)))
+        {
+            coin.weight = coin.value;
+            m_staker_weight.AddCoin(coin.weight, coin.mature_height, coin.weight >= DEFAULT_STAKING_MIN_UTXO_VALUE);
+        }
+        coins.push_back(coin);
+    }
+    if(!coins.empty())
+    {
+        m_stakeable_coins[wtx.GetHash()] = std::move(coins);
+    }
+}
+
+void CWallet::UnindexStakeableCoins(const uint256& txid) const
+{
+    AssertLockHeld(cs_wallet);
+    auto it = m_stakeable_coins.find(txid);
+    if(it == m_stakeable_coins.end())
+        return;
+
+    for(const CStakeableCoin& coin : it->second)
+    {
+        if(coin.weight > 0)
+        {
+            m_staker_weight.RemoveCoin(coin.weight, coin.mature_height, coin.weight >= DEFAULT_STAKING_MIN_UTXO_VALUE);
+        }
+    }
+    m_stakeable_coins.erase(it);
+}
+
+void CWallet::MarkStakeableCoinsDirty(const CTransaction& tx)
+{
+    AssertLockHeld(cs_wallet);
+    std::vector<uint256> txids{tx.GetHash()};
+    for(const CTxIn& txin : tx.vin)
+    {
+        if(mapWallet.count(txin.prevout.hash))
+        {
+            txids.push_back(txin.prevout.hash);
+        }
+    }
+
+    // The spendable coins are indexed again on the same changes
+    for(const uint256& txid : txids)
+    {
+        if(!m_stakeable_coins_rebuild) m_stakeable_coins_dirty.insert(txid);
+        if(!m_spendable_coins_rebuild) m_spendable_coins_dirty.insert(txid);
+    }
+}
+
+const std::map<uint256, std::vector<unsigned int>>& CWallet::GetSpendableCoins() const
+{
+    AssertLockHeld(cs_wallet);
+    if(m_spendable_coins_rebuild)
+    {
+        m_spendable_coins.clear();
+        m_spendable_coins_dirty.clear();
+        for(const auto& [txid, wtx] : mapWallet)
+        {
+            IndexSpendableCoins(wtx);
+        }
+        m_spendable_coins_rebuild = false;
+    }
+    else if(!m_spendable_coins_dirty.empty())
+    {
+        for(const uint256& txid : m_spendable_coins_dirty)
+        {
+            m_spendable_coins.erase(txid);
+            auto it = mapWallet.find(txid);
+            if(it != mapWallet.end())
+            {
+                IndexSpendableCoins(it->second);
+            }
+        }
+        m_spendable_coins_dirty.clear();
+    }
+    return m_spendable_coins;
+}
+
+void CWallet::IndexSpendableCoins(const CWalletTx& wtx) const
+{
+    AssertLockHeld(cs_wallet);
+    std::vector<unsigned int> outputs;
+    for(unsigned int i = 0; i < wtx.tx->vout.size(); i++)
+    {
+        if(IsMine(wtx.tx->vout[i]) != ISMINE_NO && !IsSpent(COutPoint(wtx.GetHash(), i)))
+        {
+            outputs.push_back(i);
+        }
+    }
+    if(!outputs.empty())
+    {
+        m_spendable_coins[wtx.GetHash()] = std::move(outputs);
+    }
+}
+
+const CSpendInfo* CWallet::GetCachedSpendInfo(const CScript& scriptPubKey, bool use_max_sig) const
+{
+    AssertLockHeld(cs_wallet);
+    auto it = m_spend_info_cache.find(std::make_pair(scriptPubKey, use_max_sig));
+    return it != m_spend_info_cache.end() ? &it->second : nullptr;
+}
+
+void CWallet::CacheSpendInfo(const CScript& scriptPubKey, bool use_max_sig, const CSpendInfo& info) const
+{
+    AssertLockHeld(cs_wallet);
+    if(m_spend_info_cache.size() >= MAX_SPEND_INFO_CACHE)
+    {
+        m_spend_info_cache.clear();
+    }
+    m_spend_info_cache[std::make_pair(scriptPubKey, use_max_sig)] = info;
 }
 
 bool CWallet::HasAddressStakeScripts(const uint160& keyId, std::map<uint160, bool>* _insertAddressStake) const
@@ -2267,6 +2694,9 @@ bool CWallet::HasAddressStakeScripts(const uint160& keyId, std::map<uint160, boo
 
 void CWallet::RefreshAddressStakeCache()
 {
+    AssertLockHeld(cs_wallet);
+    // Coins need both descriptors to stake
+    m_stakeable_coins_rebuild = true;
     std::map<uint160, bool> tmpAddressStakeCache = addressStakeCache;
     addressStakeCache.clear();
     for(std::map<uint160, bool>::iterator it = tmpAddressStakeCache.begin(); it != tmpAddressStakeCache.end(); ++it)
@@ -2329,8 +2759,12 @@ bool CWallet::SignTransactionOutput(CMutableTransaction& tx, int sighash, std::m
 
 bool CWallet::SignTransactionStake(CMutableTransaction& txTo, const std::vector<std::pair<const CWalletTx*,unsigned int>>& vwtxPrev) const
 {
+    LOCK(cs_wallet);
+
     // Create the list of coins
     std::vector<std::pair<CTxOut,unsigned int>> coins;
+    FlatSigningProvider stakeKeys;
+    bool haveStakeKeys = true;
     unsigned int nIn = 0;
     for(const std::pair<const CWalletTx*,unsigned int> &pcoin : vwtxPrev)
     {
@@ -2341,8 +2775,25 @@ bool CWallet::SignTransactionStake(CMutableTransaction& txTo, const std::vector<
         const CTxOut& txout = txFrom.vout[txin.prevout.n];
         coins.push_back(std::make_pair(txout, nIn));
         nIn++;
+
+        // Use the keys looked up ahead of time if all the coins have one
+        if(haveStakeKeys)
+        {
+            bool keyIdOk = false;
+            PKHash pkhash = ExtractPublicKeyHash(txout.scriptPubKey, &keyIdOk);
+            auto it = m_stake_keys.find(pkhash);
+            haveStakeKeys = keyIdOk && it != m_stake_keys.end() && it->second.key.IsValid();
+            if(haveStakeKeys)
+            {
+                stakeKeys.pubkeys[ToKeyID(pkhash)] = it->second.pubKey;
+                stakeKeys.keys[ToKeyID(pkhash)] = it->second.key;
+            }
+        }
     }
 
+    if(haveStakeKeys && ::SignTransactionStake(txTo, &stakeKeys, coins))
+        return true;
+
     // Sign coinstake transaction
     for (ScriptPubKeyMan* spk_man : GetAllScriptPubKeyMans()) {
         if (spk_man->SignTransactionStake(txTo, coins)) {
@@ -2355,6 +2806,18 @@ bool CWallet::SignTransactionStake(CMutableTransaction& txTo, const std::vector<
 
 bool CWallet::SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact) const
 {
+    // Use the key looked up ahead of time
+    {
+        LOCK(cs_wallet);
+        auto it = m_stake_keys.find(pkhash);
+        if(it != m_stake_keys.end() && it->second.key.IsValid())
+        {
+            CKey key = it->second.key;
+            if(::SignBlockStake(block, key, compact))
+                return true;
+        }
+    }
+
     // Sign coinstake transaction
     for (ScriptPubKeyMan* spk_man : GetAllScriptPubKeyMans()) {
         if (spk_man->SignBlockStake(block, pkhash, compact)) {
@@ -2365,6 +2828,54 @@ bool CWallet::SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact)
     return false;
 }
 
+const CStakeKey* CWallet::GetStakeKey(const PKHash& pkhash, bool fAllowWatchOnly)
+{
+    AssertLockHeld(cs_wallet);
+    auto it = m_stake_keys.find(pkhash);
+    if(it != m_stake_keys.end())
+        return &it->second;
+
+    CStakeKey stakeKey;
+    if(!HasPrivateKey(pkhash, fAllowWatchOnly) || !GetPubKey(pkhash, stakeKey.pubKey))
+        return nullptr;
+
+    // The private key is not available with hardware wallets, they sign on the device
+    if(!IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS))
+    {
+        for (ScriptPubKeyMan* spk_man : GetScriptPubKeyMans(GetScriptForDestination(pkhash))) {
+            if (spk_man->GetStakeKey(pkhash, stakeKey.key)) break;
+        }
+    }
+    return &m_stake_keys.emplace(pkhash, std::move(stakeKey)).first->second;
+}
+
+void CWallet::CacheStakeKeys(const std::set<std::pair<const CWalletTx*,unsigned int>>& setCoins)
+{
+    AssertLockHeld(cs_wallet);
+    std::set<PKHash> stakers;
+    for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+    {
+        bool keyIdOk = false;
+        PKHash pkhash = ExtractPublicKeyHash(pcoin.first->tx->vout[pcoin.second].scriptPubKey, &keyIdOk);
+        if(keyIdOk) stakers.insert(pkhash);
+    }
+
+    for(auto it = m_stake_keys.begin(); it != m_stake_keys.end();)
+    {
+        it = stakers.count(it->first) ? std::next(it) : m_stake_keys.erase(it);
+    }
+
+    // Keys can't be read while the wallet is locked, they are looked up on use then
+    if(IsLocked())
+        return;
+
+    const bool fAllowWatchOnly = IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+    for(const PKHash& pkhash : stakers)
+    {
+        GetStakeKey(pkhash, fAllowWatchOnly);
+    }
+}
+
 TransactionError CWallet::FillPSBT(PartiallySignedTransaction& psbtx, bool& complete, int sighash_type, bool sign, bool bip32derivs, size_t * n_signed, bool finalize) const
 {
     if (n_signed) {
@@ -2534,13 +3045,254 @@ void CWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::ve
     }
 }
 
+void CStakeWeight::AddCoin(CAmount weight, int mature_height, bool super_stake)
+{
+    Coins& coins = m_coins[mature_height];
+    coins.weight += weight;
+    coins.super_stake_coins += super_stake ? 1 : 0;
+    coins.count++;
+    if(mature_height <= m_height)
+    {
+        m_weight += weight;
+        m_super_stake_coins += super_stake ? 1 : 0;
+    }
+}
+
+void CStakeWeight::RemoveCoin(CAmount weight, int mature_height, bool super_stake)
+{
+    auto it = m_coins.find(mature_height);
+    assert(it != m_coins.end());
+    it->second.weight -= weight;
+    it->second.super_stake_coins -= super_stake ? 1 : 0;
+    if(--it->second.count == 0)
+    {
+        m_coins.erase(it);
+    }
+    if(mature_height <= m_height)
+    {
+        m_weight -= weight;
+        m_super_stake_coins -= super_stake ? 1 : 0;
+    }
+}
+
+void CStakeWeight::SetHeight(int height)
+{
+    // Add the coins that mature on the way up, or remove those that are immature again on the way down
+    const int sign = height > m_height ? 1 : -1;
+    for(auto it = m_coins.upper_bound(std::min(height, m_height)); it != m_coins.end() && it->first <= std::max(height, m_height); ++it)
+    {
+        m_weight += sign * it->second.weight;
+        m_super_stake_coins += sign * it->second.super_stake_coins;
+    }
+    m_height = height;
+}
+
+void CStakeWeight::Clear()
+{
+    m_coins.clear();
+    m_weight = 0;
+    m_super_stake_coins = 0;
+}
+
 uint64_t CWallet::GetStakeWeight(uint64_t* pStakerWeight, uint64_t* pDelegateWeight) const
 {
+    AssertLockHeld(cs_wallet);
+    if(!HaveChain() || m_last_block_processed_height < 0 || m_reserve_balance > 0)
+    {
+        return ComputeStakeWeight(pStakerWeight, pDelegateWeight);
+    }
+
+    UpdateStakeWeight();
+    uint64_t nStakerWeight = m_staker_weight.GetWeight();
+    uint64_t nDelegateWeight = m_staker_weight.CanSuperStake() ? m_delegate_weight.GetWeight() : 0;
+
+    if(pStakerWeight) *pStakerWeight = nStakerWeight;
+    if(pDelegateWeight) *pDelegateWeight = nDelegateWeight;
+    return nStakerWeight + nDelegateWeight;
+}
+
+uint64_t CWallet::ComputeStakeWeight(uint64_t* pStakerWeight, uint64_t* pDelegateWeight) const
+{
+    AssertLockHeld(cs_wallet);
+    uint64_t nStakerWeight = 0;
+    uint64_t nDelegateWeight = 0;
     if(HaveChain())
     {
-        return chain().getStakeWeight(*this, pStakerWeight, pDelegateWeight);
+        chain().getStakeWeight(*this, &nStakerWeight, &nDelegateWeight);
+    }
+
+    if(pStakerWeight) *pStakerWeight = nStakerWeight;
+    if(pDelegateWeight) *pDelegateWeight = nDelegateWeight;
+    return nStakerWeight + nDelegateWeight;
+}
+
+void CWallet::UpdateStakeWeight() const
+{
+    AssertLockHeld(cs_wallet);
+
+    // Weigh the coins of the wallet transactions that changed
+    UpdateStakeableCoins();
+    if(m_delegate_stake_coins_rebuild)
+    {
+        LoadDelegateStakeCoins();
+    }
+
+    // Move the mature coins to the last processed block
+    const int height = GetLastBlockHeight();
+    m_staker_weight.SetHeight(height);
+    m_delegate_weight.SetHeight(height);
+}
+
+void CWallet::LoadDelegateStakeCoins() const
+{
+    AssertLockHeld(cs_wallet);
+    m_delegate_stake_coins.clear();
+    m_delegate_stake_coins_spent.clear();
+    m_delegate_weight.Clear();
+    m_delegate_stake_coins_rebuild = false;
+
+    int height = GetLastBlockHeight();
+    if(!m_delegations_staker.empty())
+    {
+        chain().getDelegateStakeCoins(*this, m_delegate_stake_coins, height);
+    }
+
+    // Blocks from the tip the outputs were read at can be disconnected
+    m_delegate_stake_coins_undo_height = std::max(height, GetLastBlockHeight()) + 1;
+    for(const auto& [prevout, coin] : m_delegate_stake_coins)
+    {
+        m_delegate_weight.AddCoin(coin.first, coin.second + m_stake_weight_maturity - 1, false);
+    }
+}
+
+void CWallet::ConnectDelegateStakeCoins(const interfaces::BlockInfo& block)
+{
+    AssertLockHeld(cs_wallet);
+    if(m_delegate_stake_coins_rebuild || m_delegations_staker.empty())
+        return;
+
+    auto& spent = m_delegate_stake_coins_spent[block.height];
+    for(const CTransactionRef& tx : block.data->vtx)
+    {
+        for(const CTxIn& txin : tx->vin)
+        {
+            auto it = m_delegate_stake_coins.find(txin.prevout);
+            if(it == m_delegate_stake_coins.end())
+                continue;
+
+            m_delegate_weight.RemoveCoin(it->second.first, it->second.second + m_stake_weight_maturity - 1, false);
+            spent.emplace_back(*it);
+            m_delegate_stake_coins.erase(it);
+        }
+
+        // The outputs are matched with the delegations the way the address index records them
+        for(unsigned int i = 0; i < tx->vout.size(); i++)
+        {
+            const CTxOut& txout = tx->vout[i];
+            CTxDestination dest;
+            if(!ExtractDestination({tx->GetHash(), i}, txout.scriptPubKey, dest) || !std::holds_alternative<PKHash>(dest))
+                continue;
+
+            auto delegation = m_delegations_staker.find(uint160(std::get<PKHash>(dest)));
+            CAmount nMinUtxoValue = 0;
+            if(delegation == m_delegations_staker.end() || !GetDelegationStakingFilter(delegation->second, mapSuperStaker, nMinUtxoValue) || txout.nValue < nMinUtxoValue)
+                continue;
+
+            if(m_delegate_stake_coins.emplace(COutPoint(tx->GetHash(), i), std::make_pair(txout.nValue, block.height)).second)
+            {
+                m_delegate_weight.AddCoin(txout.nValue, block.height + m_stake_weight_maturity - 1, false);
+            }
+        }
+    }
+    if(spent.empty())
+    {
+        m_delegate_stake_coins_spent.erase(block.height);
+    }
+
+    // Only keep the spent outputs of the blocks that are likely to be disconnected
+    const int undo_height = block.height - DELEGATE_STAKE_UNDO_DEPTH + 1;
+    if(m_delegate_stake_coins_undo_height < undo_height)
+    {
+        m_delegate_stake_coins_spent.erase(m_delegate_stake_coins_spent.begin(), m_delegate_stake_coins_spent.lower_bound(undo_height));
+        m_delegate_stake_coins_undo_height = undo_height;
     }
-    return 0;
+}
+
+void CWallet::DisconnectDelegateStakeCoins(const interfaces::BlockInfo& block)
+{
+    AssertLockHeld(cs_wallet);
+    if(m_delegate_stake_coins_rebuild || m_delegations_staker.empty())
+        return;
+
+    if(block.height < m_delegate_stake_coins_undo_height)
+    {
+        // The outputs spent by the block are not known anymore
+        m_delegate_stake_coins_rebuild = true;
+        return;
+    }
+
+    for(const CTransactionRef& tx : block.data->vtx)
+    {
+        for(unsigned int i = 0; i < tx->vout.size(); i++)
+        {
+            auto it = m_delegate_stake_coins.find(COutPoint(tx->GetHash(), i));
+            if(it == m_delegate_stake_coins.end())
+                continue;
+
+            m_delegate_weight.RemoveCoin(it->second.first, it->second.second + m_stake_weight_maturity - 1, false);
+            m_delegate_stake_coins.erase(it);
+        }
+    }
+
+    auto spent = m_delegate_stake_coins_spent.find(block.height);
+    if(spent != m_delegate_stake_coins_spent.end())
+    {
+        for(const auto& [prevout, coin] : spent->second)
+        {
+            // Outputs created and spent in the block are gone with it
+            if(coin.second == block.height)
+                continue;
+
+            if(m_delegate_stake_coins.emplace(prevout, coin).second)
+            {
+                m_delegate_weight.AddCoin(coin.first, coin.second + m_stake_weight_maturity - 1, false);
+            }
+        }
+        m_delegate_stake_coins_spent.erase(spent);
+    }
+}
+
+void CWallet::SetMyDelegations(const std::map<uint160, Delegation>& delegations)
+{
+    AssertLockHeld(cs_wallet);
+    if(m_my_delegations != delegations)
+    {
+        // Coins of the addresses delegated to other stakers don't stake
+        m_my_delegations = delegations;
+        m_stakeable_coins_rebuild = true;
+    }
+}
+
+bool CWallet::GetDelegationStakingFilter(const Delegation& delegation, const std::map<uint256, CSuperStakerInfo>& mapStakers, CAmount& nMinUtxoValue) const
+{
+    // Get super staker custom configuration
+    nMinUtxoValue = m_staking_min_utxo_value;
+    uint8_t nMinFee = m_staking_min_fee;
+    for (std::map<uint256, CSuperStakerInfo>::const_iterator it=mapStakers.begin(); it!=mapStakers.end(); it++)
+    {
+        if(it->second.stakerAddress == delegation.staker)
+        {
+            CSuperStakerInfo info = it->second;
+            if(info.fCustomConfig)
+            {
+                nMinUtxoValue = info.nMinDelegateUtxo;
+                nMinFee = info.nMinFee;
+            }
+        }
+    }
+
+    // Check for min staking fee
+    return delegation.fee >= nMinFee;
 }
 
 bool CWallet::GetDelegationStaker(const uint160& keyid, Delegation& delegation)
@@ -2916,6 +3668,7 @@ void CWallet::DisableTransaction(const CTransaction &tx)
             }
         }
         wtx.MarkDirty();
+        MarkStakeableCoinsDirty(tx);
         NotifyTransactionChanged(hash, CT_DELETED);
     }
 }
@@ -2975,6 +3728,8 @@ bool CWallet::LockCoin(const COutPoint& output, WalletBatch* batch)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.insert(output);
+    // Locked coins don't stake, weigh the outputs of the transaction again
+    if (!m_stakeable_coins_rebuild) m_stakeable_coins_dirty.insert(output.hash);
     if (batch) {
         return batch->WriteLockedUTXO(output);
     }
@@ -2985,6 +3740,7 @@ bool CWallet::UnlockCoin(const COutPoint& output, WalletBatch* batch)
 {
     AssertLockHeld(cs_wallet);
     bool was_locked = setLockedCoins.erase(output);
+    if (was_locked && !m_stakeable_coins_rebuild) m_stakeable_coins_dirty.insert(output.hash);
     if (batch && was_locked) {
         return batch->EraseLockedUTXO(output);
     }
@@ -3000,6 +3756,7 @@ bool CWallet::UnlockAllCoins()
         success &= batch.EraseLockedUTXO(*it);
     }
     setLockedCoins.clear();
+    m_stakeable_coins_rebuild = true;
     return success;
 }
 
@@ -3485,6 +4242,10 @@ std::shared_ptr<CWallet> CWallet::Create(WalletContext& context, const std::stri
         walletInstance->m_staking_min_fee = nStakingMinFee;
     }
     walletInstance->m_staker_max_utxo_script_cache = gArgs.GetIntArg("-maxstakerutxoscriptcache", DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE);
+    walletInstance->m_staking_consolidate = gArgs.GetBoolArg("-stakingconsolidate", DEFAULT_STAKING_CONSOLIDATE);
+    walletInstance->m_staking_consolidate_max_utxos = std::max(0, (int32_t)gArgs.GetIntArg("-stakingconsolidatemaxutxos", DEFAULT_STAKING_CONSOLIDATE_MAX_UTXOS));
+    std::optional<CAmount> staking_consolidate_value = ParseMoney(gArgs.GetArg("-stakingconsolidatevalue", FormatMoney(DEFAULT_STAKING_CONSOLIDATE_VALUE)));
+    walletInstance->m_staking_consolidate_value = staking_consolidate_value.value_or(DEFAULT_STAKING_CONSOLIDATE_VALUE);
     walletInstance->m_num_threads = gArgs.GetIntArg("-stakerthreads", GetNumCores());
     walletInstance->m_num_threads = std::max(1, walletInstance->m_num_threads);
     walletInstance->m_ledger_id = gArgs.GetArg("-stakerledgerid", "");
@@ -3735,7 +4496,7 @@ bool CWallet::AddTokenEntry(const CTokenInfo &token, bool fFlushOnClose)
 
     // Write to disk
     CTokenInfo wtoken = token;
-    if(!fInsertedNew)
+    if(fInsertedNew)
     {
         wtoken.nCreateTime = chain().getAdjustedTime();
     }
@@ -3892,6 +4653,7 @@ bool CWallet::Lock()
             memory_cleanse(vMasterKey.data(), vMasterKey.size() * sizeof(decltype(vMasterKey)::value_type));
             vMasterKey.clear();
         }
+        m_stake_keys.clear();
     }
 
     NotifyStatusChanged(this);
@@ -3908,6 +4670,8 @@ bool CWallet::Unlock(const CKeyingMaterial& vMasterKeyIn)
             }
         }
         vMasterKey = vMasterKeyIn;
+        // Look up the staking keys again now that they can be read
+        m_stake_keys.clear();
     }
     NotifyStatusChanged(this);
     return true;
@@ -4285,6 +5049,10 @@ ScriptPubKeyMan* CWallet::AddWalletDescriptor(WalletDescriptor& desc, const Flat
         AddScriptPubKeyMan(id, std::move(new_spk_man));
     }
 
+    // The new descriptor may solve the scripts of the wallet in other ways, or make more outputs ours
+    m_spend_info_cache.clear();
+    m_spendable_coins_rebuild = true;
+
     // Add the private keys to the descriptor
     for (const auto& entry : signing_provider.keys) {
         const CKey& key = entry.second;
@@ -5041,6 +5809,105 @@ bool CWallet::RemoveTokenEntry(const uint256 &tokenHash, bool fFlushOnClose)
     return true;
 }
 
+std::optional<uint256> CWallet::GetTokenBalance(const uint256 &tokenHash) const
+{
+    LOCK(cs_wallet);
+
+    auto it = m_token_balances.find(tokenHash);
+    if(it == m_token_balances.end() || it->second.height != m_last_block_processed_height)
+        return std::nullopt;
+
+    // Let the caller read the balance from the contract again from time to time
+    if(it->second.height - it->second.read_height >= TOKEN_BALANCE_RECONCILE_INTERVAL)
+        return std::nullopt;
+
+    return it->second.balance;
+}
+
+bool CWallet::SetTokenBalance(const uint256 &tokenHash, const uint256 &balance, int height)
+{
+    LOCK(cs_wallet);
+
+    // The events of the blocks up to the height must be processed already
+    if(height != m_last_block_processed_height || mapToken.count(tokenHash) == 0)
+        return false;
+
+    auto it = m_token_balances.find(tokenHash);
+    if(it != m_token_balances.end() && it->second.height == height && it->second.balance != balance)
+    {
+        LogPrintf("SetTokenBalance %s: tracked balance %s does not match the contract balance %s at height %d\n",
+                  tokenHash.ToString(), uintTou256(it->second.balance).str(), uintTou256(balance).str(), height);
+    }
+
+    m_token_balances[tokenHash] = TokenBalance{balance, height, height};
+
+    return true;
+}
+
+void CWallet::SyncTokenLogs(const interfaces::BlockInfo& block)
+{
+    AssertLockHeld(cs_wallet);
+
+    if(mapToken.empty())
+        return;
+
+    // Get the token events from the receipts of the block
+    QtumToken tokenAbi;
+    std::vector<TokenEvent> tokenEvents;
+    for(const CTransactionRef& tx : block.data->vtx)
+    {
+        if(!tx->HasCreateOrCall()) continue;
+
+        for(const interfaces::ContractLog& log : chain().getContractLogs(tx->GetHash(), block.hash))
+        {
+            TokenEvent tokenEvent;
+            if(!tokenAbi.parseEvent(log.address, log.topics, log.data, tokenEvent)) continue;
+            tokenEvent.blockHash = block.hash;
+            tokenEvent.blockNumber = block.height;
+            tokenEvent.transactionHash = tx->GetHash();
+            QtumToken::addTokenEvent(tokenEvents, tokenEvent);
+        }
+    }
+
+    for(auto& [tokenHash, tokenInfo] : mapToken)
+    {
+        // A balance is only tracked from the block after it is known
+        auto itBalance = m_token_balances.find(tokenHash);
+        if(itBalance != m_token_balances.end() && itBalance->second.height != block.height - 1)
+        {
+            m_token_balances.erase(itBalance);
+            itBalance = m_token_balances.end();
+        }
+
+        dev::u256 balance = itBalance != m_token_balances.end() ? uintTou256(itBalance->second.balance) : 0;
+        for(const TokenEvent& tokenEvent : tokenEvents)
+        {
+            if(tokenEvent.address != tokenInfo.strContractAddress) continue;
+            if(tokenEvent.sender != tokenInfo.strSenderAddress && tokenEvent.receiver != tokenInfo.strSenderAddress) continue;
+
+            CTokenTx tokenTx;
+            tokenTx.strContractAddress = tokenEvent.address;
+            tokenTx.strSenderAddress = tokenEvent.sender;
+            tokenTx.strReceiverAddress = tokenEvent.receiver;
+            tokenTx.nValue = tokenEvent.value;
+            tokenTx.transactionHash = tokenEvent.transactionHash;
+            tokenTx.blockHash = tokenEvent.blockHash;
+            tokenTx.blockNumber = tokenEvent.blockNumber;
+            AddTokenTxEntry(tokenTx, false);
+
+            dev::u256 value = uintTou256(tokenEvent.value);
+            if(tokenEvent.sender == tokenInfo.strSenderAddress) balance -= value;
+            if(tokenEvent.receiver == tokenInfo.strSenderAddress) balance += value;
+        }
+
+        if(itBalance != m_token_balances.end())
+        {
+            itBalance->second.balance = u256Touint(balance);
+            itBalance->second.height = block.height;
+        }
+    }
+}
+
 bool CWallet::CleanTokenTxEntries(bool fFlushOnClose)
 {
     LOCK(cs_wallet);
@@ -5273,6 +6140,7 @@ bool CWallet::AddSuperStakerEntry(const CSuperStakerInfo& superStaker, bool fFlu
         return false;
 
     mapSuperStaker[hash] = wsuperStaker;
+    MarkDelegateStakeCoinsDirty();
 
     NotifySuperStakerChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
@@ -5309,6 +6177,7 @@ bool CWallet::RemoveSuperStakerEntry(const uint256& superStakerHash, bool fFlush
             return false;
 
         mapSuperStaker.erase(it);
+        MarkDelegateStakeCoinsDirty();
 
         NotifySuperStakerChanged(this, superStakerHash, CT_DELETED);
     }
@@ -5352,6 +6221,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
         {
             it = m_delegations_staker.erase(it);
             m_delegations_weight.erase(addressDelegate);
+            MarkDelegateStakeCoinsDirty();
             NotifyDelegationsStakerChanged(this, addressDelegate, CT_DELETED);
         }
         else
@@ -5359,6 +6229,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
             if(delegation->second != it->second)
             {
                 it->second = delegation->second;
+                MarkDelegateStakeCoinsDirty();
                 NotifyDelegationsStakerChanged(this, addressDelegate, CT_UPDATED);
             }
             it++;
@@ -5371,6 +6242,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
         if(m_delegations_staker.find(it->first) == m_delegations_staker.end())
         {
             m_delegations_staker[it->first] = it->second;
+            MarkDelegateStakeCoinsDirty();
             NotifyDelegationsStakerChanged(this, it->first, CT_NEW);
         }
     }
@@ -17,6 +17,7 @@
 #include <primitives/transaction.h>
 #include <script/interpreter.h>
 #include <script/script.h>
+#include <script/solver.h>
 #include <support/allocators/secure.h>
 #include <sync.h>
 #include <tinyformat.h>
@@ -150,6 +151,18 @@ constexpr CAmount HIGH_TX_FEE_PER_KB{1 * COIN};
 constexpr CAmount HIGH_MAX_TX_FEE{100 * HIGH_TX_FEE_PER_KB};
 //! Pre-calculated constants for input size estimation in *virtual size*
 static constexpr size_t DUMMY_NESTED_P2WPKH_INPUT_SIZE = 91;
+//! Number of threads reading blocks ahead of a rescan
+static constexpr int RESCAN_PREFETCH_THREADS{4};
+//! Maximum number of blocks a rescan reads ahead
+static constexpr int RESCAN_PREFETCH_BLOCKS{16};
+//! Maximum number of output scripts with a cached input size for coin selection
+static constexpr size_t MAX_SPEND_INFO_CACHE{100000};
+
+//! Number of last blocks whose spent delegated outputs are kept for the stake weight, to disconnect them
+static constexpr int DELEGATE_STAKE_UNDO_DEPTH{100};
+
+//! Number of blocks after which a token balance tracked from the event logs is read again from the contract to check it
+static constexpr int TOKEN_BALANCE_RECONCILE_INTERVAL{100};
 
 //! -stakingminfee default
 static const uint8_t DEFAULT_STAKING_MIN_FEE = 10;
@@ -160,6 +173,15 @@ static const CAmount DEFAULT_STAKER_MIN_UTXO_SIZE{COIN/10};
 //! -maxstakerutxoscriptcache default
 static const int32_t DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE = 200000;
 
+//! -stakingconsolidate default
+static const bool DEFAULT_STAKING_CONSOLIDATE = false;
+
+//! -stakingconsolidatemaxutxos default
+static const int32_t DEFAULT_STAKING_CONSOLIDATE_MAX_UTXOS = 100;
+
+//! -stakingconsolidatevalue default
+static const CAmount DEFAULT_STAKING_CONSOLIDATE_VALUE{100 * COIN};
+
 //! -signpsbtwithhwitool default
 static const bool DEFAULT_SIGN_PSBT_WITH_HWI_TOOL = true;
 
@@ -325,6 +347,64 @@ struct CScriptCache{
     bool solvable = false;
 };
 
+//! Key of a staking address, kept to create and sign coinstakes without looking it up in the wallet
+struct CStakeKey{
+    CPubKey pubKey;
+    //! Not valid when the wallet can't sign with it, e.g. with a hardware wallet
+    CKey key;
+};
+
+//! Size and type of an input spending an output script of the wallet, as seen by coin selection
+struct CSpendInfo{
+    int input_bytes = -1;
+    TxoutType type = TxoutType::NONSTANDARD;
+    bool is_from_p2sh = false;
+};
+
+//! Confirmed and unspent output of the wallet which may be used for staking
+struct CStakeableCoin{
+    const CWalletTx* wtx = nullptr;
+    unsigned int n = 0;
+    CAmount value = 0;
+    isminetype mine = ISMINE_NO;
+    CScriptCache script;
+    //! Weight of the coin once it is mature, zero if the wallet can't stake with it
+    CAmount weight = 0;
+    //! Height of the tip from which the coin is mature
+    int mature_height = 0;
+};
+
+/**
+ * Weight of the coins of a staker, by the height of the tip from which each coin
+ * is mature. Coins are added and removed one at a time as the wallet and the chain
+ * change, and the weight of the coins mature at the current height is read in
+ * constant time. Moving the height only visits the heights passed on the way.
+ */
+class CStakeWeight
+{
+public:
+    void AddCoin(CAmount weight, int mature_height, bool super_stake);
+    void RemoveCoin(CAmount weight, int mature_height, bool super_stake);
+    void SetHeight(int height);
+    void Clear();
+
+    //! Weight of the coins mature at the current height
+    CAmount GetWeight() const { return m_weight; }
+    //! Whether one of the coins mature at the current height can super stake
+    bool CanSuperStake() const { return m_super_stake_coins > 0; }
+
+private:
+    struct Coins {
+        CAmount weight{0};
+        int super_stake_coins{0};
+        size_t count{0};
+    };
+    std::map<int, Coins> m_coins;
+    int m_height{0};
+    CAmount m_weight{0};
+    int m_super_stake_coins{0};
+};
+
 class WalletRescanReserver; //forward declarations for ScanForWalletTransactions/RescanFromTime
 /**
  * A CWallet maintains a set of transactions and balances, and provides the ability to create new transactions.
@@ -716,6 +796,14 @@ public:
     bool SignTransactionOutput(CMutableTransaction& tx, int sighash, std::map<int, std::string>& output_errors) const;
     bool SignTransactionStake(CMutableTransaction& tx, const std::vector<std::pair<const CWalletTx*,unsigned int>>& vwtxPrev) const;
     bool SignBlockStake(CBlock& block, const PKHash& pkhash, bool compact) const;
+    /**
+     * Return the key of a staking address if the wallet can stake with it. The
+     * key is looked up once and kept until the wallet is locked, so that only
+     * the signatures remain to be made when a kernel is found.
+     */
+    const CStakeKey* GetStakeKey(const PKHash& pkhash, bool fAllowWatchOnly) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Look up the keys of the staking coins ahead of time, and drop the keys of addresses without any. */
+    void CacheStakeKeys(const std::set<std::pair<const CWalletTx*,unsigned int>>& setCoins) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /**
      * Fills out a PSBT with information from the wallet. Fills in UTXOs if we have
@@ -751,7 +839,25 @@ public:
      */
     void CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::vector<std::pair<std::string, std::string>> orderForm);
 
-    uint64_t GetStakeWeight(uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr) const;
+    /**
+     * Return the staker and delegate weight of the wallet. The weight of each
+     * stakeable coin and delegated output is added and removed as the wallet
+     * transactions and the blocks change them, so repeated calls from the RPCs,
+     * the GUI and the staker only apply what changed since the last one. With a
+     * reserve balance the staker only uses part of the coins, and the weight is
+     * computed in full.
+     */
+    uint64_t GetStakeWeight(uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Compute the stake weight in full from the wallet coins and delegations. */
+    uint64_t ComputeStakeWeight(uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Weigh all the stakeable coins and delegated outputs again by the next GetStakeWeight. */
+    void MarkStakeWeightDirty() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { m_stakeable_coins_rebuild = true; m_delegate_stake_coins_rebuild = true; }
+    /** Read the delegated outputs again, after the delegations or the super staker configuration change. */
+    void MarkDelegateStakeCoinsDirty() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { m_delegate_stake_coins_rebuild = true; }
+    /** Replace the delegations of the wallet addresses to other stakers. */
+    void SetMyDelegations(const std::map<uint160, Delegation>& delegations) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Check the fee of a delegation against the staker configuration and return the minimum value of the outputs to stake. */
+    bool GetDelegationStakingFilter(const Delegation& delegation, const std::map<uint256, CSuperStakerInfo>& mapStakers, CAmount& nMinUtxoValue) const;
     uint64_t GetSuperStakerWeight(const uint160& staker) const;
     bool CanSuperStake(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const std::vector<COutPoint>& setDelegateCoins) const;
     bool GetSenderDest(const CTransaction& tx, CTxDestination& txSenderDest, bool sign=true) const;
@@ -759,6 +865,28 @@ public:
     bool GetDelegationStaker(const uint160& keyid, Delegation& delegation);
     const CWalletTx* GetCoinSuperStaker(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const PKHash& superStaker, COutPoint& prevout, CAmount& nValueRet);
     const CScriptCache& GetScriptCache(const COutPoint& prevout, const CScript& scriptPubKey, std::map<COutPoint, CScriptCache>* insertScriptCache = nullptr) const;
+    /**
+     * Return the confirmed and unspent outputs of the wallet with a public key hash
+     * script, sorted by value with the largest first. They are indexed as the
+     * wallet transactions change, so the staker only checks maturity, locks and
+     * delegations on them.
+     */
+    const std::vector<CStakeableCoin>& GetStakeableCoins() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Index again the outputs of a transaction and the outputs it spends. */
+    void MarkStakeableCoinsDirty(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /**
+     * Return the unspent outputs of the wallet by txid. They are indexed with the
+     * stakeable coins, so coin selection skips the spent history of the wallet and
+     * only checks depth, trust and locks on them.
+     */
+    const std::map<uint256, std::vector<unsigned int>>& GetSpendableCoins() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /**
+     * Look up the input size and type of a solvable output script, computed by
+     * an earlier coin selection. Most outputs of a staking wallet pay to a few
+     * scripts, so this saves inferring their descriptors for every output.
+     */
+    const CSpendInfo* GetCachedSpendInfo(const CScript& scriptPubKey, bool use_max_sig) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void CacheSpendInfo(const CScript& scriptPubKey, bool use_max_sig, const CSpendInfo& info) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool HasAddressStakeScripts(const uint160& keyId, std::map<uint160, bool>* insertAddressStake = nullptr) const;
     void RefreshAddressStakeCache();
     bool GetSuperStaker(CSuperStakerInfo &info, const uint160& stakerAddress) const;
@@ -832,10 +960,19 @@ public:
     CAmount m_reserve_balance{DEFAULT_RESERVE_BALANCE};
     int64_t m_last_coin_stake_search_time{0};
     int64_t m_last_coin_stake_search_interval{0};
+    //! Milliseconds from finding a kernel to signing the block, for the last block created by the staker
+    std::atomic<int64_t> m_last_coin_stake_latency{-1};
     std::atomic<bool> m_enabled_staking{false};
     CAmount m_staking_min_utxo_value{DEFAULT_STAKING_MIN_UTXO_VALUE};
     CAmount m_staker_min_utxo_size{DEFAULT_STAKER_MIN_UTXO_SIZE};
     int32_t m_staker_max_utxo_script_cache{DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE};
+    bool m_staking_consolidate{DEFAULT_STAKING_CONSOLIDATE};
+    int32_t m_staking_consolidate_max_utxos{DEFAULT_STAKING_CONSOLIDATE_MAX_UTXOS};
+    CAmount m_staking_consolidate_value{DEFAULT_STAKING_CONSOLIDATE_VALUE};
+    //! Last consolidation of the staking outputs, the next one waits for it to be confirmed
+    uint256 m_last_consolidation_txid GUARDED_BY(cs_wallet);
+    //! Inputs of the coinstake of the block the staker is creating, not spent by other transactions until the block is submitted
+    std::set<COutPoint> m_staking_coins_in_use GUARDED_BY(cs_wallet);
     uint8_t m_staking_min_fee{DEFAULT_STAKING_MIN_FEE};
     std::atomic<bool> m_stop_staking_thread{false};
     std::atomic<bool> m_is_staking_thread_stopped{false};
@@ -1215,6 +1352,15 @@ public:
     /* Clean token transaction entries in the wallet */
     bool CleanTokenTxEntries(bool fFlushOnClose=true);
 
+    /* Get the token balance tracked from the event logs, if it is known at the last processed block and not due for a check against the contract */
+    std::optional<uint256> GetTokenBalance(const uint256& tokenHash) const EXCLUSIVE_LOCKS_REQUIRED(!cs_wallet);
+
+    /* Set the token balance read from the contract at a height, ignored unless it is the last processed block */
+    bool SetTokenBalance(const uint256& tokenHash, const uint256& balance, int height) EXCLUSIVE_LOCKS_REQUIRED(!cs_wallet);
+
+    /* Add the token transactions from the event logs of a connected block and update the token balances */
+    void SyncTokenLogs(const interfaces::BlockInfo& block) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /* Load delegation entry into the wallet */
     bool LoadDelegation(const CDelegationInfo &delegation);
 
@@ -1266,6 +1412,58 @@ public:
     mutable std::map<COutPoint, CScriptCache> prevoutScriptCache;
     mutable std::map<uint160, bool> addressStakeCache;
     std::atomic<bool> fCleanCoinStake = true;
+
+private:
+    //! Weight of the stakeable coins and of the delegated outputs, and the coinbase maturity their mature heights use
+    mutable CStakeWeight m_staker_weight GUARDED_BY(cs_wallet);
+    mutable CStakeWeight m_delegate_weight GUARDED_BY(cs_wallet);
+    mutable int m_stake_weight_maturity GUARDED_BY(cs_wallet){0};
+    //! Delegated outputs that can stake for the wallet, with their value and height
+    mutable std::map<COutPoint, std::pair<CAmount, int>> m_delegate_stake_coins GUARDED_BY(cs_wallet);
+    //! Delegated outputs spent by the last blocks by height, and the first height they are kept for
+    mutable std::map<int, std::vector<std::pair<COutPoint, std::pair<CAmount, int>>>> m_delegate_stake_coins_spent GUARDED_BY(cs_wallet);
+    mutable int m_delegate_stake_coins_undo_height GUARDED_BY(cs_wallet){0};
+    mutable bool m_delegate_stake_coins_rebuild GUARDED_BY(cs_wallet){true};
+    void UpdateStakeWeight() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void LoadDelegateStakeCoins() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void ConnectDelegateStakeCoins(const interfaces::BlockInfo& block) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void DisconnectDelegateStakeCoins(const interfaces::BlockInfo& block) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    //! Keys of the staking addresses, cleared when the wallet is locked
+    std::map<PKHash, CStakeKey> m_stake_keys GUARDED_BY(cs_wallet);
+
+    //! Stakeable outputs by txid, the transactions to index again and whether to index all of them
+    mutable std::map<uint256, std::vector<CStakeableCoin>> m_stakeable_coins GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_stakeable_coins_dirty GUARDED_BY(cs_wallet);
+    mutable bool m_stakeable_coins_rebuild GUARDED_BY(cs_wallet){true};
+    //! All stakeable outputs sorted by value, built again after the index changes
+    mutable std::vector<CStakeableCoin> m_stakeable_coins_sorted GUARDED_BY(cs_wallet);
+    mutable bool m_stakeable_coins_unsorted GUARDED_BY(cs_wallet){true};
+    void UpdateStakeableCoins() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void IndexStakeableCoins(const CWalletTx& wtx) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void UnindexStakeableCoins(const uint256& txid) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    CScriptCache MakeScriptCache(const CScript& scriptPubKey) const;
+
+    //! Unspent outputs of the wallet by txid, the transactions to index again and whether to index all of them
+    mutable std::map<uint256, std::vector<unsigned int>> m_spendable_coins GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_spendable_coins_dirty GUARDED_BY(cs_wallet);
+    mutable bool m_spendable_coins_rebuild GUARDED_BY(cs_wallet){true};
+    void IndexSpendableCoins(const CWalletTx& wtx) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    //! Input size and type of the solvable output scripts, by script and whether the maximum signature size is used
+    mutable std::map<std::pair<CScript, bool>, CSpendInfo> m_spend_info_cache GUARDED_BY(cs_wallet);
+
+    //! Token balance tracked from the event logs
+    struct TokenBalance {
+        uint256 balance;
+        //! Last processed block height the balance is known at
+        int height;
+        //! Block height the balance was last read from the contract at
+        int read_height;
+    };
+
+    //! Tracked token balances, by token hash
+    std::map<uint256, TokenBalance> m_token_balances GUARDED_BY(cs_wallet);
 };
 
 /**
@@ -42,3 +42,8 @@ bool CZMQAbstractNotifier::NotifyTransactionRemoval(const CTransaction &/*transa
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyBlockContractReceipts(const CBlockIndex * /*CBlockIndex*/, const std::vector<TransactionReceiptInfo> &/*receipts*/, bool /*connected*/)
+{
+    return true;
+}
@@ -9,10 +9,12 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 class CBlockIndex;
 class CTransaction;
 class CZMQAbstractNotifier;
+struct TransactionReceiptInfo;
 
 using CZMQNotifierFactory = std::function<std::unique_ptr<CZMQAbstractNotifier>()>;
 
@@ -56,6 +58,8 @@ public:
     virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence);
     // Notifies of transactions added to mempool or appearing in blocks
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Notifies of the contract receipts of every block connection or disconnection (qtum)
+    virtual bool NotifyBlockContractReceipts(const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts, bool connected);
 
 protected:
     void* psocket{nullptr};
@@ -51,6 +51,8 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
     };
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
+    factories["pubrawreceipt"] = CZMQAbstractNotifier::Create<CZMQPublishRawReceiptNotifier>;
+    factories["pubcontractlog"] = CZMQAbstractNotifier::Create<CZMQPublishContractLogNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -205,4 +207,11 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     });
 }
 
+void CZMQNotificationInterface::BlockContractReceipts(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::shared_ptr<const std::vector<TransactionReceiptInfo>>& receipts, bool connected)
+{
+    TryForEachAndRemoveFailed(notifiers, [pindex, &receipts, connected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockContractReceipts(pindex, *receipts, connected);
+    });
+}
+
 std::unique_ptr<CZMQNotificationInterface> g_zmq_notification_interface;
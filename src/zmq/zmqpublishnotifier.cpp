@@ -14,6 +14,7 @@
 #include <node/blockstorage.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <qtum/storageresults.h>
 #include <rpc/server.h>
 #include <serialize.h>
 #include <streams.h>
@@ -45,6 +46,8 @@ static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
+static const char *MSG_RAWRECEIPT  = "rawreceipt";
+static const char *MSG_CONTRACTLOG = "contractlog";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -304,3 +307,39 @@ bool CZMQPublishSequenceNotifier::NotifyTransactionRemoval(const CTransaction &t
     LogPrint(BCLog::ZMQ, "Publish hashtx mempool removal %s to %s\n", hash.GetHex(), this->address);
     return SendSequenceMsg(*this, hash, /* Mempool (R)emoval */ 'R', mempool_sequence);
 }
+
+// Messages of the receipt topics have the following structure:
+//    <32-byte block hash> | <1-byte label, (C)onnect or (D)isconnect> | <CompactSize count> | <entries>
+bool CZMQPublishRawReceiptNotifier::NotifyBlockContractReceipts(const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts, bool connected)
+{
+    LogPrint(BCLog::ZMQ, "Publish rawreceipt %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
+    DataStream ss;
+    ss << pindex->GetBlockHash() << uint8_t(connected ? 'C' : 'D');
+    WriteCompactSize(ss, receipts.size());
+    for (const TransactionReceiptInfo& receipt : receipts) {
+        SerializeReceipt(ss, receipt);
+    }
+    return SendZmqMessage(MSG_RAWRECEIPT, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishContractLogNotifier::NotifyBlockContractReceipts(const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts, bool connected)
+{
+    size_t count{0};
+    for (const TransactionReceiptInfo& receipt : receipts) {
+        count += receipt.logs.size();
+    }
+    if (count == 0) return true;
+
+    LogPrint(BCLog::ZMQ, "Publish contractlog %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
+    DataStream ss;
+    ss << pindex->GetBlockHash() << uint8_t(connected ? 'C' : 'D');
+    WriteCompactSize(ss, count);
+    // Each entry is <32-byte txid> | <4-byte LE output index> | <log>
+    for (const TransactionReceiptInfo& receipt : receipts) {
+        for (const dev::eth::LogEntry& log : receipt.logs) {
+            ss << receipt.transactionHash << receipt.outputIndex;
+            SerializeLogEntry(ss, log);
+        }
+    }
+    return SendZmqMessage(MSG_CONTRACTLOG, &(*ss.begin()), ss.size());
+}
@@ -72,4 +72,16 @@ public:
     bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence) override;
 };
 
+class CZMQPublishRawReceiptNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlockContractReceipts(const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts, bool connected) override;
+};
+
+class CZMQPublishContractLogNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlockContractReceipts(const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts, bool connected) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
@@ -79,24 +79,42 @@ class AssumeutxoTest(BitcoinTestFramework):
             with self.nodes[1].assert_debug_log([log_msg]):
                 assert_raises_rpc_error(-32603, f"Unable to load UTXO snapshot{rpc_details}", self.nodes[1].loadtxoutset, bad_snapshot_path)
 
+        self.log.info("  - snapshot file with invalid file magic")
+        parsing_error_code = -22
+        bad_magic = 0xf00f00f000
+        with open(bad_snapshot_path, 'wb') as f:
+            f.write(bad_magic.to_bytes(5, "big") + valid_snapshot_contents[5:])
+        assert_raises_rpc_error(parsing_error_code, "Unable to parse metadata: Invalid UTXO set snapshot magic bytes. Please check if this is indeed a snapshot file or if you are using an outdated snapshot format.", self.nodes[1].loadtxoutset, bad_snapshot_path)
+
+        self.log.info("  - snapshot file with unsupported version")
+        for version in [0, 1, 3]:
+            with open(bad_snapshot_path, 'wb') as f:
+                f.write(valid_snapshot_contents[:5] + version.to_bytes(2, "little") + valid_snapshot_contents[7:])
+            assert_raises_rpc_error(parsing_error_code, f"Unable to parse metadata: Version of snapshot {version} does not match the supported version 2.", self.nodes[1].loadtxoutset, bad_snapshot_path)
+
+        # The base block hash and the number of coins follow the magic bytes and the version
+        header_len = 5 + 2
+        metadata_len = header_len + 32 + 8
+
         self.log.info("  - snapshot file referring to a block that is not in the assumeutxo parameters")
         prev_block_hash = self.nodes[0].getblockhash(SNAPSHOT_BASE_HEIGHT - 1)
         bogus_block_hash = "0" * 64  # Represents any unknown block hash
         for bad_block_hash in [bogus_block_hash, prev_block_hash]:
             with open(bad_snapshot_path, 'wb') as f:
-                # block hash of the snapshot base is stored right at the start (first 32 bytes)
-                f.write(bytes.fromhex(bad_block_hash)[::-1] + valid_snapshot_contents[32:])
+                f.write(valid_snapshot_contents[:header_len] + bytes.fromhex(bad_block_hash)[::-1] + valid_snapshot_contents[header_len + 32:])
             error_details = f", assumeutxo block hash in snapshot metadata not recognized ({bad_block_hash})"
             expected_error(rpc_details=error_details)
 
         self.log.info("  - snapshot file with wrong number of coins")
-        valid_num_coins = int.from_bytes(valid_snapshot_contents[32:32 + 8], "little")
+        valid_num_coins = int.from_bytes(valid_snapshot_contents[header_len + 32:metadata_len], "little")
         for off in [-1, +1]:
             with open(bad_snapshot_path, 'wb') as f:
-                f.write(valid_snapshot_contents[:32])
+                f.write(valid_snapshot_contents[:header_len + 32])
                 f.write((valid_num_coins + off).to_bytes(8, "little"))
-                f.write(valid_snapshot_contents[32 + 8:])
-            expected_error(log_msg=f"bad snapshot - coins left over after deserializing 4098 coins" if off == -1 else f"bad snapshot format or truncated snapshot after deserializing 4099 coins")
+                f.write(valid_snapshot_contents[metadata_len:])
+            # The contract state follows the coins: a coin left over is read where the contract
+            # state is expected, and a missing coin is read from the null outpoint starting it.
+            expected_error(log_msg=f"[snapshot] bad contract state - no contract state after the coins" if off == -1 else f"[snapshot] bad snapshot - contract state found after deserializing {valid_num_coins} coins")
 
         self.log.info("  - snapshot file with alternated UTXO data")
         cases = [
@@ -108,9 +126,9 @@ class AssumeutxoTest(BitcoinTestFramework):
 
         for content, offset, wrong_hash in cases:
             with open(bad_snapshot_path, "wb") as f:
-                f.write(valid_snapshot_contents[:(32 + 8 + offset)])
+                f.write(valid_snapshot_contents[:(metadata_len + offset)])
                 f.write(content)
-                f.write(valid_snapshot_contents[(32 + 8 + offset + len(content)):])
+                f.write(valid_snapshot_contents[(metadata_len + offset + len(content)):])
             expected_error(log_msg=f"[snapshot] bad snapshot content hash: expected 73200c9ce4eb500fb90dc57599ed084a1351eb0bf5de133c8a8ed4662e7e8162, got {wrong_hash}")
 
     def test_invalid_chainstate_scenarios(self):
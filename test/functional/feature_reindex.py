@@ -8,6 +8,7 @@
 - Stop the node and restart it with -reindex. Verify that the node has reindexed up to block 3.
 - Stop the node and restart it with -reindex-chainstate. Verify that the node has reindexed up to block 3.
 - Verify that out-of-order blocks are correctly processed, see LoadExternalBlockFile()
+- Verify that -reindex keeps track of the size of compressed blocks, so that new blocks are appended right after them
 """
 
 from test_framework.test_framework import BitcoinTestFramework
@@ -73,6 +74,41 @@ class ReindexTest(BitcoinTestFramework):
         # All blocks should be accepted and processed.
         assert_equal(self.nodes[0].getblockcount(), 12)
 
+    # Check that the blocks stored compressed are accounted for with their size on disk
+    def compressed_blocks(self):
+        self.log.info("Test -reindex with compressed blocks")
+        self.restart_node(0, extra_args=["-blockcompression=9"])
+        self.generatetoaddress(self.nodes[0], 3, self.nodes[0].get_deterministic_priv_key().address)
+        self.restart_node(0, extra_args=["-blockcompression=9", "-reindex"])
+        assert_equal(self.nodes[0].getblockcount(), 15)
+        self.generatetoaddress(self.nodes[0], 3, self.nodes[0].get_deterministic_priv_key().address)
+        blockcount = self.nodes[0].getblockcount()
+        self.stop_nodes()
+
+        # The block records follow each other without gaps, the rest of the file is preallocated space
+        blk0 = self.nodes[0].blocks_path / "blk00000.dat"
+        with open(blk0, 'rb') as bf:
+            b = bf.read()
+        pos = 0
+        records = 0
+        compressed = 0
+        while b[pos:pos + 4] == MAGIC_BYTES["regtest"]:
+            size = int.from_bytes(b[pos + 4:pos + 8], "little")
+            if size & 0x80000000:
+                compressed += 1
+                size &= ~0x80000000
+            pos += 8 + size
+            records += 1
+        assert_equal(records, blockcount + 1)
+        assert compressed > 0
+        assert_equal(b[pos:].count(0), len(b) - pos)
+
+        # All the blocks can be read back
+        self.start_nodes([["-blockcompression=9", "-reindex"]])
+        assert_equal(self.nodes[0].getblockcount(), blockcount)
+        for height in range(blockcount + 1):
+            self.nodes[0].getblock(self.nodes[0].getblockhash(height), 0)
+
     def run_test(self):
         self.reindex(False)
         self.reindex(True)
@@ -80,6 +116,7 @@ class ReindexTest(BitcoinTestFramework):
         self.reindex(True)
 
         self.out_of_order()
+        self.compressed_blocks()
 
 
 if __name__ == '__main__':
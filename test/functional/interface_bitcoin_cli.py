@@ -104,6 +104,12 @@ class TestBitcoinCli(BitcoinTestFramework):
         assert_equal(['foo', 'bar'], self.nodes[0].cli(f'-rpcuser={user}', '-stdin', '-stdinrpcpass', input=f'{password}\nfoo\nbar').echo())
         assert_raises_process_error(1, 'Incorrect rpcuser or rpcpassword', self.nodes[0].cli(f'-rpcuser={user}', '-stdin', '-stdinrpcpass', input='foo').echo)
 
+        self.log.info("Test -stdinbatch")
+        commands = "getblockcount\necho 'a b' \"c\\\"d\"\n\n# comment\ngetblockhash 0\n"
+        assert_equal(f'{BLOCKS}\n["a b","c\\"d"]\n{self.nodes[0].getblockhash(0)}', self.nodes[0].cli('-stdinbatch', '-stdinbatchsize=2', input=commands).send_cli())
+        assert_raises_process_error(8, "line 2: error code: -8", self.nodes[0].cli('-stdinbatch', input="getblockcount\ngetblockhash -1\n").send_cli)
+        assert_raises_process_error(1, "can't be combined with a command", self.nodes[0].cli('-stdinbatch', input="").getblockcount)
+
         self.log.info("Test connecting to a non-existing server")
         assert_raises_process_error(1, "Could not connect to the server", self.nodes[0].cli('-rpcport=1').echo)
 
@@ -15,7 +15,12 @@ import urllib.parse
 from test_framework.messages import (
     # BLOCK_HEADER_SIZE,
     COIN,
+    COutPoint,
+    CTransaction,
+    CTxIn,
+    CTxOut,
 )
+from test_framework.script import CScriptNum
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
@@ -24,19 +29,25 @@ from test_framework.util import (
 )
 from test_framework.wallet import (
     MiniWallet,
+    MiniWalletMode,
     getnewdestination,
 )
 from typing import Optional
 from test_framework.messages import CBlockHeader
 
-from test_framework.qtumconfig import COINBASE_MATURITY, INITIAL_BLOCK_REWARD
-from test_framework.qtum import convert_btc_address_to_qtum, generatesynchronized
+from test_framework.qtumconfig import COINBASE_MATURITY, INITIAL_BLOCK_REWARD, QTUM_MIN_GAS_PRICE
+from test_framework.qtum import convert_btc_address_to_qtum, generatesynchronized, make_op_call_output, make_op_create_output
 
 BLOCK_HEADER_SIZE = len(CBlockHeader().serialize())
 
 
 INVALID_PARAM = "abc"
 UNKNOWN_PARAM = "0000000000000000000000000000000000000000000000000000000000000000"
+UNKNOWN_CONTRACT = "0000000000000000000000000000000000000001"
+
+# Contract storing 13 at slot 0, whose function 5b9af12b emits two events and adds its argument to it
+LOG_CONTRACT_CODE = "6060604052600d600055341561001457600080fd5b61017e806100236000396000f30060606040526004361061004c576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff168063027c1aaf1461004e5780635b9af12b14610058575b005b61005661008f565b005b341561006357600080fd5b61007960048080359060200190919050506100a1565b6040518082815260200191505060405180910390f35b60026000808282540292505081905550565b60007fc5c442325655248f6bccf5c6181738f8755524172cea2a8bd1e38e43f833e7f282600054016000548460405180848152602001838152602001828152602001935050505060405180910390a17fc5c442325655248f6bccf5c6181738f8755524172cea2a8bd1e38e43f833e7f282600054016000548460405180848152602001838152602001828152602001935050505060405180910390a1816000540160008190555060005490509190505600a165627a7a7230582015732bfa66bdede47ecc05446bf4c1e8ed047efac25478cb13b795887df70f290029"
+CONTRACT_TX_FEE = 1 * COIN
 
 
 class ReqType(Enum):
@@ -442,5 +453,113 @@ class RESTTest (BitcoinTestFramework):
         resp = self.test_rest_request(f"/deploymentinfo/{INVALID_PARAM}", ret_type=RetType.OBJ, status=400)
         assert_equal(resp.read().decode('utf-8').rstrip(), f"Invalid hash: {INVALID_PARAM}")
 
+        self.test_qtum_endpoints()
+
+    def assert_rest_error(self, uri, status, message, query_params=None):
+        resp = self.test_rest_request(uri, ret_type=RetType.OBJ, status=status, query_params=query_params)
+        assert_equal(resp.read().decode('utf-8').rstrip(), message)
+
+    def send_contract_tx(self, output):
+        # The sender of a contract tx is the P2PK or P2PKH script of its first input
+        utxo = self.p2pk_wallet.get_utxo()
+        tx = CTransaction()
+        tx.vin = [CTxIn(COutPoint(int(utxo['txid'], 16), utxo['vout']))]
+        tx.vout = [output, CTxOut(int(utxo['value'] * COIN) - CONTRACT_TX_FEE, self.p2pk_wallet.get_scriptPubKey())]
+        self.p2pk_wallet.sign_tx(tx)
+        txid = self.p2pk_wallet.sendrawtransaction(from_node=self.nodes[0], tx_hex=tx.serialize().hex())
+        self.generate(self.nodes[0], 1, sync_fun=self.no_op)
+        return txid
+
+    def test_qtum_endpoints(self):
+        node = self.nodes[0]
+        self.log.info("Create a contract and call it")
+        self.p2pk_wallet = MiniWallet(node, mode=MiniWalletMode.RAW_P2PK)
+        for _ in range(2):
+            self.wallet.send_to(from_node=node, scriptPubKey=self.p2pk_wallet.get_scriptPubKey(), amount=10 * COIN)
+        _, address_script, _ = getnewdestination('legacy')
+        address = node.decodescript(address_script.hex())['address']
+        address_txid = self.wallet.send_to(from_node=node, scriptPubKey=address_script, amount=int(0.1 * COIN))["txid"]
+        self.generate(node, 1, sync_fun=self.no_op)
+        address_height = node.getblockcount()
+        self.p2pk_wallet.rescan_utxos()
+
+        contracts_before = node.listcontracts(1, 10000)
+        create_txid = self.send_contract_tx(make_op_create_output(node, 0, b"\x04", CScriptNum(1000000), CScriptNum(QTUM_MIN_GAS_PRICE), bytes.fromhex(LOG_CONTRACT_CODE)))
+        create_height = node.getblockcount()
+        contract = next(c for c in node.listcontracts(1, 10000) if c not in contracts_before)
+        call_txid = self.send_contract_tx(make_op_call_output(0, b"\x04", CScriptNum(1000000), CScriptNum(QTUM_MIN_GAS_PRICE), bytes.fromhex("5b9af12b"), bytes.fromhex(contract)))
+        call_height = node.getblockcount()
+
+        self.log.info("Test the /receipt, /logs and /address URIs with the indexes disabled")
+        self.assert_rest_error(f"/receipt/{call_txid}", 404, "Events indexing disabled")
+        self.assert_rest_error(f"/logs/{call_height}/{call_height}", 404, "Events indexing disabled")
+        self.assert_rest_error(f"/address/{address}/deltas", 404, "No information available for address")
+
+        self.log.info("Test the /storage URI")
+        assert_equal(self.test_rest_request(f"/storage/{contract}"), node.getstorage(contract))
+        assert_equal(self.test_rest_request(f"/storage/{contract}", query_params={"height": create_height}), node.getstorage(contract, create_height))
+        self.assert_rest_error(f"/storage/{contract}", 404, f"{contract} not found", query_params={"height": create_height - 1})
+        storage_bin = self.test_rest_request(f"/storage/{contract}", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        assert_equal(storage_bin[0], len(node.getstorage(contract)))
+        assert_equal(len(storage_bin), 1 + 96 * storage_bin[0])
+        storage_hex = self.test_rest_request(f"/storage/{contract}", req_type=ReqType.HEX, ret_type=RetType.BYTES)
+        assert_equal(storage_hex.decode('utf-8').rstrip(), storage_bin.hex())
+        self.assert_rest_error(f"/storage/{UNKNOWN_CONTRACT}", 404, f"{UNKNOWN_CONTRACT} not found")
+        self.assert_rest_error(f"/storage/{INVALID_PARAM}", 400, f"Invalid address: {INVALID_PARAM}")
+        self.assert_rest_error(f"/storage/{contract}", 400, f"Invalid height: {call_height + 1}", query_params={"height": call_height + 1})
+
+        self.log.info("Rebuild the indexes")
+        self.restart_node(0, ["-rest", "-blockfilterindex=1", "-whitelist=noban@127.0.0.1", "-logevents", "-addressindex", "-reindex"])
+        self.wait_until(lambda: node.getblockcount() == call_height)
+
+        self.log.info("Test the /receipt URI")
+        receipt = node.gettransactionreceipt(call_txid)
+        assert_equal(len(receipt), 1)
+        assert_equal(len(receipt[0]['log']), 2)
+        assert_equal(self.test_rest_request(f"/receipt/{call_txid}"), receipt)
+        assert_equal(self.test_rest_request(f"/receipt/{create_txid}"), node.gettransactionreceipt(create_txid))
+        receipt_bin = self.test_rest_request(f"/receipt/{call_txid}", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        assert_equal(receipt_bin[0], 1)
+        assert_equal(receipt_bin[1:33][::-1].hex(), receipt[0]['blockHash'])
+        assert_equal(int.from_bytes(receipt_bin[33:37], 'little'), call_height)
+        assert_equal(receipt_bin[37:69][::-1].hex(), call_txid)
+        receipt_hex = self.test_rest_request(f"/receipt/{call_txid}", req_type=ReqType.HEX, ret_type=RetType.BYTES)
+        assert_equal(receipt_hex.decode('utf-8').rstrip(), receipt_bin.hex())
+        assert_equal(self.test_rest_request(f"/receipt/{UNKNOWN_PARAM}"), [])
+        assert_equal(self.test_rest_request(f"/receipt/{address_txid}"), [])
+        self.assert_rest_error(f"/receipt/{INVALID_PARAM}", 400, f"Invalid hash: {INVALID_PARAM}")
+
+        self.log.info("Test the /logs URI")
+        logs = node.searchlogs(create_height, call_height, {"addresses": [contract]})
+        assert_equal(len(logs), 1)
+        assert_equal(logs[0]['transactionHash'], call_txid)
+        assert_equal(self.test_rest_request(f"/logs/{create_height}/{call_height}", query_params={"address": contract}), logs)
+        assert_equal(self.test_rest_request(f"/logs/{create_height}/{call_height}"), node.searchlogs(create_height, call_height))
+        assert_equal(self.test_rest_request(f"/logs/{create_height}/{call_height}", query_params={"address": UNKNOWN_CONTRACT}), [])
+        assert_equal(self.test_rest_request(f"/logs/{create_height}/{call_height}", query_params={"minconf": 2}), [])
+        logs_bin = self.test_rest_request(f"/logs/{create_height}/{call_height}", req_type=ReqType.BIN, ret_type=RetType.BYTES, query_params={"address": contract})
+        assert_equal(logs_bin, receipt_bin)
+        self.assert_rest_error("/logs/0/10000", 400, "Invalid block range, at most 10000 blocks can be searched: 0/10000")
+        self.assert_rest_error(f"/logs/{call_height}/{create_height}", 400, f"Invalid block range, at most 10000 blocks can be searched: {call_height}/{create_height}")
+        self.assert_rest_error(f"/logs/{create_height}", 400, "Invalid URI format. Expected /rest/logs/<FROM>/<TO>.<ext>?address=<ADDRESS>,...&minconf=<MINCONF>")
+        self.assert_rest_error(f"/logs/{create_height}/{call_height}", 400, f"Invalid address: {INVALID_PARAM}", query_params={"address": INVALID_PARAM})
+
+        self.log.info("Test the /address URI")
+        deltas = node.getaddressdeltas({"addresses": [address]})
+        assert_equal(len(deltas), 1)
+        assert_equal(deltas[0]['txid'], address_txid)
+        assert_equal(self.test_rest_request(f"/address/{address}/deltas"), deltas)
+        assert_equal(self.test_rest_request(f"/address/{address}/deltas", query_params={"start": address_height, "end": address_height}), deltas)
+        assert_equal(self.test_rest_request(f"/address/{address}/deltas", query_params={"start": create_height, "end": call_height}), [])
+        deltas_bin = self.test_rest_request(f"/address/{address}/deltas", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        assert_equal(deltas_bin[0], 1)
+        assert_equal(deltas_bin[1:33][::-1].hex(), address_txid)
+        assert_equal(int.from_bytes(deltas_bin[-8:], 'little'), int(0.1 * COIN))
+        unused_address = node.decodescript(getnewdestination('legacy')[1].hex())['address']
+        assert_equal(self.test_rest_request(f"/address/{unused_address}/deltas"), [])
+        self.assert_rest_error(f"/address/{INVALID_PARAM}/deltas", 400, f"Invalid address: {INVALID_PARAM}")
+        self.assert_rest_error(f"/address/{address}/utxos", 400, "Invalid URI format. Expected /rest/address/<ADDRESS>/deltas.<ext>?start=<HEIGHT>&end=<HEIGHT>")
+        self.assert_rest_error(f"/address/{address}/deltas", 400, "Invalid block range, start and end are needed with 0 < start <= end", query_params={"start": address_height})
+
 if __name__ == '__main__':
     RESTTest().main()
@@ -5,6 +5,7 @@
 """Tests some generic aspects of the RPC interface."""
 
 import os
+from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE
 from test_framework.authproxy import JSONRPCException
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import assert_equal, assert_greater_than_or_equal
@@ -74,6 +75,56 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(result_by_id[3]['error'], None)
         assert result_by_id[3]['result'] is not None
 
+    def check_parallel_batch(self):
+        node = self.nodes[0]
+        height = node.getblockcount()
+        requests = []
+        expected = []
+
+        def add(method, params, result=None, error=None):
+            requests.append({"method": method, "id": f"{method}-{len(requests)}", "params": params})
+            expected.append((result, error))
+            return len(requests) - 1
+
+        # A run of read-only calls, which run in parallel, with failing ones among them
+        for h in range(height + 1):
+            add("getblockhash", [h], result=node.getblockhash(h))
+        add("getblockhash", [height + 1], error=-8)
+        add("getblockcount", [], result=height)
+        add("getblock", ["00" * 32], error=-5)
+        add("getbestblockhash", [], result=node.getblockhash(height))
+        # Calls that run on their own, after all earlier calls and before all later ones
+        add("invalidmethod", [], error=-32601)
+        generate = add("generatetoaddress", [1, ADDRESS_BCRT1_UNSPENDABLE])
+        add("getblockcount", [], result=height + 1)
+        new_hash = add("getblockhash", [height + 1])
+        add("getblockcount", [], result=height + 1)
+        add("generatetoaddress", [1, "invalid"], error=-5)
+        add("getblockcount", [], result=height + 1)
+
+        results = node.batch(requests)
+        assert_equal([res["id"] for res in results], [req["id"] for req in requests])
+        for res, (result, error) in zip(results, expected):
+            if error is None:
+                assert_equal(res["error"], None)
+                if result is not None:
+                    assert_equal(res["result"], result)
+            else:
+                assert_equal(res["error"]["code"], error)
+                assert_equal(res["result"], None)
+        assert_equal(results[new_hash]["result"], results[generate]["result"][0])
+        assert_equal(node.getbestblockhash(), results[generate]["result"][0])
+
+    def test_parallel_batch_request(self):
+        self.log.info("Testing JSON-RPC batch request mixing parallel and serial calls...")
+        self.generatetoaddress(self.nodes[0], 10, ADDRESS_BCRT1_UNSPENDABLE)
+        self.check_parallel_batch()
+
+        self.log.info("Testing the same batch with the calls run in order...")
+        self.restart_node(0, ['-rpcbatchconcurrency=1'])
+        self.check_parallel_batch()
+        self.restart_node(0)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC requests...")
 
@@ -95,6 +146,7 @@ class RPCInterfaceTest(BitcoinTestFramework):
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
+        self.test_parallel_batch_request()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
 
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the JSON-RPC server on a Unix domain socket (-rpcunix)."""
+
+import http.client
+import json
+import os
+import shutil
+import socket
+import stat
+import tempfile
+import urllib.parse
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, str_to_b64str
+
+
+class UnixHTTPConnection(http.client.HTTPConnection):
+    def __init__(self, path):
+        super().__init__('localhost')
+        self.path = path
+
+    def connect(self):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(self.path)
+
+
+class RPCUnixTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.supports_cli = False
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_platform_not_posix()
+
+    def setup_network(self):
+        # Keep the socket paths short, they are limited to about 100 characters
+        self.socket_dir = tempfile.mkdtemp(prefix='rpcunix')
+        self.socket_path = os.path.join(self.socket_dir, 'rpc.sock')
+        self.extra_args = [[f'-rpcunix={self.socket_path}']]
+        self.setup_nodes()
+
+    def unix_call(self, method, auth=True):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        headers = {'Content-Type': 'application/json'}
+        if auth:
+            headers['Authorization'] = f'Basic {str_to_b64str(f"{url.username}:{url.password}")}'
+        conn = UnixHTTPConnection(self.socket_path)
+        conn.request('POST', '/', json.dumps({'jsonrpc': '1.0', 'id': method, 'method': method, 'params': []}), headers)
+        response = conn.getresponse()
+        body = response.read()
+        conn.close()
+        return response.status, json.loads(body) if body else None
+
+    def check_calls(self):
+        status, reply = self.unix_call('getblockcount')
+        assert_equal(status, 200)
+        assert_equal(reply['error'], None)
+        assert_equal(reply['id'], 'getblockcount')
+        assert_equal(reply['result'], self.nodes[0].getblockcount())
+
+    def run_test(self):
+        self.log.info("Call the RPC server over the Unix socket")
+        self.check_calls()
+
+        self.log.info("Only the user running the node can connect")
+        assert_equal(stat.S_IMODE(os.stat(self.socket_path).st_mode), stat.S_IRUSR | stat.S_IWUSR)
+
+        self.log.info("Authentication still applies")
+        status, _ = self.unix_call('getblockcount', auth=False)
+        assert_equal(status, 401)
+
+        self.log.info("The socket is removed on shutdown")
+        self.stop_node(0)
+        assert not os.path.exists(self.socket_path)
+
+        self.log.info("A socket left behind by an unclean shutdown is replaced")
+        stale = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        stale.bind(self.socket_path)
+        stale.close()
+        assert stat.S_ISSOCK(os.stat(self.socket_path).st_mode)
+        self.start_node(0)
+        self.check_calls()
+
+        self.log.info("A socket another process listens on is left alone")
+        busy_path = os.path.join(self.socket_dir, 'busy.sock')
+        busy = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        busy.bind(busy_path)
+        busy.listen(1)
+        with self.nodes[0].assert_debug_log([f'Binding RPC on Unix socket {busy_path} failed, the socket is in use.']):
+            self.restart_node(0, extra_args=[f'-rpcunix={self.socket_path}', f'-rpcunix={busy_path}'])
+        client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        client.connect(busy_path)
+        accepted, _ = busy.accept()
+        accepted.close()
+        client.close()
+        busy.close()
+        self.check_calls()
+
+        self.stop_node(0)
+        shutil.rmtree(self.socket_dir)
+
+
+if __name__ == '__main__':
+    RPCUnixTest().main()
@@ -17,10 +17,18 @@ from test_framework.blocktools import (
 )
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.messages import (
+    COIN,
+    COutPoint,
+    CTransaction,
+    CTxIn,
+    CTxOut,
+    deser_compact_size,
+    deser_string,
     hash256,
     tx_from_hex,
     CBlockHeader,
 )
+from test_framework.script import CScriptNum
 from test_framework.util import (
     assert_equal,
     assert_raises_rpc_error,
@@ -28,10 +36,12 @@ from test_framework.util import (
 )
 from test_framework.wallet import (
     MiniWallet,
+    MiniWalletMode,
 )
 from test_framework.netutil import test_ipv6_local
 from io import BytesIO
-from test_framework.qtum import convert_btc_bech32_address_to_qtum
+from test_framework.qtum import convert_btc_bech32_address_to_qtum, make_op_call_output, make_op_create_output
+from test_framework.qtumconfig import QTUM_MIN_GAS_PRICE
 
 # Test may be skipped and not have zmq installed
 try:
@@ -39,9 +49,39 @@ try:
 except ImportError:
     pass
 
+# Contract storing 13 at slot 0, whose function 5b9af12b emits two events and adds its argument to it
+LOG_CONTRACT_CODE = "6060604052600d600055341561001457600080fd5b61017e806100236000396000f30060606040526004361061004c576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff168063027c1aaf1461004e5780635b9af12b14610058575b005b61005661008f565b005b341561006357600080fd5b61007960048080359060200190919050506100a1565b6040518082815260200191505060405180910390f35b60026000808282540292505081905550565b60007fc5c442325655248f6bccf5c6181738f8755524172cea2a8bd1e38e43f833e7f282600054016000548460405180848152602001838152602001828152602001935050505060405180910390a17fc5c442325655248f6bccf5c6181738f8755524172cea2a8bd1e38e43f833e7f282600054016000548460405180848152602001838152602001828152602001935050505060405180910390a1816000540160008190555060005490509190505600a165627a7a7230582015732bfa66bdede47ecc05446bf4c1e8ed047efac25478cb13b795887df70f290029"
+CONTRACT_TX_FEE = 1 * COIN
+
 def hash256_reversed(byte_str):
     return hash256(byte_str)[::-1]
 
+# Deserialize a contract log as published by the receipt topics, in the format of the RPC results
+def deser_contract_log(f):
+    log = {'address': f.read(20).hex()}
+    log['topics'] = [f.read(32).hex() for _ in range(deser_compact_size(f))]
+    log['data'] = deser_string(f).hex()
+    return log
+
+# Deserialize a contract receipt as published by the rawreceipt topic, in the format of gettransactionreceipt
+# (except for the excepted field, which is published as its code)
+def deser_contract_receipt(f):
+    receipt = {'blockHash': f.read(32)[::-1].hex()}
+    receipt['blockNumber'], = struct.unpack('<I', f.read(4))
+    receipt['transactionHash'] = f.read(32)[::-1].hex()
+    receipt['transactionIndex'], receipt['outputIndex'] = struct.unpack('<II', f.read(8))
+    receipt['from'] = f.read(20).hex()
+    receipt['to'] = f.read(20).hex()
+    receipt['cumulativeGasUsed'], receipt['gasUsed'] = struct.unpack('<QQ', f.read(16))
+    receipt['contractAddress'] = f.read(20).hex()
+    receipt['excepted'], = struct.unpack('<I', f.read(4))
+    receipt['exceptedMessage'] = deser_string(f).decode()
+    receipt['bloom'] = f.read(256).hex()
+    receipt['stateRoot'] = f.read(32).hex()
+    receipt['utxoRoot'] = f.read(32).hex()
+    receipt['log'] = [deser_contract_log(f) for _ in range(deser_compact_size(f))]
+    return receipt
+
 class ZMQSubscriber:
     def __init__(self, socket, topic):
         self.sequence = None  # no sequence number received yet
@@ -78,6 +118,25 @@ class ZMQSubscriber:
             assert label == "D" or label == "C"
         return (hash, label, mempool_sequence)
 
+    def _receive_block_contract_entries(self, deser_entry):
+        f = BytesIO(self._receive_from_publisher_and_check())
+        hash = f.read(32)[::-1].hex()
+        label = chr(f.read(1)[0])
+        assert label == "D" or label == "C"
+        entries = [deser_entry(f) for _ in range(deser_compact_size(f))]
+        assert_equal(f.read(), b"")
+        return (hash, label, entries)
+
+    def receive_receipts(self):
+        return self._receive_block_contract_entries(deser_contract_receipt)
+
+    def receive_logs(self):
+        def deser_entry(f):
+            txid = f.read(32)[::-1].hex()
+            output_index, = struct.unpack('<I', f.read(4))
+            return dict(deser_contract_log(f), transactionHash=txid, outputIndex=output_index)
+        return self._receive_block_contract_entries(deser_entry)
+
 
 class ZMQTestSetupBlock:
     """Helper class for setting up a ZMQ test via the "sync up" procedure.
@@ -103,6 +162,20 @@ class ZMQTestSetupBlock:
         )
 
 
+class ZMQTestSetupContractCall(ZMQTestSetupBlock):
+    """Helper class for the "sync up" procedure of the receipt topics, which
+    only notify the blocks with contract receipts. Calls the log contract before
+    generating the block, and matches the notifications starting with the block
+    hash in serialization order.
+    """
+    def __init__(self, test_framework, node):
+        test_framework.send_log_contract_call()
+        super().__init__(test_framework, node)
+
+    def caused_notification(self, notification):
+        return notification.startswith(bytes.fromhex(self.block_hash)[::-1].hex())
+
+
 class ZMQTest (BitcoinTestFramework):
     def set_test_params(self):
         self.num_nodes = 2
@@ -125,6 +198,7 @@ class ZMQTest (BitcoinTestFramework):
             self.test_reorg()
             self.test_multiple_interfaces()
             self.test_ipv6()
+            self.test_contract_receipts()
         finally:
             # Destroy the ZMQ context.
             self.log.debug("Destroying ZMQ context")
@@ -132,7 +206,7 @@ class ZMQTest (BitcoinTestFramework):
 
     # Restart node with the specified zmq notifications enabled, subscribe to
     # all of them and return the corresponding ZMQSubscriber objects.
-    def setup_zmq_test(self, services, *, recv_timeout=60, sync_blocks=True, ipv6=False):
+    def setup_zmq_test(self, services, *, recv_timeout=60, sync_blocks=True, ipv6=False, setup_block=ZMQTestSetupBlock, extra_args=None):
         subscribers = []
         for topic, address in services:
             socket = self.ctx.socket(zmq.SUB)
@@ -141,7 +215,7 @@ class ZMQTest (BitcoinTestFramework):
             subscribers.append(ZMQSubscriber(socket, topic.encode()))
 
         self.restart_node(0, [f"-zmqpub{topic}={address}" for topic, address in services] +
-                             self.extra_args[0])
+                             self.extra_args[0] + (extra_args or []))
 
         for i, sub in enumerate(subscribers):
             sub.socket.connect(services[i][1])
@@ -155,7 +229,7 @@ class ZMQTest (BitcoinTestFramework):
         for sub in subscribers:
             sub.socket.set(zmq.RCVTIMEO, 1000)
         while True:
-            test_block = ZMQTestSetupBlock(self, self.nodes[0])
+            test_block = setup_block(self, self.nodes[0])
             recv_failed = False
             for sub in subscribers:
                 try:
@@ -581,6 +655,90 @@ class ZMQTest (BitcoinTestFramework):
         # Should receive the same block hash
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[0].receive().hex())
 
+    def send_contract_tx(self, output):
+        # The sender of a contract tx is the P2PK or P2PKH script of its first input
+        utxo = self.p2pk_wallet.get_utxo()
+        tx = CTransaction()
+        tx.vin = [CTxIn(COutPoint(int(utxo['txid'], 16), utxo['vout']))]
+        tx.vout = [output, CTxOut(int(utxo['value'] * COIN) - CONTRACT_TX_FEE, self.p2pk_wallet.get_scriptPubKey())]
+        self.p2pk_wallet.sign_tx(tx)
+        return self.p2pk_wallet.sendrawtransaction(from_node=self.nodes[0], tx_hex=tx.serialize().hex())
+
+    def send_log_contract_call(self):
+        return self.send_contract_tx(make_op_call_output(0, b"\x04", CScriptNum(1000000), CScriptNum(QTUM_MIN_GAS_PRICE), bytes.fromhex("5b9af12b"), bytes.fromhex(self.log_contract)))
+
+    def check_contract_notifications(self, rawreceipt, contractlog, block_hash, label, receipts):
+        received_hash, received_label, received_receipts = rawreceipt.receive_receipts()
+        assert_equal((received_hash, received_label), (block_hash, label))
+        for receipt in received_receipts:
+            assert_equal(receipt.pop('excepted'), 0)
+        assert_equal(received_receipts, [{k: v for k, v in receipt.items() if k != 'excepted'} for receipt in receipts])
+
+        logs = [dict(log, transactionHash=receipt['transactionHash'], outputIndex=receipt['outputIndex']) for receipt in receipts for log in receipt['log']]
+        assert_equal(contractlog.receive_logs(), (block_hash, label, logs))
+
+    def test_contract_receipts(self):
+        """
+        The rawreceipt and contractlog notifications give the receipts and the
+        event logs of the blocks with contract transactions, as they are
+        connected and disconnected.
+        Format of messages:
+        <32-byte hash>C<CompactSize count><entries> : Blockhash connected
+        <32-byte hash>D<CompactSize count><entries> : Blockhash disconnected
+        """
+        self.log.info("Testing 'rawreceipt' and 'contractlog' publishers")
+        node = self.nodes[0]
+        # The receipts are only stored with -logevents, which needs a reindex to be enabled
+        tip = node.getbestblockhash()
+        self.restart_node(0, self.extra_args[0] + ["-logevents", "-reindex"])
+        self.wait_until(lambda: node.getbestblockhash() == tip)
+
+        self.p2pk_wallet = MiniWallet(node, mode=MiniWalletMode.RAW_P2PK)
+        self.wallet.rescan_utxos()
+        self.wallet.send_to(from_node=node, scriptPubKey=self.p2pk_wallet.get_scriptPubKey(), amount=100 * COIN)
+        self.generate(node, 1, sync_fun=self.no_op)
+        self.p2pk_wallet.rescan_utxos()
+        create_txid = self.send_contract_tx(make_op_create_output(node, 0, b"\x04", CScriptNum(1000000), CScriptNum(QTUM_MIN_GAS_PRICE), bytes.fromhex(LOG_CONTRACT_CODE)))
+        self.generate(node, 1, sync_fun=self.no_op)
+        self.log_contract = node.gettransactionreceipt(create_txid)[0]['contractAddress']
+
+        address = f"tcp://127.0.0.1:{self.zmq_port_base}"
+        rawreceipt, contractlog = self.setup_zmq_test(
+            [(topic, address) for topic in ["rawreceipt", "contractlog"]],
+            setup_block=ZMQTestSetupContractCall, extra_args=["-logevents"])
+        self.disconnect_nodes(0, 1)
+        receipt_seq = rawreceipt.sequence
+        log_seq = contractlog.sequence
+
+        self.log.info("Check the receipt and the logs of a contract call")
+        call_txid = self.send_log_contract_call()
+        call_block = self.generatetoaddress(node, 1, ADDRESS_BCRT1_UNSPENDABLE, sync_fun=self.no_op)[0]
+        receipts = node.gettransactionreceipt(call_txid)
+        assert_equal(len(receipts), 1)
+        assert_equal(receipts[0]['blockHash'], call_block)
+        assert_equal(receipts[0]['contractAddress'], self.log_contract)
+        assert_equal(len(receipts[0]['log']), 2)
+        self.check_contract_notifications(rawreceipt, contractlog, call_block, "C", receipts)
+
+        self.log.info("Check that a reorg disconnects them and connects them again with the block that confirms the call")
+        # The longer chain has no contract transactions, its blocks are not notified
+        self.generatetoaddress(self.nodes[1], 2, ADDRESS_BCRT1_P2WSH_OP_TRUE, sync_fun=self.no_op)
+        self.connect_nodes(0, 1)
+        self.sync_blocks()
+        self.check_contract_notifications(rawreceipt, contractlog, call_block, "D", receipts)
+        assert call_txid in node.getrawmempool()
+
+        confirm_block = self.generatetoaddress(node, 1, ADDRESS_BCRT1_UNSPENDABLE)[0]
+        receipts = node.gettransactionreceipt(call_txid)
+        assert_equal(receipts[0]['blockHash'], confirm_block)
+        assert_equal(len(receipts[0]['log']), 2)
+        self.check_contract_notifications(rawreceipt, contractlog, confirm_block, "C", receipts)
+
+        # Every notification took the next sequence number of its topic
+        assert_equal(rawreceipt.sequence, receipt_seq + 3)
+        assert_equal(contractlog.sequence, log_seq + 3)
+
+
 
 if __name__ == '__main__':
     ZMQTest().main()
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the delegation index with the delegation RPCs.
+
+Node 0 serves getdelegationsforstaker and getdelegationinfoforaddress from
+-delegationindex, node 1 replays the delegation events. Both must agree as
+delegations are added, changed and removed, across a reorg, a restart, and
+blocks connected while the index was disabled.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.qtum import create_POD, delegate_to_staker, get_delegate_abi
+from test_framework.qtumconfig import DELEGATION_CONTRACT_ADDRESS
+from test_framework.util import assert_equal
+
+
+class QtumDelegationIndexTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        self.add_wallet_options(parser)
+
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [['-logevents', '-delegationindex'], ['-logevents']]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def check_delegations(self, delegator_address, staker_address, expected):
+        for node in self.nodes:
+            delegations = node.getdelegationsforstaker(staker_address)
+            assert_equal([d['delegate'] for d in delegations], [delegator_address] if expected else [])
+            info = node.getdelegationinfoforaddress(delegator_address)
+            if expected:
+                assert_equal(info['staker'], staker_address)
+                assert_equal(info['fee'], expected)
+                assert_equal(delegations[0]['fee'], expected)
+                assert_equal(delegations[0]['PoD'], info['PoD'])
+                assert info['verified']
+            else:
+                assert_equal(info['staker'], "")
+                assert not info['verified']
+        assert_equal(self.nodes[0].getdelegationsforstaker(staker_address), self.nodes[1].getdelegationsforstaker(staker_address))
+        assert_equal(self.nodes[0].getdelegationinfoforaddress(delegator_address), self.nodes[1].getdelegationinfoforaddress(delegator_address))
+
+    def run_test(self):
+        self.delegator = self.nodes[0]
+        assert self.delegator.getindexinfo('delegationindex')['delegationindex']['synced']
+
+        delegator_address = self.delegator.getnewaddress()
+        staker_address = self.nodes[1].getnewaddress()
+        other_staker_address = self.nodes[1].getnewaddress()
+        self.delegator.sendtoaddress(delegator_address, 100)
+        self.generate(self.delegator, 1)
+        self.check_delegations(delegator_address, staker_address, None)
+
+        self.log.info("Delegate to a staker")
+        delegate_to_staker(self.delegator, delegator_address, staker_address, 10, create_POD(self.delegator, delegator_address, staker_address))
+        self.sync_all()
+        add_hash = self.delegator.getbestblockhash()
+        self.check_delegations(delegator_address, staker_address, 10)
+        self.check_delegations(delegator_address, other_staker_address, None)
+
+        self.log.info("Move the delegation to another staker")
+        abi = get_delegate_abi(other_staker_address, 20, create_POD(self.delegator, delegator_address, other_staker_address))
+        self.delegator.sendtocontract(DELEGATION_CONTRACT_ADDRESS, abi, 0, 2250000, 0.00000040, delegator_address)
+        self.generate(self.delegator, 1)
+        move_hash = self.delegator.getbestblockhash()
+        self.check_delegations(delegator_address, other_staker_address, 20)
+        assert_equal(self.delegator.getdelegationsforstaker(staker_address), [])
+
+        self.log.info("Disconnect the blocks of the delegations")
+        for node in self.nodes:
+            node.invalidateblock(move_hash)
+        self.check_delegations(delegator_address, staker_address, 10)
+        assert_equal(self.delegator.getdelegationsforstaker(other_staker_address), [])
+        for node in self.nodes:
+            node.invalidateblock(add_hash)
+        self.check_delegations(delegator_address, staker_address, None)
+
+        self.log.info("Connect them again")
+        for node in self.nodes:
+            node.reconsiderblock(add_hash)
+        self.sync_all()
+        assert_equal(self.delegator.getbestblockhash(), move_hash)
+        self.check_delegations(delegator_address, other_staker_address, 20)
+
+        self.log.info("Remove the delegation")
+        self.delegator.sendtocontract(DELEGATION_CONTRACT_ADDRESS, "3d666e8b", 0, 2250000, 0.00000040, delegator_address)
+        self.generate(self.delegator, 1)
+        self.check_delegations(delegator_address, other_staker_address, None)
+
+        self.log.info("Delegate again and restart the node with the index")
+        delegate_to_staker(self.delegator, delegator_address, staker_address, 30, create_POD(self.delegator, delegator_address, staker_address))
+        self.sync_all()
+        self.restart_node(0)
+        self.connect_nodes(0, 1)
+        assert self.delegator.getindexinfo('delegationindex')['delegationindex']['synced']
+        self.check_delegations(delegator_address, staker_address, 30)
+
+        self.log.info("Remove the delegation while the index is disabled, the index is then behind the chain")
+        self.restart_node(0, extra_args=['-logevents'])
+        self.connect_nodes(0, 1)
+        self.delegator.sendtocontract(DELEGATION_CONTRACT_ADDRESS, "3d666e8b", 0, 2250000, 0.00000040, delegator_address)
+        self.generate(self.delegator, 1)
+        index_height = self.delegator.getblockcount() - 1
+        self.restart_node(0)
+        self.connect_nodes(0, 1)
+
+        self.log.info("The index catches up with the blocks connected while it was behind")
+        self.wait_until(lambda: self.delegator.getindexinfo('delegationindex')['delegationindex']['best_block_height'] > index_height)
+        assert self.delegator.getindexinfo('delegationindex')['delegationindex']['synced']
+        self.check_delegations(delegator_address, staker_address, None)
+
+
+if __name__ == '__main__':
+    QtumDelegationIndexTest().main()
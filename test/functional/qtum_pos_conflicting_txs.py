@@ -74,6 +74,8 @@ class QtumPOSConflictingStakingMempoolTxTest(BitcoinTestFramework):
 
         # Allow node#1 to stake two blocks, which will orphan any (potentially) staked block in node#0
         self.wait_until(lambda: self.nodes[1].getblockcount() >= COINBASE_MATURITY+25)
+        # The staker reports how long it took to sign its last block
+        assert_greater_than_or_equal(self.nodes[1].getstakinginfo()['latency'], 0)
         self.nodes[0].setmocktime(self.nodes[1].getblock(self.nodes[1].getbestblockhash())['time'])
 
         # Connect the nodes
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test that the stake weight updated coin by coin matches a full computation.
+
+The weight reported by getstakinginfo is updated as wallet transactions and
+blocks change the stakeable coins. checkstakeweight computes it in full from the
+wallet coins and compares both, across block connection and disconnection,
+coin maturity, coin locks and the reserve balance.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.qtumconfig import COINBASE_MATURITY
+from test_framework.messages import COIN
+
+
+class QtumStakeWeightTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        self.add_wallet_options(parser)
+
+    def set_test_params(self):
+        self.num_nodes = 1
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def check_stake_weight(self):
+        check = self.node.checkstakeweight()
+        assert check['consistent']
+        assert_equal(check['weight'], check['computedweight'])
+        assert_equal(check['delegateweight'], check['computeddelegateweight'])
+        info = self.node.getstakinginfo()
+        assert_equal(info['weight'], check['weight'])
+        assert_equal(info['delegateweight'], check['delegateweight'])
+        return check['weight']
+
+    def run_test(self):
+        self.node = self.nodes[0]
+        self.check_stake_weight()
+
+        self.log.info("Spend coins to a new address of the wallet")
+        address = self.node.getnewaddress("", "legacy")
+        txid = self.node.sendtoaddress(address, 1000)
+        vout = next(d['vout'] for d in self.node.gettransaction(txid)['details'] if d['address'] == address and d['category'] == 'receive')
+        self.check_stake_weight()
+
+        self.log.info("Connect blocks until the new coin is about to mature")
+        self.generatetoaddress(self.node, 1, self.node.getnewaddress())
+        confirmed_hash = self.node.getbestblockhash()
+        self.check_stake_weight()
+        self.generatetoaddress(self.node, COINBASE_MATURITY - 2, self.node.getnewaddress())
+        weight_immature = self.check_stake_weight()
+
+        self.log.info("Connect the block that matures the coin")
+        self.generatetoaddress(self.node, 1, self.node.getnewaddress())
+        mature_hash = self.node.getbestblockhash()
+        weight_mature = self.check_stake_weight()
+        assert_greater_than_or_equal(weight_mature - weight_immature, 1000 * COIN)
+
+        self.log.info("Disconnect and connect again the block that matures the coin")
+        self.node.invalidateblock(mature_hash)
+        assert_equal(self.check_stake_weight(), weight_immature)
+        self.node.reconsiderblock(mature_hash)
+        assert_equal(self.node.getbestblockhash(), mature_hash)
+        assert_equal(self.check_stake_weight(), weight_mature)
+
+        self.log.info("Lock and unlock the coin")
+        self.node.lockunspent(False, [{"txid": txid, "vout": vout}])
+        assert_equal(self.check_stake_weight(), weight_mature - 1000 * COIN)
+        self.node.lockunspent(True, [{"txid": txid, "vout": vout}])
+        assert_equal(self.check_stake_weight(), weight_mature)
+
+        self.log.info("Set and clear the reserve balance")
+        self.node.reservebalance(True, 1)
+        self.check_stake_weight()
+        self.node.reservebalance(False)
+        assert_equal(self.check_stake_weight(), weight_mature)
+
+        self.log.info("Disconnect the block that confirmed the coin")
+        self.node.invalidateblock(confirmed_hash)
+        assert txid in self.node.getrawmempool()
+        self.check_stake_weight()
+        self.node.reconsiderblock(confirmed_hash)
+        assert_equal(self.node.getbestblockhash(), mature_hash)
+        assert_equal(self.check_stake_weight(), weight_mature)
+
+        self.log.info("Spend the coin")
+        self.node.sendtoaddress(self.node.getnewaddress(), 1500)
+        self.check_stake_weight()
+        self.generatetoaddress(self.node, 1, self.node.getnewaddress())
+        self.check_stake_weight()
+
+
+if __name__ == '__main__':
+    QtumStakeWeightTest().main()
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the consolidation of the small staking outputs (-stakingconsolidate).
+
+The consolidation runs from the scheduler, forwarded with mockscheduler. It is
+checked to wait for low fees and for the last consolidation to be confirmed,
+to keep the mature outputs within the stake weight budget, and to commit a
+transaction spending the smallest outputs of the address back to it.
+"""
+
+from decimal import Decimal
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.qtumconfig import COINBASE_MATURITY
+from test_framework.util import assert_equal
+
+CONSOLIDATE_INTERVAL = 600
+
+
+class QtumStakingConsolidateTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        self.add_wallet_options(parser)
+
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [['-stakingconsolidate=1', '-stakingconsolidatemaxutxos=5', '-stakingconsolidatevalue=100']]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def fund(self, amount, count):
+        for _ in range(count):
+            self.funder.sendtoaddress(self.address, amount)
+
+    def run_consolidation(self):
+        self.node.mockscheduler(CONSOLIDATE_INTERVAL)
+
+    def assert_no_consolidation(self):
+        with self.node.assert_debug_log(expected_msgs=[], unexpected_msgs=['Consolidated']):
+            self.run_consolidation()
+        assert_equal(self.consolidations(), [])
+
+    def consolidations(self):
+        # Unconfirmed transactions sent by the staker wallet
+        return sorted({tx['txid'] for tx in self.staker.listtransactions('*', 1000) if tx['category'] == 'send' and tx['confirmations'] == 0})
+
+    def check_consolidation(self, inputs):
+        with self.node.assert_debug_log([f'Consolidated {inputs} staking outputs']):
+            self.run_consolidation()
+        self.wait_until(lambda: len(self.consolidations()) == 1)
+        txid = self.consolidations()[0]
+        tx = self.staker.gettransaction(txid, True, True)['decoded']
+        assert_equal(len(tx['vin']), inputs)
+        assert all(txout['scriptPubKey']['address'] == self.address for txout in tx['vout'])
+        return txid, tx
+
+    def run_test(self):
+        self.node = self.nodes[0]
+        self.funder = self.node.get_wallet_rpc(self.default_wallet_name)
+        self.node.createwallet(wallet_name='staker')
+        self.staker = self.node.get_wallet_rpc('staker')
+        self.address = self.staker.getnewaddress('', 'legacy')
+
+        self.log.info("Create mature outputs with stake weight and young outputs without")
+        self.fund(5, 8)
+        self.generatetoaddress(self.node, COINBASE_MATURITY, self.funder.getnewaddress())
+        self.fund(1, 3)
+        self.generatetoaddress(self.node, 1, self.funder.getnewaddress())
+        assert_equal(len(self.staker.listunspent()), 11)
+
+        self.log.info("Wait for the fees to be low")
+        self.staker.settxfee(Decimal('0.01'))
+        self.assert_no_consolidation()
+        self.staker.settxfee(0)
+
+        self.log.info("Spend the outputs without stake weight, the mature ones don't fit in the weight budget")
+        txid, tx = self.check_consolidation(3)
+        spent_values = [self.staker.gettransaction(txin['txid'], True, True)['decoded']['vout'][txin['vout']]['value'] for txin in tx['vin']]
+        assert_equal(spent_values, [Decimal(1)] * 3)
+
+        self.log.info("Wait for the last consolidation to be confirmed")
+        self.node.prioritisetransaction(txid, 0, -100000000)
+        self.fund(1, 3)
+        self.generatetoaddress(self.node, 1, self.funder.getnewaddress())
+        assert txid in self.node.getrawmempool()
+        with self.node.assert_debug_log(expected_msgs=[], unexpected_msgs=['Consolidated']):
+            self.run_consolidation()
+        assert_equal(self.consolidations(), [txid])
+
+        self.log.info("Consolidate again once it is confirmed, the consolidated output is immature")
+        self.node.prioritisetransaction(txid, 0, 100000000)
+        self.generatetoaddress(self.node, 1, self.funder.getnewaddress())
+        assert_equal(self.staker.gettransaction(txid)['confirmations'], 1)
+        txid, tx = self.check_consolidation(4)
+        assert txid in self.node.getrawmempool()
+        assert_equal(self.staker.gettransaction(txid)['txid'], txid)
+        self.generatetoaddress(self.node, 1, self.funder.getnewaddress())
+        assert_equal(self.staker.gettransaction(txid)['confirmations'], 1)
+        assert_equal(len(self.staker.listunspent()), 9)
+
+
+if __name__ == '__main__':
+    QtumStakingConsolidateTest().main()
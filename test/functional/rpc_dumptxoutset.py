@@ -5,6 +5,9 @@
 """Test the generation of UTXO snapshots using `dumptxoutset`.
 """
 
+import hashlib
+import io
+
 from test_framework.blocktools import COINBASE_MATURITY
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
@@ -15,6 +18,33 @@ from test_framework.util import (
 from test_framework.qtumconfig import *
 
 
+def read_varint(f):
+    n = 0
+    while True:
+        b = f.read(1)[0]
+        n = (n << 7) | (b & 0x7f)
+        if not b & 0x80:
+            return n
+        n += 1
+
+
+def snapshot_coins_end(contents, offset):
+    """Return the offset of the end of the coins, given the offset of the metadata."""
+    f = io.BytesIO(contents)
+    f.seek(offset + 32)
+    coins_count = int.from_bytes(f.read(8), 'little')
+    for _ in range(coins_count):
+        f.read(32 + 4)  # outpoint
+        read_varint(f)  # height, coinbase and coinstake
+        read_varint(f)  # compressed amount
+        script_size = read_varint(f)
+        if script_size < 6:
+            f.read(20 if script_size < 2 else 32)
+        else:
+            f.read(script_size - 6)
+    return f.tell()
+
+
 class DumptxoutsetTest(BitcoinTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
@@ -41,14 +71,33 @@ class DumptxoutsetTest(BitcoinTestFramework):
             out['base_hash'],
             '1c6a2bd16896a6dbaa571008982248288bd049df79ae97e8303d942044f37dc7')
 
-        # UTXO snapshot hash should be deterministic based on mocked time.
+        # The snapshot starts with the magic bytes and the version of the format
+        with open(expected_path, 'rb') as f:
+            contents = f.read()
+        assert_equal(contents[:5], b'utxo\xff')
+        assert_equal(int.from_bytes(contents[5:7], 'little'), 2)
+
+        # The metadata and the coins after the header are unchanged by the versioned format,
+        # their hash should be deterministic based on mocked time.
+        coins_end = snapshot_coins_end(contents, 7)
         assert_equal(
-            sha256sum_file(str(expected_path)).hex(),
+            hashlib.sha256(contents[7:coins_end]).hexdigest(),
             'f150758e2b321b537f31356d1e2d34bda29b72823cd4eeb6fc9cffcd8690e344')
 
+        # The contract state section starts with a null outpoint
+        assert_equal(contents[coins_end:coins_end + 36], b'\x00' * 32 + b'\xff' * 4)
+
+        # UTXO snapshot contents should be deterministic, including the contract state.
+        out2 = node.dumptxoutset(FILENAME + '.2')
+        assert_equal(
+            sha256sum_file(str(expected_path)).hex(),
+            sha256sum_file(out2['path']).hex())
+        assert_equal(out2['accounts_written'], out['accounts_written'])
+
         assert_equal(
             out['txoutset_hash'], '95ee89650dd9a0c63cdf6b7900eee8b1ca973024b3f2305aa9a28ea654d30588')
         assert_equal(out['nchaintx'], 2001)
+        assert out['accounts_written'] > 0
 
         # Specifying a path to an existing or invalid file will fail.
         assert_raises_rpc_error(
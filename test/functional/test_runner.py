@@ -217,6 +217,7 @@ BASE_SCRIPTS = [
     'wallet_conflicts.py --descriptors',
     'interface_http.py',
     'interface_rpc.py',
+    'interface_rpc_unix.py',
     'interface_usdt_coinselection.py',
     'interface_usdt_mempool.py',
     'interface_usdt_net.py',
@@ -416,6 +417,14 @@ BASE_SCRIPTS = [
     'qtum_dgp.py --descriptors',
     'qtum_pos.py --legacy-wallet',
     'qtum_pos.py --descriptors',
+    'qtum_stake_weight.py --legacy-wallet',
+    'qtum_stake_weight.py --descriptors',
+    'qtum_delegation_index.py --legacy-wallet',
+    'qtum_delegation_index.py --descriptors',
+    'qtum_staking_consolidate.py --legacy-wallet',
+    'qtum_staking_consolidate.py --descriptors',
+    'qtum_token_balance.py --legacy-wallet',
+    'qtum_token_balance.py --descriptors',
     'qtum_opcall.py --legacy-wallet',
     'qtum_opcall.py --descriptors',
     'qtum_opcreate.py --legacy-wallet',
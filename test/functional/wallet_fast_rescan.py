@@ -2,8 +2,9 @@
 # Copyright (c) 2022 The Bitcoin Core developers
 # Distributed under the MIT software license, see the accompanying
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
-"""Test that fast rescan using block filters for descriptor wallets detects
-   top-ups correctly and finds the same transactions than the slow variant."""
+"""Test that fast rescan using block filters or the address index for descriptor
+   wallets detects top-ups correctly and finds the same transactions than the
+   slow variant."""
 from test_framework.address import address_to_scriptpubkey
 from test_framework.descriptors import descsum_create
 from test_framework.test_framework import BitcoinTestFramework
@@ -89,12 +90,22 @@ class WalletFastRescanTest(BitcoinTestFramework):
             w.importdescriptors([{"desc": descriptor['desc'], "timestamp": 0} for descriptor in descriptors])
         txids_slow_nonactive = self.get_wallet_txids(node, 'rescan_slow_nonactive')
 
+        height = node.getblockcount()
+        self.restart_node(0, [f'-keypool={KEYPOOL_SIZE}', '-addrindex=1', '-reindex'])
+        self.wait_until(lambda: node.getblockcount() == height)
+        self.log.info("Import wallet backup with address index")
+        with node.assert_debug_log(['fast variant using the address index']):
+            node.restorewallet("rescan_addrindex", WALLET_BACKUP_FILENAME)
+        txids_addrindex = self.get_wallet_txids(node, 'rescan_addrindex')
+
         self.log.info("Verify that all rescans found the same txs in slow and fast variants")
         assert_equal(len(txids_slow), NUM_DESCRIPTORS * NUM_BLOCKS)
         assert_equal(len(txids_fast), NUM_DESCRIPTORS * NUM_BLOCKS)
         assert_equal(len(txids_slow_nonactive), NUM_DESCRIPTORS * NUM_BLOCKS)
         assert_equal(len(txids_fast_nonactive), NUM_DESCRIPTORS * NUM_BLOCKS)
+        assert_equal(len(txids_addrindex), NUM_DESCRIPTORS * NUM_BLOCKS)
         assert_equal(sorted(txids_slow), sorted(txids_fast))
+        assert_equal(sorted(txids_slow), sorted(txids_addrindex))
         assert_equal(sorted(txids_slow_nonactive), sorted(txids_fast_nonactive))
 
 